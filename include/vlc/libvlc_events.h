@@ -95,6 +95,13 @@ enum libvlc_event_e {
      * wish to use them
      */
     libvlc_MediaAttachedThumbnailsFound,
+    /**
+     * Subitems of a \link #libvlc_media_t media item\endlink were read
+     * while parsing it, e.g. the entries of a large directory. This reports
+     * the progress of the parsing: the subitems are added, sorted, once all
+     * of them are read (see libvlc_MediaSubItemTreeAdded).
+     */
+    libvlc_MediaSubItemsProgress,
 
     libvlc_MediaPlayerMediaChanged=0x100,
     libvlc_MediaPlayerNothingSpecial,
@@ -278,6 +285,10 @@ typedef struct libvlc_event_t
         {
             libvlc_picture_list_t* thumbnails;
         } media_attached_thumbnails_found;
+        struct
+        {
+            unsigned count; /**< number of subitems read so far */
+        } media_subitems_progress;
 
         /* media instance */
         struct
@@ -589,7 +589,8 @@ LIBVLC_API int
  *
  * To track when this is over you can listen to libvlc_MediaParsedChanged
  * event. However if this functions returns an error, you will not receive any
- * events.
+ * events. While a large directory is parsed, libvlc_MediaSubItemsProgress
+ * events report the number of entries read so far.
  *
  * It uses a flag to specify parse options (see libvlc_media_parse_flag_t). All
  * these flags can be combined. By default, media is parsed if it's a local
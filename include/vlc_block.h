@@ -87,6 +87,7 @@
 #define block_CopyProperties vlc_frame_CopyProperties
 #define block_Duplicate vlc_frame_Duplicate
 #define block_heap_Alloc vlc_frame_heap_Alloc
+#define block_IsWritable vlc_frame_IsWritable
 #define block_mmap_Alloc vlc_frame_mmap_Alloc
 #define block_shm_Alloc vlc_frame_shm_Alloc
 #define block_File vlc_frame_File
@@ -217,6 +217,56 @@ static inline int block_GetBytes( block_bytestream_t *p_bytestream,
     return VLC_SUCCESS;
 }
 
+/**
+ * Takes the next bytes out of the byte stream, copying as few as possible.
+ *
+ * This only succeeds if the i_data next bytes reach the end of the current
+ * block, which is not the last one, if no read bytes are pending (see
+ * block_BytestreamFlush()), and if the block is writable (see
+ * block_IsWritable()), since the caller gets to modify it. The last block
+ * stays in the byte stream, so that block_BytestreamPop() still returns it.
+ * That block is then removed from the byte stream and returned with its
+ * payload restricted to those bytes, the bytes already read becoming spare
+ * room in front of them. The few bytes located in the next blocks, if any,
+ * are copied after the payload, provided that they fit in its spare room.
+ *
+ * \return the block, or NULL if the bytes cannot be taken
+ */
+VLC_USED
+static inline block_t *block_BytestreamTake( block_bytestream_t *p_bytestream,
+                                             size_t i_data )
+{
+    block_t *p_block = p_bytestream->p_block;
+
+    if( p_block == NULL || p_block != p_bytestream->p_chain ||
+        p_block->p_next == NULL ||
+        block_BytestreamRemaining( p_bytestream ) < i_data ||
+        !block_IsWritable( p_block ) )
+        return NULL;
+
+    const size_t i_offset = p_bytestream->i_block_offset;
+    const size_t i_head = p_block->i_buffer - i_offset;
+    if( i_head == 0 || i_data < i_head )
+        return NULL;
+
+    uint8_t *p_end = p_block->p_buffer + p_block->i_buffer;
+    if( (size_t)(p_block->p_start + p_block->i_size - p_end) < i_data - i_head )
+        return NULL;
+
+    vlc_assert( p_bytestream->i_base_offset == 0 );
+    p_bytestream->p_chain = p_bytestream->p_block = p_block->p_next;
+    p_bytestream->i_total -= p_block->i_buffer;
+    p_bytestream->i_block_offset = 0;
+
+    block_GetBytes( p_bytestream, p_end, i_data - i_head );
+
+    p_block->p_next = NULL;
+    p_block->p_buffer += i_offset;
+    p_block->i_buffer = i_data;
+
+    return p_block;
+}
+
 static inline int block_SkipBytes( block_bytestream_t *p_bytestream,
                                    size_t i_data )
 {
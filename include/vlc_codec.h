@@ -357,6 +357,21 @@ VLC_API int decoder_UpdateVideoFormat( decoder_t *dec );
  */
 VLC_API picture_t *decoder_NewPicture( decoder_t *dec );
 
+/**
+ * Get the number of threads a decoder should use.
+ *
+ * This is the number of CPUs, unless the CPUs are shared between the video
+ * decoders of the process (see the "dec-threads-shared" option): then this
+ * is the share of the CPUs reserved when the decoder was created, which does
+ * not change afterwards.
+ *
+ * To be used by decoder modules using threads, if not set by the user or
+ * the decoder owner (see the "dec-threads" option).
+ *
+ * \return the number of threads (at least one)
+ */
+VLC_API unsigned decoder_GetThreadCount( decoder_t *dec ) VLC_USED;
+
 /**
  * Initialize a decoder structure before creating the decoder.
  *
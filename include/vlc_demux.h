@@ -65,6 +65,19 @@ typedef struct demux_meta_t
     input_attachment_t **attachments;    /**< array of attachments */
 } demux_meta_t;
 
+/**
+ * Segment download of an adaptive stream, see DEMUX_GET_DOWNLOADS
+ */
+typedef struct
+{
+    char       psz_representation[64]; /**< representation ID, truncated */
+    uint64_t   i_bandwidth; /**< advertised bitrate of the representation */
+    uint64_t   i_size;      /**< downloaded bytes */
+    vlc_tick_t i_duration;  /**< from request to last byte */
+    vlc_tick_t i_latency;   /**< from request to first byte */
+    vlc_tick_t i_date;      /**< completion date */
+} demux_download_t;
+
 /**
  * Control query identifiers for use with demux_t.pf_control
  *
@@ -128,6 +141,20 @@ enum demux_query_e
      * arg1= int* */
     DEMUX_GET_TYPE = 0x109,
 
+    /** Retrieves the last segment downloads, oldest first.
+     * The array must be released with free().
+     * Can fail if the stream is not segmented.
+     *
+     * arg1= demux_download_t **, arg2= size_t * */
+    DEMUX_GET_DOWNLOADS = 0x10B,
+
+    /** Retrieves the progress of the index built while playing, in the
+     * range [0:1], 1 once it is complete.
+     * Can fail if the demuxer does not build its index while playing.
+     *
+     * arg1= double * */
+    DEMUX_GET_INDEX_PROGRESS = 0x10D,
+
     /** Sets the paused or playing/resumed state.
      *
      * Streams are initially in playing state. The control always specifies a
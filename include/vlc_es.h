@@ -64,6 +64,22 @@ typedef struct
     float      pf_gain[AUDIO_REPLAY_GAIN_MAX];
 } audio_replay_gain_t;
 
+/**
+ * Audio gapless information
+ *
+ * Positions are in samples, counted from the first sample of the ES, which
+ * is dated VLC_TICK_0.
+ */
+typedef struct
+{
+    /* encoder and decoder delay to skip at the start */
+    uint32_t i_delay;
+    /* padding to skip at the end */
+    uint32_t i_padding;
+    /* total number of samples including delay and padding, 0 if unknown */
+    uint64_t i_samples;
+} audio_gapless_t;
+
 
 /**
  * Audio channel type
@@ -642,6 +658,7 @@ struct es_format_t
         struct {
             audio_format_t  audio;    /**< description of audio format */
             audio_replay_gain_t audio_replay_gain; /**< audio replay gain information */
+            audio_gapless_t audio_gapless; /**< audio gapless information */
         };
         video_format_t video;     /**< description of video format */
         subs_format_t  subs;      /**< description of subtitle format */
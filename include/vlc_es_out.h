@@ -113,6 +113,10 @@ enum es_out_query_e
     ES_OUT_SPU_SET_HIGHLIGHT, /* arg1= es_out_id_t* (spu es),
                                  arg2= const vlc_spu_highlight_t *, res=can fail  */
 
+    /* Subitems read so far, before ES_OUT_POST_SUBNODE posts all of them */
+    ES_OUT_POST_SUBITEMS, /* arg1=input_item_t *const *, arg2=size_t,
+                             arg3=size_t (total read), res=can fail */
+
     /* First value usable for private control */
     ES_OUT_PRIVATE_START = 0x10000,
 };
@@ -168,6 +168,18 @@ vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 VLC_API bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Change the maximum number of threads.
+ *
+ * Threads are spawned as needed for the queued runnables. When the maximum is
+ * lowered, the extra threads exit as soon as they are idle.
+ *
+ * \param executor the executor
+ * \param max_threads the new maximum number of threads (at least 1)
+ */
+VLC_API void
+vlc_executor_SetMaxThreads(vlc_executor_t *executor, unsigned max_threads);
+
 /**
  * Wait until all submitted tasks are completed or canceled.
  *
@@ -116,6 +116,8 @@ typedef struct vlc_frame_t vlc_frame_t;
 struct vlc_frame_callbacks
 {
     void (*free)(vlc_frame_t *);
+    /** Whether the frames own their whole buffer (see vlc_frame_IsWritable()) */
+    bool writable;
 };
 
 struct vlc_frame_t
@@ -211,6 +213,35 @@ VLC_API vlc_frame_t *vlc_frame_Realloc(vlc_frame_t *, ssize_t pre, size_t body)
  */
 VLC_API void vlc_frame_Release(vlc_frame_t *frame);
 
+/**
+ * Frame pool statistics.
+ */
+struct vlc_frame_pool_stats
+{
+    uint64_t hits; /**< frames allocated from the pool */
+    uint64_t misses; /**< frames allocated from the heap for the pool */
+    size_t bytes; /**< memory held by the pool, frames in use included */
+    size_t peak_bytes; /**< highest value of bytes */
+};
+
+/**
+ * Enables or disables the frame pool.
+ *
+ * Unless disabled, vlc_frame_Alloc() recycles the small and medium frames
+ * through per-thread caches. Frames allocated from the pool while it was
+ * enabled remain valid once it is disabled, and are freed when released.
+ *
+ * This is process-wide and can be changed at any time.
+ */
+VLC_API void vlc_frame_SetPooling(bool enabled);
+
+/**
+ * Gets the frame pool statistics.
+ *
+ * The counters are process-wide and never reset.
+ */
+VLC_API void vlc_frame_GetPoolStats(struct vlc_frame_pool_stats *stats);
+
 /**
  * Attach an ancillary to the frame
  *
@@ -286,6 +317,21 @@ static inline vlc_frame_t *vlc_frame_Duplicate( const vlc_frame_t *frame )
  */
 VLC_API vlc_frame_t *vlc_frame_heap_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC;
 
+/**
+ * Checks whether the whole buffer of a frame can be written in place.
+ *
+ * This is true for the frames whose callbacks are flagged writable, such as
+ * the frames allocated by vlc_frame_Alloc() or wrapping a heap allocation,
+ * which own their buffer. Other frames, e.g. mapping a file
+ * read-only or memory shared with another process, must only be read: their
+ * data, or the spare room around it, must be copied to a new frame in order
+ * to be modified.
+ *
+ * @param frame frame to check
+ * @return true if the buffer, including its spare room, is writable
+ */
+VLC_API bool vlc_frame_IsWritable(const vlc_frame_t *frame) VLC_USED;
+
 /**
  * Wraps a memory mapping in a frame
  *
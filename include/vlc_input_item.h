@@ -205,6 +205,14 @@ struct input_item_node_t
     input_item_t *         p_item;
     int                    i_children;
     input_item_node_t      **pp_children;
+
+    /* Optional, notified of the children read so far by a directory access,
+     * before they are sorted (see vlc_readdir_helper_additem()), and of the
+     * total number of children read, including the ones not notified yet */
+    void                (* pf_read)( input_item_node_t *,
+                                     input_item_t *const *, size_t, size_t,
+                                     void * );
+    void *                 p_read_data;
 };
 
 VLC_API void input_item_CopyOptions( input_item_t *p_child, input_item_t *p_parent );
@@ -431,6 +439,26 @@ typedef struct input_item_parser_cbs_t
      * @param userdata user data set by input_item_Parse()
      */
     void (*on_subtree_added)(input_item_t *item, input_item_node_t *subtree, void *userdata);
+
+    /**
+     * Event received when subitems are read, before the whole subtree is
+     * added (e.g. the entries of a large directory, by batches)
+     *
+     * The subitems are not sorted and may be incomplete (without their
+     * slaves), on_subtree_added() is still called with all of them. The
+     * subitems that may be slaves of others are held until all of them are
+     * read, but they are counted in the total.
+     *
+     * @note This callback is optional.
+     *
+     * @param item the parsed item
+     * @param subitems subitems read since the previous event
+     * @param count number of subitems
+     * @param total number of subitems read so far, including the held ones
+     * @param userdata user data set by input_item_Parse()
+     */
+    void (*on_subitems_read)(input_item_t *item, input_item_t *const *subitems,
+                             size_t count, size_t total, void *userdata);
 } input_item_parser_cbs_t;
 
 /**
@@ -496,6 +524,9 @@ enum input_item_preparse_status
 typedef struct input_preparser_callbacks_t {
     void (*on_preparse_ended)(input_item_t *, enum input_item_preparse_status status, void *userdata);
     void (*on_subtree_added)(input_item_t *, input_item_node_t *subtree, void *userdata);
+    /* Optional, see input_item_parser_cbs_t.on_subitems_read */
+    void (*on_subitems_read)(input_item_t *, input_item_t *const *subitems,
+                             size_t count, size_t total, void *userdata);
 } input_preparser_callbacks_t;
 
 typedef struct input_fetcher_callbacks_t {
@@ -542,6 +573,14 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Timeshift */
+    vlc_tick_t i_timeshift_window; /* Duration buffered ahead of the playback */
+
+    /* Adaptive streaming, from the last segment downloads */
+    uint64_t i_download_bandwidth; /* Advertised bitrate of the last one */
+    float f_download_bitrate;      /* Measured throughput */
+    vlc_tick_t i_download_latency; /* Time to first byte of the last one */
 };
 
 /**
@@ -561,6 +600,11 @@ struct vlc_readdir_helper
     bool b_show_hiddenfiles;
     bool b_flatten;
     char *psz_ignored_exts;
+    input_item_t **pp_read;  /* items read but not notified yet */
+    size_t i_read;
+    size_t i_read_held;      /* possible slaves read but not notified yet */
+    size_t i_read_total;     /* items read, including the held slaves */
+    vlc_tick_t i_read_date;  /* date of the last notification */
 };
 
 /**
@@ -597,6 +641,12 @@ VLC_API void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_
  * \param i_net see \ref input_item_net_type
  * \param[out] created_item if an input item is created. The item should not be
  * released and is valid until vlc_readdir_helper_finish() is called.
+ *
+ * The items added at the top of the node are notified by batches to the
+ * pf_read callback of the node, if any, while the directory is read. They are
+ * sorted only by vlc_readdir_helper_finish(). The items that may be slaves are
+ * only counted: they are notified by vlc_readdir_helper_finish(), unless they
+ * are attached to another item.
  * \param status VLC_SUCCESS in case of success, an error otherwise. Parsing
  * should be aborted in case of error.
  */
@@ -2796,6 +2796,20 @@ struct vlc_player_cbs
     void (*on_buffering_changed)(vlc_player_t *player,
         float new_buffering, void *data);
 
+    /**
+     * Called when the progress of the media index has changed
+     *
+     * Only sent for media whose index is built while playing, as AVI files
+     * with a broken or missing index. Seeking is approximate until it
+     * reaches 1.
+     *
+     * @param player locked player instance
+     * @param progress progress in the range [0:1]
+     * @param data opaque pointer set by vlc_player_AddListener()
+     */
+    void (*on_index_progress_changed)(vlc_player_t *player,
+        float progress, void *data);
+
     /**
      * Called when the player rate has changed
      *
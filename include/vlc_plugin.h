@@ -48,6 +48,7 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_SIGNATURE,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -310,6 +311,19 @@ VLC_METADATA_EXPORTS
         goto error; \
 }
 
+/* Magic bytes of the streams handled by the module (string literal), at a
+ * given offset. Matching modules are probed first. */
+#define add_signature( offset, magic ) \
+    add_signature_repeat( offset, magic, 0, 1 )
+
+/* Magic bytes repeated count times, every stride bytes from the offset,
+ * such as the sync bytes of fixed size packets */
+#define add_signature_repeat( offset, magic, stride, count ) \
+    if (vlc_module_set (VLC_MODULE_SIGNATURE, (unsigned)(offset), \
+                        (const char *)(magic), sizeof (magic) - 1, \
+                        (unsigned)(stride), (unsigned)(count))) \
+        goto error;
+
 #define set_shortname( shortname ) \
     if (vlc_module_set (VLC_MODULE_SHORTNAME, (const char *)(shortname))) \
         goto error;
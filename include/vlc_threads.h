@@ -821,6 +821,8 @@ VLC_USED;
  *
  * \warning This function <b>must</b> be called before the timer data can be
  * freed and before the timer callback function can be unmapped/unloaded.
+ * It waits for the timer function to return, so it must not be called from
+ * the timer function itself.
  *
  * \param timer timer to destroy
  */
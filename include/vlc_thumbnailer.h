@@ -112,6 +112,50 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               input_item_t *input_item, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief vlc_thumbnailer_strip_cb defines a callback invoked for each picture
+ * of a strip request
+ *
+ * It is called exactly once for each requested time, in the order of the
+ * times array, the request being completed after the last call.
+ * The picture, if any, is owned by the thumbnailer, as for vlc_thumbnailer_cb.
+ *
+ * \param data Is the opaque pointer passed as vlc_thumbnailer_RequestStrip last
+ * parameter
+ * \param index The index of the picture time in the requested times
+ * \param thumbnail The generated thumbnail, or NULL in case of failure or timeout
+ */
+typedef void(*vlc_thumbnailer_strip_cb)( void* data, size_t index,
+                                         picture_t* thumbnail );
+
+/**
+ * \brief vlc_thumbnailer_RequestStrip Requests thumbnails at several times
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken
+ * \param count The number of times, must not be 0
+ * \param width The maximum width of the thumbnails, or 0
+ * \param height The maximum height of the thumbnails, or 0
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for the whole request, or VLC_TICK_INVALID
+ * to disable timeout
+ * \param cb A user callback to be called for each thumbnail (success & error)
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * This is meant for timeline strips: the media is opened once, and the
+ * nearest keyframe of each time is decoded (fast seek).
+ * If width or height is not 0, the thumbnails are scaled to fit in, keeping
+ * the aspect ratio.
+ * The request object follows the rules of vlc_thumbnailer_RequestByTime, and
+ * must not be used after the last callback invocation.
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestStrip( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              unsigned width, unsigned height,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_strip_cb cb, void* user_data );
+
 /**
  * \brief vlc_thumbnailer_Cancel Cancel a thumbnail request
  * \param thumbnailer A thumbnailer object
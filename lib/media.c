@@ -283,6 +283,29 @@ static void input_item_subtree_added(input_item_t *item,
     libvlc_media_add_subtree(p_md, node);
 }
 
+static void input_item_subitems_read(input_item_t *item,
+                                     input_item_t *const *subitems,
+                                     size_t count, size_t total,
+                                     void *user_data)
+{
+    VLC_UNUSED(item); VLC_UNUSED(subitems); VLC_UNUSED(count);
+    libvlc_media_t * p_md = user_data;
+
+    /* Only read by the parsing thread. The held subitems are already
+     * counted when they are flushed. */
+    if (total <= p_md->subitems_read)
+        return;
+    p_md->subitems_read = total;
+
+    /* Construct the event */
+    libvlc_event_t event;
+    event.type = libvlc_MediaSubItemsProgress;
+    event.u.media_subitems_progress.count = p_md->subitems_read;
+
+    /* Send the event */
+    libvlc_event_send( &p_md->event_manager, &event );
+}
+
 void libvlc_media_add_subtree(libvlc_media_t *p_md, input_item_node_t *node)
 {
     input_item_add_subnode( p_md, node );
@@ -881,6 +904,7 @@ libvlc_media_get_stat( libvlc_media_t *p_md, unsigned type, uint64_t *out )
 static const input_preparser_callbacks_t input_preparser_callbacks = {
     .on_preparse_ended = input_item_preparse_ended,
     .on_subtree_added = input_item_subtree_added,
+    .on_subitems_read = input_item_subitems_read,
 };
 
 static int media_parse(libvlc_media_t *media, bool b_async,
@@ -895,6 +919,7 @@ static int media_parse(libvlc_media_t *media, bool b_async,
     {
         media->is_parsed = false;
         media->parsed_status = 0;
+        media->subitems_read = 0;
     }
     vlc_mutex_unlock(&media->parsed_lock);
 
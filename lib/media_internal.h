@@ -54,6 +54,7 @@ struct libvlc_media_t
     atomic_uint worker_count;
 
     libvlc_media_parsed_status_t parsed_status;
+    unsigned subitems_read;
     bool is_parsed;
     bool has_asked_preparse;
 };
@@ -97,6 +97,7 @@ static void libvlc_picture_block_release( block_t* block )
 static const struct vlc_block_callbacks block_cbs =
 {
     libvlc_picture_block_release,
+    false,
 };
 
 static libvlc_picture_t* libvlc_picture_from_attachment( input_attachment_t* attachment )
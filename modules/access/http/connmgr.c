@@ -103,6 +103,8 @@ struct vlc_http_mgr
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    bool multiplexed;
+    vlc_mutex_t lock;
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -121,25 +123,57 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
     vlc_http_conn_release(conn);
 }
 
+/**
+ * Stores a new connection, unless another thread connected concurrently:
+ * the first connection is kept, and this one is released once it is idle.
+ */
+static void vlc_http_mgr_set(struct vlc_http_mgr *mgr,
+                             struct vlc_http_conn *conn, bool multiplexed)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool first = mgr->conn == NULL;
+    if (first)
+    {
+        mgr->conn = conn;
+        mgr->multiplexed = multiplexed;
+    }
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (!first)
+        vlc_http_conn_release(conn);
+}
+
 static
 struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
+    vlc_mutex_lock(&mgr->lock);
     struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
     if (conn == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL;
+    }
 
+    /* The opened stream keeps the connection alive even if another thread
+     * releases it, so the response can be waited for without the lock. */
     struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    vlc_mutex_unlock(&mgr->lock);
+
     if (stream != NULL)
     {
         struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
         if (m != NULL)
             return m;
     }
+
     /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->conn == conn)
+        vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
     return NULL;
 }
 
@@ -151,15 +185,23 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->creds == NULL && mgr->conn != NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL; /* switch from HTTP to HTTPS not implemented */
+    }
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
             return NULL;
+        }
     }
+    vlc_mutex_unlock(&mgr->lock);
 
     if (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
@@ -206,10 +248,8 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    vlc_http_mgr_set(mgr, conn, http2);
+    /* Use whichever connection was kept */
     return vlc_http_mgr_reuse(mgr, host, port, req, payload);
 }
 
@@ -218,7 +258,11 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    bool secure = mgr->creds != NULL && mgr->conn != NULL;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (secure)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     if (idempotent)
@@ -263,10 +307,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    vlc_http_mgr_set(mgr, conn, false);
     return resp;
 }
 
@@ -287,6 +328,14 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
     return mgr->jar;
 }
 
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool multiplexed = mgr->conn != NULL && mgr->multiplexed;
+    vlc_mutex_unlock(&mgr->lock);
+    return multiplexed;
+}
+
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar)
 {
@@ -299,6 +348,8 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->multiplexed = false;
+    vlc_mutex_init(&mgr->lock);
     return mgr;
 }
 
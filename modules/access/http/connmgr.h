@@ -57,6 +57,20 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Checks for request multiplexing
+ *
+ * Tells whether the current connection of the manager is HTTP/2, and so
+ * can carry concurrent requests. A manager is safe to share between
+ * threads, but sharing it over HTTP/1 connections forces new connections
+ * for concurrent requests.
+ *
+ * @param mgr HTTP connection manager
+ * @return true if the connection multiplexes requests, false if it does not
+ * or if there is no connection
+ */
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr);
+
 /**
  * Creates an HTTP connection manager
  *
@@ -0,0 +1,193 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager tests
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <vlc_common.h>
+#include <vlc_network.h>
+#include "transport.h"
+#include "conn.h"
+#include "connmgr.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+struct mock_conn
+{
+    struct vlc_http_conn conn;
+    unsigned streams;
+    bool dead;
+    bool released;
+};
+
+static struct mock_conn conns[4];
+static unsigned connects;
+static bool race;
+static struct vlc_http_mgr *mgr;
+static char fake_stream, fake_msg;
+
+static struct vlc_http_stream *mock_stream_open(struct vlc_http_conn *c,
+                                                const struct vlc_http_msg *m,
+                                                bool has_data)
+{
+    struct mock_conn *conn = container_of(c, struct mock_conn, conn);
+
+    assert(!conn->released);
+    (void) m; (void) has_data;
+    if (conn->dead)
+        return NULL;
+    conn->streams++;
+    return (struct vlc_http_stream *)&fake_stream;
+}
+
+static void mock_release(struct vlc_http_conn *c)
+{
+    struct mock_conn *conn = container_of(c, struct mock_conn, conn);
+
+    assert(!conn->released);
+    conn->released = true;
+}
+
+static const struct vlc_http_conn_cbs mock_cbs =
+{
+    mock_stream_open,
+    mock_release,
+};
+
+static struct vlc_http_msg *request(bool idempotent)
+{
+    return vlc_http_mgr_request(mgr, false, "www.example.com", 0,
+                                (const struct vlc_http_msg *)&fake_msg,
+                                idempotent, false);
+}
+
+int main(void)
+{
+    vlc_object_t obj = { .logger = NULL };
+
+    mgr = vlc_http_mgr_create(&obj, NULL);
+    assert(mgr != NULL);
+
+    /* Two requests connecting at the same time: the first connection set
+     * is kept, the other one is released */
+    race = true;
+    assert(request(true) != NULL);
+    assert(connects == 2);
+    assert(conns[0].released);
+    assert(!conns[1].released);
+    assert(!vlc_http_mgr_is_multiplexed(mgr));
+
+    /* Idempotent requests reuse the kept connection */
+    assert(request(true) != NULL);
+    assert(request(true) != NULL);
+    assert(connects == 2);
+    assert(conns[1].streams == 2);
+
+    /* A dead connection is dropped and replaced */
+    conns[1].dead = true;
+    assert(request(true) != NULL);
+    assert(connects == 3);
+    assert(conns[1].released);
+    assert(!conns[2].released);
+
+    /* A non-idempotent request connects anew, but does not replace the
+     * existing connection */
+    assert(request(false) != NULL);
+    assert(connects == 4);
+    assert(conns[3].released);
+    assert(!conns[2].released);
+    assert(request(true) != NULL);
+    assert(conns[2].streams == 1);
+
+    vlc_http_mgr_destroy(mgr);
+    assert(conns[2].released);
+    return 0;
+}
+
+/* Callback hooks */
+
+struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
+                                       unsigned port, bool proxy,
+                                       const struct vlc_http_msg *req,
+                                       bool idempotent, bool has_data,
+                                       struct vlc_http_conn **restrict connp)
+{
+    assert(connects < ARRAY_SIZE(conns));
+
+    struct mock_conn *conn = &conns[connects++];
+
+    conn->conn.cbs = &mock_cbs;
+    conn->conn.tls = NULL;
+    *connp = &conn->conn;
+
+    if (race)
+    {   /* Another request completes while this one is connecting */
+        race = false;
+        assert(request(idempotent) != NULL);
+    }
+    (void) ctx; (void) hostname; (void) port; (void) proxy; (void) req;
+    (void) has_data;
+    return (struct vlc_http_stream *)&fake_stream;
+}
+
+struct vlc_http_msg *vlc_http_msg_get_initial(struct vlc_http_stream *s)
+{
+    assert(s == (struct vlc_http_stream *)&fake_stream);
+    return (struct vlc_http_msg *)&fake_msg;
+}
+
+struct vlc_http_conn *vlc_h1_conn_create(void *ctx, struct vlc_tls *tls,
+                                         bool proxy)
+{
+    (void) ctx; (void) tls; (void) proxy;
+    assert(!"unexpected HTTP/1 connection");
+    return NULL;
+}
+
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
+{
+    (void) ctx; (void) tls;
+    assert(!"unexpected HTTP/2 connection");
+    return NULL;
+}
+
+struct vlc_tls *vlc_https_connect_proxy(void *ctx,
+                                        struct vlc_tls_client *creds,
+                                        const char *hostname, unsigned port,
+                                        bool *restrict two, const char *proxy)
+{
+    (void) ctx; (void) creds; (void) hostname; (void) port; (void) two;
+    (void) proxy;
+    assert(!"unexpected proxy");
+    return NULL;
+}
+
+char *vlc_getProxyUrl(const char *url)
+{
+    (void) url;
+    return NULL;
+}
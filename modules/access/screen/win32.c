@@ -197,6 +197,7 @@ static void CaptureBlockRelease( block_t *p_block )
 static const struct vlc_block_callbacks CaptureBlockCallbacks =
 {
     CaptureBlockRelease,
+    false,
 };
 
 static block_t *CaptureBlockNew( demux_t *p_demux )
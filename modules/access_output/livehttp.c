@@ -34,6 +34,7 @@
 #include <time.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 #include <unistd.h>
 
 #include <vlc_common.h>
@@ -43,6 +44,7 @@
 #include <vlc_fs.h>
 #include <vlc_strings.h>
 #include <vlc_charset.h>
+#include <vlc_list.h>
 
 #include <gcrypt.h>
 #include <vlc_gcrypt.h>
@@ -55,6 +57,9 @@
 
 #define STR_ENDLIST "#EXT-X-ENDLIST\n"
 
+/* Completed segments which still list their partial segments */
+#define PART_SEGMENTS             2
+
 #define MAX_RENAME_RETRIES        10
 
 /*****************************************************************************
@@ -102,6 +107,35 @@ static void Close( vlc_object_t * );
 #define RANDOMIV_TEXT N_("Use randomized IV for encryption")
 #define RANDOMIV_LONGTEXT N_("Generate IV instead using segment-number as IV")
 
+#define MASTER_TEXT N_("Master playlist file")
+#define MASTER_LONGTEXT N_("Path to the master playlist to create. All "\
+                           "livehttp outputs of the same process sharing "\
+                           "this path are listed in it as variants.")
+
+#define MASTERURL_TEXT N_("Index URL to put in master playlist")
+#define MASTERURL_LONGTEXT N_("URL of this output index file, as listed in "\
+                              "the master playlist (required with a master "\
+                              "playlist)")
+
+#define BANDWIDTH_TEXT N_("Variant bandwidth (kb/s)")
+#define BANDWIDTH_LONGTEXT N_("Configured bitrate of this variant, "\
+                              "advertised in the master playlist (required "\
+                              "with a master playlist)")
+
+#define RESOLUTION_TEXT N_("Variant resolution")
+#define RESOLUTION_LONGTEXT N_("Video resolution (WIDTHxHEIGHT) advertised "\
+                               "in the master playlist for this variant")
+
+#define PARTLEN_TEXT N_("Partial segment length (ms)")
+#define PARTLEN_LONGTEXT N_("Target duration of Low-Latency HLS partial "\
+                            "segments, written as byte ranges of the ongoing "\
+                            "segment. 0 disables partial segments.")
+
+#define BLOCKRELOAD_TEXT N_("Advertise blocking playlist reload")
+#define BLOCKRELOAD_LONGTEXT N_("Set CAN-BLOCK-RELOAD in the index file, "\
+                                "for HTTP servers handling _HLS_msn and "\
+                                "_HLS_part requests on it.")
+
 #define INTITIAL_SEG_TEXT N_("Number of first segment")
 #define INITIAL_SEG_LONGTEXT N_("The number of the first segment generated")
 
@@ -134,6 +168,19 @@ vlc_module_begin ()
                  KEYFILE_TEXT, KEYFILE_LONGTEXT)
     add_loadfile(SOUT_CFG_PREFIX "key-loadfile", NULL,
                  KEYLOADFILE_TEXT, KEYLOADFILE_LONGTEXT)
+    add_integer( SOUT_CFG_PREFIX "partlen", 0, PARTLEN_TEXT, PARTLEN_LONGTEXT )
+        change_integer_range( 0, 10000 )
+    add_bool( SOUT_CFG_PREFIX "blocking-reload", false,
+              BLOCKRELOAD_TEXT, BLOCKRELOAD_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "master-index", NULL,
+                MASTER_TEXT, MASTER_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "master-url", NULL,
+                MASTERURL_TEXT, MASTERURL_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "bandwidth", 0,
+                 BANDWIDTH_TEXT, BANDWIDTH_LONGTEXT )
+        change_integer_range( 0, INT_MAX )
+    add_string( SOUT_CFG_PREFIX "resolution", NULL,
+                RESOLUTION_TEXT, RESOLUTION_LONGTEXT )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -155,12 +202,26 @@ static const char *const ppsz_sout_options[] = {
     "key-loadfile",
     "generate-iv",
     "initial-segment-number",
+    "master-index",
+    "master-url",
+    "bandwidth",
+    "resolution",
+    "partlen",
+    "blocking-reload",
     NULL
 };
 
 static ssize_t Write( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
+typedef struct
+{
+    uint64_t i_offset;
+    uint64_t i_size;
+    vlc_tick_t length;
+    bool b_independent;
+} output_part_t;
+
 typedef struct output_segment
 {
     char *psz_filename;
@@ -168,8 +229,11 @@ typedef struct output_segment
     char *psz_key_uri;
     char *psz_duration;
     vlc_tick_t segment_length;
+    uint64_t i_size;
     uint32_t i_segment_number;
     uint8_t aes_ivs[16];
+    output_part_t *p_parts;
+    size_t i_parts;
 } output_segment_t;
 
 typedef struct
@@ -180,7 +244,9 @@ typedef struct
     char *psz_keyfile;
     vlc_tick_t i_keyfile_modification;
     vlc_tick_t segment_max_length;
+    vlc_tick_t part_max_length;
     vlc_tick_t current_segment_length;
+    uint64_t current_segment_size;
     uint32_t i_segment;
     block_t *full_segments;
     block_t **full_segments_end;
@@ -195,18 +261,49 @@ typedef struct
     bool b_caching;
     bool b_generate_iv;
     bool b_segment_has_data;
+    bool b_blocking_reload;
+    bool b_part_independent;
     uint8_t aes_ivs[16];
     gcry_cipher_hd_t aes_ctx;
     char *key_uri;
     uint8_t stuffing_bytes[16];
     ssize_t stuffing_size;
     vlc_array_t segments_t;
+    struct livehttp_variant *p_variant;
 } sout_access_out_sys_t;
 
+/* Master playlists are shared by all the livehttp outputs of the process
+ * (typically one per rendition behind a duplicate stream output). */
+typedef struct
+{
+    char *psz_path;
+    struct vlc_list variants;
+    struct vlc_list node;
+} livehttp_master_t;
+
+typedef struct livehttp_variant
+{
+    livehttp_master_t *p_master;
+    char *psz_uri;
+    char *psz_resolution;
+    uint64_t i_bandwidth; /* configured, in bits per second */
+    struct vlc_list node;
+} livehttp_variant_t;
+
+static vlc_mutex_t masters_lock = VLC_STATIC_MUTEX;
+static struct vlc_list masters = VLC_LIST_INITIALIZER(&masters);
+
+static int MasterRegister( sout_access_out_t *p_access, const char *psz_path );
+static void MasterUnregister( sout_access_out_t *p_access,
+                              livehttp_variant_t *p_variant );
+static void MasterWriteLocked( sout_access_out_t *p_access,
+                               livehttp_master_t *p_master );
+
 static int LoadCryptFile( sout_access_out_t *p_access);
 static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
 static ssize_t writeSegment( sout_access_out_t *p_access );
+static ssize_t writePart( sout_access_out_t *p_access );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
 /*****************************************************************************
  * Open: open the file
@@ -245,7 +342,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_ratecontrol = var_GetBool( p_access, SOUT_CFG_PREFIX "ratecontrol") ;
     p_sys->b_caching = var_GetBool( p_access, SOUT_CFG_PREFIX "caching") ;
     p_sys->b_generate_iv = var_GetBool( p_access, SOUT_CFG_PREFIX "generate-iv") ;
+    p_sys->b_blocking_reload = var_GetBool( p_access, SOUT_CFG_PREFIX "blocking-reload") ;
     p_sys->b_segment_has_data = false;
+    p_sys->part_max_length =
+        VLC_TICK_FROM_MS( var_GetInteger( p_access, SOUT_CFG_PREFIX "partlen" ) );
 
     vlc_array_init( &p_sys->segments_t );
 
@@ -274,6 +374,15 @@ static int Open( vlc_object_t *p_this )
 
     p_access->p_sys = p_sys;
 
+    if( p_sys->part_max_length && ( p_sys->key_uri || p_sys->psz_keyfile ) )
+    {
+        /* CBC chaining prevents decrypting a part on its own */
+        msg_Warn( p_access, "partial segments are disabled with encryption" );
+        p_sys->part_max_length = 0;
+    }
+    if( p_sys->part_max_length >= p_sys->segment_max_length )
+        p_sys->part_max_length = 0;
+
     if( p_sys->psz_keyfile && ( LoadCryptFile( p_access ) < 0 ) )
     {
         free( p_sys->psz_indexUrl );
@@ -291,6 +400,26 @@ static int Open( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
+    char *psz_master = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "master-index" );
+    if( psz_master )
+    {
+        int ret = MasterRegister( p_access, psz_master );
+        free( psz_master );
+        if( ret != VLC_SUCCESS )
+        {
+            if( p_sys->key_uri )
+            {
+                gcry_cipher_close( p_sys->aes_ctx );
+                free( p_sys->key_uri );
+            }
+            free( p_sys->psz_keyfile );
+            free( p_sys->psz_indexUrl );
+            free( p_sys->psz_indexPath );
+            free( p_sys );
+            return ret;
+        }
+    }
+
     p_sys->i_handle = -1;
     p_sys->i_segment = p_sys->i_initial_segment-1;
     p_sys->psz_cursegPath = NULL;
@@ -301,6 +430,131 @@ static int Open( vlc_object_t *p_this )
     return VLC_SUCCESS;
 }
 
+/************************************************************************
+ * MasterRegister: Add this output as a variant of a master playlist
+ ************************************************************************/
+static int MasterRegister( sout_access_out_t *p_access, const char *psz_path )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    livehttp_variant_t *p_variant = calloc( 1, sizeof(*p_variant) );
+    if( unlikely(!p_variant) )
+        return VLC_ENOMEM;
+
+    /* The index path is a local file name, not something clients resolve */
+    p_variant->psz_uri = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "master-url" );
+    if( !p_variant->psz_uri )
+    {
+        msg_Err( p_access, "master-url is required with master-index" );
+        free( p_variant );
+        return VLC_EGENERIC;
+    }
+    p_variant->i_bandwidth = var_GetInteger( p_access, SOUT_CFG_PREFIX "bandwidth" ) * UINT64_C(1000);
+    if( p_variant->i_bandwidth == 0 )
+    {
+        msg_Err( p_access, "bandwidth is required with master-index" );
+        free( p_variant->psz_uri );
+        free( p_variant );
+        return VLC_EGENERIC;
+    }
+    p_variant->psz_resolution = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "resolution" );
+
+    vlc_mutex_lock( &masters_lock );
+    livehttp_master_t *p_master = NULL, *p_cur;
+    vlc_list_foreach( p_cur, &masters, node )
+        if( !strcmp( p_cur->psz_path, psz_path ) )
+        {
+            p_master = p_cur;
+            break;
+        }
+
+    if( !p_master )
+    {
+        p_master = malloc( sizeof(*p_master) );
+        if( unlikely(!p_master) ||
+            unlikely(!(p_master->psz_path = strdup( psz_path ))) )
+        {
+            vlc_mutex_unlock( &masters_lock );
+            free( p_master );
+            free( p_variant->psz_resolution );
+            free( p_variant->psz_uri );
+            free( p_variant );
+            return VLC_ENOMEM;
+        }
+        vlc_list_init( &p_master->variants );
+        vlc_list_append( &p_master->node, &masters );
+    }
+    p_variant->p_master = p_master;
+    vlc_list_append( &p_variant->node, &p_master->variants );
+    MasterWriteLocked( p_access, p_master );
+    vlc_mutex_unlock( &masters_lock );
+
+    p_sys->p_variant = p_variant;
+    return VLC_SUCCESS;
+}
+
+static void MasterUnregister( sout_access_out_t *p_access,
+                              livehttp_variant_t *p_variant )
+{
+    livehttp_master_t *p_master = p_variant->p_master;
+
+    vlc_mutex_lock( &masters_lock );
+    vlc_list_remove( &p_variant->node );
+    if( vlc_list_is_empty( &p_master->variants ) )
+    {
+        vlc_list_remove( &p_master->node );
+        free( p_master->psz_path );
+        free( p_master );
+    }
+    else
+        MasterWriteLocked( p_access, p_master );
+    vlc_mutex_unlock( &masters_lock );
+
+    free( p_variant->psz_resolution );
+    free( p_variant->psz_uri );
+    free( p_variant );
+}
+
+/************************************************************************
+ * MasterWriteLocked: Rewrite master playlist with all the variants
+ ************************************************************************/
+static void MasterWriteLocked( sout_access_out_t *p_access,
+                               livehttp_master_t *p_master )
+{
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.tmp", p_master->psz_path ) < 0 )
+        return;
+
+    FILE *fp = vlc_fopen( psz_tmp, "wt" );
+    if( !fp )
+    {
+        msg_Err( p_access, "cannot open master playlist file `%s'", psz_tmp );
+        free( psz_tmp );
+        return;
+    }
+
+    int val = fputs( "#EXTM3U\n#EXT-X-VERSION:3\n", fp );
+    livehttp_variant_t *p_cur;
+    vlc_list_foreach( p_cur, &p_master->variants, node )
+    {
+        if( val < 0 )
+            break;
+        val = fprintf( fp, "#EXT-X-STREAM-INF:BANDWIDTH=%"PRIu64"%s%s\n%s\n",
+                       p_cur->i_bandwidth,
+                       p_cur->psz_resolution ? ",RESOLUTION=" : "",
+                       p_cur->psz_resolution ? p_cur->psz_resolution : "",
+                       p_cur->psz_uri );
+    }
+    fclose( fp );
+
+    if( val < 0 || vlc_rename( psz_tmp, p_master->psz_path ) < 0 )
+    {
+        vlc_unlink( psz_tmp );
+        msg_Err( p_access, "Error writing LiveHttp master playlist" );
+    }
+    free( psz_tmp );
+}
+
 /************************************************************************
  * CryptSetup: Initialize encryption
  ************************************************************************/
@@ -504,6 +758,7 @@ static void destroySegment( output_segment_t *segment )
     free( segment->psz_duration );
     free( segment->psz_uri );
     free( segment->psz_key_uri );
+    free( segment->p_parts );
     free( segment );
 }
 
@@ -549,6 +804,52 @@ static bool isFirstItemRemovable( sout_access_out_sys_t *p_sys, uint32_t i_first
     return duration >= (first->segment_length + (p_sys->i_numsegs * p_sys->segment_max_length));
 }
 
+/************************************************************************
+ * formatSeconds: locale independent seconds with millisecond precision
+ ************************************************************************/
+static void formatSeconds( char psz[32], vlc_tick_t tick )
+{
+    int64_t i_ms = MS_FROM_VLC_TICK( tick );
+    snprintf( psz, 32, "%"PRId64".%03d", i_ms / 1000, (int)(i_ms % 1000) );
+}
+
+/************************************************************************
+ * writeParts: list the partial segments and the preload hint
+ ************************************************************************/
+static int writeParts( FILE *fp, const output_segment_t *segment )
+{
+    for( size_t i = 0; i < segment->i_parts; i++ )
+    {
+        const output_part_t *part = &segment->p_parts[i];
+        char psz_duration[32];
+        formatSeconds( psz_duration, part->length );
+        if( fprintf( fp, "#EXT-X-PART:DURATION=%s,URI=\"%s\","
+                         "BYTERANGE=\"%"PRIu64"@%"PRIu64"\"%s\n",
+                     psz_duration, segment->psz_uri,
+                     part->i_size, part->i_offset,
+                     part->b_independent ? ",INDEPENDENT=YES" : "" ) < 0 )
+            return -1;
+    }
+    return 0;
+}
+
+static int writePreloadHint( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                             FILE *fp, const output_segment_t *last )
+{
+    if( last && !last->psz_duration ) /* ongoing segment */
+        return fprintf( fp, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\","
+                            "BYTERANGE-START=%"PRIu64"\n",
+                        last->psz_uri, p_sys->current_segment_size );
+
+    char *psz_idxFormat = p_sys->psz_indexUrl ? p_sys->psz_indexUrl : p_access->psz_path;
+    char *psz_uri = formatSegmentPath( psz_idxFormat, p_sys->i_segment + 1 );
+    if( !psz_uri )
+        return -1;
+    int ret = fprintf( fp, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\"\n", psz_uri );
+    free( psz_uri );
+    return ret;
+}
+
 /************************************************************************
  * updateIndexAndDel: If necessary, update index file & delete old segments
  ************************************************************************/
@@ -587,8 +888,9 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             return -1;
         }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
                           "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
+                          p_sys->part_max_length ? 6 : 3,
                           p_sys->b_caching ? "YES" : "NO",
                           p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
                           i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
@@ -598,7 +900,25 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             fclose( fp );
             return -1;
         }
+        if( p_sys->part_max_length )
+        {
+            /* Clients should stay at least 3 part durations behind live */
+            char psz_target[32], psz_holdback[32];
+            formatSeconds( psz_target, p_sys->part_max_length );
+            formatSeconds( psz_holdback, 3 * p_sys->part_max_length );
+            if( fprintf( fp, "#EXT-X-SERVER-CONTROL:%sPART-HOLD-BACK=%s\n"
+                             "#EXT-X-PART-INF:PART-TARGET=%s\n",
+                         p_sys->b_blocking_reload ? "CAN-BLOCK-RELOAD=YES," : "",
+                         psz_holdback, psz_target ) < 0 )
+            {
+                free( psz_idxTmp );
+                fclose( fp );
+                return -1;
+            }
+        }
+
         char *psz_current_uri=NULL;
+        output_segment_t *segment = NULL;
 
 
         for ( uint32_t i = i_firstseg; i <= p_sys->i_segment; i++ )
@@ -606,7 +926,7 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             //scale to i_index_offset..numsegs + i_index_offset
             uint32_t index = i - i_firstseg + i_index_offset;
 
-            output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, index );
+            segment = vlc_array_item_at_index( &p_sys->segments_t, index );
             if( p_sys->key_uri &&
                 ( !psz_current_uri ||  strcmp( psz_current_uri, segment->psz_key_uri ) )
               )
@@ -640,6 +960,19 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 }
             }
 
+            /* Recent and ongoing segments also list their parts */
+            if( p_sys->part_max_length && p_sys->i_segment - i <= PART_SEGMENTS &&
+                writeParts( fp, segment ) < 0 )
+            {
+                free( psz_current_uri );
+                free( psz_idxTmp );
+                fclose( fp );
+                return -1;
+            }
+
+            if( !segment->psz_duration )
+                continue;
+
             val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
             if ( val < 0 )
             {
@@ -651,6 +984,14 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
         }
         free( psz_current_uri );
 
+        if( p_sys->part_max_length && !b_isend &&
+            writePreloadHint( p_access, p_sys, fp, segment ) < 0 )
+        {
+            free( psz_idxTmp );
+            fclose( fp );
+            return -1;
+        }
+
         if ( b_isend )
         {
             if ( fputs ( STR_ENDLIST, fp ) < 0)
@@ -735,6 +1076,7 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
             return;
         }
         segment->segment_length = p_sys->current_segment_length;
+        segment->i_size = p_sys->current_segment_size;
 
         segment->i_segment_number = p_sys->i_segment;
 
@@ -756,6 +1098,14 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
+    if( p_sys->part_max_length )
+    {
+        if( p_sys->ongoing_segment && p_sys->i_handle >= 0 )
+            writePart( p_access );
+        closeCurrentSegment( p_access, p_sys, true );
+        goto closed;
+    }
+
     if( p_sys->ongoing_segment )
         block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
     p_sys->ongoing_segment = NULL;
@@ -792,6 +1142,10 @@ static void Close( vlc_object_t * p_this )
 
     closeCurrentSegment( p_access, p_sys, true );
 
+closed:
+    if( p_sys->ongoing_segment )
+        block_ChainRelease( p_sys->ongoing_segment );
+
     if( p_sys->key_uri )
     {
         gcry_cipher_close( p_sys->aes_ctx );
@@ -811,6 +1165,9 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    if( p_sys->p_variant )
+        MasterUnregister( p_access, p_sys->p_variant );
+
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -891,6 +1248,8 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     msg_Dbg( p_access, "Successfully opened livehttp file: %s (%"PRIu32")" , segment->psz_filename, i_newseg );
 
     p_sys->psz_cursegPath = strdup(segment->psz_filename);
+    p_sys->current_segment_length = 0;
+    p_sys->current_segment_size = 0;
     p_sys->i_handle = fd;
     p_sys->i_segment = i_newseg;
     p_sys->b_segment_has_data = false;
@@ -931,6 +1290,81 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
     return writevalue;
 }
 
+/*****************************************************************************
+ * writeChain: write a block chain as is, and release it
+ *****************************************************************************/
+static ssize_t writeChain( int fd, block_t *output )
+{
+    ssize_t i_write = 0;
+
+    while( output )
+    {
+        ssize_t val = vlc_write( fd, output->p_buffer, output->i_buffer );
+        if ( val == -1 )
+        {
+            if ( errno == EINTR )
+                continue;
+            block_ChainRelease( output );
+            return -1;
+        }
+        i_write += val;
+
+        if ( (size_t)val >= output->i_buffer )
+        {
+            block_t *p_next = output->p_next;
+            block_Release( output );
+            output = p_next;
+        }
+        else
+        {
+            output->p_buffer += val;
+            output->i_buffer -= val;
+        }
+    }
+    return i_write;
+}
+
+/*****************************************************************************
+ * writePart: write ongoing data to the segment file as a partial segment
+ *****************************************************************************/
+static ssize_t writePart( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    block_t *output = p_sys->ongoing_segment;
+    p_sys->ongoing_segment = NULL;
+    p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+
+    vlc_tick_t length = 0;
+    block_ChainProperties( output, NULL, NULL, &length );
+
+    ssize_t i_write = writeChain( p_sys->i_handle, output );
+    if( i_write < 0 )
+        return -1;
+
+    output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t,
+                                    vlc_array_count( &p_sys->segments_t ) - 1 );
+    output_part_t *p_parts = realloc( segment->p_parts,
+                                      (segment->i_parts + 1) * sizeof(*p_parts) );
+    if( unlikely(!p_parts) )
+        return -1;
+    segment->p_parts = p_parts;
+    p_parts[segment->i_parts++] = (output_part_t) {
+        .i_offset = p_sys->current_segment_size,
+        .i_size = i_write,
+        .length = length,
+        .b_independent = p_sys->b_part_independent,
+    };
+
+    p_sys->current_segment_size += i_write;
+    p_sys->current_segment_length += length;
+    segment->segment_length = p_sys->current_segment_length;
+    p_sys->b_segment_has_data = true;
+
+    updateIndexAndDel( p_access, p_sys, false );
+    return i_write;
+}
+
 static ssize_t writeSegment( sout_access_out_t *p_access )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
@@ -946,6 +1380,7 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     ssize_t i_write=0;
     bool crypted = false;
     p_sys->current_segment_length = current_length;
+    p_sys->current_segment_size = 0;
     while( output )
     {
         if( p_sys->key_uri && !crypted )
@@ -1002,6 +1437,60 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
         }
         i_write += val;
     }
+    p_sys->current_segment_size += i_write;
+    return i_write;
+}
+
+/*****************************************************************************
+ * WriteParts: write data as soon as a partial segment is complete
+ *****************************************************************************/
+static ssize_t WriteParts( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t i_write = 0;
+
+    while( p_buffer )
+    {
+        bool b_independent = p_sys->b_splitanywhere ||
+                             ( p_buffer->i_flags & BLOCK_FLAG_HEADER );
+        vlc_tick_t pending = 0;
+        block_ChainProperties( p_sys->ongoing_segment, NULL, NULL, &pending );
+
+        /* Segments can only be split before an independent block */
+        bool b_close = b_independent && p_sys->i_handle >= 0 &&
+            p_sys->current_segment_length + pending >= p_sys->segment_max_length;
+
+        if( p_sys->ongoing_segment &&
+            ( b_close || pending + p_buffer->i_length > p_sys->part_max_length ) )
+        {
+            ssize_t ret = writePart( p_access );
+            if( ret < 0 )
+            {
+                msg_Err( p_access, "Error in write loop");
+                block_ChainRelease( p_buffer );
+                return -1;
+            }
+            i_write += ret;
+        }
+
+        if( b_close )
+            closeCurrentSegment( p_access, p_sys, false );
+
+        if( p_sys->i_handle < 0 && openNextFile( p_access, p_sys ) < 0 )
+        {
+            block_ChainRelease( p_buffer );
+            return -1;
+        }
+
+        if( !p_sys->ongoing_segment )
+            p_sys->b_part_independent = b_independent;
+
+        block_t *p_temp = p_buffer->p_next;
+        p_buffer->p_next = NULL;
+        block_ChainLastAppend( &p_sys->ongoing_segment_end, p_buffer );
+        p_buffer = p_temp;
+    }
+
     return i_write;
 }
 
@@ -1012,6 +1501,10 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
     size_t i_write = 0;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_sys->part_max_length )
+        return WriteParts( p_access, p_buffer );
+
     while( p_buffer )
     {
         /* Check if current block is already past segment-length
@@ -351,8 +351,12 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     sys->i_next_frame_priv = 0;
 
+    int threads = var_InheritInteger(dec, "dec-threads");
+    if (threads <= 0)
+        threads = decoder_GetThreadCount(dec);
+
     struct aom_codec_dec_cfg deccfg = {
-        .threads = __MIN(vlc_GetCPUCount(), 16),
+        .threads = __MIN(threads, 16),
         .allow_lowbitdepth = 1
     };
 
@@ -171,6 +171,7 @@ static void vlc_av_frame_Release(block_t *block)
 static const struct vlc_block_callbacks vlc_av_frame_cbs =
 {
     vlc_av_frame_Release,
+    false,
 };
 
 static block_t *vlc_av_frame_Wrap(AVFrame *frame)
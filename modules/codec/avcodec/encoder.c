@@ -1081,6 +1081,7 @@ static void vlc_av_packet_Release(block_t *block)
 static const struct vlc_block_callbacks vlc_av_packet_cbs =
 {
     vlc_av_packet_Release,
+    false,
 };
 
 static block_t *vlc_av_packet_Wrap(AVPacket *packet, AVCodecContext *context )
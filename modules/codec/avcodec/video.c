@@ -509,9 +509,11 @@ int InitVideoDec( vlc_object_t *obj )
     p_context->reordered_opaque = 0;
 
     int i_thread_count = var_InheritInteger( p_dec, "avcodec-threads" );
+    if( i_thread_count <= 0 )
+        i_thread_count = var_InheritInteger( p_dec, "dec-threads" );
     if( i_thread_count <= 0 )
     {
-        i_thread_count = vlc_GetCPUCount();
+        i_thread_count = decoder_GetThreadCount( p_dec );
         if( i_thread_count > 1 )
             i_thread_count++;
 
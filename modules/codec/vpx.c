@@ -323,8 +323,12 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_ENOMEM;
     dec->p_sys = sys;
 
+    int threads = var_InheritInteger(dec, "dec-threads");
+    if (threads <= 0)
+        threads = decoder_GetThreadCount(dec);
+
     struct vpx_codec_dec_cfg deccfg = {
-        .threads = __MIN(vlc_GetCPUCount(), 16)
+        .threads = __MIN(threads, 16)
     };
 
     msg_Dbg(p_this, "VP%d: using libvpx version %s (build options %s)",
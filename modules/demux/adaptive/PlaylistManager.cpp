@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/HybridAdaptationLogic.hpp"
 #include "logic/BufferingLogic.hpp"
 #include "tools/Debug.hpp"
 #ifdef ADAPTIVE_DEBUGGING_LOGIC
@@ -73,8 +74,10 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     b_canceled = false;
     b_preparsing = false;
     nextPlaylistupdate = 0;
+    nextLatencyCheck = 0;
     demux.i_nzpcr = VLC_TICK_INVALID;
     demux.i_firstpcr = VLC_TICK_INVALID;
+    demux.b_catchup = false;
     demux.pcr_syncpoint = TimestampSynchronizationPoint::RandomAccess;
     vlc_mutex_init(&demux.lock);
     vlc_cond_init(&demux.cond);
@@ -126,6 +129,7 @@ bool PlaylistManager::setupPeriod()
                                                          bufferingLogic, set);
             if(!tracker)
                 continue;
+            tracker->registerListener(&telemetry);
 
             AbstractStream *st = streamFactory->create(p_demux, set->getStreamFormat(),
                                                        tracker, resources->getConnManager());
@@ -431,6 +435,14 @@ int PlaylistManager::demux_callback(demux_t *p_demux)
 int PlaylistManager::doDemux(vlc_tick_t increment)
 {
     vlc_mutex_lock(&demux.lock);
+    if(demux.b_catchup)
+    {
+        demux.b_catchup = false;
+        vlc_mutex_unlock(&demux.lock);
+        catchUpLive();
+        return VLC_DEMUXER_SUCCESS;
+    }
+
     if(demux.i_nzpcr == VLC_TICK_INVALID)
     {
         bool b_dead = true;
@@ -639,12 +651,92 @@ int PlaylistManager::doControl(int i_query, va_list args)
             *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
             break;
 
+        case DEMUX_GET_DOWNLOADS:
+        {
+            demux_download_t **pp_downloads = va_arg(args, demux_download_t **);
+            size_t *pi_downloads = va_arg(args, size_t *);
+
+            std::vector<DownloadRecord> records;
+            telemetry.getRecords(records);
+            if(records.empty())
+                return VLC_EGENERIC;
+
+            demux_download_t *p_downloads = (demux_download_t *)
+                    vlc_alloc(records.size(), sizeof(*p_downloads));
+            if(!p_downloads)
+                return VLC_ENOMEM;
+            for(size_t i = 0; i < records.size(); i++)
+            {
+                strlcpy(p_downloads[i].psz_representation,
+                        records[i].representation.str().c_str(),
+                        sizeof(p_downloads[i].psz_representation));
+                p_downloads[i].i_bandwidth = records[i].bandwidth;
+                p_downloads[i].i_size = records[i].size;
+                p_downloads[i].i_duration = records[i].time;
+                p_downloads[i].i_latency = records[i].latency;
+                p_downloads[i].i_date = records[i].date;
+            }
+            *pp_downloads = p_downloads;
+            *pi_downloads = records.size();
+            break;
+        }
+
         default:
             return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
 }
 
+/* We can't speed up playback from a demuxer, so when we drift away from
+ * the live edge we jump back to it, the same way resuming a live pause does */
+#define LIVE_LATENCY_CHECK_INTERVAL  VLC_TICK_FROM_SEC(1)
+#define LIVE_CATCHUP_MIN_INTERVAL    VLC_TICK_FROM_SEC(10)
+void PlaylistManager::checkLiveLatency(vlc_tick_t i_nzpcr)
+{
+    if(i_nzpcr == VLC_TICK_INVALID || !playlist->isLive() ||
+       !bufferingLogic->isLowLatency(playlist))
+        return;
+
+    const vlc_tick_t now = vlc_tick_now();
+    if(now < nextLatencyCheck)
+        return;
+    nextLatencyCheck = now + LIVE_LATENCY_CHECK_INTERVAL;
+
+    vlc_tick_t latency = 0;
+    for(const AbstractStream *st : streams)
+    {
+        if(!st->isValid() || st->isDisabled() || !st->isSelected())
+            continue;
+        const vlc_tick_t l = st->getLiveLatency(i_nzpcr);
+        if(latency == 0 || l < latency)
+            latency = l;
+    }
+
+    const vlc_tick_t maxlatency = bufferingLogic->getLiveDelay(playlist) * 2;
+    if(latency <= maxlatency)
+        return;
+
+    msg_Dbg(p_demux, "Live latency %" PRId64 "ms above %" PRId64 "ms, catching up",
+            MS_FROM_VLC_TICK(latency), MS_FROM_VLC_TICK(maxlatency));
+    nextLatencyCheck = now + LIVE_CATCHUP_MIN_INTERVAL;
+    vlc_mutex_lock(&demux.lock);
+    demux.b_catchup = true;
+    vlc_mutex_unlock(&demux.lock);
+}
+
+void PlaylistManager::catchUpLive()
+{
+    setBufferingRunState(false); /* /!\ always stop buffering process first */
+    vlc_mutex_lock(&demux.lock);
+    demux.i_nzpcr = VLC_TICK_INVALID;
+    demux.i_firstpcr = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&demux.lock);
+    cached.lastupdate = 0;
+    setLivePause(false);
+    es_out_Control(p_demux->out, ES_OUT_RESET_PCR);
+    setBufferingRunState(true);
+}
+
 void PlaylistManager::setBufferingRunState(bool b)
 {
     mutex_locker locker {lock};
@@ -680,6 +772,8 @@ void PlaylistManager::Run()
         AbstractStream::BufferingStatus i_return = bufferize(i_nzpcr, i_min_buffering,
                                                              i_max_buffering, i_target_buffering);
 
+        checkLiveLatency(i_nzpcr);
+
         if(i_return != AbstractStream::BufferingStatus::Lessthanmin)
         {
             vlc_tick_t i_deadline = vlc_tick_now();
@@ -824,14 +918,8 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = new (std::nothrow) AlwaysBestAdaptationLogic(obj);
             break;
         case AbstractAdaptationLogic::LogicType::RateBased:
-        {
-            RateBasedAdaptationLogic *ratelogic =
-                    new (std::nothrow) RateBasedAdaptationLogic(obj);
-            if(ratelogic)
-                conn->setDownloadRateObserver(ratelogic);
-            logic = ratelogic;
+            logic = new (std::nothrow) RateBasedAdaptationLogic(obj);
             break;
-        }
         case AbstractAdaptationLogic::LogicType::Default:
 #ifdef ADAPTIVE_DEBUGGING_LOGIC
             logic = new (std::nothrow) RoundRobinLogic(obj);
@@ -839,22 +927,14 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             break;
 #endif
         case AbstractAdaptationLogic::LogicType::NearOptimal:
-        {
-            NearOptimalAdaptationLogic *noplogic =
-                    new (std::nothrow) NearOptimalAdaptationLogic(obj);
-            if(noplogic)
-                conn->setDownloadRateObserver(noplogic);
-            logic = noplogic;
+            logic = new (std::nothrow) NearOptimalAdaptationLogic(obj);
             break;
-        }
         case AbstractAdaptationLogic::LogicType::Predictive:
-        {
-            AbstractAdaptationLogic *predictivelogic =
-                    new (std::nothrow) PredictiveAdaptationLogic(obj);
-            if(predictivelogic)
-                conn->setDownloadRateObserver(predictivelogic);
-            logic = predictivelogic;
-        }
+            logic = new (std::nothrow) PredictiveAdaptationLogic(obj);
+            break;
+        case AbstractAdaptationLogic::LogicType::Hybrid:
+            logic = new (std::nothrow) HybridAdaptationLogic(obj);
+            break;
 
         default:
             break;
@@ -862,6 +942,10 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
 
     if(logic)
     {
+        /* Every segment download gets recorded before reaching the logic */
+        telemetry.setDownstreamObserver(logic);
+        conn->setDownloadRateObserver(&telemetry);
+
         int w = var_InheritInteger(p_demux, "adaptive-maxwidth");
         int h = var_InheritInteger(p_demux, "adaptive-maxheight");
         if(h == 0)
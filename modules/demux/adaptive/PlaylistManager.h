@@ -23,6 +23,7 @@
 #define PLAYLISTMANAGER_H_
 
 #include "logic/AbstractAdaptationLogic.h"
+#include "logic/DownloadTelemetry.hpp"
 #include "Streams.hpp"
 #include <vector>
 
@@ -90,6 +91,8 @@ namespace adaptive
             void unsetPeriod();
 
             void updateControlsPosition();
+            void checkLiveLatency(vlc_tick_t);
+            void catchUpLive();
 
             /* local factories */
             virtual AbstractAdaptationLogic *createLogic(AbstractAdaptationLogic::LogicType,
@@ -100,6 +103,7 @@ namespace adaptive
             AbstractAdaptationLogic::LogicType  logicType;
             AbstractAdaptationLogic             *logic;
             AbstractBufferingLogic              *bufferingLogic;
+            DownloadTelemetry                    telemetry;
             BasePlaylist                    *playlist;
             AbstractStreamFactory               *streamFactory;
             demux_t                             *p_demux;
@@ -118,6 +122,7 @@ namespace adaptive
                 TimestampSynchronizationPoint pcr_syncpoint;
                 vlc_tick_t  i_nzpcr;
                 vlc_tick_t  i_firstpcr;
+                bool        b_catchup;
                 mutable vlc_mutex_t lock;
                 vlc_cond_t  cond;
             } demux;
@@ -125,6 +130,7 @@ namespace adaptive
             /* buffering process */
             time_t                               nextPlaylistupdate;
             int                                  failedupdates;
+            vlc_tick_t                           nextLatencyCheck;
 
             /* Controls */
             struct
@@ -226,6 +226,7 @@ void SegmentTracker::reset()
 SegmentTracker::ChunkEntry::ChunkEntry()
 {
     chunk = nullptr;
+    gap = false;
 }
 
 SegmentTracker::ChunkEntry::ChunkEntry(SegmentChunk *c, Position p, vlc_tick_t s, vlc_tick_t d, vlc_tick_t dt)
@@ -235,6 +236,7 @@ SegmentTracker::ChunkEntry::ChunkEntry(SegmentChunk *c, Position p, vlc_tick_t s
     duration = d;
     starttime = s;
     displaytime = dt;
+    gap = false;
 }
 
 bool SegmentTracker::ChunkEntry::isValid() const
@@ -304,7 +306,7 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos,
             ++pos;
     }
 
-    bool b_gap = true;
+    bool b_gap = false;
     if(!segment)
         segment = pos.rep->getNextMediaSegment(pos.number, &pos.number, &b_gap);
 
@@ -316,8 +318,10 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos,
         return ChunkEntry();
 
     const Timescale timescale = pos.rep->inheritTimescale();
-    return ChunkEntry(segmentChunk, pos, VLC_TICK_0 + timescale.ToTime(segment->startTime.Get()),
-                      timescale.ToTime(segment->duration.Get()), segment->getDisplayTime());
+    ChunkEntry entry(segmentChunk, pos, VLC_TICK_0 + timescale.ToTime(segment->startTime.Get()),
+                     timescale.ToTime(segment->duration.Get()), segment->getDisplayTime());
+    entry.gap = b_gap;
+    return entry;
 }
 
 void SegmentTracker::resetChunksSequence()
@@ -349,8 +353,8 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
         return nullptr;
     }
 
-    /* here next == wanted chunk pos */
-    bool b_gap = (next.number != chunk.pos.number);
+    /* here next == wanted chunk pos, unless media segments were skipped */
+    bool b_gap = chunk.gap;
     const bool b_switched = (next.rep != chunk.pos.rep);
     const bool b_discontinuity = chunk.chunk->discontinuity;
 
@@ -525,6 +529,15 @@ vlc_tick_t SegmentTracker::getMinAheadTime() const
     return 0;
 }
 
+vlc_tick_t SegmentTracker::getLiveLatency() const
+{
+    /* Only what is already published after our segment: unlike
+     * getMinAheadTime(), this never reloads (and blocks on) the playlist */
+    if(!current.isValid())
+        return 0;
+    return current.rep->getMinAheadTime(current.number);
+}
+
 void SegmentTracker::notifyBufferingState(bool enabled) const
 {
     notify(BufferingStateUpdatedEvent(adaptationSet->getID(), enabled));
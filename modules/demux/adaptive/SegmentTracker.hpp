@@ -195,6 +195,7 @@ namespace adaptive
             vlc_tick_t getPlaybackTime(bool = false) const; /* Current segment start time if selected */
             bool getMediaPlaybackRange(vlc_tick_t *, vlc_tick_t *, vlc_tick_t *) const;
             vlc_tick_t getMinAheadTime() const;
+            vlc_tick_t getLiveLatency() const;
             void notifyBufferingState(bool) const;
             void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t) const;
             void registerListener(SegmentTrackerListenerInterface *);
@@ -213,6 +214,7 @@ namespace adaptive
                     vlc_tick_t displaytime;
                     vlc_tick_t starttime;
                     vlc_tick_t duration;
+                    bool gap; /* some media segments were skipped */
             };
             std::list<ChunkEntry> chunkssequence;
             ChunkEntry prepareChunk(bool switch_allowed, Position pos,
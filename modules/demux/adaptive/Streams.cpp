@@ -182,6 +182,14 @@ vlc_tick_t AbstractStream::getMinAheadTime() const
     return segmentTracker->getMinAheadTime();
 }
 
+vlc_tick_t AbstractStream::getLiveLatency(vlc_tick_t nz_pcr) const
+{
+    if(!segmentTracker || nz_pcr == VLC_TICK_INVALID)
+        return 0;
+    return segmentTracker->getLiveLatency() +
+           fakeEsOut()->commandsQueue()->getDemuxedAmount(nz_pcr);
+}
+
 vlc_tick_t AbstractStream::getFirstDTS() const
 {
     vlc_mutex_locker locker(&lock);
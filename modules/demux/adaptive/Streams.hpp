@@ -63,6 +63,7 @@ namespace adaptive
         void setLanguage(const std::string &);
         void setDescription(const std::string &);
         vlc_tick_t getMinAheadTime() const;
+        vlc_tick_t getLiveLatency(vlc_tick_t) const;
         vlc_tick_t getFirstDTS() const;
         int esCount() const;
         bool isSelected() const;
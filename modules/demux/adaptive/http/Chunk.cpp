@@ -380,8 +380,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         if(readsize < HTTPChunkSource::CHUNK_SIZE)
             readsize = HTTPChunkSource::CHUNK_SIZE;
 
-        if(contentLength && readsize > contentLength - buffered)
-            readsize = contentLength - buffered;
+        if(contentLength && readsize > contentLength - buffered - consumed)
+            readsize = contentLength - buffered - consumed;
     }
 
     block_t *p_block = block_Alloc(readsize);
@@ -398,7 +398,9 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t latency;
     } rate = {0,0,0};
 
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    /* Forward whatever has been received so far: low latency
+     * segments are still being produced while we're downloading */
+    ssize_t ret = connection->readPartial(p_block->p_buffer, readsize);
     if(ret <= 0)
     {
         block_Release(p_block);
@@ -416,7 +418,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         mutex_locker locker {lock};
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
-        if((size_t) ret < readsize)
+        if(contentLength && buffered + consumed >= contentLength)
         {
             done = true;
             downloadEndTime = vlc_tick_now();
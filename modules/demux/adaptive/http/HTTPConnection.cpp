@@ -63,6 +63,11 @@ bool AbstractConnection::prepare(const ConnectionParams &params_)
     return true;
 }
 
+ssize_t AbstractConnection::readPartial(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len);
+}
+
 size_t AbstractConnection::getContentLength() const
 {
     return contentLength;
@@ -191,12 +196,14 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
     public:
         struct vlc_http_resource *http_res;
         int create(const char *uri,const std::string &ua,
-                   const std::string &ref, const BytesRange &range)
+                   const std::string &ref, const BytesRange &range,
+                   struct vlc_http_mgr *shared_mgr)
         {
             struct restuple *tpl = new struct restuple;
             tpl->source = this;
             this->range = range;
-            if (vlc_http_res_init(&tpl->resource, &this->callbacks, http_mgr, uri,
+            if (vlc_http_res_init(&tpl->resource, &this->callbacks,
+                                  shared_mgr ? shared_mgr : http_mgr, uri,
                                   ua.empty() ? nullptr : ua.c_str(),
                                   ref.empty() ? nullptr : ref.c_str()))
             {
@@ -235,9 +242,76 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPSessions::LibVLCHTTPSessions(AuthStorage *auth)
+{
+    authStorage = auth;
+    vlc_mutex_init(&lock);
+}
+
+LibVLCHTTPSessions::~LibVLCHTTPSessions()
+{
+    for(auto it = sessions.begin(); it != sessions.end(); ++it)
+        vlc_http_mgr_destroy((*it).second.mgr);
+}
+
+std::string LibVLCHTTPSessions::getOrigin(const ConnectionParams &params)
+{
+    return params.getScheme() + "://" + params.getHostname() + ":" +
+           std::to_string(params.getPort());
+}
+
+struct vlc_http_mgr * LibVLCHTTPSessions::getManager(vlc_object_t *p_object,
+                                                     const ConnectionParams &params)
+{
+    /* HTTP/2 is only negotiated over TLS */
+    if(params.getScheme() != "https")
+        return nullptr;
+
+    const std::string origin = getOrigin(params);
+    struct vlc_http_mgr *mgr = nullptr;
+
+    vlc_mutex_lock(&lock);
+    auto it = sessions.find(origin);
+    if(it != sessions.end())
+    {
+        if((*it).second.multiplexed)
+            mgr = (*it).second.mgr;
+    }
+    else
+    {
+        mgr = vlc_http_mgr_create(p_object, authStorage->getJar());
+        if(mgr)
+        {
+            Session session;
+            session.mgr = mgr;
+            session.multiplexed = true; /* until proven otherwise */
+            sessions.insert(std::pair<std::string, Session>(origin, session));
+        }
+    }
+    vlc_mutex_unlock(&lock);
+    return mgr;
+}
+
+void LibVLCHTTPSessions::updateMultiplexing(const ConnectionParams &params,
+                                            struct vlc_http_mgr *mgr)
+{
+    if(vlc_http_mgr_is_multiplexed(mgr))
+        return;
+
+    /* Concurrent HTTP/1 requests would keep replacing the shared
+     * connection. The manager stays alive for the pending requests. */
+    vlc_mutex_lock(&lock);
+    auto it = sessions.find(getOrigin(params));
+    if(it != sessions.end() && (*it).second.mgr == mgr)
+        (*it).second.multiplexed = false;
+    vlc_mutex_unlock(&lock);
+}
+
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           LibVLCHTTPSessions *sessions_)
     : AbstractConnection( p_object_ )
 {
+    sessions = sessions_;
     source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
@@ -303,7 +377,9 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     else
         msg_Dbg(p_object, "Retrieving %s", params.getUrl().c_str());
 
-    if(source->create(params.getUrl().c_str(), useragent,referer, range))
+    struct vlc_http_mgr *shared_mgr = sessions ? sessions->getManager(p_object, params)
+                                               : nullptr;
+    if(source->create(params.getUrl().c_str(), useragent, referer, range, shared_mgr))
         return RequestStatus::GenericError;
 
     struct vlc_credential crd;
@@ -325,6 +401,9 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
         return RequestStatus::GenericError;
     }
 
+    if(shared_mgr)
+        sessions->updateMultiplexing(params, shared_mgr);
+
     char *psz_realm = nullptr;
     if (status == 401) /* authentication */
     {
@@ -413,6 +492,15 @@ ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
     return read;
 }
 
+ssize_t LibVLCHTTPConnection::readPartial(void *p_buffer, size_t len)
+{
+    /* Return as soon as some data is available, so chunked
+     * transfers can be forwarded before the response completes */
+    ssize_t read = vlc_stream_ReadPartial(stream, p_buffer, len);
+    bytesRead = source->totalRead;
+    return read;
+}
+
 void LibVLCHTTPConnection::setUsed( bool b )
 {
     available = !b;
@@ -536,7 +624,8 @@ void StreamUrlConnection::setUsed( bool b )
 }
 
 LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
-    : AbstractConnectionFactory()
+    : AbstractConnectionFactory(),
+      sessions( auth )
 {
     authStorage = auth;
 }
@@ -547,7 +636,7 @@ AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    return new LibVLCHTTPConnection(p_object, authStorage, &sessions);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
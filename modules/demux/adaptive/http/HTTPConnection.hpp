@@ -29,6 +29,9 @@
 #include "BytesRange.hpp"
 #include <vlc_common.h>
 #include <string>
+#include <map>
+
+struct vlc_http_mgr;
 
 namespace adaptive
 {
@@ -52,6 +55,7 @@ namespace adaptive
                 virtual RequestStatus request(const std::string& path,
                                               const BytesRange & = BytesRange()) = 0;
                 virtual ssize_t read        (void *p_buffer, size_t len) = 0;
+                virtual ssize_t readPartial (void *p_buffer, size_t len);
 
                 virtual size_t  getContentLength() const;
                 virtual size_t  getBytesRead() const;
@@ -72,15 +76,41 @@ namespace adaptive
 
        class LibVLCHTTPSource;
 
+       /* Shares one HTTP manager per HTTPS origin between the connections,
+        * so that all requests multiplex on a single HTTP/2 session.
+        * Origins not negotiating HTTP/2 fall back to per connection managers */
+       class LibVLCHTTPSessions
+       {
+            public:
+               LibVLCHTTPSessions(AuthStorage *);
+               ~LibVLCHTTPSessions();
+               struct vlc_http_mgr * getManager(vlc_object_t *, const ConnectionParams &);
+               void    updateMultiplexing(const ConnectionParams &, struct vlc_http_mgr *);
+
+            private:
+               class Session
+               {
+                   public:
+                       struct vlc_http_mgr *mgr;
+                       bool multiplexed;
+               };
+               static std::string getOrigin(const ConnectionParams &);
+               AuthStorage *authStorage;
+               std::map<std::string, Session> sessions;
+               vlc_mutex_t lock;
+       };
+
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    LibVLCHTTPSessions * = nullptr);
                virtual ~LibVLCHTTPConnection();
                virtual bool    canReuse     (const ConnectionParams &) const override;
                virtual RequestStatus request(const std::string& path,
                                              const BytesRange & = BytesRange()) override;
                virtual ssize_t read         (void *p_buffer, size_t len) override;
+               virtual ssize_t readPartial  (void *p_buffer, size_t len) override;
                virtual void    setUsed      ( bool ) override;
 
             private:
@@ -88,6 +118,7 @@ namespace adaptive
                std::string useragent;
                std::string referer;
                LibVLCHTTPSource *source;
+               LibVLCHTTPSessions *sessions;
                ChunksSourceStream *sourceStream;
                stream_t *stream;
        };
@@ -127,6 +158,7 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
            private:
                AuthStorage *authStorage;
+               LibVLCHTTPSessions sessions;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
@@ -38,9 +38,11 @@ using namespace adaptive::playlist;
 using namespace adaptive::logic;
 
 const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWEST_LIMIT = VLC_TICK_FROM_SEC(2);
+const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWLATENCY_LIMIT = VLC_TICK_FROM_MS(500);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING = VLC_TICK_FROM_SEC(15);
+const vlc_tick_t AbstractBufferingLogic::DEFAULT_LOWLATENCY_BUFFERING = VLC_TICK_FROM_MS(1500);
 
 AbstractBufferingLogic::AbstractBufferingLogic()
 {
@@ -103,7 +105,7 @@ uint64_t DefaultBufferingLogic::getStartSegmentNumber(BaseRepresentation *rep) c
 vlc_tick_t DefaultBufferingLogic::getMinBuffering(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return BUFFERING_LOWEST_LIMIT;
+        return getLowLatencyDelay(p);
 
     vlc_tick_t buffering = userMinBuffering ? userMinBuffering
                                             : DEFAULT_MIN_BUFFERING;
@@ -179,7 +181,7 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
         uint64_t safeMinElementNumber = timeline->minElementNumber();
         uint64_t safeMaxElementNumber = timeline->maxElementNumber();
         stime_t safeedgetime, safestarttime, duration;
-        for(unsigned i=0; i<SAFETY_BUFFERING_EDGE_OFFSET; i++)
+        for(unsigned i=0; i<getSafetyEdgeOffset(playlist); i++)
         {
             if(safeMinElementNumber == safeMaxElementNumber)
                 break;
@@ -242,7 +244,9 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
         {
             /* Compute playback offset and effective finished segment from wall time */
             vlc_tick_t now = vlc_tick_from_sec(time(nullptr));
-            vlc_tick_t playbacktime = now - i_buffering;
+            /* segments can be requested before their completion time */
+            vlc_tick_t playbacktime = now + mediaSegmentTemplate->inheritAvailabilityTimeOffset()
+                                    - i_buffering;
             vlc_tick_t minavailtime = playlist->availabilityStartTime.Get() + rep->getPeriodStart();
             const uint64_t startnumber = mediaSegmentTemplate->inheritStartNumber();
             const Timescale timescale = mediaSegmentTemplate->inheritTimescale();
@@ -273,7 +277,7 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
             }
 
             const uint64_t max_safety_offset = playbacktime - minavailtime / duration;
-            const uint64_t safety_offset = std::min((uint64_t)SAFETY_BUFFERING_EDGE_OFFSET,
+            const uint64_t safety_offset = std::min((uint64_t)getSafetyEdgeOffset(playlist),
                                                     max_safety_offset);
             if(startnumber + safety_offset <= start)
                 start -= safety_offset;
@@ -318,7 +322,7 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
 
         uint64_t safeedgenumber = back->getSequenceNumber() -
                         std::min((uint64_t)list.size() - 1,
-                                 (uint64_t)SAFETY_BUFFERING_EDGE_OFFSET);
+                                 (uint64_t)getSafetyEdgeOffset(playlist));
         uint64_t safestartnumber = availableliststartnumber;
 
         for(unsigned i=0; i<SAFETY_EXPURGING_OFFSET; i++)
@@ -386,6 +390,21 @@ vlc_tick_t DefaultBufferingLogic::getBufferingOffset(const BasePlaylist *p) cons
     return p->isLive() ? getLiveDelay(p) : getMaxBuffering(p);
 }
 
+vlc_tick_t DefaultBufferingLogic::getLowLatencyDelay(const BasePlaylist *p) const
+{
+    vlc_tick_t delay = userLiveDelay ? userLiveDelay
+                                     : DEFAULT_LOWLATENCY_BUFFERING;
+    if(p->suggestedPresentationDelay.Get())
+        delay = p->suggestedPresentationDelay.Get();
+    return std::max(delay, BUFFERING_LOWLATENCY_LIMIT);
+}
+
+unsigned DefaultBufferingLogic::getSafetyEdgeOffset(const BasePlaylist *p) const
+{
+    /* low latency sources already publish only what can be fetched */
+    return isLowLatency(p) ? 0 : SAFETY_BUFFERING_EDGE_OFFSET;
+}
+
 bool DefaultBufferingLogic::isLowLatency(const BasePlaylist *p) const
 {
     if(userLowLatency.isSet())
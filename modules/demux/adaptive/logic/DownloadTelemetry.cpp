@@ -0,0 +1,129 @@
+/*
+ * DownloadTelemetry.cpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "DownloadTelemetry.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+const size_t DownloadTelemetry::DEFAULT_CAPACITY = 64;
+
+DownloadRecord::DownloadRecord()
+{
+    bandwidth = 0;
+    size = 0;
+    time = 0;
+    latency = 0;
+    date = VLC_TICK_INVALID;
+}
+
+DownloadTelemetry::DownloadTelemetry(size_t capacity)
+    : ring(capacity ? capacity : 1)
+{
+    head = 0;
+    count = 0;
+    downstream = nullptr;
+    vlc_mutex_init(&lock);
+}
+
+DownloadTelemetry::~DownloadTelemetry()
+{
+}
+
+void DownloadTelemetry::setDownstreamObserver(IDownloadRateObserver *obs)
+{
+    downstream = obs;
+}
+
+void DownloadTelemetry::updateDownloadRate(const ID &id, size_t size,
+                                           vlc_tick_t time, vlc_tick_t latency)
+{
+    vlc_mutex_lock(&lock);
+    DownloadRecord &record = ring[head];
+    record.id = id;
+    std::map<ID, Current>::const_iterator it = current.find(id);
+    if(it != current.end())
+    {
+        record.representation = (*it).second.representation;
+        record.bandwidth = (*it).second.bandwidth;
+    }
+    else
+    {
+        record.representation = ID();
+        record.bandwidth = 0;
+    }
+    record.size = size;
+    record.time = time;
+    record.latency = latency;
+    record.date = vlc_tick_now();
+    head = (head + 1) % ring.size();
+    if(count < ring.size())
+        count++;
+    vlc_mutex_unlock(&lock);
+
+    if(downstream)
+        downstream->updateDownloadRate(id, size, time, latency);
+}
+
+void DownloadTelemetry::trackerEvent(const TrackerEvent &ev)
+{
+    if(ev.getType() != TrackerEvent::Type::RepresentationSwitch)
+        return;
+
+    const RepresentationSwitchEvent &event =
+            static_cast<const RepresentationSwitchEvent &>(ev);
+    if(!event.next)
+        return;
+
+    vlc_mutex_lock(&lock);
+    Current &cur = current[event.next->getAdaptationSet()->getID()];
+    cur.representation = event.next->getID();
+    cur.bandwidth = event.next->getBandwidth();
+    vlc_mutex_unlock(&lock);
+}
+
+size_t DownloadTelemetry::getRecords(std::vector<DownloadRecord> &records) const
+{
+    vlc_mutex_lock(&lock);
+    records.clear();
+    records.reserve(count);
+    size_t index = (head + ring.size() - count) % ring.size();
+    for(size_t i = 0; i < count; i++)
+    {
+        records.push_back(ring[index]);
+        index = (index + 1) % ring.size();
+    }
+    vlc_mutex_unlock(&lock);
+    return records.size();
+}
+
+size_t DownloadTelemetry::getCount() const
+{
+    vlc_mutex_lock(&lock);
+    size_t ret = count;
+    vlc_mutex_unlock(&lock);
+    return ret;
+}
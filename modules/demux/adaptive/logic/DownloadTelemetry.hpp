@@ -0,0 +1,85 @@
+/*
+ * DownloadTelemetry.hpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef DOWNLOADTELEMETRY_HPP
+#define DOWNLOADTELEMETRY_HPP
+
+#include "IDownloadRateObserver.h"
+#include "../SegmentTracker.hpp"
+#include "../ID.hpp"
+
+#include <vector>
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class DownloadRecord
+        {
+            public:
+                DownloadRecord();
+
+                ID          id;         /* stream the segment belongs to */
+                ID          representation;
+                uint64_t    bandwidth;  /* advertised bitrate */
+                size_t      size;
+                vlc_tick_t  time;       /* request to last byte */
+                vlc_tick_t  latency;    /* request to first byte */
+                vlc_tick_t  date;
+        };
+
+        /* Keeps the last segment downloads in a fixed size ring,
+         * and forwards rates to the adaptation logic */
+        class DownloadTelemetry : public IDownloadRateObserver,
+                                  public SegmentTrackerListenerInterface
+        {
+            public:
+                DownloadTelemetry(size_t = DEFAULT_CAPACITY);
+                virtual ~DownloadTelemetry();
+
+                virtual void updateDownloadRate(const ID &, size_t,
+                                                vlc_tick_t, vlc_tick_t) override;
+                virtual void trackerEvent(const TrackerEvent &) override;
+                void setDownstreamObserver(IDownloadRateObserver *);
+
+                /* Copies the records, oldest first, and returns their count */
+                size_t getRecords(std::vector<DownloadRecord> &) const;
+                size_t getCount() const;
+
+                static const size_t DEFAULT_CAPACITY;
+
+            private:
+                class Current
+                {
+                    public:
+                        ID          representation;
+                        uint64_t    bandwidth;
+                };
+                std::vector<DownloadRecord> ring;
+                size_t                      head;
+                size_t                      count;
+                std::map<ID, Current>       current;
+                IDownloadRateObserver      *downstream;
+                mutable vlc_mutex_t         lock;
+        };
+    }
+}
+
+#endif // DOWNLOADTELEMETRY_HPP
@@ -0,0 +1,290 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput and buffer hybrid, simplified RobustMPC
+ * A Control-Theoretic Approach for Dynamic Adaptive Video Streaming over HTTP
+ * https://dl.acm.org/doi/10.1145/2785956.2787486
+ *
+ * Each candidate is kept over a few segments lookahead, starting from
+ * the current buffer level and the predicted throughput. It is scored
+ * by its utility, minus the predicted stall and the quality change
+ * from the current representation. Bitrates above the throughput are
+ * only considered when the buffer is above its target.
+ */
+
+#define defaultSegmentDuration  VLC_TICK_FROM_SEC(4)
+#define rebufferPenalty         4.3f /* per stalled second */
+#define switchPenalty           1.0f
+
+const unsigned HybridAdaptationLogic::THROUGHPUT_SAMPLES = 5;
+const unsigned HybridAdaptationLogic::LOOKAHEAD_SEGMENTS = 5;
+
+HybridContext::HybridContext()
+    : buffering_level( 0 )
+    , buffering_target( 1 )
+    , last_duration( 0 )
+{ }
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , latency( 0 )
+    , usedBps( 0 )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet,
+                                                                 BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(lowest == nullptr || highest == nullptr)
+        return nullptr;
+
+    if(lowest == highest)
+        return lowest;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::const_iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end() || samples.empty())
+    {
+        vlc_mutex_unlock(&lock);
+        return lowest;
+    }
+    const HybridContext ctxcopy = (*it).second;
+    const uint64_t bps = getAvailableBw(getPredictedBw(), prevRep);
+    const vlc_tick_t ttfb = latency;
+
+    vlc_mutex_unlock(&lock);
+
+    if(bps == 0)
+        return lowest;
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    float maxscore = 0;
+    for(BaseRepresentation *rep = lowest;
+                            rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        prev = rep;
+        /* Only go beyond the throughput once the buffer is above target.
+         * Keeping the current one below gives some hysteresis */
+        if(rep != lowest && rep != prevRep && rep->getBandwidth() > bps &&
+           ctxcopy.buffering_level < ctxcopy.buffering_target)
+            continue;
+        float score = getScore(rep, prevRep, lowest, ctxcopy, bps, ttfb);
+        if(ret == nullptr || score > maxscore)
+        {
+            ret = rep;
+            maxscore = score;
+        }
+    }
+
+    BwDebug( msg_Info(p_obj, "buffering level %.2f%% rep %" PRIu64 " kBps %" PRIu64 " kBps",
+             (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target,
+             ret->getBandwidth() / 8000, bps / 8000); );
+
+    return ret;
+}
+
+float HybridAdaptationLogic::getScore(const BaseRepresentation *rep,
+                                      const BaseRepresentation *prevRep,
+                                      const BaseRepresentation *lowest,
+                                      const HybridContext &ctx,
+                                      uint64_t bps, vlc_tick_t ttfb) const
+{
+    const float segment = secf_from_vlc_tick(ctx.last_duration ? ctx.last_duration
+                                                               : defaultSegmentDuration);
+    const float lowestbw = std::max(lowest->getBandwidth(), (uint64_t) 1);
+
+    const float dltime = secf_from_vlc_tick(ttfb) + segment * rep->getBandwidth() / bps;
+    const float utility = std::log(std::max(rep->getBandwidth(), (uint64_t) 1) / lowestbw);
+
+    float buffer = secf_from_vlc_tick(ctx.buffering_level);
+    float stall = 0.0f;
+    for(unsigned i=0; i<LOOKAHEAD_SEGMENTS; i++)
+    {
+        /* Stalls if the segment can't be fetched before the buffer runs out */
+        stall += std::max(0.0f, dltime - buffer);
+        buffer = std::max(0.0f, buffer - dltime) + segment;
+    }
+
+    float score = utility * LOOKAHEAD_SEGMENTS - rebufferPenalty * stall;
+    if(prevRep && prevRep != rep)
+    {
+        const float prevutility = std::log(std::max(prevRep->getBandwidth(), (uint64_t) 1) / lowestbw);
+        score -= switchPenalty * std::fabs(utility - prevutility);
+    }
+    return score;
+}
+
+uint64_t HybridAdaptationLogic::getHarmonicMeanBw() const
+{
+    /* Harmonic mean is robust against a single fast outlier */
+    double invsum = 0.0;
+    for(uint64_t s : samples)
+        invsum += 1.0 / std::max(s, (uint64_t) 1);
+    return samples.size() / invsum;
+}
+
+uint64_t HybridAdaptationLogic::getPredictedBw() const
+{
+    /* Discount by the worst recent prediction error */
+    float maxerror = 0.0f;
+    for(float e : errors)
+        maxerror = std::max(maxerror, e);
+    return getHarmonicMeanBw() / (1.0f + maxerror);
+}
+
+uint64_t HybridAdaptationLogic::getAvailableBw(uint64_t i_bw, const BaseRepresentation *curRep) const
+{
+    uint64_t i_remain = i_bw;
+    if(i_remain > usedBps)
+        i_remain -= usedBps;
+    else
+        i_remain = 0;
+    if(curRep)
+        i_remain += curRep->getBandwidth();
+    return i_remain > i_bw ? i_bw : i_remain;
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &, size_t dlsize,
+                                               vlc_tick_t time, vlc_tick_t ttfb)
+{
+    if(unlikely(time == 0))
+        return;
+
+    /* Time to first byte is accounted separately from the transfer */
+    vlc_tick_t transfer = (ttfb > 0 && ttfb < time) ? time - ttfb : time;
+
+    const uint64_t bps = std::max<uint64_t>(CLOCK_FREQ * dlsize * 8 / transfer, 1);
+
+    vlc_mutex_lock(&lock);
+    if(!samples.empty())
+    {
+        const uint64_t predicted = getHarmonicMeanBw();
+        if(errors.size() >= THROUGHPUT_SAMPLES)
+            errors.pop_front();
+        errors.push_back(std::fabs((float) predicted - (float) bps) / bps);
+    }
+    if(samples.size() >= THROUGHPUT_SAMPLES)
+        samples.pop_front();
+    samples.push_back(bps);
+    if(ttfb > 0 && ttfb < time)
+        latency = (latency * 3 + ttfb) / 4;
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &event =
+                    static_cast<const RepresentationSwitchEvent &>(ev);
+            vlc_mutex_lock(&lock);
+            if(event.prev)
+                usedBps -= event.prev->getBandwidth();
+            if(event.next)
+                usedBps += event.next->getBandwidth();
+            BwDebug(msg_Info(p_obj, "New total bandwidth usage %" PRIu64 " kBps", (usedBps / 8000)));
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    HybridContext ctx;
+                    streams.insert(std::pair<ID, HybridContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+            BwDebug(msg_Info(p_obj, "Stream %s is now known %sactive", id.str().c_str(),
+                             (event.enabled) ? "" : "in"));
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            HybridContext &ctx = streams[id];
+            ctx.buffering_level = event.current;
+            ctx.buffering_target = std::max(event.target, (vlc_tick_t) 1);
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::SegmentChange:
+        {
+            const SegmentChangedEvent &event =
+                    static_cast<const SegmentChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            HybridContext &ctx = streams[id];
+            if(event.duration != VLC_TICK_INVALID)
+                ctx.last_duration = event.duration;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
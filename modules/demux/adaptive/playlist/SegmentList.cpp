@@ -262,7 +262,12 @@ Segment *  SegmentList::getNextMediaSegment(uint64_t i_pos,uint64_t *pi_newpos,
         if(seg->getSequenceNumber() >= i_pos)
         {
             *pi_newpos = seg->getSequenceNumber();
-            *pb_gap = (*pi_newpos != i_pos);
+            /* Numbering may skip values (HLS parts), which is not a gap
+             * when the segment before is the one that was expected last
+             * and continues into this one */
+            *pb_gap = (*pi_newpos != i_pos) &&
+                      (it == segments.begin() || seg->discontinuity ||
+                       (*(it - 1))->getSequenceNumber() + 1 != i_pos);
             return seg;
         }
     }
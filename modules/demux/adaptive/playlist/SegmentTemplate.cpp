@@ -135,7 +135,8 @@ vlc_tick_t SegmentTemplate::getMinAheadTime(uint64_t number) const
     else
     {
         const Timescale timescale = inheritTimescale();
-        uint64_t current = getLiveTemplateNumber(vlc_tick_from_sec(time(nullptr)));
+        uint64_t current = getLiveTemplateNumber(vlc_tick_from_sec(time(nullptr)) +
+                                                 inheritAvailabilityTimeOffset());
         stime_t i_length = (current - number) * inheritDuration();
         return timescale.ToTime(i_length);
     }
@@ -188,6 +189,7 @@ Segment *  SegmentTemplate::getNextMediaSegment(uint64_t i_pos,uint64_t *pi_newp
         /* start number */
         *pi_newpos = std::max(inheritStartNumber(), i_pos);
     }
+    *pb_gap = (*pi_newpos != i_pos);
     return virtualsegment;
 }
 
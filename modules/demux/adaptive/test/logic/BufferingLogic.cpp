@@ -141,8 +141,12 @@ int BufferingLogic_test()
         if(DefaultBufferingLogic::DEFAULT_MIN_BUFFERING > DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT)
             Expect(bufferinglogic.getMinBuffering(playlist) < DefaultBufferingLogic::DEFAULT_MIN_BUFFERING);
         Expect(bufferinglogic.getMaxBuffering(playlist) < DefaultBufferingLogic::DEFAULT_MAX_BUFFERING);
-        Expect(bufferinglogic.getMinBuffering(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
-        Expect(bufferinglogic.getLiveDelay(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
+        Expect(bufferinglogic.getMinBuffering(playlist) >= DefaultBufferingLogic::BUFFERING_LOWLATENCY_LIMIT);
+        Expect(bufferinglogic.getLiveDelay(playlist) >= DefaultBufferingLogic::BUFFERING_LOWLATENCY_LIMIT);
+        Expect(bufferinglogic.getLiveDelay(playlist) < DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
+        bufferinglogic.setUserLiveDelay(DefaultBufferingLogic::BUFFERING_LOWLATENCY_LIMIT / 2);
+        Expect(bufferinglogic.getLiveDelay(playlist) == DefaultBufferingLogic::BUFFERING_LOWLATENCY_LIMIT);
+        bufferinglogic.setUserLiveDelay(0);
 
         playlist->b_lowlatency = false;
         Expect(bufferinglogic.getStartSegmentNumber(rep) == number);
@@ -0,0 +1,328 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2021 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/AlwaysBestAdaptationLogic.h"
+#include "../../logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../../logic/DownloadTelemetry.hpp"
+
+#include "../test.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace adaptive::logic;
+
+/*
+ * Replays bandwidth traces against the adaptation logics, simulating
+ * a single stream downloading its segments back to back.
+ * Set ADAPTIVE_SIMULATION_TRACE to a file of "<duration ms> <kbps>"
+ * lines to also replay a recorded trace and print every result.
+ */
+
+class SimulationPlaylist : public BasePlaylist
+{
+    public:
+        SimulationPlaylist() : BasePlaylist(nullptr) {}
+        virtual ~SimulationPlaylist() {}
+        virtual bool isLive() const override { return false; }
+};
+
+struct TracePoint
+{
+    vlc_tick_t duration;
+    uint64_t   bps;
+};
+
+typedef std::vector<TracePoint> Trace;
+
+struct SimulationResult
+{
+    unsigned   segments;
+    unsigned   switches;
+    vlc_tick_t rebuffering;
+    uint64_t   averagebps;
+};
+
+#define SIM_SEGMENT_DURATION VLC_TICK_FROM_SEC(4)
+#define SIM_SEGMENT_COUNT    75
+#define SIM_BUFFER_MIN       VLC_TICK_FROM_SEC(6)
+#define SIM_BUFFER_MAX       VLC_TICK_FROM_SEC(30)
+#define SIM_BUFFER_TARGET    VLC_TICK_FROM_SEC(12)
+#define SIM_LATENCY          VLC_TICK_FROM_MS(80)
+
+static uint64_t TraceBandwidth(const Trace &trace, vlc_tick_t time)
+{
+    vlc_tick_t total = 0;
+    for(const TracePoint &p : trace)
+        total += p.duration;
+    time %= total; /* loop over the trace */
+    for(const TracePoint &p : trace)
+    {
+        if(time < p.duration)
+            return p.bps;
+        time -= p.duration;
+    }
+    return trace.back().bps;
+}
+
+/* Time needed to transfer size bytes starting at time, 10ms steps */
+static vlc_tick_t TraceDownload(const Trace &trace, vlc_tick_t time, uint64_t size)
+{
+    const vlc_tick_t step = VLC_TICK_FROM_MS(10);
+    vlc_tick_t elapsed = 0;
+    uint64_t bits = size * 8;
+    while(bits)
+    {
+        uint64_t stepbits = TraceBandwidth(trace, time + elapsed) * step / CLOCK_FREQ;
+        if(stepbits >= bits)
+        {
+            elapsed += step * bits / stepbits;
+            break;
+        }
+        bits -= stepbits;
+        elapsed += step;
+    }
+    return elapsed;
+}
+
+static SimulationResult Simulate(AbstractAdaptationLogic *logic,
+                                 BaseAdaptationSet *set, const Trace &trace)
+{
+    SimulationResult result = { 0, 0, 0, 0 };
+    const ID &id = set->getID();
+    BaseRepresentation *prev = nullptr;
+    vlc_tick_t now = 0;
+    vlc_tick_t buffering = 0;
+    uint64_t totalbps = 0;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+    for(unsigned i=0; i<SIM_SEGMENT_COUNT; i++)
+    {
+        BaseRepresentation *rep = logic->getNextRepresentation(set, prev);
+        if(rep == nullptr)
+            throw 1;
+        if(rep != prev)
+        {
+            logic->trackerEvent(RepresentationSwitchEvent(prev, rep));
+            if(prev)
+                result.switches++;
+            prev = rep;
+        }
+        logic->trackerEvent(SegmentChangedEvent(id, i * SIM_SEGMENT_DURATION,
+                                                SIM_SEGMENT_DURATION));
+
+        const uint64_t size = rep->getBandwidth() * SIM_SEGMENT_DURATION / CLOCK_FREQ / 8;
+        const vlc_tick_t dltime = SIM_LATENCY + TraceDownload(trace, now + SIM_LATENCY, size);
+        now += dltime;
+        if(i > 0 && dltime > buffering) /* startup isn't a stall */
+            result.rebuffering += dltime - buffering;
+        buffering = (dltime < buffering) ? buffering - dltime : 0;
+        buffering += SIM_SEGMENT_DURATION;
+        if(buffering > SIM_BUFFER_MAX) /* wait for room */
+        {
+            now += buffering - SIM_BUFFER_MAX;
+            buffering = SIM_BUFFER_MAX;
+        }
+
+        logic->updateDownloadRate(id, size, dltime, SIM_LATENCY);
+        logic->trackerEvent(BufferingLevelChangedEvent(id, SIM_BUFFER_MIN, SIM_BUFFER_MAX,
+                                                       buffering, SIM_BUFFER_TARGET));
+        totalbps += rep->getBandwidth();
+        result.segments++;
+    }
+    logic->trackerEvent(RepresentationSwitchEvent(prev, nullptr));
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, false));
+
+    result.averagebps = totalbps / result.segments;
+    return result;
+}
+
+static Trace LoadTrace(const char *psz_file)
+{
+    Trace trace;
+    FILE *fp = fopen(psz_file, "r");
+    if(!fp)
+        return trace;
+    unsigned ms, kbps;
+    while(fscanf(fp, "%u %u", &ms, &kbps) == 2)
+    {
+        if(ms)
+            trace.push_back({VLC_TICK_FROM_MS(ms), (uint64_t) kbps * 1000});
+    }
+    fclose(fp);
+    return trace;
+}
+
+static int Telemetry_test()
+{
+    DownloadTelemetry telemetry(4);
+    std::vector<DownloadRecord> records;
+
+    Expect(telemetry.getRecords(records) == 0);
+    for(unsigned i=1; i<=6; i++)
+        telemetry.updateDownloadRate(ID(i % 2), i * 1000,
+                                     VLC_TICK_FROM_MS(i), VLC_TICK_FROM_MS(1));
+    Expect(telemetry.getCount() == 4);
+    Expect(telemetry.getRecords(records) == 4);
+    for(unsigned i=0; i<4; i++) /* oldest first */
+    {
+        Expect(records[i].size == (i + 3) * 1000);
+        Expect(records[i].time == VLC_TICK_FROM_MS(i + 3));
+        Expect(records[i].latency == VLC_TICK_FROM_MS(1));
+        Expect(records[i].id == ID((i + 3) % 2));
+        Expect(records[i].bandwidth == 0);
+    }
+
+    /* downloads are tagged with the current representation of their set */
+    SimulationPlaylist *playlist = new SimulationPlaylist();
+    try
+    {
+        BasePeriod *period = new BasePeriod(playlist);
+        BaseAdaptationSet *set = new BaseAdaptationSet(period);
+        set->setID(ID(7));
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setID(ID("video-hd"));
+        rep->setBandwidth(3200000);
+        set->addRepresentation(rep);
+        period->addAdaptationSet(set);
+        playlist->addPeriod(period);
+
+        telemetry.trackerEvent(RepresentationSwitchEvent(nullptr, rep));
+        telemetry.updateDownloadRate(set->getID(), 1000, VLC_TICK_FROM_MS(2),
+                                     VLC_TICK_FROM_MS(1));
+        Expect(telemetry.getRecords(records) == 4);
+        Expect(records[3].id == ID(7));
+        Expect(records[3].representation == ID("video-hd"));
+        Expect(records[3].bandwidth == 3200000);
+    }
+    catch(...)
+    {
+        delete playlist;
+        return 1;
+    }
+    delete playlist;
+    return 0;
+}
+
+int AdaptationLogics_test()
+{
+    try
+    {
+        if(Telemetry_test())
+            return 1;
+    }
+    catch(...)
+    {
+        return 1;
+    }
+
+    SimulationPlaylist *playlist = new SimulationPlaylist();
+    BasePeriod *period = new BasePeriod(playlist);
+    BaseAdaptationSet *set = new BaseAdaptationSet(period);
+    const uint64_t ladder[] = { 400000, 800000, 1600000, 3200000, 6400000 };
+    for(uint64_t bps : ladder)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setBandwidth(bps);
+        set->addRepresentation(rep);
+    }
+    period->addAdaptationSet(set);
+    playlist->addPeriod(period);
+
+    std::vector<std::pair<const char *, Trace>> traces = {
+        { "steady",   { { VLC_TICK_FROM_SEC(60), 5000000 } } },
+        { "stepdown", { { VLC_TICK_FROM_SEC(60), 8000000 },
+                        { VLC_TICK_FROM_SEC(90), 1000000 },
+                        { VLC_TICK_FROM_SEC(60), 8000000 } } },
+        { "bursty",   { { VLC_TICK_FROM_SEC(3), 6000000 },
+                        { VLC_TICK_FROM_SEC(2), 500000 } } },
+    };
+    const char *psz_trace = getenv("ADAPTIVE_SIMULATION_TRACE");
+    if(psz_trace)
+    {
+        Trace trace = LoadTrace(psz_trace);
+        if(!trace.empty())
+            traces.push_back({ psz_trace, trace });
+    }
+
+    int ret = 0;
+    for(const auto &trace : traces)
+    {
+        const struct
+        {
+            const char *name;
+            AbstractAdaptationLogic *logic;
+        } logics[] = {
+            { "rate",        new RateBasedAdaptationLogic(nullptr) },
+            { "fixedrate",   new FixedRateAdaptationLogic(nullptr, 1000000) },
+            { "predictive",  new PredictiveAdaptationLogic(nullptr) },
+            { "nearoptimal", new NearOptimalAdaptationLogic(nullptr) },
+            { "hybrid",      new HybridAdaptationLogic(nullptr) },
+            { "lowest",      new AlwaysLowestAdaptationLogic(nullptr) },
+            { "highest",     new AlwaysBestAdaptationLogic(nullptr) },
+        };
+
+        for(const auto &l : logics)
+        {
+            try
+            {
+                SimulationResult res = Simulate(l.logic, set, trace.second);
+                if(psz_trace) /* only report when comparing against a capture */
+                    std::cerr << " " << trace.first << " " << l.name
+                              << ": " << res.averagebps / 1000 << "kbps"
+                              << " switches " << res.switches
+                              << " stalled " << MS_FROM_VLC_TICK(res.rebuffering) << "ms"
+                              << std::endl;
+                Expect(res.segments == SIM_SEGMENT_COUNT);
+                if(!strcmp(l.name, "hybrid") && psz_trace != trace.first)
+                {
+                    /* must adapt on synthetic traces. The segment in flight
+                     * when the bandwidth suddenly drops can still stall */
+                    Expect(res.rebuffering < 2 * SIM_SEGMENT_DURATION);
+                    Expect(res.averagebps >= 800000);
+                }
+            }
+            catch(...)
+            {
+                ret = 1;
+            }
+        }
+        for(const auto &l : logics)
+            delete l.logic;
+    }
+
+    delete playlist;
+    return ret;
+}
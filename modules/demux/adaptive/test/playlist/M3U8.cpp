@@ -382,6 +382,61 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 5 */
+    const char manifest5[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.5\n"
+    "#EXT-X-PART-INF:PART-TARGET=0.5\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4,\n"
+    "foobar.ts\n"
+    "#EXTINF:4,\n"
+    "foobar.ts\n"
+    "#EXTINF:4,\n"
+    "foobar.ts\n"
+    "#EXTINF:4,\n"
+    "foobar.ts\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"foobar.14.0.ts\",INDEPENDENT=YES\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"foobar.14.1.ts\"\n";
+
+    m3u = ParseM3U8(obj, manifest5, sizeof(manifest5));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        Expect(m3u->suggestedPresentationDelay.Get() == VLC_TICK_FROM_MS(1500));
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Expect(rep->getProfile()->getStartSegmentNumber() == 10 * HLSSegment::PART_STRIDE);
+        Expect(bufferingLogic.getLiveDelay(m3u) < DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
+        /* no safety segment needed when parts are advertised */
+        Expect(bufferingLogic.getStartSegmentNumber(rep) == 13 * HLSSegment::PART_STRIDE);
+        /* parts and preload hint are fetched in place of the pending segment */
+        SegmentList *segmentList = rep->inheritSegmentList();
+        Expect(segmentList);
+        Expect(segmentList->getSegments().size() == 6);
+        Segment *seg = segmentList->getMediaSegment(14 * HLSSegment::PART_STRIDE);
+        Expect(seg);
+        Expect(seg->duration.Get() == VLC_TICK_FROM_MS(500));
+        seg = segmentList->getMediaSegment(14 * HLSSegment::PART_STRIDE + 1);
+        Expect(seg);
+        Expect(seg->getSequenceNumber() == 14 * HLSSegment::PART_STRIDE + 1);
+        /* blocking reload asks for the hinted part */
+        HLSRepresentation *hlsrep = dynamic_cast<HLSRepresentation *>(rep);
+        Expect(hlsrep);
+        std::string requrl = hlsrep->getPlaylistRequestUrl();
+        Expect(requrl.find("_HLS_msn=14&_HLS_part=1") != std::string::npos);
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
 
     return 0;
 }
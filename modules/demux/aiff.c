@@ -52,6 +52,8 @@ vlc_module_begin ()
     set_callback( Open )
     add_shortcut( "aiff" )
     add_file_extension("aiff")
+    add_signature(8, "AIFF")
+    add_signature(8, "AIFC")
 vlc_module_end ()
 
 /*****************************************************************************
@@ -64,6 +64,7 @@ vlc_module_begin ()
     add_file_extension("asf")
     add_file_extension("wma")
     add_file_extension("wmv")
+    add_signature(0, "\x30\x26\xB2\x75\x8E\x66\xCF\x11")
 vlc_module_end ()
 
 
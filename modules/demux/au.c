@@ -50,6 +50,7 @@ vlc_module_begin ()
     set_callback( Open )
     add_shortcut( "au" )
     add_file_extension("au")
+    add_signature(0, ".snd")
 vlc_module_end ()
 
 /*****************************************************************************
@@ -30,6 +30,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <limits.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -45,6 +46,7 @@
 #include "libavi.h"
 #include "../rawdv.h"
 #include "bitmapinfoheader.h"
+#include "index.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -73,6 +75,7 @@ vlc_module_begin ()
     set_capability( "demux", 212 )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     add_file_extension("avi")
+    add_signature(8, "AVI ")
 
     add_bool( "avi-interleaved", false,
               INTERLEAVE_TEXT, NULL )
@@ -116,27 +119,6 @@ typedef struct
 } avi_packet_t;
 
 
-typedef struct
-{
-    vlc_fourcc_t i_id;
-    uint32_t     i_flags;
-    uint64_t     i_pos;
-    uint32_t     i_length;
-    uint64_t     i_lengthtotal;
-
-} avi_entry_t;
-
-typedef struct
-{
-    uint32_t        i_size;
-    uint32_t        i_max;
-    avi_entry_t     *p_entry;
-
-} avi_index_t;
-static void avi_index_Init( avi_index_t * );
-static void avi_index_Clean( avi_index_t * );
-static void avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
-
 typedef struct
 {
     bool            b_activated;
@@ -167,6 +149,33 @@ typedef struct
 
 } avi_track_t;
 
+/* Index creation in the background */
+typedef struct
+{
+    demux_t         *p_demux;
+    stream_t        *s;
+    vlc_thread_t    thread;
+    atomic_bool     b_abort;
+    atomic_bool     b_done;
+    atomic_uint     i_progress; /* of the scan, in 1/1000 */
+    bool            b_complete;
+
+    uint64_t        i_movi_begin; /* first chunk */
+    uint64_t        i_movi_end;
+    uint64_t        i_avix_begin; /* first chunk after the second RIFF */
+    bool            b_odml;
+
+    unsigned int    i_track;
+    struct
+    {
+        enum es_format_category_e i_cat;
+        vlc_fourcc_t i_codec;
+        avi_index_t  idx;
+    } *track;
+    uint64_t        i_last_pos;
+
+} avi_indexer_t;
+
 typedef struct
 {
     vlc_tick_t i_time;
@@ -189,6 +198,10 @@ typedef struct
     unsigned int i_track;
     avi_track_t  **track;
 
+    avi_indexer_t *p_indexer;
+    double         f_index_progress; /* once created in the background,
+                                        negative if it was not */
+
     /* meta */
     vlc_meta_t  *meta;
 
@@ -213,12 +226,14 @@ static int AVI_StreamBytesSet ( demux_t *,
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( vlc_fourcc_t , uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
-static void AVI_IndexCreate  ( demux_t * );
+static void AVI_IndexStart   ( demux_t *, avi_chunk_list_t *p_movi );
+static void AVI_IndexAdopt   ( demux_t * );
+static void AVI_IndexStop    ( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -271,6 +286,9 @@ static void Close ( vlc_object_t * p_this )
     demux_t *    p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    if( p_sys->p_indexer )
+        AVI_IndexStop( p_demux );
+
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         if( p_sys->track[i] )
@@ -339,6 +357,7 @@ static int Open( vlc_object_t * p_this )
     if( unlikely(!p_sys) )
         return VLC_EGENERIC;
     p_sys->b_odml   = false;
+    p_sys->f_index_progress = -1.;
     p_sys->meta     = NULL;
     TAB_INIT(p_sys->i_track, p_sys->track);
     TAB_INIT(p_sys->i_attachment, p_sys->attachment);
@@ -694,7 +713,9 @@ static int Open( vlc_object_t * p_this )
 aviindex:
         if( p_sys->b_fastseekable )
         {
-            AVI_IndexCreate( p_demux );
+            if( !b_index )
+                AVI_IndexLoad( p_demux );
+            AVI_IndexStart( p_demux, p_movi );
         }
         else if( p_sys->b_seekable )
         {
@@ -718,7 +739,7 @@ aviindex:
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
+        if( tk->fmt.i_cat == VIDEO_ES )
             i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
     }
     if( i_idx_totalframes != p_avih->i_totalframes &&
@@ -792,9 +813,7 @@ aviindex:
             p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
             tk->i_rate == p_auds->p_wf->nSamplesPerSec )
         {
-            int64_t i_track_length =
-                tk->idx.p_entry[tk->idx.i_size-1].i_length +
-                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
+            int64_t i_track_length = tk->idx.i_lengthtotal;
             vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
                                                     p_avih->i_microsecperframe );
 
@@ -977,6 +996,7 @@ static int Demux_Seekable( demux_t *p_demux )
     /* cannot be more than 100 stream (dcXX or wbXX) */
     avi_track_toread_t toread[100];
 
+    AVI_IndexAdopt( p_demux );
 
     /* detect new selected/unselected streams */
     for( i_track = 0; i_track < p_sys->i_track; i_track++ )
@@ -1034,7 +1054,7 @@ static int Demux_Seekable( demux_t *p_demux )
         toread[i_track].b_ok = tk->b_activated && !tk->b_eof;
         if( tk->i_idxposc < tk->idx.i_size )
         {
-            toread[i_track].i_posf = tk->idx.p_entry[tk->i_idxposc].i_pos;
+            toread[i_track].i_posf = avi_index_Pos( &tk->idx, tk->i_idxposc );
            if( tk->i_idxposb > 0 )
            {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1122,7 +1142,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
                     return VLC_DEMUXER_EGENERIC;
 
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1137,7 +1157,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1146,7 +1166,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1164,11 +1184,9 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk->fmt.i_codec, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
-                    index.i_lengthtotal = index.i_length;
                     avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
 
                     /* do we will read this data ? */
@@ -1178,7 +1196,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1215,13 +1233,13 @@ static int Demux_Seekable( demux_t *p_demux )
                     i_toread = __MAX( i_toread, 100 );
                 }
             }
-            i_size = __MIN( tk->idx.p_entry[tk->i_idxposc].i_length -
+            i_size = __MIN( avi_index_Length( &tk->idx, tk->i_idxposc ) -
                                 tk->i_idxposb,
                             (size_t) i_toread );
         }
         else
         {
-            i_size = tk->idx.p_entry[tk->i_idxposc].i_length;
+            i_size = avi_index_Length( &tk->idx, tk->i_idxposc );
         }
 
         if( tk->i_idxposb == 0 )
@@ -1239,7 +1257,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
 
         p_frame->i_pts = VLC_TICK_0 + AVI_GetPTS( tk );
-        if( tk->idx.p_entry[tk->i_idxposc].i_flags&AVIIF_KEYFRAME )
+        if( avi_index_IsKeyframe( &tk->idx, tk->i_idxposc ) )
         {
             p_frame->i_flags = BLOCK_FLAG_TYPE_I;
         }
@@ -1258,7 +1276,7 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread -= i_size;
             tk->i_idxposb += i_size;
             if( tk->i_idxposb >=
-                    tk->idx.p_entry[tk->i_idxposc].i_length )
+                    avi_index_Length( &tk->idx, tk->i_idxposc ) )
             {
                 tk->i_idxposb = 0;
                 tk->i_idxposc++;
@@ -1266,7 +1284,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
         else
         {
-            int i_length = tk->idx.p_entry[tk->i_idxposc].i_length;
+            int i_length = avi_index_Length( &tk->idx, tk->i_idxposc );
 
             tk->i_idxposc++;
             if( tk->fmt.i_cat == AUDIO_ES )
@@ -1279,7 +1297,7 @@ static int Demux_Seekable( demux_t *p_demux )
         if( tk->i_idxposc < tk->idx.i_size)
         {
             toread[i_track].i_posf =
-                tk->idx.p_entry[tk->i_idxposc].i_pos;
+                avi_index_Pos( &tk->idx, tk->i_idxposc );
             if( tk->i_idxposb > 0 )
             {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1358,7 +1376,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
     {
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -1375,18 +1393,18 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return VLC_DEMUXER_EOF;
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position @%"PRIu64", resync",
                               vlc_stream_Tell(p_demux->s) );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return VLC_DEMUXER_EGENERIC;
@@ -1413,7 +1431,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return VLC_DEMUXER_EOF;
                 }
@@ -1524,8 +1542,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
                 goto failandresetpos;
             }
 
-            while( i_pos >= p_stream->idx.p_entry[p_stream->i_idxposc].i_pos +
-               p_stream->idx.p_entry[p_stream->i_idxposc].i_length + 8 )
+            while( i_pos >= avi_index_Pos( &p_stream->idx, p_stream->i_idxposc ) +
+               avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) + 8 )
             {
                 /* search after i_idxposc */
                 if( AVI_StreamChunkSet( p_demux,
@@ -1620,6 +1638,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     bool b;
     vlc_meta_t *p_meta;
 
+    AVI_IndexAdopt( p_demux );
+
     switch( i_query )
     {
         case DEMUX_CAN_SEEK:
@@ -1672,6 +1692,17 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             *va_arg( args, vlc_tick_t * ) = p_sys->i_length;
             return VLC_SUCCESS;
 
+        case DEMUX_GET_INDEX_PROGRESS:
+            pf = va_arg( args, double * );
+            if( p_sys->p_indexer != NULL )
+                *pf = atomic_load_explicit( &p_sys->p_indexer->i_progress,
+                                            memory_order_relaxed ) / 1000.;
+            else if( p_sys->f_index_progress >= 0. )
+                *pf = p_sys->f_index_progress;
+            else
+                return VLC_EGENERIC;
+            return VLC_SUCCESS;
+
         case DEMUX_GET_FPS:
             pf = va_arg( args, double * );
             *pf = 0.0;
@@ -1790,13 +1821,11 @@ static vlc_tick_t AVI_GetPTS( avi_track_t *tk )
         if( idx >= tk->idx.i_size )
         {
             /* use the last entry */
-            idx = tk->idx.i_size - 1;
-            i_count = tk->idx.p_entry[idx].i_lengthtotal
-                    + tk->idx.p_entry[idx].i_length;
+            i_count = tk->idx.i_lengthtotal;
         }
         else
         {
-            i_count = tk->idx.p_entry[idx].i_lengthtotal;
+            i_count = avi_index_LengthTotal( &tk->idx, idx );
         }
         return AVI_GetDPTS( tk, i_count + tk->i_idxposb );
     }
@@ -1819,7 +1848,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     {
         if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
             return VLC_EGENERIC;
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1832,7 +1861,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
     for( ;; )
     {
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1840,7 +1869,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1854,11 +1883,9 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk->fmt.i_codec, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
-            index.i_lengthtotal = index.i_length;
             avi_index_Append( &tk_pk->idx, &p_sys->i_movi_lastchunk_pos, &index );
 
             if( avi_pk.i_stream == i_stream  )
@@ -1866,7 +1893,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1910,8 +1937,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
     avi_track_t *p_stream = p_sys->track[i_stream];
 
     if( ( p_stream->idx.i_size > 0 )
-        &&( i_byte < p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
-                p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) )
+        &&( i_byte < p_stream->idx.i_lengthtotal ) )
     {
         /* index is valid to find the ck */
         /* uses dichototmie to be fast enougth */
@@ -1920,15 +1946,15 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
         int i_idxmin  = 0;
         for( ;; )
         {
-            if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal > i_byte )
+            if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) > i_byte )
             {
                 i_idxmax  = i_idxposc ;
                 i_idxposc = ( i_idxmin + i_idxposc ) / 2 ;
             }
             else
             {
-                if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal +
-                        p_stream->idx.p_entry[i_idxposc].i_length <= i_byte)
+                if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) +
+                        avi_index_Length( &p_stream->idx, i_idxposc ) <= i_byte)
                 {
                     i_idxmin  = i_idxposc ;
                     i_idxposc = (i_idxmax + i_idxposc ) / 2 ;
@@ -1937,7 +1963,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 {
                     p_stream->i_idxposc = i_idxposc;
                     p_stream->i_idxposb = i_byte -
-                            p_stream->idx.p_entry[i_idxposc].i_lengthtotal;
+                            avi_index_LengthTotal( &p_stream->idx, i_idxposc );
                     return VLC_SUCCESS;
                 }
             }
@@ -1956,11 +1982,11 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 return VLC_EGENERIC;
             }
 
-        } while( p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal +
-                    p_stream->idx.p_entry[p_stream->i_idxposc].i_length <= i_byte );
+        } while( avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc ) +
+                    avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) <= i_byte );
 
         p_stream->i_idxposb = i_byte -
-                       p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal;
+                       avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc );
         return VLC_SUCCESS;
     }
 }
@@ -1994,7 +2020,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             {
                 if( tk->i_blocksize > 0 )
                 {
-                    tk->i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
+                    tk->i_blockno += ( avi_index_Length( &tk->idx, i ) + tk->i_blocksize - 1 ) / tk->i_blocksize;
                 }
                 else
                 {
@@ -2015,8 +2041,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             //if( i_date < i_oldpts || 1 )
             {
                 while( p_stream->i_idxposc > 0 &&
-                   !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
-                                                                AVIIF_KEYFRAME ) )
+                   !avi_index_IsKeyframe( &p_stream->idx, p_stream->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
                                             i_stream,
@@ -2030,8 +2055,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             else
             {
                 while( p_stream->i_idxposc < p_stream->idx.i_size &&
-                        !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
-                                                                AVIIF_KEYFRAME ) )
+                        !avi_index_IsKeyframe( &p_stream->idx, p_stream->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
                                             i_stream,
@@ -2163,17 +2187,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( vlc_stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = vlc_stream_Tell( p_demux->s );
+    p_pk->i_pos     = vlc_stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2190,12 +2214,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     size_t          i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2220,7 +2244,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     if( i_skip > SSIZE_MAX )
         return VLC_EGENERIC;
 
-    ssize_t i_ret = vlc_stream_Read( p_demux->s, NULL, i_skip );
+    ssize_t i_ret = vlc_stream_Read( s, NULL, i_skip );
     if( i_ret < 0 || (size_t) i_ret != i_skip )
     {
         return VLC_EGENERIC;
@@ -2228,7 +2252,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2236,11 +2260,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( vlc_stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2263,47 +2287,6 @@ static int AVI_PacketSearch( demux_t *p_demux )
 /****************************************************************************
  * Index stuff.
  ****************************************************************************/
-static void avi_index_Init( avi_index_t *p_index )
-{
-    p_index->i_size  = 0;
-    p_index->i_max   = 0;
-    p_index->p_entry = NULL;
-}
-static void avi_index_Clean( avi_index_t *p_index )
-{
-    free( p_index->p_entry );
-}
-static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
-                              avi_entry_t *p_entry )
-{
-    /* Update last chunk position */
-    if( *pi_last_pos < p_entry->i_pos )
-         *pi_last_pos = p_entry->i_pos;
-
-    /* add the entry */
-    if( p_index->i_size >= p_index->i_max )
-    {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
-            return;
-    }
-    /* calculate cumulate length */
-    if( p_index->i_size > 0 )
-    {
-        p_entry->i_lengthtotal =
-            p_index->p_entry[p_index->i_size - 1].i_length +
-                p_index->p_entry[p_index->i_size - 1].i_lengthtotal;
-    }
-    else
-    {
-        p_entry->i_lengthtotal = 0;
-    }
-
-    p_index->p_entry[p_index->i_size++] = *p_entry;
-}
-
 static int AVI_IndexFind_idx1( demux_t *p_demux,
                                avi_chunk_idx1_t **pp_idx1,
                                uint64_t *pi_offset )
@@ -2393,11 +2376,9 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
-            index.i_lengthtotal = index.i_length;
 
             avi_index_Append( &p_index[i_stream], pi_last_offset, &index );
         }
@@ -2412,14 +2393,14 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             if( p_sys->track[i_index]->i_samplesize )
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index],
-                                        p_index[i_index].p_entry[i].i_lengthtotal );
+                                        avi_index_LengthTotal( &p_index[i_index], i ) );
             }
             else
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index], i );
             }
             msg_Dbg( p_demux, "index stream %d @%ld time %ld", i_index,
-                     p_index[i_index].p_entry[i].i_pos, i_length );
+                     avi_index_Pos( &p_index[i_index], i ), i_length );
         }
     }
 #endif
@@ -2439,11 +2420,9 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
             index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
-            index.i_lengthtotal = index.i_length;
 
             avi_index_Append( p_index, pi_max_offset, &index );
         }
@@ -2452,11 +2431,9 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
             index.i_length = p_indx->idx.field[i].i_size;
-            index.i_lengthtotal = index.i_length;
 
             avi_index_Append( p_index, pi_max_offset, &index );
         }
@@ -2552,14 +2529,14 @@ static void AVI_IndexLoad( demux_t *p_demux )
         if( p_idx_indx[i].i_size > p_idx_idx1[i].i_size )
         {
             msg_Dbg( p_demux, "selected ODML index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_indx[i];
             avi_index_Clean( &p_idx_idx1[i] );
         }
         else
         {
             msg_Dbg( p_demux, "selected standard index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_idx1[i];
             avi_index_Clean( &p_idx_indx[i] );
         }
@@ -2573,12 +2550,12 @@ static void AVI_IndexLoad( demux_t *p_demux )
         /* Fix key flag */
         bool b_key = false;
         for( unsigned j = 0; !b_key && j < p_index->i_size; j++ )
-            b_key = p_index->p_entry[j].i_flags & AVIIF_KEYFRAME;
+            b_key = avi_index_IsKeyframe( p_index, j );
         if( !b_key )
         {
             msg_Err( p_demux, "no key frame set for track %u", i );
             for( unsigned j = 0; j < p_index->i_size; j++ )
-                p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+                p_index->p_length[j] |= AVI_INDEX_KEYFRAME;
         }
 
         /* */
@@ -2587,41 +2564,22 @@ static void AVI_IndexLoad( demux_t *p_demux )
     }
 }
 
-static void AVI_IndexCreate( demux_t *p_demux )
+static void AVI_IndexCreate( avi_indexer_t *p_indexer )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-
-    avi_chunk_list_t *p_riff;
-    avi_chunk_list_t *p_movi;
+    demux_t *p_demux = p_indexer->p_demux;
+    stream_t *s = p_indexer->s;
 
-    unsigned int i_stream;
-    uint32_t i_movi_end;
-
-    vlc_tick_t i_dialog_update;
+    vlc_tick_t i_progress_update;
     vlc_dialog_id *p_dialog_id = NULL;
 
-    p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
-    p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
-
-    if( !p_movi )
-    {
-        msg_Err( p_demux, "cannot find p_movi" );
+    if( vlc_stream_Seek( s, p_indexer->i_movi_begin ) )
         return;
-    }
-
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
-
-    i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
-
-    vlc_stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
     msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
 
 
     /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = vlc_tick_now();
-    if( stream_Size( p_demux->s ) > 10000000 )
+    i_progress_update = vlc_tick_now();
+    if( stream_Size( s ) > 10000000 )
     {
         p_dialog_id =
             vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
@@ -2633,54 +2591,57 @@ static void AVI_IndexCreate( demux_t *p_demux )
     {
         avi_packet_t pk;
 
-        /* Don't update/check dialog too often */
-        if( p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
+        if( atomic_load_explicit( &p_indexer->b_abort, memory_order_relaxed ) )
+            goto print_stat;
+
+        /* Don't update/check progress too often */
+        if( vlc_tick_now() - i_progress_update > VLC_TICK_FROM_MS(100) )
         {
-            if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
-                break;
+            if( p_dialog_id != NULL &&
+                vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
+                goto print_stat;
 
-            double f_current = vlc_stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
-            double f_pos     = f_current / f_size;
-            vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
+            /* Also reported to the player, see DEMUX_GET_INDEX_PROGRESS */
+            double f_current = vlc_stream_Tell( s );
+            double f_size    = stream_Size( s );
+            double f_pos     = f_size > 0 ? __MIN( f_current / f_size, 1. ) : 0.;
+            atomic_store_explicit( &p_indexer->i_progress,
+                                   __MIN( f_pos * 1000, 999 ),
+                                   memory_order_relaxed );
+            if( p_dialog_id != NULL )
+                vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
 
-            i_dialog_update = vlc_tick_now();
+            i_progress_update = vlc_tick_now();
         }
 
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
+        if( AVI_PacketGetHeader( s, &pk ) )
             break;
 
-        if( pk.i_stream < p_sys->i_track &&
-            pk.i_cat == p_sys->track[pk.i_stream]->fmt.i_cat )
+        if( pk.i_stream < p_indexer->i_track &&
+            pk.i_cat == p_indexer->track[pk.i_stream].i_cat )
         {
-            avi_track_t *tk = p_sys->track[pk.i_stream];
-
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
-            index.i_flags   = AVI_GetKeyFlag(tk->fmt.i_codec, pk.i_peek);
+            index.i_flags   = AVI_GetKeyFlag(p_indexer->track[pk.i_stream].i_codec,
+                                             pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
-            index.i_lengthtotal = pk.i_size;
-            avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
+            avi_index_Append( &p_indexer->track[pk.i_stream].idx,
+                              &p_indexer->i_last_pos, &index );
         }
         else
         {
             switch( pk.i_fourcc )
             {
             case AVIFOURCC_idx1:
-                if( p_sys->b_odml )
+                if( p_indexer->b_odml )
                 {
-                    avi_chunk_list_t *p_sysx;
-                    p_sysx = AVI_ChunkFind( &p_sys->ck_root,
-                                            AVIFOURCC_RIFF, 1, true );
-
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( !p_sysx || vlc_stream_Seek( p_demux->s,
-                                         p_sysx->i_chunk_pos + 24 ) )
-                        goto print_stat;
+                    if( !p_indexer->i_avix_begin ||
+                        vlc_stream_Seek( s, p_indexer->i_avix_begin ) )
+                        goto done;
                     break;
                 }
-                goto print_stat;
+                goto done;
 
             case AVIFOURCC_RIFF:
                     msg_Dbg( p_demux, "new RIFF chunk found" );
@@ -2692,32 +2653,183 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
-                    goto print_stat;
+                    goto done;
                 }
             }
         }
 
-        if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+        if( ( !p_indexer->b_odml && pk.i_pos + pk.i_size >= p_indexer->i_movi_end ) ||
+            AVI_PacketNext( s ) )
         {
             break;
         }
     }
 
+done:
+    p_indexer->b_complete = true;
+    atomic_store_explicit( &p_indexer->i_progress, 1000, memory_order_relaxed );
+
 print_stat:
     if( p_dialog_id != NULL )
         vlc_dialog_release( p_demux, p_dialog_id );
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    for( unsigned i_stream = 0; i_stream < p_indexer->i_track; i_stream++ )
     {
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
-                i_stream, p_sys->track[i_stream]->idx.i_size );
+                i_stream, p_indexer->track[i_stream].idx.i_size );
     }
 }
 
+static void *AVI_IndexThread( void *data )
+{
+    avi_indexer_t *p_indexer = data;
+
+    AVI_IndexCreate( p_indexer );
+    atomic_store_explicit( &p_indexer->b_done, true, memory_order_release );
+    return NULL;
+}
+
+/* Replaces the indexes of the tracks with the created ones */
+static void AVI_IndexSwap( demux_t *p_demux, avi_indexer_t *p_indexer )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_track_t *tk = p_sys->track[i];
+        avi_index_t *p_idx = &p_indexer->track[i].idx;
+
+        /* Keep the longest index if the creation was cancelled */
+        if( !p_indexer->b_complete && p_idx->i_size <= tk->idx.i_size )
+        {
+            avi_index_Clean( p_idx );
+            continue;
+        }
+
+        /* Go on reading from the same chunk */
+        if( tk->i_idxposc < tk->idx.i_size )
+        {
+            uint64_t i_pos = avi_index_Pos( &tk->idx, tk->i_idxposc );
+            tk->i_idxposc = avi_index_Find( p_idx, i_pos );
+            if( tk->i_idxposc >= p_idx->i_size ||
+                avi_index_Pos( p_idx, tk->i_idxposc ) != i_pos )
+                tk->i_idxposb = 0;
+        }
+        else if( tk->idx.i_size > 0 )
+        {
+            uint64_t i_pos = avi_index_Pos( &tk->idx, tk->idx.i_size - 1 );
+            tk->i_idxposc = avi_index_Find( p_idx, i_pos + 1 );
+            tk->i_idxposb = 0;
+        }
+
+        avi_index_Clean( &tk->idx );
+        tk->idx = *p_idx;
+    }
+
+    p_sys->i_movi_lastchunk_pos = __MAX( p_sys->i_movi_lastchunk_pos,
+                                         p_indexer->i_last_pos );
+    free( p_indexer->track );
+    free( p_indexer );
+}
+
+static void AVI_IndexStart( demux_t *p_demux, avi_chunk_list_t *p_movi )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    avi_indexer_t *p_indexer = malloc( sizeof( *p_indexer ) );
+    if( unlikely(p_indexer == NULL) )
+        return;
+    p_indexer->track = malloc( p_sys->i_track * sizeof( *p_indexer->track ) );
+    if( unlikely(p_indexer->track == NULL) )
+    {
+        free( p_indexer );
+        return;
+    }
+
+    p_indexer->p_demux = p_demux;
+    atomic_init( &p_indexer->b_abort, false );
+    atomic_init( &p_indexer->b_done, false );
+    atomic_init( &p_indexer->i_progress, 0 );
+    p_indexer->b_complete = false;
+
+    avi_chunk_list_t *p_avix = AVI_ChunkFind( &p_sys->ck_root,
+                                              AVIFOURCC_RIFF, 1, true );
+    p_indexer->i_movi_begin = p_movi->i_chunk_pos + 12;
+    p_indexer->i_movi_end = __MIN( p_movi->i_chunk_pos + p_movi->i_chunk_size,
+                                   (uint64_t)stream_Size( p_demux->s ) );
+    p_indexer->i_avix_begin = p_avix ? p_avix->i_chunk_pos + 24 : 0;
+    p_indexer->b_odml = p_sys->b_odml;
+
+    p_indexer->i_track = p_sys->i_track;
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        p_indexer->track[i].i_cat = p_sys->track[i]->fmt.i_cat;
+        p_indexer->track[i].i_codec = p_sys->track[i]->fmt.i_codec;
+        avi_index_Init( &p_indexer->track[i].idx );
+    }
+    p_indexer->i_last_pos = 0;
+
+    /* Play with the current index while creating the new one from another
+     * stream, and switch to it once done */
+    p_indexer->s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( p_indexer->s != NULL )
+    {
+        if( !vlc_clone( &p_indexer->thread, AVI_IndexThread, p_indexer,
+                        VLC_THREAD_PRIORITY_LOW ) )
+        {
+            p_sys->p_indexer = p_indexer;
+            return;
+        }
+        vlc_stream_Delete( p_indexer->s );
+    }
+
+    p_indexer->s = p_demux->s;
+    AVI_IndexCreate( p_indexer );
+    AVI_IndexSwap( p_demux, p_indexer );
+}
+
+/* Switches to the created index once the background creation is done */
+static void AVI_IndexAdopt( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_indexer_t *p_indexer = p_sys->p_indexer;
+
+    if( likely(p_indexer == NULL) ||
+        !atomic_load_explicit( &p_indexer->b_done, memory_order_acquire ) )
+        return;
+
+    vlc_join( p_indexer->thread, NULL );
+    vlc_stream_Delete( p_indexer->s );
+    p_sys->p_indexer = NULL;
+
+    /* Stays below 1 if the creation was cancelled */
+    p_sys->f_index_progress = atomic_load_explicit( &p_indexer->i_progress,
+                                                    memory_order_relaxed ) / 1000.;
+    AVI_IndexSwap( p_demux, p_indexer );
+    p_sys->i_length = AVI_MovieGetLength( p_demux );
+    msg_Dbg( p_demux, "switched to the created index, length %"PRId64"s",
+             SEC_FROM_VLC_TICK(p_sys->i_length) );
+}
+
+static void AVI_IndexStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_indexer_t *p_indexer = p_sys->p_indexer;
+
+    atomic_store_explicit( &p_indexer->b_abort, true, memory_order_relaxed );
+    vlc_join( p_indexer->thread, NULL );
+    vlc_stream_Delete( p_indexer->s );
+    p_sys->p_indexer = NULL;
+
+    for( unsigned i = 0; i < p_indexer->i_track; i++ )
+        avi_index_Clean( &p_indexer->track[i].idx );
+    free( p_indexer->track );
+    free( p_indexer );
+}
+
 /* */
 static void AVI_MetaLoad( demux_t *p_demux,
                           avi_chunk_list_t *p_riff, avi_chunk_avih_t *p_avih )
@@ -3006,16 +3118,14 @@ static vlc_tick_t  AVI_MovieGetLength( demux_t *p_demux )
         vlc_tick_t i_length;
 
         /* fix length for each stream */
-        if( tk->idx.i_size < 1 || !tk->idx.p_entry )
+        if( tk->idx.i_size < 1 )
         {
             continue;
         }
 
         if( tk->i_samplesize )
         {
-            i_length = AVI_GetDPTS( tk,
-                                    tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal +
-                                        tk->idx.p_entry[tk->idx.i_size-1].i_length );
+            i_length = AVI_GetDPTS( tk, tk->idx.i_lengthtotal );
         }
         else
         {
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * index.c: AVI demuxer chunk index
+ *****************************************************************************
+ * Copyright (C) 2001-2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_codecs.h>
+
+#include "libavi.h"
+#include "index.h"
+
+void avi_index_Init( avi_index_t *p_index )
+{
+    p_index->i_size  = 0;
+    p_index->i_max   = 0;
+    p_index->p_offset = NULL;
+    p_index->p_length = NULL;
+    p_index->p_block = NULL;
+    p_index->i_lengthtotal = 0;
+    p_index->i_far   = 0;
+    p_index->p_far   = NULL;
+}
+void avi_index_Clean( avi_index_t *p_index )
+{
+    free( p_index->p_offset );
+    free( p_index->p_length );
+    free( p_index->p_block );
+    free( p_index->p_far );
+}
+void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
+                       avi_entry_t *p_entry )
+{
+    /* Update last chunk position */
+    if( *pi_last_pos < p_entry->i_pos )
+         *pi_last_pos = p_entry->i_pos;
+
+    if( p_entry->i_length & AVI_INDEX_KEYFRAME )
+        return;
+
+    /* add the entry */
+    if( p_index->i_size >= p_index->i_max )
+    {
+        uint32_t i_max = p_index->i_max + 16384;
+        uint32_t *p_offset = realloc( p_index->p_offset,
+                                      i_max * sizeof( *p_offset ) );
+        if( p_offset )
+            p_index->p_offset = p_offset;
+        uint32_t *p_length = realloc( p_index->p_length,
+                                      i_max * sizeof( *p_length ) );
+        if( p_length )
+            p_index->p_length = p_length;
+        avi_index_block_t *p_block = realloc( p_index->p_block,
+                                              i_max / AVI_INDEX_BLOCK * sizeof( *p_block ) );
+        if( p_block )
+            p_index->p_block = p_block;
+        if( !p_offset || !p_length || !p_block )
+            return;
+        p_index->i_max = i_max;
+    }
+
+    const uint32_t i = p_index->i_size;
+    avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+    if( i % AVI_INDEX_BLOCK == 0 )
+    {
+        p_block->i_pos = p_entry->i_pos;
+        p_block->i_lengthtotal = p_index->i_lengthtotal;
+    }
+
+    if( p_entry->i_pos >= p_block->i_pos &&
+        p_entry->i_pos - p_block->i_pos < AVI_INDEX_FAR )
+    {
+        p_index->p_offset[i] = p_entry->i_pos - p_block->i_pos;
+    }
+    else
+    {
+        avi_index_far_t *p_far = realloc( p_index->p_far,
+                                          (p_index->i_far + 1) * sizeof( *p_far ) );
+        if( !p_far )
+            return;
+        p_far[p_index->i_far].i_entry = i;
+        p_far[p_index->i_far].i_pos = p_entry->i_pos;
+        p_index->p_far = p_far;
+        p_index->i_far++;
+        p_index->p_offset[i] = AVI_INDEX_FAR;
+    }
+
+    p_index->p_length[i] = p_entry->i_length;
+    if( p_entry->i_flags & AVIIF_KEYFRAME )
+        p_index->p_length[i] |= AVI_INDEX_KEYFRAME;
+    p_index->i_lengthtotal += p_entry->i_length;
+    p_index->i_size++;
+}
+uint64_t avi_index_Pos( const avi_index_t *p_index, uint32_t i )
+{
+    if( likely(p_index->p_offset[i] != AVI_INDEX_FAR) )
+        return p_index->p_block[i / AVI_INDEX_BLOCK].i_pos + p_index->p_offset[i];
+
+    uint32_t i_min = 0, i_max = p_index->i_far;
+    while( i_min < i_max )
+    {
+        uint32_t i_mid = (i_min + i_max) / 2;
+        if( p_index->p_far[i_mid].i_entry < i )
+            i_min = i_mid + 1;
+        else
+            i_max = i_mid;
+    }
+    assert( i_min < p_index->i_far && p_index->p_far[i_min].i_entry == i );
+    return p_index->p_far[i_min].i_pos;
+}
+uint64_t avi_index_LengthTotal( const avi_index_t *p_index, uint32_t i )
+{
+    uint64_t i_lengthtotal = p_index->p_block[i / AVI_INDEX_BLOCK].i_lengthtotal;
+    for( uint32_t j = i - i % AVI_INDEX_BLOCK; j < i; j++ )
+        i_lengthtotal += avi_index_Length( p_index, j );
+    return i_lengthtotal;
+}
+uint32_t avi_index_Find( const avi_index_t *p_index, uint64_t i_pos )
+{
+    uint32_t i_min = 0, i_max = p_index->i_size;
+    while( i_min < i_max )
+    {
+        uint32_t i_mid = (i_min + i_max) / 2;
+        if( avi_index_Pos( p_index, i_mid ) < i_pos )
+            i_min = i_mid + 1;
+        else
+            i_max = i_mid;
+    }
+    return i_min;
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * index.h: AVI demuxer chunk index
+ *****************************************************************************
+ * Copyright (C) 2001-2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_AVI_INDEX_H
+#define VLC_AVI_INDEX_H
+
+typedef struct
+{
+    uint32_t     i_flags;
+    uint64_t     i_pos;
+    uint32_t     i_length;
+
+} avi_entry_t;
+
+/* The index takes 8 bytes per chunk: its offset from the first chunk of its
+ * block of AVI_INDEX_BLOCK entries, and its size with the keyframe flag. */
+#define AVI_INDEX_BLOCK     64
+#define AVI_INDEX_KEYFRAME  0x80000000
+#define AVI_INDEX_FAR       UINT32_MAX /* offset stored in p_far */
+
+typedef struct
+{
+    uint64_t        i_pos;         /* of the first chunk */
+    uint64_t        i_lengthtotal; /* of the chunks before it */
+
+} avi_index_block_t;
+
+typedef struct
+{
+    uint32_t        i_entry;
+    uint64_t        i_pos;
+
+} avi_index_far_t;
+
+typedef struct
+{
+    uint32_t        i_size;
+    uint32_t        i_max;
+    uint32_t        *p_offset;
+    uint32_t        *p_length;
+    avi_index_block_t *p_block;
+    uint64_t        i_lengthtotal;
+
+    /* chunks too far from their block, as in sparse tracks */
+    uint32_t        i_far;
+    avi_index_far_t *p_far;
+
+} avi_index_t;
+
+void avi_index_Init( avi_index_t * );
+void avi_index_Clean( avi_index_t * );
+/* Appends an entry, and updates *pi_last_pos to the last chunk position */
+void avi_index_Append( avi_index_t *, uint64_t *pi_last_pos, avi_entry_t * );
+uint64_t avi_index_Pos( const avi_index_t *, uint32_t );
+/* Returns the total size of the chunks before the entry */
+uint64_t avi_index_LengthTotal( const avi_index_t *, uint32_t );
+/* Returns the first entry at or after the given position */
+uint32_t avi_index_Find( const avi_index_t *, uint64_t );
+
+static inline uint32_t avi_index_Length( const avi_index_t *p_index, uint32_t i )
+{
+    return p_index->p_length[i] & ~AVI_INDEX_KEYFRAME;
+}
+
+static inline bool avi_index_IsKeyframe( const avi_index_t *p_index, uint32_t i )
+{
+    return p_index->p_length[i] & AVI_INDEX_KEYFRAME;
+}
+
+#endif
@@ -52,6 +52,7 @@ set_description( N_( "CAF demuxer" ))
 set_capability( "demux", 140 )
 set_callbacks( Open, Close )
 add_shortcut( "caf" )
+add_signature(0, "caff")
 vlc_module_end ()
 
 /*****************************************************************************
@@ -54,6 +54,7 @@ vlc_module_begin ()
     set_callbacks( Open, Close )
     add_shortcut( "flac" )
     add_file_extension("flac")
+    add_signature(0, "fLaC")
 vlc_module_end ()
 
 /*****************************************************************************
@@ -33,6 +33,8 @@
 #include "../../adaptive/playlist/SegmentList.h"
 
 #include <ctime>
+#include <locale>
+#include <sstream>
 #include <limits>
 #include <cassert>
 
@@ -47,6 +49,10 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     b_failed = false;
     lastUpdateTime = 0;
     targetDuration = 0;
+    partTargetDuration = 0;
+    b_canBlockReload = false;
+    nextMediaSequence = 0;
+    nextPartNumber = 0;
     streamFormat = StreamFormat::Type::Unknown;
 }
 
@@ -89,6 +95,23 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getPlaylistRequestUrl() const
+{
+    std::string url = getPlaylistUrl().toString();
+    if(!b_loaded || !isLive() || !b_canBlockReload)
+        return url;
+
+    /* Blocking reload: the server answers once the next segment, or part,
+     * is available, instead of being polled */
+    std::ostringstream ss;
+    ss.imbue(std::locale("C"));
+    ss << url << (url.find('?') == std::string::npos ? '?' : '&')
+       << "_HLS_msn=" << nextMediaSequence;
+    if(partTargetDuration)
+        ss << "&_HLS_part=" << nextPartNumber;
+    return ss.str();
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -138,7 +161,17 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
         const vlc_tick_t duration = targetDuration
                                   ? vlc_tick_from_sec(targetDuration)
                                   : VLC_TICK_FROM_SEC(2);
-        if(elapsed < duration)
+        if(b_canBlockReload)
+        {
+            /* The server holds the request until the next part or segment
+             * exists, so only ask once everything listed is downloaded */
+            if(elapsed < (partTargetDuration ? partTargetDuration : duration) / 2 ||
+               number == std::numeric_limits<uint64_t>::max())
+                return false;
+            return getMinAheadTime(number) == 0;
+        }
+        /* Low latency playlists are refreshed on each new part */
+        if(elapsed < (partTargetDuration ? partTargetDuration : duration))
             return false;
 
         if(number != std::numeric_limits<uint64_t>::max())
@@ -45,6 +45,7 @@ namespace hls
 
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
+                std::string getPlaylistRequestUrl() const;
                 bool isLive() const;
                 bool initialized() const;
                 virtual void scheduleNextUpdate(uint64_t, bool) override;
@@ -61,6 +62,10 @@ namespace hls
                 bool b_failed;
                 vlc_tick_t lastUpdateTime;
                 time_t targetDuration;
+                vlc_tick_t partTargetDuration;
+                bool b_canBlockReload;
+                uint64_t nextMediaSequence; /* first not listed yet */
+                uint64_t nextPartNumber;
                 Url playlistUrl;
         };
     }
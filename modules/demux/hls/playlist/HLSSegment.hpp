@@ -41,8 +41,14 @@ namespace hls
                 vlc_tick_t getUTCTime() const;
                 virtual int compare(ISegment *) const override;
 
+                /* Low latency playlists number segments and parts in a single
+                 * sequence: part p of media segment n is n * PART_STRIDE + p,
+                 * and a whole segment is n * PART_STRIDE */
+                static const uint64_t PART_STRIDE = 1000;
+
             protected:
                 vlc_tick_t utcTime;
+                uint64_t mediaSequence; /* EXT-X-MEDIA-SEQUENCE based */
                 virtual bool prepareChunk(SharedResources *, SegmentChunk *,
                                           BaseRepresentation *) override;
         };
@@ -162,7 +162,7 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistRequestUrl());
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -233,10 +233,31 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    vlc_tick_t partHoldBack = 0;
 
     std::list<HLSSegment *> segmentstoappend;
 
+    /* Parts of the media segment being read, which replace it once listed */
+    std::list<HLSSegment *> partstoappend;
+    uint64_t partNumber = 0;
+    vlc_tick_t nzPartStartTime = 0;
+    std::size_t prevpartbyterangeoffset = 0;
+    rep->nextPartNumber = std::numeric_limits<uint64_t>::max();
+
     std::list<Tag *>::const_iterator it;
+    for(it = tagslist.begin(); it != tagslist.end(); ++it)
+    {
+        if((*it)->getType() == AttributesTag::EXTXPARTINF)
+        {
+            const Attribute *partAttr = static_cast<const AttributesTag *>(*it)->
+                                        getAttributeByName("PART-TARGET");
+            if(partAttr)
+                rep->partTargetDuration = vlc_tick_from_sec(partAttr->floatingPoint());
+        }
+    }
+    /* The part numbering must not depend on the tags order */
+    const uint64_t stride = rep->partTargetDuration ? HLSSegment::PART_STRIDE : 1;
+
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
     {
         const Tag *tag = *it;
@@ -265,12 +286,6 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
-
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
                 if(ctx_extinf)
@@ -280,6 +295,34 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                         nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
                     ctx_extinf = nullptr;
                 }
+
+                /* Recent segments are fetched by parts, as listed before them */
+                if(!partstoappend.empty())
+                {
+                    if(discontinuity)
+                    {
+                        partstoappend.front()->discontinuity = true;
+                        discontinuity = false;
+                    }
+                    segmentstoappend.splice(segmentstoappend.end(), partstoappend);
+                    partNumber = 0;
+                    sequenceNumber++;
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    if(absReferenceTime != VLC_TICK_INVALID)
+                        absReferenceTime += nzDuration;
+                    ctx_byterange = nullptr;
+                    break;
+                }
+
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber * stride);
+                if(!segment)
+                    break;
+                segment->mediaSequence = sequenceNumber++;
+                partNumber = 0;
+
+                segment->setSourceUrl(uritag->getValue().value);
+
                 segment->duration.Set(timescale.ToScaled(nzDuration));
                 segment->startTime.Set(timescale.ToScaled(nzStartTime));
                 nzStartTime += nzDuration;
@@ -373,6 +416,90 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             }
             break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *controltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *holdAttr = controltag->getAttributeByName("PART-HOLD-BACK");
+                if(holdAttr)
+                    partHoldBack = vlc_tick_from_sec(holdAttr->floatingPoint());
+                const Attribute *blockAttr = controltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->b_canBlockReload = blockAttr && blockAttr->value == "YES";
+            }
+            break;
+
+            case AttributesTag::EXTXPART:
+            case AttributesTag::EXTXPRELOADHINT:
+            {
+                if(stride == 1)
+                    break;
+
+                const AttributesTag *parttag = static_cast<const AttributesTag *>(tag);
+                const bool b_hint = tag->getType() == AttributesTag::EXTXPRELOADHINT;
+                const Attribute *uriAttr = parttag->getAttributeByName("URI");
+                const Attribute *attr;
+                if(b_hint)
+                {
+                    /* Only the next part can be requested ahead */
+                    attr = parttag->getAttributeByName("TYPE");
+                    if(!attr || attr->value != "PART")
+                        break;
+                    rep->nextPartNumber = partNumber;
+                }
+
+                const uint64_t number = sequenceNumber * stride + partNumber++;
+                vlc_tick_t nzDuration = rep->partTargetDuration;
+                if(!b_hint && (attr = parttag->getAttributeByName("DURATION")))
+                    nzDuration = vlc_tick_from_sec(attr->floatingPoint());
+                if(partstoappend.empty())
+                    nzPartStartTime = nzStartTime;
+
+                if(!uriAttr || number % stride >= stride - 1 ||
+                   ((attr = parttag->getAttributeByName("GAP")) && attr->value == "YES"))
+                {
+                    nzPartStartTime += nzDuration;
+                    break;
+                }
+
+                HLSSegment *part = new (std::nothrow) HLSSegment(rep, number);
+                if(!part)
+                    break;
+                part->mediaSequence = sequenceNumber;
+                part->setSourceUrl(uriAttr->quotedString());
+                part->duration.Set(timescale.ToScaled(nzDuration));
+                part->startTime.Set(timescale.ToScaled(nzPartStartTime));
+                if(absReferenceTime != VLC_TICK_INVALID)
+                    part->setDisplayTime(absReferenceTime + nzPartStartTime - nzStartTime);
+                nzPartStartTime += nzDuration;
+
+                if(!b_hint && (attr = parttag->getAttributeByName("BYTERANGE")))
+                {
+                    std::pair<std::size_t,std::size_t> range = attr->unescapeQuotes().getByteRange();
+                    if(range.first == 0) /* first = offset, second = size */
+                        range.first = prevpartbyterangeoffset;
+                    prevpartbyterangeoffset = range.first + range.second;
+                    part->setByteRange(range.first, prevpartbyterangeoffset - 1);
+                }
+                else if(b_hint && (attr = parttag->getAttributeByName("BYTERANGE-START")))
+                {
+                    const std::size_t start = attr->decimal();
+                    attr = parttag->getAttributeByName("BYTERANGE-LENGTH");
+                    /* An open ended range is completed as the part is produced */
+                    part->setByteRange(start, attr ? start + attr->decimal() - 1 : 0);
+                }
+
+                if(discontinuity && partstoappend.empty())
+                {
+                    part->discontinuity = true;
+                    discontinuity = false;
+                }
+
+                if(encryption.method != CommonEncryption::Method::None)
+                    part->setEncryption(encryption);
+
+                partstoappend.push_back(part);
+            }
+            break;
+
             case Tag::EXTXDISCONTINUITY:
                 discontinuity  = true;
                 break;
@@ -383,6 +510,14 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         }
     }
 
+    /* Blocking reloads wait for the part following the listed ones */
+    rep->nextMediaSequence = sequenceNumber;
+    if(rep->nextPartNumber == std::numeric_limits<uint64_t>::max())
+        rep->nextPartNumber = partNumber;
+
+    /* Parts of the segment still being produced */
+    segmentstoappend.splice(segmentstoappend.end(), partstoappend);
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
@@ -390,6 +525,16 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
+        /* Low latency HLS: segments are also advertised as parts,
+         * which allows staying closer to the live edge */
+        if(rep->partTargetDuration)
+        {
+            M3U8 *m3u8 = static_cast<M3U8 *>(rep->getPlaylist());
+            m3u8->setLowLatency(true);
+            if(partHoldBack == 0) /* 3 parts, as recommended */
+                partHoldBack = rep->partTargetDuration * 3;
+            m3u8->suggestedPresentationDelay.Set(partHoldBack);
+        }
     }
     else if(totalduration > rep->getPlaylist()->duration.Get())
     {
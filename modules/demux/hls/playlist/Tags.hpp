@@ -99,6 +99,10 @@ namespace hls
                     EXTXSTART,
                     EXTXSTREAMINF,
                     EXTXSESSIONKEY,
+                    EXTXPARTINF,
+                    EXTXSERVERCONTROL,
+                    EXTXPART,
+                    EXTXPRELOADHINT,
                 };
                 AttributesTag(int, const std::string &);
                 virtual ~AttributesTag();
@@ -31,6 +31,7 @@
 #include <vlc_picture.h>
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_interrupt.h>
 #include <vlc_vector.h>
 
 static ssize_t
@@ -161,6 +162,7 @@ var_Read_float(const char *psz)
     X(can_control_pace, bool, add_bool, Bool, true) \
     X(can_control_rate, bool, add_bool, Bool, true) \
     X(can_record, bool, add_bool, Bool, true) \
+    X(realtime, bool, add_bool, Bool, false) \
     X(error, bool, add_bool, Bool, false) \
     X(pts_delay, unsigned, add_integer, Unsigned, MS_FROM_VLC_TICK(DEFAULT_PTS_DELAY)) \
     X(config, char *, add_string, String, NULL )
@@ -231,6 +233,8 @@ struct demux_sys
     vlc_tick_t audio_pts;
     vlc_tick_t video_pts;
 
+    vlc_tick_t start_date;
+
     int current_title;
     vlc_tick_t chapter_gap;
 
@@ -321,6 +325,7 @@ Control(demux_t *demux, int query, va_list args)
                     return VLC_EGENERIC;
                 sys->current_title = new_title;
                 sys->pts = sys->audio_pts = sys->video_pts = VLC_TICK_0;
+                sys->start_date = VLC_TICK_INVALID;
                 sys->updates |= INPUT_UPDATE_TITLE;
                 return VLC_SUCCESS;
             }
@@ -333,6 +338,7 @@ Control(demux_t *demux, int query, va_list args)
                 {
                     sys->pts = sys->audio_pts = sys->video_pts =
                         (seekpoint_idx * sys->chapter_gap) + VLC_TICK_0;
+                    sys->start_date = VLC_TICK_INVALID;
                     return VLC_SUCCESS;
                 }
             }
@@ -365,6 +371,7 @@ Control(demux_t *demux, int query, va_list args)
             if (!sys->can_seek)
                 return VLC_EGENERIC;
             sys->pts = sys->video_pts = sys->audio_pts = va_arg(args, double) * sys->length;
+            sys->start_date = VLC_TICK_INVALID;
             return VLC_SUCCESS;
         case DEMUX_GET_LENGTH:
             *va_arg(args, vlc_tick_t *) = sys->length;
@@ -376,6 +383,7 @@ Control(demux_t *demux, int query, va_list args)
             if (!sys->can_seek)
                 return VLC_EGENERIC;
             sys->pts = sys->video_pts = sys->audio_pts = va_arg(args, vlc_tick_t);
+            sys->start_date = VLC_TICK_INVALID;
             return VLC_SUCCESS;
         case DEMUX_GET_TITLE_INFO:
             if (sys->title_count > 0)
@@ -530,7 +538,10 @@ CreateVideoBlock(demux_t *demux, struct mock_track *track)
         block_len += pic->p[i].i_lines * pic->p[i].i_pitch;
     memset(pic->p[0].p_pixels, (sys->video_pts / VLC_TICK_FROM_MS(10)) % 255,
            block_len);
-    return block_Init(&video->b, &cbs, pic->p[0].p_pixels, block_len);
+    block_t *b = block_Init(&video->b, &cbs, pic->p[0].p_pixels, block_len);
+    /* Raw pictures are all keyframes */
+    b->i_flags |= BLOCK_FLAG_TYPE_I;
+    return b;
     (void) demux;
 }
 
@@ -915,6 +926,15 @@ Demux(demux_t *demux)
 
     if (sys->pts > sys->length)
         sys->pts = sys->length;
+
+    if (sys->realtime)
+    {
+        /* Deliver the samples when they are due, like a live source */
+        if (sys->start_date == VLC_TICK_INVALID)
+            sys->start_date = vlc_tick_now() - sys->pts;
+        if (vlc_mwait_i11e(sys->start_date + sys->pts))
+            return VLC_DEMUXER_SUCCESS;
+    }
     es_out_SetPCR(demux->out, sys->pts);
 
     const vlc_tick_t video_step_length =
@@ -1119,6 +1139,7 @@ Open(vlc_object_t *obj)
         goto error;
 
     sys->pts = sys->audio_pts = sys->video_pts = VLC_TICK_0;
+    sys->start_date = VLC_TICK_INVALID;
     sys->current_title = 0;
     sys->chapter_gap = sys->chapter_count > 0 ?
                        (sys->length / sys->chapter_count) : VLC_TICK_INVALID;
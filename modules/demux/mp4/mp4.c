@@ -71,6 +71,9 @@ vlc_module_begin ()
     add_file_extension("moov")
     add_file_extension("mov")
     add_file_extension("mp4")
+    add_signature(4, "ftyp")
+    add_signature(4, "moov")
+    add_signature(4, "mdat")
 
     set_section("Hacks", NULL)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT )
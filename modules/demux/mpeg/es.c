@@ -38,6 +38,7 @@
 
 #include "../../packetizer/a52.h"
 #include "../../packetizer/dts_header.h"
+#include "../../packetizer/mpegaudio.h"
 #include "../../meta_engine/ID3Tag.h"
 #include "../../meta_engine/ID3Text.h"
 #include "../../meta_engine/ID3Meta.h"
@@ -100,6 +101,8 @@ typedef struct
 {
     char  psz_version[10];
     int   i_lowpass;
+    unsigned i_encoder_delay;
+    unsigned i_encoder_padding;
 } lame_extra_t;
 
 typedef struct
@@ -265,6 +268,21 @@ static int OpenCommon( demux_t *p_demux,
     }
 
     es_format_t *p_fmt = &p_sys->p_packetizer->fmt_out;
+    if( p_sys->xing.b_lame &&
+        ( p_sys->xing.lame.i_encoder_delay || p_sys->xing.lame.i_encoder_padding ) )
+    {
+        /* LAME counts the encoder delay, decoders add 529 samples of their
+         * own, which are also part of the padding */
+        const unsigned i_decoder_delay = 529;
+        const lame_extra_t *p_lame = &p_sys->xing.lame;
+
+        p_fmt->audio_gapless.i_delay = p_lame->i_encoder_delay + i_decoder_delay;
+        p_fmt->audio_gapless.i_padding =
+            p_lame->i_encoder_padding > i_decoder_delay ?
+            p_lame->i_encoder_padding - i_decoder_delay : 0;
+        p_fmt->audio_gapless.i_samples =
+            (uint64_t) p_sys->xing.i_frames * p_sys->xing.i_frame_samples;
+    }
     for( int i = 0; i < AUDIO_REPLAY_GAIN_MAX; i++ )
     {
         if ( p_sys->rgf_replay_gain[i] != 0.0 )
@@ -1185,7 +1203,8 @@ static int MpgaInit( demux_t *p_demux )
     else
         i_skip = MPGA_MODE( header ) != 3 ? 21 : 13;
 
-    if( i_skip + 8 >= i_xing || memcmp( &p_xing[i_skip], "Xing", 4 ) )
+    if( i_skip + 8 >= i_xing || ( memcmp( &p_xing[i_skip], "Xing", 4 ) &&
+                                  memcmp( &p_xing[i_skip], "Info", 4 ) ) )
         return VLC_SUCCESS;
 
     const uint32_t i_flags = GetDWBE( &p_xing[i_skip+4] );
@@ -1239,8 +1258,32 @@ static int MpgaInit( demux_t *p_demux )
         p_sys->rgf_replay_gain[AUDIO_REPLAY_GAIN_ALBUM] = (float) MpgaXingLameConvertGain( album );
 
         MpgaXingSkip( &p_xing, &i_xing, 1 ); /* flags */
+        MpgaXingSkip( &p_xing, &i_xing, 1 ); /* abr bitrate */
+
+        if( i_xing >= 3 )
+        {
+            p_lame->i_encoder_delay = (p_xing[0] << 4) | (p_xing[1] >> 4);
+            p_lame->i_encoder_padding = ((p_xing[1] & 0x0f) << 8) | p_xing[2];
+            msg_Dbg( p_demux, "lame encoder delay %u, padding %u",
+                     p_lame->i_encoder_delay, p_lame->i_encoder_padding );
+        }
     }
 
+    /* The LAME encoder delay counts from the frame after the Xing/Info
+     * one: only skip that frame, which decodes to silence, when the delay
+     * and padding are trimmed. Other files keep their timestamps. */
+    const lame_extra_t *p_lame = &p_sys->xing.lame;
+    if( !p_sys->xing.b_lame ||
+        ( p_lame->i_encoder_delay == 0 && p_lame->i_encoder_padding == 0 ) )
+        return VLC_SUCCESS;
+
+    unsigned i_chans, i_conf, i_mode, i_srate, i_brate, i_samples, i_max, i_layer;
+    int i_frame_size = SyncInfo( header, &i_chans, &i_conf, &i_mode, &i_srate,
+                                 &i_brate, &i_samples, &i_max, &i_layer );
+    if( i_frame_size > 0 && i_frame_size <= i_peek &&
+        vlc_stream_Read( p_demux->s, NULL, i_frame_size ) == i_frame_size )
+        p_sys->i_stream_offset += i_frame_size;
+
     return VLC_SUCCESS;
 }
 
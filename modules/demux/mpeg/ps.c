@@ -28,15 +28,21 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_demux.h>
+#include <vlc_fs.h>
+#include <vlc_vector.h>
 
 #include "pes.h"
 #include "ps.h"
 
 /* TODO:
- *  - re-add pre-scanning.
+ *  - re-add pre-scanning of ES.
  *  - ...
  */
 
@@ -45,11 +51,22 @@
     "to calculate position and duration. However sometimes this might not " \
     "be usable. Disable this option to calculate from the bitrate instead." )
 
+#define INDEX_TEXT N_("Index the timestamps")
+#define INDEX_LONGTEXT N_("Scan local files in the background to map " \
+    "their timestamps to byte offsets, for precise seeking and duration. " \
+    "The index is saved next to the file and reused the next time." )
+
 #define PS_PACKET_PROBE 3
 #define CDXA_HEADER_SIZE 44
 #define CDXA_SECTOR_SIZE 2352
 #define CDXA_SECTOR_HEADER_SIZE 24
 
+#define PS_INDEX_INTERVAL VLC_TICK_FROM_MS(500)
+#define PS_INDEX_SUFFIX ".psidx"
+#define PS_INDEX_MAGIC "VLCPSIX1"
+#define PS_INDEX_HEADER_SIZE 28
+#define PS_INDEX_ENTRY_SIZE 24
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -68,18 +85,46 @@ vlc_module_begin ()
     add_bool( "ps-trust-timestamps", true, TIME_TEXT,
                  TIME_LONGTEXT )
         change_safe ()
+    add_bool( "ps-index", false, INDEX_TEXT, INDEX_LONGTEXT )
 
     add_submodule ()
     set_description( N_("MPEG-PS demuxer") )
     set_capability( "demux", 8 )
     set_callbacks( Open, Close )
     add_shortcut( "ps" )
+    add_signature(0, "\x00\x00\x01\xBA")
 vlc_module_end ()
 
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
 
+typedef struct
+{
+    vlc_tick_t  i_time; /* since the first SCR, without discontinuities */
+    vlc_tick_t  i_scr;
+    uint64_t    i_offset; /* of the pack header */
+} ps_index_entry_t;
+
+typedef struct
+{
+    vlc_object_t *p_obj;
+    char        *psz_url;
+    char        *psz_path; /* saved index */
+    uint64_t    i_size;
+    time_t      i_mtime;
+    uint64_t    i_start_byte;
+    int         format;
+
+    vlc_thread_t thread;
+    atomic_bool b_abort;
+
+    vlc_mutex_t lock;
+    struct VLC_VECTOR(ps_index_entry_t) entries;
+    vlc_tick_t  i_length;
+    bool        b_complete;
+} ps_index_t;
+
 typedef struct
 {
     ps_psm_t    psm;
@@ -112,6 +157,10 @@ typedef struct
     int         current_title;
     int         current_seekpoint;
     unsigned    updates;
+
+    ps_index_t  *p_index;
+    vlc_tick_t  i_index_time; /* of the current pack, on the index timeline */
+    vlc_tick_t  i_index_delta; /* from the SCR to the index timeline */
 } demux_sys_t;
 
 static int Demux  ( demux_t *p_demux );
@@ -120,6 +169,14 @@ static int Control( demux_t *p_demux, int i_query, va_list args );
 static int      ps_pkt_resynch( stream_t *, int, bool );
 static block_t *ps_pkt_read   ( stream_t * );
 
+static ps_index_t *IndexNew      ( demux_t * );
+static void        IndexDelete   ( ps_index_t * );
+static bool        IndexGetTime  ( ps_index_t *, uint64_t, vlc_tick_t,
+                                   vlc_tick_t * );
+static bool        IndexGetOffset( ps_index_t *, vlc_tick_t, uint64_t *,
+                                   vlc_tick_t * );
+static bool        IndexGetLength( ps_index_t *, vlc_tick_t * );
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -225,12 +282,21 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->current_title = 0;
     p_sys->current_seekpoint = 0;
     p_sys->updates = 0;
+    p_sys->p_index = NULL;
+    p_sys->i_index_time = VLC_TICK_INVALID;
+    p_sys->i_index_delta = VLC_TICK_INVALID;
 
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
 
+    if( p_sys->b_seekable && !p_demux->b_preparsing &&
+        p_demux->psz_filepath != NULL &&
+        var_InheritBool( p_demux, "ps-index" ) &&
+        var_InheritBool( p_demux, "ps-trust-timestamps" ) )
+        p_sys->p_index = IndexNew( p_demux );
+
     /* TODO prescanning of ES */
 
     return VLC_SUCCESS;
@@ -267,6 +333,9 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    if( p_sys->p_index )
+        IndexDelete( p_sys->p_index );
+
     free( p_sys );
 }
 
@@ -402,6 +471,35 @@ static void CheckPCR( demux_sys_t *p_sys, es_out_t *out, vlc_tick_t i_scr )
         NotifyDiscontinuity( p_sys->tk, out );
 }
 
+/* Places the pack just read on the index timeline. Where the index does not
+ * cover it yet, the SCR is folded the same way as by the scan, so that the
+ * time does not jump once the index catches up. Must be called before the
+ * new SCR is committed. */
+static void IndexUpdateTime( demux_sys_t *p_sys, vlc_tick_t i_scr, bool b_first )
+{
+    vlc_tick_t i_time = VLC_TICK_INVALID;
+
+    if( !IndexGetTime( p_sys->p_index, p_sys->i_lastpack_byte, i_scr, &i_time ) )
+    {
+        if( p_sys->i_scr != VLC_TICK_INVALID &&
+            p_sys->i_index_time != VLC_TICK_INVALID )
+        {
+            vlc_tick_t i_delta = i_scr - p_sys->i_scr;
+            i_time = p_sys->i_index_time;
+            if( i_delta >= 0 && i_delta <= VLC_TICK_FROM_SEC(1) )
+                i_time += i_delta;
+        }
+        else if( p_sys->i_index_delta != VLC_TICK_INVALID ) /* after a seek */
+            i_time = __MAX( i_scr + p_sys->i_index_delta, 0 );
+        else if( b_first )
+            i_time = 0;
+    }
+
+    p_sys->i_index_time = i_time;
+    if( i_time != VLC_TICK_INVALID )
+        p_sys->i_index_delta = i_time - i_scr;
+}
+
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
@@ -461,11 +559,14 @@ static int Demux( demux_t *p_demux )
         if( !ps_pkt_parse_pack( p_pkt->p_buffer, p_pkt->i_buffer,
                                 &p_sys->i_pack_scr, &i_mux_rate ) )
         {
-            if( p_sys->i_first_scr == VLC_TICK_INVALID )
+            bool b_first = p_sys->i_first_scr == VLC_TICK_INVALID;
+            if( b_first )
                 p_sys->i_first_scr = p_sys->i_pack_scr;
             CheckPCR( p_sys, p_demux->out, p_sys->i_pack_scr );
-            p_sys->i_scr = p_sys->i_pack_scr;
             p_sys->i_lastpack_byte = vlc_stream_Tell( p_demux->s );
+            if( p_sys->p_index )
+                IndexUpdateTime( p_sys, p_sys->i_pack_scr, b_first );
+            p_sys->i_scr = p_sys->i_pack_scr;
             if( !p_sys->b_have_pack ) p_sys->b_have_pack = true;
             /* done later on to work around bad vcd/svcd streams */
             /* es_out_SetPCR( p_demux->out, p_sys->i_scr ); */
@@ -731,9 +832,26 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             break;
 
         case DEMUX_GET_TIME:
+        {
+            vlc_tick_t *pi_time = va_arg( args, vlc_tick_t * );
+
+            /* Stay on the index timeline, even where it is not built yet */
+            if( p_sys->p_index && p_sys->b_have_pack && !p_sys->b_bad_scr &&
+                p_sys->i_scr != VLC_TICK_INVALID &&
+                p_sys->i_index_time != VLC_TICK_INVALID )
+            {
+                vlc_tick_t i_time = p_sys->i_index_time;
+                if( p_sys->i_mux_rate > 0 )
+                {
+                    uint64_t i_offset = vlc_stream_Tell( p_demux->s ) - p_sys->i_lastpack_byte;
+                    i_time += vlc_tick_from_samples(i_offset, p_sys->i_mux_rate * 50);
+                }
+                *pi_time = i_time;
+                return VLC_SUCCESS;
+            }
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID )
             {
-                *va_arg( args, vlc_tick_t * ) = p_sys->i_current_pts - p_sys->tk[p_sys->i_time_track_index].i_first_pts;
+                *pi_time = p_sys->i_current_pts - p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return VLC_SUCCESS;
             }
             if( p_sys->i_first_scr != VLC_TICK_INVALID && p_sys->i_scr != VLC_TICK_INVALID )
@@ -745,33 +863,66 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                     uint64_t i_offset = vlc_stream_Tell( p_demux->s ) - p_sys->i_lastpack_byte;
                     i_time += vlc_tick_from_samples(i_offset, p_sys->i_mux_rate * 50);
                 }
-                *va_arg( args, vlc_tick_t * ) = i_time;
+                *pi_time = i_time;
                 return VLC_SUCCESS;
             }
-            *va_arg( args, vlc_tick_t * ) = 0;
+            *pi_time = 0;
             break;
+        }
 
         case DEMUX_GET_LENGTH:
+        {
+            vlc_tick_t *pi_time = va_arg( args, vlc_tick_t * );
+
+            if( p_sys->p_index && !p_sys->b_bad_scr &&
+                IndexGetLength( p_sys->p_index, pi_time ) )
+                return VLC_SUCCESS;
             if( p_sys->i_length > VLC_TICK_0 )
             {
-                *va_arg( args, vlc_tick_t * ) = p_sys->i_length;
+                *pi_time = p_sys->i_length;
                 return VLC_SUCCESS;
             }
             else if( p_sys->i_mux_rate > 0 )
             {
-                *va_arg( args, vlc_tick_t * ) = vlc_tick_from_samples( stream_Size( p_demux->s ) - p_sys->i_start_byte / 50,
+                *pi_time = vlc_tick_from_samples( stream_Size( p_demux->s ) - p_sys->i_start_byte / 50,
                     p_sys->i_mux_rate );
                 return VLC_SUCCESS;
             }
-            *va_arg( args, vlc_tick_t * ) = 0;
+            *pi_time = 0;
             break;
+        }
 
         case DEMUX_SET_TIME:
         {
+            vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+            vlc_tick_t i_entry_time;
+            uint64_t i_offset;
+
+            if( p_sys->p_index && !p_sys->b_bad_scr &&
+                IndexGetOffset( p_sys->p_index, i_time, &i_offset, &i_entry_time ) )
+            {
+                /* Past the indexed part, go on from its end at the mux rate */
+                if( i_time - i_entry_time > PS_INDEX_INTERVAL && p_sys->i_mux_rate > 0 )
+                {
+                    i64 = stream_Size( p_demux->s ) - p_sys->i_start_byte;
+                    if( i64 <= 0 )
+                        break;
+                    i_offset += samples_from_vlc_tick( i_time - i_entry_time,
+                                                       p_sys->i_mux_rate * 50 );
+                    f = (double)(i_offset - p_sys->i_start_byte) / i64;
+                    return demux_Control( p_demux, DEMUX_SET_POSITION,
+                                          __MIN( f, 1.0 ) );
+                }
+                p_sys->i_current_pts = VLC_TICK_INVALID;
+                p_sys->i_scr = VLC_TICK_INVALID;
+                if( vlc_stream_Seek( p_demux->s, i_offset ) != VLC_SUCCESS )
+                    break;
+                NotifyDiscontinuity( p_sys->tk, p_demux->out );
+                return VLC_SUCCESS;
+            }
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID &&
                 p_sys->i_length > VLC_TICK_0)
             {
-                vlc_tick_t i_time = va_arg( args, vlc_tick_t );
                 i_time -= p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return demux_Control( p_demux, DEMUX_SET_POSITION, (double) i_time / p_sys->i_length );
             }
@@ -926,3 +1077,371 @@ static block_t *ps_pkt_read( stream_t *s )
 
     return NULL;
 }
+
+/*****************************************************************************
+ * Index:
+ *****************************************************************************/
+
+/* The index maps the SCR of the pack headers, every PS_INDEX_INTERVAL, to
+ * their offset. It is built by a background thread reading its own stream,
+ * and saved next to the file once complete:
+ *   magic[8], file size (64), length (64), entries count (32),
+ *   then for each entry: time (64), scr (64), offset (64), all big endian.
+ * Both the times and the offsets of the entries are increasing.
+ */
+static int IndexLoad( ps_index_t *p_index )
+{
+    struct stat index;
+    uint8_t p_buf[PS_INDEX_HEADER_SIZE];
+
+    /* Stale if the file was modified afterwards */
+    if( vlc_stat( p_index->psz_path, &index ) ||
+        index.st_mtime < p_index->i_mtime )
+        return VLC_EGENERIC;
+
+    FILE *p_file = vlc_fopen( p_index->psz_path, "rb" );
+    if( p_file == NULL )
+        return VLC_EGENERIC;
+
+    if( fread( p_buf, 1, PS_INDEX_HEADER_SIZE, p_file ) != PS_INDEX_HEADER_SIZE ||
+        memcmp( p_buf, PS_INDEX_MAGIC, 8 ) ||
+        GetQWBE( &p_buf[8] ) != p_index->i_size ||
+        (uint64_t)index.st_size != PS_INDEX_HEADER_SIZE +
+                                   (uint64_t)GetDWBE( &p_buf[24] ) * PS_INDEX_ENTRY_SIZE )
+        goto error;
+
+    vlc_tick_t i_length = GetQWBE( &p_buf[16] );
+    uint32_t i_count = GetDWBE( &p_buf[24] );
+
+    vlc_mutex_lock( &p_index->lock );
+    if( !vlc_vector_reserve( &p_index->entries, i_count ) )
+    {
+        vlc_mutex_unlock( &p_index->lock );
+        goto error;
+    }
+    vlc_mutex_unlock( &p_index->lock );
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        ps_index_entry_t entry;
+
+        if( fread( p_buf, 1, PS_INDEX_ENTRY_SIZE, p_file ) != PS_INDEX_ENTRY_SIZE )
+            goto error;
+        entry.i_time = GetQWBE( &p_buf[0] );
+        entry.i_scr = GetQWBE( &p_buf[8] );
+        entry.i_offset = GetQWBE( &p_buf[16] );
+        if( entry.i_offset >= p_index->i_size || entry.i_time < 0 ||
+            entry.i_time > i_length )
+            goto error;
+
+        /* The lookups are binary searches on both */
+        if( i > 0 )
+        {
+            const ps_index_entry_t *p_prev =
+                &p_index->entries.data[p_index->entries.size - 1];
+            if( entry.i_time <= p_prev->i_time ||
+                entry.i_offset <= p_prev->i_offset )
+                goto error;
+        }
+
+        vlc_mutex_lock( &p_index->lock );
+        vlc_vector_push( &p_index->entries, entry ); /* reserved */
+        vlc_mutex_unlock( &p_index->lock );
+    }
+    fclose( p_file );
+
+    vlc_mutex_lock( &p_index->lock );
+    p_index->i_length = i_length;
+    p_index->b_complete = true;
+    vlc_mutex_unlock( &p_index->lock );
+    return VLC_SUCCESS;
+
+error:
+    fclose( p_file );
+    vlc_mutex_lock( &p_index->lock );
+    vlc_vector_clear( &p_index->entries );
+    vlc_mutex_unlock( &p_index->lock );
+    return VLC_EGENERIC;
+}
+
+static void IndexSave( ps_index_t *p_index )
+{
+    uint8_t p_buf[PS_INDEX_HEADER_SIZE];
+    char *psz_temp;
+
+    /* Write a temporary file and rename it, so that a concurrent reader
+     * or an interruption never leaves a partial index behind */
+    if( asprintf( &psz_temp, "%s.XXXXXX", p_index->psz_path ) == -1 )
+        return;
+
+    int fd = vlc_mkstemp( psz_temp );
+    FILE *p_file = fd != -1 ? fdopen( fd, "wb" ) : NULL;
+    if( p_file == NULL )
+    {
+        msg_Dbg( p_index->p_obj, "cannot save the index to %s: %s",
+                 p_index->psz_path, vlc_strerror_c( errno ) );
+        if( fd != -1 )
+        {
+            vlc_close( fd );
+            vlc_unlink( psz_temp );
+        }
+        free( psz_temp );
+        return;
+    }
+
+    /* The index is complete, hence no longer modified */
+    memcpy( p_buf, PS_INDEX_MAGIC, 8 );
+    SetQWBE( &p_buf[8], p_index->i_size );
+    SetQWBE( &p_buf[16], p_index->i_length );
+    SetDWBE( &p_buf[24], p_index->entries.size );
+    bool b_error = fwrite( p_buf, 1, PS_INDEX_HEADER_SIZE, p_file ) != PS_INDEX_HEADER_SIZE;
+
+    for( size_t i = 0; i < p_index->entries.size && !b_error; i++ )
+    {
+        const ps_index_entry_t *p_entry = &p_index->entries.data[i];
+
+        SetQWBE( &p_buf[0], p_entry->i_time );
+        SetQWBE( &p_buf[8], p_entry->i_scr );
+        SetQWBE( &p_buf[16], p_entry->i_offset );
+        b_error = fwrite( p_buf, 1, PS_INDEX_ENTRY_SIZE, p_file ) != PS_INDEX_ENTRY_SIZE;
+    }
+
+    if( fclose( p_file ) || b_error ||
+        vlc_rename( psz_temp, p_index->psz_path ) )
+    {
+        msg_Warn( p_index->p_obj, "cannot save the index to %s",
+                  p_index->psz_path );
+        vlc_unlink( psz_temp );
+    }
+    free( psz_temp );
+}
+
+static int IndexScan( ps_index_t *p_index, stream_t *s )
+{
+    vlc_tick_t i_time = 0;
+    vlc_tick_t i_next = 0;
+    vlc_tick_t i_last_scr = VLC_TICK_INVALID;
+
+    if( vlc_stream_Seek( s, p_index->i_start_byte ) )
+        return VLC_EGENERIC;
+
+    while( !atomic_load_explicit( &p_index->b_abort, memory_order_relaxed ) )
+    {
+        const uint8_t *p_peek;
+
+        int i_ret = ps_pkt_resynch( s, p_index->format, true );
+        if( i_ret < 0 )
+            break;
+        if( i_ret == 0 )
+            continue;
+
+        uint64_t i_pos = vlc_stream_Tell( s );
+        int i_peek = vlc_stream_Peek( s, &p_peek, 14 );
+        if( i_peek < 4 )
+            break;
+
+        vlc_tick_t i_scr; int i_mux_rate;
+        if( p_peek[3] == PS_STREAM_ID_PACK_HEADER &&
+            !ps_pkt_parse_pack( p_peek, i_peek, &i_scr, &i_mux_rate ) )
+        {
+            if( i_last_scr != VLC_TICK_INVALID )
+            {
+                vlc_tick_t i_delta = i_scr - i_last_scr;
+                if( i_delta >= 0 && i_delta <= VLC_TICK_FROM_SEC(1) )
+                    i_time += i_delta;
+                else /* discontinuity, the timeline goes on */
+                    i_next = i_time;
+            }
+            i_last_scr = i_scr;
+
+            if( i_time >= i_next )
+            {
+                ps_index_entry_t entry = {
+                    .i_time = i_time, .i_scr = i_scr, .i_offset = i_pos,
+                };
+                bool b_ok = true;
+                vlc_mutex_lock( &p_index->lock );
+                size_t i_count = p_index->entries.size;
+                /* A discontinuity right after an entry replaces it: the
+                 * entry times stay increasing */
+                if( i_count > 0 &&
+                    p_index->entries.data[i_count - 1].i_time == i_time )
+                    p_index->entries.data[i_count - 1] = entry;
+                else
+                    b_ok = vlc_vector_push( &p_index->entries, entry );
+                vlc_mutex_unlock( &p_index->lock );
+                if( !b_ok )
+                    return VLC_ENOMEM;
+                i_next = i_time + PS_INDEX_INTERVAL;
+            }
+        }
+
+        /* Skip the packet, or only its start code if its size is unknown */
+        int i_size = ps_pkt_size( p_peek, i_peek );
+        if( i_size <= 6 )
+            i_size = 4;
+        if( vlc_stream_Read( s, NULL, i_size ) != i_size )
+            break;
+    }
+
+    if( atomic_load_explicit( &p_index->b_abort, memory_order_relaxed ) ||
+        i_last_scr == VLC_TICK_INVALID )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_index->lock );
+    p_index->i_length = i_time;
+    p_index->b_complete = true;
+    vlc_mutex_unlock( &p_index->lock );
+
+    msg_Dbg( p_index->p_obj, "indexed %zu entries, length %"PRId64"s",
+             p_index->entries.size, SEC_FROM_VLC_TICK(i_time) );
+    return VLC_SUCCESS;
+}
+
+static void *IndexThread( void *data )
+{
+    ps_index_t *p_index = data;
+
+    if( IndexLoad( p_index ) == VLC_SUCCESS )
+    {
+        msg_Dbg( p_index->p_obj, "loaded the index from %s",
+                 p_index->psz_path );
+        return NULL;
+    }
+
+    stream_t *s = vlc_stream_NewURL( p_index->p_obj, p_index->psz_url );
+    if( s == NULL )
+        return NULL;
+
+    if( IndexScan( p_index, s ) == VLC_SUCCESS )
+        IndexSave( p_index );
+    vlc_stream_Delete( s );
+    return NULL;
+}
+
+static ps_index_t *IndexNew( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    struct stat media;
+
+    if( vlc_stat( p_demux->psz_filepath, &media ) )
+        return NULL;
+
+    ps_index_t *p_index = malloc( sizeof( *p_index ) );
+    if( p_index == NULL )
+        return NULL;
+
+    p_index->p_obj = VLC_OBJECT(p_demux);
+    p_index->psz_url = strdup( p_demux->psz_url );
+    if( asprintf( &p_index->psz_path, "%s"PS_INDEX_SUFFIX,
+                  p_demux->psz_filepath ) == -1 )
+        p_index->psz_path = NULL;
+    p_index->i_size = stream_Size( p_demux->s );
+    p_index->i_mtime = media.st_mtime;
+    p_index->i_start_byte = p_sys->i_start_byte;
+    p_index->format = p_sys->format;
+    atomic_init( &p_index->b_abort, false );
+    vlc_mutex_init( &p_index->lock );
+    vlc_vector_init( &p_index->entries );
+    p_index->i_length = VLC_TICK_INVALID;
+    p_index->b_complete = false;
+
+    if( p_index->psz_url == NULL || p_index->psz_path == NULL ||
+        vlc_clone( &p_index->thread, IndexThread, p_index,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        free( p_index->psz_path );
+        free( p_index->psz_url );
+        free( p_index );
+        return NULL;
+    }
+    return p_index;
+}
+
+static void IndexDelete( ps_index_t *p_index )
+{
+    atomic_store_explicit( &p_index->b_abort, true, memory_order_relaxed );
+    vlc_join( p_index->thread, NULL );
+
+    vlc_vector_destroy( &p_index->entries );
+    free( p_index->psz_path );
+    free( p_index->psz_url );
+    free( p_index );
+}
+
+/* Maps the pack read before the given offset to a time */
+static bool IndexGetTime( ps_index_t *p_index, uint64_t i_offset,
+                          vlc_tick_t i_scr, vlc_tick_t *pi_time )
+{
+    bool b_found = false;
+
+    vlc_mutex_lock( &p_index->lock );
+    size_t i_count = p_index->entries.size;
+    if( i_count > 0 && ( p_index->b_complete ||
+                         i_offset < p_index->entries.data[i_count - 1].i_offset ) )
+    {
+        /* Find the first entry at or after the offset */
+        size_t i_low = 0, i_high = i_count;
+        while( i_low < i_high )
+        {
+            size_t i_mid = (i_low + i_high) / 2;
+            if( p_index->entries.data[i_mid].i_offset < i_offset )
+                i_low = i_mid + 1;
+            else
+                i_high = i_mid;
+        }
+
+        if( i_low > 0 )
+        {
+            const ps_index_entry_t *p_entry = &p_index->entries.data[i_low - 1];
+            vlc_tick_t i_delta = i_scr - p_entry->i_scr;
+            /* There is an entry at every discontinuity */
+            if( i_delta < 0 || i_delta > PS_INDEX_INTERVAL + VLC_TICK_FROM_SEC(1) )
+                i_delta = 0;
+            *pi_time = p_entry->i_time + i_delta;
+            b_found = true;
+        }
+    }
+    vlc_mutex_unlock( &p_index->lock );
+    return b_found;
+}
+
+/* Finds the offset of the last indexed pack at or before the given time,
+ * which is the last one indexed so far if the time is past it */
+static bool IndexGetOffset( ps_index_t *p_index, vlc_tick_t i_time,
+                            uint64_t *pi_offset, vlc_tick_t *pi_entry_time )
+{
+    bool b_found = false;
+
+    vlc_mutex_lock( &p_index->lock );
+    size_t i_count = p_index->entries.size;
+    if( i_count > 0 )
+    {
+        size_t i_low = 0, i_high = i_count;
+        while( i_low < i_high )
+        {
+            size_t i_mid = (i_low + i_high) / 2;
+            if( p_index->entries.data[i_mid].i_time <= i_time )
+                i_low = i_mid + 1;
+            else
+                i_high = i_mid;
+        }
+
+        const ps_index_entry_t *p_entry = &p_index->entries.data[i_low > 0 ? i_low - 1 : 0];
+        *pi_offset = p_entry->i_offset;
+        *pi_entry_time = p_entry->i_time;
+        b_found = true;
+    }
+    vlc_mutex_unlock( &p_index->lock );
+    return b_found;
+}
+
+static bool IndexGetLength( ps_index_t *p_index, vlc_tick_t *pi_length )
+{
+    vlc_mutex_lock( &p_index->lock );
+    bool b_complete = p_index->b_complete;
+    if( b_complete )
+        *pi_length = p_index->i_length;
+    vlc_mutex_unlock( &p_index->lock );
+    return b_complete;
+}
@@ -167,6 +167,10 @@ vlc_module_begin ()
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
     add_shortcut( "ts" )
+    /* Sync bytes of 4 packets, as checked by DetectPacketSize() */
+    add_signature_repeat(0, "\x47", 188, 4)
+    add_signature_repeat(4, "\x47", 192, 4)
+    add_signature_repeat(0, "\x47", 204, 4)
 vlc_module_end ()
 
 /*****************************************************************************
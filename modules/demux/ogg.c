@@ -68,6 +68,7 @@ vlc_module_begin ()
     add_file_extension("ogm")
     add_file_extension("ogv")
     add_file_extension("ogx")
+    add_signature(0, "OggS")
     add_file_extension("opus")
     add_file_extension("spx")
 vlc_module_end ()
@@ -45,6 +45,7 @@ vlc_module_begin ()
     set_capability( "demux", 10 )
     set_callback( Open )
     add_file_extension("voc")
+    add_signature(0, "Creative Voice File\x1A")
 vlc_module_end ()
 
 /*****************************************************************************
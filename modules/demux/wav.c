@@ -721,4 +721,5 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
     set_callbacks( Open, Close )
+    add_signature(8, "WAVE")
 vlc_module_end ()
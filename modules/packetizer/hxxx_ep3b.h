@@ -20,10 +20,33 @@
  *****************************************************************************/
 #include <vlc_bits.h>
 
+/* Minimum count of bytes to forward for looking up the next 0x03 byte */
+#define HXXX_EP3B_SKIP_MIN 16
+
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
+    size_t i_next_skip = 0;
+
     for( size_t i=0; i<i_count; i++ )
     {
+        /* No escape can happen before the next 0x03 byte: forward up to it
+         * at once, using the vectorized lookup of the C library */
+        if( i >= i_next_skip && i_count - i >= HXXX_EP3B_SKIP_MIN && end - p > 1 )
+        {
+            size_t i_max = __MIN( i_count - i, (size_t)(end - p - 1) );
+            const uint8_t *p_ep3b = memchr( p + 1, 0x03, i_max );
+            size_t i_skip = p_ep3b ? (size_t)(p_ep3b - p) - 1 : i_max;
+            if( i_skip >= 2 )
+            {
+                p += i_skip;
+                i += i_skip - 1;
+                *pi_prev = (!p[-1] << 1) | !p[0];
+                continue;
+            }
+            /* Dense 0x03 bytes, go byte per byte for a while */
+            i_next_skip = i + HXXX_EP3B_SKIP_MIN;
+        }
+
         if( ++p >= end )
             return p;
 
@@ -73,7 +96,7 @@ struct hxxx_bsfw_ep3b_ctx_s
     size_t i_bytepos;
 };
 
-static void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
+static inline void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
 {
     ctx->i_prev = 0;
     ctx->i_bytepos = 0;
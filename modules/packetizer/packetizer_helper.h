@@ -180,19 +180,44 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
-            p_pic->i_pts = p_block_bytestream->i_pts;
-            p_pic->i_dts = p_block_bytestream->i_dts;
-
             /* Do not wait for next sync code if notified block ends AU */
-            if( (p_block_bytestream->i_flags & BLOCK_FLAG_AU_END) &&
-                 p_block_bytestream->i_buffer == p_pack->i_offset )
+            const bool b_au_end =
+                (p_block_bytestream->i_flags & BLOCK_FLAG_AU_END) &&
+                 p_block_bytestream->i_buffer == p_pack->i_offset;
+
+            /* When the fragment ends its block, up to the next startcode
+             * leading bytes, which is the case if the source splits its
+             * blocks on startcodes, use the block itself instead of copying
+             * the fragment. The bytes already read leave room for the AU
+             * prepend. */
+            p_pic = NULL;
+            if( (size_t)(p_block_bytestream->p_buffer - p_block_bytestream->p_start) +
+                p_pack->bytestream.i_block_offset >= (size_t)p_pack->i_au_prepend )
+                p_pic = block_BytestreamTake( &p_pack->bytestream, p_pack->i_offset );
+
+            if( p_pic )
             {
-                p_pic->i_flags |= BLOCK_FLAG_AU_END;
+                p_pic->p_buffer -= p_pack->i_au_prepend;
+                p_pic->i_buffer += p_pack->i_au_prepend;
+                p_pic->i_flags = 0;
+                p_pic->i_nb_samples = 0;
+                p_pic->i_length = 0;
+                /* The timestamps of the block can no longer be reused */
+                p_block_bytestream = NULL;
             }
+            else
+            {
+                p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+                p_pic->i_pts = p_block_bytestream->i_pts;
+                p_pic->i_dts = p_block_bytestream->i_dts;
+
+                block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
+                                p_pic->i_buffer - p_pack->i_au_prepend );
+            }
+
+            if( b_au_end )
+                p_pic->i_flags |= BLOCK_FLAG_AU_END;
 
-            block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
-                            p_pic->i_buffer - p_pack->i_au_prepend );
             if( p_pack->i_au_prepend > 0 )
                 memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
 
@@ -207,7 +232,7 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             else
             {
                 p_pic = p_pack->pf_parse( p_pack->p_private, &b_used_ts, p_pic );
-                if( b_used_ts )
+                if( b_used_ts && p_block_bytestream )
                 {
                     p_block_bytestream->i_dts = VLC_TICK_INVALID;
                     p_block_bytestream->i_pts = VLC_TICK_INVALID;
@@ -255,6 +280,70 @@ static block_t *packetizer_Packetize( packetizer_t *p_pack, block_t **pp_block )
     return p_out;
 }
 
+/**
+ * Gathers a chain of fragments into a single block, like block_ChainGather().
+ *
+ * If the largest fragment, such as a slice taken from its source block, is
+ * writable and its spare room can hold the other fragments, they are copied
+ * there instead of copying the whole chain into a new block.
+ */
+static inline block_t *packetizer_ChainGather( block_t *p_chain )
+{
+    if( p_chain->p_next == NULL )
+        return p_chain;
+
+    block_t *p_largest = p_chain;
+    size_t i_before = 0, i_total = 0;
+    vlc_tick_t i_length = 0;
+    for( block_t *p = p_chain; p != NULL; p = p->p_next )
+    {
+        if( p->i_buffer > p_largest->i_buffer )
+        {
+            p_largest = p;
+            i_before = i_total;
+        }
+        i_total += p->i_buffer;
+        i_length += p->i_length;
+    }
+
+    const size_t i_after = i_total - i_before - p_largest->i_buffer;
+    if( !block_IsWritable( p_largest ) ||
+        (size_t)(p_largest->p_buffer - p_largest->p_start) < i_before ||
+        (size_t)(p_largest->p_start + p_largest->i_size - p_largest->p_buffer)
+            < p_largest->i_buffer + i_after )
+        return block_ChainGather( p_chain );
+
+    uint8_t *p_dst = p_largest->p_buffer - i_before;
+    for( block_t *p = p_chain; p != NULL; )
+    {
+        block_t *p_next = p->p_next;
+        if( p != p_largest )
+        {
+            memcpy( p_dst, p->p_buffer, p->i_buffer );
+            p_dst += p->i_buffer;
+            if( p != p_chain )
+                block_Release( p );
+        }
+        else
+            p_dst += p->i_buffer;
+        p = p_next;
+    }
+
+    p_largest->p_next = NULL;
+    p_largest->p_buffer -= i_before;
+    p_largest->i_buffer = i_total;
+    p_largest->i_length = i_length;
+    if( p_largest != p_chain )
+    {
+        p_largest->i_flags = p_chain->i_flags;
+        p_largest->i_pts = p_chain->i_pts;
+        p_largest->i_dts = p_chain->i_dts;
+        block_Release( p_chain );
+    }
+
+    return p_largest;
+}
+
 static inline void packetizer_Header( packetizer_t *p_pack,
                                       const uint8_t *p_header, int i_header )
 {
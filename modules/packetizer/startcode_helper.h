@@ -119,6 +119,78 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+#if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+#  include <immintrin.h>
+
+/* Matches the whole startcode at 32 positions at once, using unaligned
+ * loads shifted by one and two bytes. */
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    /* Look up the first positions one by one, for densely packed
+     * startcodes not to pay for the vector loads */
+    for( const uint8_t *head = p + 8; p < head && end - p >= 3; p++ ) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8( 1 );
+
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        __m256i v0 = _mm256_loadu_si256( (const __m256i *) &p[0] );
+        __m256i v1 = _mm256_loadu_si256( (const __m256i *) &p[1] );
+        __m256i v2 = _mm256_loadu_si256( (const __m256i *) &p[2] );
+        __m256i m = _mm256_and_si256( _mm256_cmpeq_epi8( v0, zeros ),
+                                      _mm256_cmpeq_epi8( v1, zeros ) );
+        m = _mm256_and_si256( m, _mm256_cmpeq_epi8( v2, ones ) );
+
+        uint32_t match = _mm256_movemask_epi8( m );
+        if( match )
+            return p + ctz( match );
+    }
+
+    for( end -= 3; p <= end; p++ ) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+
+/* Same as the AVX2 version, at 16 positions at once. The comparison mask
+ * is narrowed to one nibble per position to be tested as a scalar. */
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    const uint8x16_t ones = vdupq_n_u8( 1 );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t m = vandq_u8( vceqq_u8( vld1q_u8( &p[0] ), zeros ),
+                                 vceqq_u8( vld1q_u8( &p[1] ), zeros ) );
+        m = vandq_u8( m, vceqq_u8( vld1q_u8( &p[2] ), ones ) );
+
+        uint64_t match = vget_lane_u64( vreinterpret_u64_u8(
+                            vshrn_n_u16( vreinterpretq_u16_u8( m ), 4 ) ), 0 );
+        if( match )
+            return p + ctz( match ) / 4;
+    }
+
+    for( end -= 3; p <= end; p++ ) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -150,9 +222,15 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #define startcode_FindAnnexB startcode_FindAnnexB_NEON
+#elif defined(CAN_COMPILE_SSE2)
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#  if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#  endif
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
     else
@@ -75,6 +75,14 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define RENDITIONS_TEXT N_("Video renditions")
+#define RENDITIONS_LONGTEXT N_( \
+    "Comma-separated list of additional video renditions to encode from the " \
+    "same decoded pictures, as WIDTHxHEIGHT@BITRATE with the bitrate in " \
+    "kb/s (eg: 1280x720@3000,640x360@800). Each rendition is output as its " \
+    "own elementary stream. Renditions are only scaled from the decoded " \
+    "pictures: deinterlacing, video filters and subpicture overlays are " \
+    "applied to the main output only." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -172,6 +180,8 @@ vlc_module_begin ()
                  MAXWIDTH_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "maxheight", 0, MAXHEIGHT_TEXT,
                  MAXHEIGHT_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "renditions", NULL, RENDITIONS_TEXT,
+                RENDITIONS_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
 
@@ -219,7 +229,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "renditions", NULL
 };
 
 /*****************************************************************************
@@ -329,6 +339,56 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoRenditionsConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys,
+                                      char *psz_renditions )
+{
+    const transcode_encoder_config_t *p_main = &p_sys->venc_cfg;
+    char *psz_save;
+
+    for( char *psz = strtok_r( psz_renditions, ",", &psz_save ); psz;
+         psz = strtok_r( NULL, ",", &psz_save ) )
+    {
+        unsigned i_width = 0, i_height = 0, i_bitrate = 0;
+        if( sscanf( psz, "%ux%u@%u", &i_width, &i_height, &i_bitrate ) < 2 ||
+            ( !i_width && !i_height ) )
+        {
+            msg_Warn( p_stream, "ignoring invalid rendition `%s'", psz );
+            continue;
+        }
+
+        transcode_encoder_config_t *p_cfgs =
+            realloc( p_sys->p_renditions_cfg,
+                     (p_sys->i_renditions + 1) * sizeof(*p_cfgs) );
+        if( unlikely(!p_cfgs) )
+            break;
+        p_sys->p_renditions_cfg = p_cfgs;
+
+        transcode_encoder_config_t *p_cfg = &p_cfgs[p_sys->i_renditions++];
+        transcode_encoder_config_init( p_cfg );
+        p_cfg->i_codec = p_main->i_codec;
+        if( p_main->psz_name )
+            p_cfg->psz_name = strdup( p_main->psz_name );
+        if( p_main->psz_lang )
+            p_cfg->psz_lang = strdup( p_main->psz_lang );
+        p_cfg->p_config_chain = config_ChainDuplicate( p_main->p_config_chain );
+
+        /* Encode every rendition on its own thread so that they run in
+         * parallel, whatever the threading of the main encoder */
+        p_cfg->video = p_main->video;
+        if( p_cfg->video.threads.i_count == 0 )
+            p_cfg->video.threads.i_count = 1;
+        p_cfg->video.f_scale = 0;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        if( i_bitrate )
+            p_cfg->video.i_bitrate = i_bitrate * 1000;
+
+        msg_Dbg( p_stream, "rendition %zu: %ux%u %ukb/s", p_sys->i_renditions,
+                 i_width, i_height, p_cfg->video.i_bitrate / 1000 );
+    }
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -418,6 +478,11 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
     }
 
+    psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "renditions" );
+    if( psz_string && *psz_string && p_sys->venc_cfg.i_codec )
+        SetVideoRenditionsConfig( p_stream, p_sys, psz_string );
+    free( psz_string );
+
     /* Video Filter Parameters */
     sout_filters_config_init( &p_sys->vfilters_cfg );
 
@@ -476,6 +541,9 @@ static void Close( vlc_object_t * p_this )
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
+    for( size_t i = 0; i < p_sys->i_renditions; i++ )
+        transcode_encoder_config_clean( &p_sys->p_renditions_cfg[i] );
+    free( p_sys->p_renditions_cfg );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
     sout_filters_config_clean( &p_sys->afilters_cfg );
@@ -687,7 +755,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
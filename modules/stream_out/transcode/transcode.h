@@ -41,6 +41,18 @@ void sout_filters_config_clean( sout_filters_config_t *p_cfg )
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
 
+/* Offset added to the source ES id for each additional video rendition */
+#define TRANSCODE_RENDITION_ID_STEP 1000
+
+typedef struct
+{
+    const transcode_encoder_config_t *p_enccfg;
+    transcode_encoder_t *encoder;
+    filter_chain_t      *p_conv; /**< scaler from the decoded pictures */
+    void                *downstream_id;
+    bool                 b_error;
+} transcode_rendition_t;
+
 typedef struct
 {
     bool                  b_soverlay;
@@ -52,6 +64,9 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    /* Additional renditions scaled from the same decoded pictures */
+    transcode_encoder_config_t *p_renditions_cfg;
+    size_t          i_renditions;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -125,6 +140,8 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             transcode_rendition_t *p_renditions;
+             size_t          i_renditions;
          };
          struct
          {
@@ -201,7 +218,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
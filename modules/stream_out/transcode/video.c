@@ -168,6 +168,239 @@ static vlc_picture_chain_t transcode_dequeue_all_pics( sout_stream_id_sys_t *id
     return p_pics;
 }
 
+static void tag_last_block_with_flag( block_t **out, int i_flag )
+{
+    block_t *p_last = *out;
+    if( p_last )
+    {
+        while( p_last->p_next )
+            p_last = p_last->p_next;
+        p_last->i_flags |= i_flag;
+    }
+}
+
+static void transcode_video_renditions_clean( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        if( r->encoder )
+        {
+            transcode_encoder_close( r->encoder );
+            transcode_encoder_delete( r->encoder );
+        }
+        transcode_remove_filters( &r->p_conv );
+        if( r->downstream_id )
+            sout_StreamIdDel( p_stream->p_next, r->downstream_id );
+    }
+    free( id->p_renditions );
+    id->p_renditions = NULL;
+    id->i_renditions = 0;
+}
+
+static int transcode_video_renditions_init( sout_stream_t *p_stream,
+                                            sout_stream_id_sys_t *id,
+                                            const es_format_t *p_enc_fmt_in )
+{
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( p_sys->i_renditions == 0 )
+        return VLC_SUCCESS;
+
+    id->p_renditions = calloc( p_sys->i_renditions, sizeof(*id->p_renditions) );
+    if( unlikely(!id->p_renditions) )
+        return VLC_ENOMEM;
+
+    /* Only count the renditions actually created, so that the cleanup on
+     * error releases exactly those */
+    for( size_t i = 0; i < p_sys->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        r->p_enccfg = &p_sys->p_renditions_cfg[i];
+
+        struct encoder_owner *p_enc_owner =
+            (struct encoder_owner *)sout_EncoderCreate( p_stream, sizeof(*p_enc_owner) );
+        if( unlikely(p_enc_owner == NULL) )
+            goto error;
+
+        /* transcode_encoder_new() releases the encoder object on failure */
+        r->encoder = transcode_encoder_new( &p_enc_owner->enc, p_enc_fmt_in );
+        if( !r->encoder )
+            goto error;
+        id->i_renditions++;
+
+        p_enc_owner->id = id;
+        p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+    }
+    return VLC_SUCCESS;
+
+error:
+    transcode_video_renditions_clean( p_stream, id );
+    return VLC_EGENERIC;
+}
+
+/* Builds the scaler from the decoded pictures to the rendition encoder input.
+ * It is rebuilt whenever the decoded format changes. */
+static int transcode_video_rendition_convert( sout_stream_t *p_stream,
+                                              transcode_rendition_t *r,
+                                              picture_t *p_src )
+{
+    es_format_t fmt_src;
+    es_format_Init( &fmt_src, VIDEO_ES, p_src->format.i_chroma );
+    video_format_Copy( &fmt_src.video, &p_src->format );
+
+    r->p_conv = filter_chain_NewVideo( p_stream, false, NULL );
+    if( !r->p_conv )
+    {
+        es_format_Clean( &fmt_src );
+        return VLC_EGENERIC;
+    }
+    filter_chain_Reset( r->p_conv, &fmt_src, picture_GetVideoContext( p_src ),
+                        transcode_encoder_format_in( r->encoder ) );
+    int ret = filter_chain_AppendConverter( r->p_conv, NULL );
+    es_format_Clean( &fmt_src );
+    if( ret != VLC_SUCCESS )
+    {
+        msg_Err( p_stream, "cannot scale to rendition %ux%u",
+                 r->p_enccfg->video.i_width, r->p_enccfg->video.i_height );
+        transcode_remove_filters( &r->p_conv );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Configures and opens a rendition encoder from the first decoded picture,
+ * so that renditions never upscale the main output. */
+static int transcode_video_rendition_open( sout_stream_t *p_stream,
+                                           sout_stream_id_sys_t *id,
+                                           size_t i_rendition,
+                                           picture_t *p_src )
+{
+    transcode_rendition_t *r = &id->p_renditions[i_rendition];
+
+    transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                       &id->p_decoder->fmt_out.video,
+                                       r->p_enccfg, &p_src->format,
+                                       picture_GetVideoContext( p_src ),
+                                       r->encoder );
+
+    if( transcode_encoder_open( r->encoder, r->p_enccfg ) != VLC_SUCCESS )
+    {
+        msg_Err( p_stream, "cannot open encoder for rendition %ux%u",
+                 r->p_enccfg->video.i_width, r->p_enccfg->video.i_height );
+        return VLC_EGENERIC;
+    }
+
+    if( !r->downstream_id )
+    {
+        /* Expose each rendition as a distinct ES of the same program */
+        const es_format_t *p_fmt_orig = &id->p_decoder->fmt_in;
+        es_format_t fmt_orig;
+        es_format_Init( &fmt_orig, VIDEO_ES, p_fmt_orig->i_codec );
+        fmt_orig.i_group = p_fmt_orig->i_group;
+        fmt_orig.i_id = p_fmt_orig->i_id +
+                        (i_rendition + 1) * TRANSCODE_RENDITION_ID_STEP;
+        fmt_orig.psz_language = p_fmt_orig->psz_language;
+
+        r->downstream_id =
+            id->pf_transcode_downstream_add( p_stream, &fmt_orig,
+                                             transcode_encoder_format_out( r->encoder ) );
+        if( !r->downstream_id )
+        {
+            msg_Err( p_stream, "cannot output rendition %ux%u",
+                     r->p_enccfg->video.i_width, r->p_enccfg->video.i_height );
+            return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+/* Drops the rendition scalers after a decoded format change */
+static void transcode_video_renditions_reset( sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+        transcode_remove_filters( &id->p_renditions[i].p_conv );
+}
+
+static void transcode_video_rendition_send( sout_stream_t *p_stream,
+                                            transcode_rendition_t *r,
+                                            block_t *p_out )
+{
+    if( !p_out )
+        return;
+    if( r->downstream_id )
+        sout_StreamIdSend( p_stream->p_next, r->downstream_id, p_out );
+    else
+        block_ChainRelease( p_out );
+}
+
+/* Scales and encodes the decoded picture for every additional rendition.
+ * This happens before the deinterlacer, the video filters and the subpicture
+ * blending of the main output, which renditions do not get. Encoders are
+ * threaded, so this only queues work. */
+static void transcode_video_renditions_encode( sout_stream_t *p_stream,
+                                               sout_stream_id_sys_t *id,
+                                               picture_t *p_pic )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        if( r->b_error )
+            continue;
+
+        if( !transcode_encoder_opened( r->encoder ) &&
+            transcode_video_rendition_open( p_stream, id, i, p_pic ) )
+        {
+            transcode_encoder_close( r->encoder );
+            r->b_error = true;
+            continue;
+        }
+
+        if( !r->p_conv &&
+            transcode_video_rendition_convert( p_stream, r, p_pic ) )
+        {
+            r->b_error = true;
+            continue;
+        }
+
+        picture_t *p_scaled = filter_chain_VideoFilter( r->p_conv,
+                                                        picture_Hold( p_pic ) );
+        if( !p_scaled )
+            continue;
+
+        block_t *p_out = transcode_encoder_encode( r->encoder, p_scaled );
+        picture_Release( p_scaled );
+        if( r->p_enccfg->video.threads.i_count >= 1 )
+            block_ChainAppend( &p_out, transcode_encoder_get_output_async( r->encoder ) );
+        transcode_video_rendition_send( p_stream, r, p_out );
+    }
+}
+
+/* Drains rendition encoders, and closes them if the stream restarts */
+static void transcode_video_renditions_drain( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id,
+                                              bool b_eos )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        if( !transcode_encoder_opened( r->encoder ) )
+            continue;
+
+        block_t *p_out = NULL;
+        if( transcode_encoder_drain( r->encoder, &p_out ) != VLC_SUCCESS )
+            r->b_error = true;
+        if( b_eos )
+        {
+            transcode_encoder_close( r->encoder );
+            transcode_remove_filters( &r->p_conv );
+            tag_last_block_with_flag( &p_out, BLOCK_FLAG_END_OF_SEQUENCE );
+        }
+        transcode_video_rendition_send( p_stream, r, p_out );
+    }
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -247,6 +480,13 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     p_enc_owner->id = id;
     p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
 
+    if( transcode_video_renditions_init( p_stream, id, &encoder_tested_fmt_in ) )
+    {
+        transcode_encoder_delete( id->encoder );
+        id->encoder = NULL;
+        goto error;
+    }
+
     es_format_Clean( &encoder_tested_fmt_in );
 
     return VLC_SUCCESS;
@@ -338,11 +578,12 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
+    transcode_video_renditions_clean( p_stream, id );
 
     es_format_Clean( &id->decoder_out );
 
@@ -429,17 +670,6 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     return p_pic;
 }
 
-static void tag_last_block_with_flag( block_t **out, int i_flag )
-{
-    block_t *p_last = *out;
-    if( p_last )
-    {
-        while( p_last->p_next )
-            p_last = p_last->p_next;
-        p_last->i_flags |= i_flag;
-    }
-}
-
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -487,6 +717,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                 transcode_remove_filters( &id->p_f_chain );
                 transcode_remove_filters( &id->p_uf_chain );
                 transcode_remove_filters( &id->p_final_conv_static );
+                transcode_video_renditions_reset( id );
                 if( id->p_spu_blender )
                     filter_DeleteBlend( id->p_spu_blender );
                 id->p_spu_blender = NULL;
@@ -576,6 +807,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             }
         }
 
+        transcode_video_renditions_encode( p_stream, id, p_pic );
+
         /* Run the filter and output chains; first with the picture,
          * and then with NULL as many times as we need until they
          * stop outputting frames.
@@ -623,6 +856,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
             transcode_encoder_close( id->encoder );
+            transcode_video_renditions_drain( p_stream, id, true );
             /* Close filters */
             transcode_remove_filters( &id->p_f_chain );
             transcode_remove_filters( &id->p_uf_chain );
@@ -652,6 +886,7 @@ error:
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
+        transcode_video_renditions_drain( p_stream, id, false );
     }
 
     if( b_eos )
@@ -85,6 +85,9 @@ typedef struct
     int                   input_profile;
     audio_sample_format_t input_format;
 
+    /* The output stream is kept open between two streams */
+    bool parked;
+
     /* Format used to configure the conversion filters. It is based on the
      * input_format but its fourcc can be different when the module is handling
      * codec passthrough. Indeed, in case of DTSHD->DTS or EAC3->AC3 fallback,
@@ -159,6 +162,8 @@ void aout_FormatsPrint(vlc_object_t *, const char *,
 int aout_DecNew(audio_output_t *, const audio_sample_format_t *, int profile,
                 struct vlc_clock_t *clock, const audio_replay_gain_t *);
 void aout_DecDelete(audio_output_t *);
+void aout_DecPark(audio_output_t *);
+void aout_DecStopParked(audio_output_t *);
 int aout_DecPlay(audio_output_t *aout, block_t *block);
 void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *);
 void aout_DecChangePause(audio_output_t *, bool b_paused, vlc_tick_t i_date);
@@ -92,16 +92,33 @@ int aout_DecNew(audio_output_t *p_aout, const audio_sample_format_t *p_format,
     if (!owner->bitexact)
         owner->volume = aout_volume_New (p_aout, p_replay_gain);
 
-    atomic_store_explicit(&owner->restart, 0, memory_order_relaxed);
+    int restart = atomic_exchange_explicit(&owner->restart, 0,
+                                           memory_order_relaxed);
+    owner->sync.clock = clock;
+    owner->filters = NULL;
+
+    if (owner->parked)
+    {
+        owner->parked = false;
+        if (!(restart & AOUT_RESTART_OUTPUT)
+         && owner->input_profile == profile
+         && AOUT_FMTS_IDENTICAL(&owner->input_format, p_format))
+        {
+            /* Same format as the previous stream: carry on with its output
+             * stream and its conversion settings */
+            msg_Dbg (p_aout, "reusing the output stream");
+            goto output;
+        }
+        aout_OutputDelete (p_aout);
+    }
+
     owner->input_profile = profile;
     owner->filter_format = owner->mixer_format = owner->input_format = *p_format;
 
-    owner->sync.clock = clock;
-
-    owner->filters = NULL;
     owner->filters_cfg = AOUT_FILTERS_CFG_INIT;
     if (aout_OutputNew (p_aout))
         goto error;
+output:
     aout_volume_SetFormat (owner->volume, owner->mixer_format.i_format);
 
     vlc_audio_meter_Reset(&owner->meter, &owner->mixer_format);
@@ -155,6 +172,45 @@ void aout_DecDelete (audio_output_t *aout)
     owner->volume = NULL;
 }
 
+/**
+ * Stops the stream like aout_DecDelete(), but keeps the output stream open.
+ *
+ * The next aout_DecNew() call reuses it if the format is the same, so that
+ * consecutive streams play back without reopening the device.
+ */
+void aout_DecPark (audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (owner->mixer_format.i_format == 0)
+    {
+        aout_DecDelete (aout);
+        return;
+    }
+
+    aout_DecFlush(aout);
+    if (owner->filters)
+        aout_FiltersDelete (aout, owner->filters);
+    owner->filters = NULL;
+    aout_volume_Delete (owner->volume);
+    owner->volume = NULL;
+    owner->parked = true;
+}
+
+/**
+ * Stops the output stream kept open by aout_DecPark(), if any.
+ */
+void aout_DecStopParked (audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (owner->parked)
+    {
+        owner->parked = false;
+        aout_OutputDelete (aout);
+    }
+}
+
 static int aout_CheckReady (audio_output_t *aout)
 {
     aout_owner_t *owner = aout_owner (aout);
@@ -49,6 +49,7 @@
 #include "stream_output/stream_output.h"
 #include "../clock/clock.h"
 #include "decoder.h"
+#include "gapless.h"
 #include "resource.h"
 #include "libvlc.h"
 
@@ -149,6 +150,7 @@ struct vlc_input_decoder_t
     bool paused;
 
     bool error;
+    unsigned threads_share; /* threads reserved from the shared CPUs */
 
     /* Waiting */
     bool b_waiting;
@@ -197,6 +199,60 @@ static inline vlc_input_decoder_t *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, vlc_input_decoder_t, dec );
 }
 
+/* Video decoders sharing the CPUs, and threads reserved by them */
+static vlc_mutex_t threads_lock = VLC_STATIC_MUTEX;
+static unsigned threads_users = 0;
+static unsigned threads_reserved = 0;
+
+/*
+ * Reserves the threads of a new video decoder: its share of the CPUs among
+ * the running video decoders, within the CPUs left by them. A decoder picks
+ * its number of threads once when it is opened, so the threads are not
+ * rebalanced while decoders run, but the threads of closed decoders go to
+ * the next ones. The total stays below the number of CPUs plus the number
+ * of decoders.
+ *
+ * Only the worker threads of the video decoders are shared: each input
+ * still runs its own input, decoder and video output threads, and frames
+ * are not scheduled by deadline across the inputs.
+ */
+static unsigned ReserveThreads( void )
+{
+    unsigned cpus = vlc_GetCPUCount();
+
+    vlc_mutex_lock( &threads_lock );
+    unsigned users = ++threads_users;
+    unsigned share = (cpus + users - 1) / users;
+    unsigned avail = cpus > threads_reserved ? cpus - threads_reserved : 0;
+
+    if( share > avail )
+        share = avail;
+    if( share == 0 )
+        share = 1;
+    threads_reserved += share;
+    vlc_mutex_unlock( &threads_lock );
+    return share;
+}
+
+static void ReleaseThreads( unsigned share )
+{
+    vlc_mutex_lock( &threads_lock );
+    assert( threads_users > 0 && threads_reserved >= share );
+    threads_users--;
+    threads_reserved -= share;
+    vlc_mutex_unlock( &threads_lock );
+}
+
+unsigned decoder_GetThreadCount( decoder_t *p_dec )
+{
+    /* Reserved by the input decoder owner, see ReserveThreads() */
+    int64_t threads = var_GetInteger( p_dec, "dec-threads-share" );
+    if( threads > 0 )
+        return threads;
+
+    return vlc_GetCPUCount();
+}
+
 /**
  * Load a decoder module
  */
@@ -1178,6 +1234,38 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 
 }
 
+/* Cut the encoder delay and padding out of decoded linear audio */
+static vlc_frame_t *DecoderTrimAudio( vlc_input_decoder_t *p_owner,
+                                      vlc_frame_t *p_audio )
+{
+    const audio_format_t *p_fmt = &p_owner->fmt.audio;
+
+    if( !AOUT_FMT_LINEAR( p_fmt ) || p_fmt->i_frame_length != 1
+     || p_fmt->i_bytes_per_frame == 0 || p_fmt->i_rate == 0
+     || p_audio->i_pts < VLC_TICK_0 )
+        return p_audio;
+
+    size_t i_skip;
+    const size_t i_count =
+        audio_gapless_Trim( &p_owner->dec.fmt_in.audio_gapless,
+                            p_fmt->i_rate, p_audio->i_pts,
+                            p_audio->i_nb_samples, &i_skip );
+    if( i_count == 0 )
+    {
+        block_Release( p_audio );
+        return NULL;
+    }
+    if( i_count == p_audio->i_nb_samples )
+        return p_audio;
+
+    p_audio->p_buffer += i_skip * p_fmt->i_bytes_per_frame;
+    p_audio->i_buffer = i_count * p_fmt->i_bytes_per_frame;
+    p_audio->i_nb_samples = i_count;
+    p_audio->i_pts += vlc_tick_from_samples( i_skip, p_fmt->i_rate );
+    p_audio->i_length = vlc_tick_from_samples( i_count, p_fmt->i_rate );
+    return p_audio;
+}
+
 static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, vlc_frame_t *p_audio )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1211,6 +1299,10 @@ static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, vlc_frame_t *p_
             aout_DecFlush( p_owner->p_aout );
     }
 
+    p_audio = DecoderTrimAudio( p_owner, p_audio );
+    if( p_audio == NULL )
+        return VLC_SUCCESS;
+
     /* */
     /* */
     vlc_mutex_lock( &p_owner->lock );
@@ -1854,6 +1946,7 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->b_has_data = false;
 
     p_owner->error = false;
+    p_owner->threads_share = 0;
 
     p_owner->flushing = false;
     p_owner->b_draining = false;
@@ -1919,6 +2012,16 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
             return p_owner;
     }
 
+    /* Reserve the threads of this decoder before it picks their number */
+    if( fmt->i_cat == VIDEO_ES && p_sout == NULL
+     && var_InheritInteger( p_dec, "dec-threads" ) <= 0
+     && vlc_GetCPUCount() > 1 && var_InheritBool( p_dec, "dec-threads-shared" )
+     && var_Create( p_dec, "dec-threads-share", VLC_VAR_INTEGER ) == VLC_SUCCESS )
+    {
+        p_owner->threads_share = ReserveThreads();
+        var_SetInteger( p_dec, "dec-threads-share", p_owner->threads_share );
+    }
+
     /* Find a suitable decoder/packetizer module */
     if( LoadDecoder( p_dec, p_sout != NULL, fmt ) )
         return p_owner;
@@ -1969,6 +2072,8 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
 
     const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
     decoder_Clean( p_dec );
+    if( p_owner->threads_share > 0 )
+        ReleaseThreads( p_owner->threads_share );
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
@@ -1996,8 +2101,14 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
         case AUDIO_ES:
             if( p_owner->p_aout )
             {
-                /* TODO: REVISIT gap-less audio */
-                aout_DecDelete( p_owner->p_aout );
+                /* Keep the output stream open for the next item if the
+                 * stream played up to its end: the decoders of the next
+                 * item are only created now, but reuse it */
+                if( atomic_load( &p_owner->drained )
+                 && var_InheritInteger( p_dec, "next-preopen" ) > 0 )
+                    aout_DecPark( p_owner->p_aout );
+                else
+                    aout_DecDelete( p_owner->p_aout );
                 input_resource_PutAout( p_owner->p_resource, p_owner->p_aout );
             }
             break;
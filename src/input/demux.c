@@ -25,6 +25,7 @@
 #endif
 
 #include <assert.h>
+#include <ctype.h>
 #include <limits.h>
 
 #include "demux.h"
@@ -35,6 +36,7 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "../modules/modules.h"
 
 typedef const struct
 {
@@ -81,6 +83,120 @@ struct vlc_demux_private
     module_t *module;
 };
 
+/*
+ * Demux modules selected while preparsing, by file extension and first bytes.
+ * Folders usually contain many files of the same kind: the cached module is
+ * probed first, instead of probing all the demuxers by priority.
+ */
+#define DEMUX_PROBE_CACHE_SIZE 32
+#define DEMUX_PROBE_MAGIC_SIZE 16
+
+struct demux_probe_key
+{
+    char ext[8];
+    uint8_t magic[DEMUX_PROBE_MAGIC_SIZE];
+};
+
+struct demux_probe_entry
+{
+    struct demux_probe_key key;
+    char module[32]; /**< empty if the entry is unused */
+    uint64_t last_use;
+};
+
+struct demux_probe_cache
+{
+    vlc_mutex_t lock;
+    struct demux_probe_entry entries[DEMUX_PROBE_CACHE_SIZE];
+    uint64_t clock;
+};
+
+struct demux_probe_cache *demux_ProbeCacheNew(void)
+{
+    struct demux_probe_cache *cache = calloc(1, sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    vlc_mutex_init(&cache->lock);
+    return cache;
+}
+
+void demux_ProbeCacheDelete(struct demux_probe_cache *cache)
+{
+    free(cache);
+}
+
+static bool demux_ProbeKey(demux_t *demux, struct demux_probe_key *key)
+{
+    const uint8_t *peek;
+    if (vlc_stream_Peek(demux->s, &peek, DEMUX_PROBE_MAGIC_SIZE)
+            < DEMUX_PROBE_MAGIC_SIZE)
+        return false;
+
+    memset(key, 0, sizeof (*key));
+    memcpy(key->magic, peek, DEMUX_PROBE_MAGIC_SIZE);
+
+    const char *path = demux->psz_filepath ? demux->psz_filepath
+                                           : demux->psz_location;
+    const char *name = strrchr(path, '/');
+    const char *ext = strrchr(name ? name : path, '.');
+    if (ext != NULL)
+        for (size_t i = 0; i < sizeof (key->ext) - 1
+                        && isalnum((unsigned char) ext[i + 1]); i++)
+            key->ext[i] = tolower((unsigned char) ext[i + 1]);
+    return true;
+}
+
+static bool demux_ProbeCacheGet(struct demux_probe_cache *cache,
+                                const struct demux_probe_key *key,
+                                char *module, size_t size)
+{
+    bool found = false;
+
+    vlc_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < DEMUX_PROBE_CACHE_SIZE; i++)
+    {
+        struct demux_probe_entry *entry = &cache->entries[i];
+        if (entry->module[0] != '\0'
+         && memcmp(&entry->key, key, sizeof (*key)) == 0)
+        {
+            entry->last_use = ++cache->clock;
+            strlcpy(module, entry->module, size);
+            found = true;
+            break;
+        }
+    }
+    vlc_mutex_unlock(&cache->lock);
+    return found;
+}
+
+static void demux_ProbeCachePut(struct demux_probe_cache *cache,
+                                const struct demux_probe_key *key,
+                                const char *module)
+{
+    if (strlen(module) >= sizeof (cache->entries[0].module))
+        return;
+
+    vlc_mutex_lock(&cache->lock);
+    /* Replace the same key, or the least recently used entry */
+    struct demux_probe_entry *victim = &cache->entries[0];
+    for (size_t i = 0; i < DEMUX_PROBE_CACHE_SIZE; i++)
+    {
+        struct demux_probe_entry *entry = &cache->entries[i];
+        if (memcmp(&entry->key, key, sizeof (*key)) == 0)
+        {
+            victim = entry;
+            break;
+        }
+        if (entry->last_use < victim->last_use)
+            victim = entry;
+    }
+    victim->key = *key;
+    strcpy(victim->module, module);
+    victim->last_use = ++cache->clock;
+    vlc_mutex_unlock(&cache->lock);
+}
+
 static void demux_DestroyDemux(demux_t *demux)
 {
     struct vlc_demux_private *priv = vlc_stream_Private(demux);
@@ -93,10 +209,9 @@ static void demux_DestroyDemux(demux_t *demux)
     vlc_stream_Delete(demux->s);
 }
 
-static int demux_Probe(void *func, bool forced, va_list ap)
+static int demux_Probe(void *func, bool forced, demux_t *demux)
 {
     int (*probe)(vlc_object_t *) = func;
-    demux_t *demux = va_arg(ap, demux_t *);
 
     /* Restore input stream offset (in case previous probed demux failed to
      * to do so). */
@@ -114,6 +229,94 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+#define DEMUX_HINTS_MAX 8
+
+/**
+ * Lists the demux modules to probe first: the module cached for similar
+ * files, then the modules whose signature matches the first bytes.
+ */
+static size_t demux_Hints(demux_t *demux, const char *cached,
+                          module_t **hints, size_t max)
+{
+    size_t count = 0;
+
+    if (cached != NULL)
+    {
+        module_t *const *mods;
+        size_t total = module_list_cap(&mods, "demux");
+
+        for (size_t i = 0; i < total; i++)
+            if (strcmp(module_get_object(mods[i]), cached) == 0)
+            {
+                hints[count++] = mods[i];
+                break;
+            }
+    }
+
+    const uint8_t *peek;
+    ssize_t size = vlc_stream_Peek(demux->s, &peek, MODULE_SIGNATURE_SIZE);
+    if (size > 0)
+        count += module_list_signature(hints + count, max - count, "demux",
+                                       peek, size);
+    return count;
+}
+
+static int demux_ProbeUnhinted(void *func, bool forced, va_list ap)
+{
+    demux_t *demux = va_arg(ap, demux_t *);
+    void *const *hinted = va_arg(ap, void *const *);
+    size_t hintedc = va_arg(ap, size_t);
+
+    /* The hinted modules were already probed, but not forced */
+    if (!forced)
+        for (size_t i = 0; i < hintedc; i++)
+            if (hinted[i] == func)
+                return VLC_EGENERIC;
+
+    return demux_Probe(func, forced, demux);
+}
+
+/**
+ * Probes the hinted demux modules first, without forcing them: they must
+ * recognize the stream by themselves. Then probes the modules as usual,
+ * skipping the hinted ones unless they are forced.
+ */
+static module_t *demux_Load(demux_t *demux, const char *names, bool strict,
+                            module_t *const *hints, size_t hintc)
+{
+    struct vlc_logger *logger = vlc_object_logger(VLC_OBJECT(demux));
+    void *hinted[DEMUX_HINTS_MAX];
+    size_t hintedc = 0;
+
+    assert(hintc <= ARRAY_SIZE(hinted));
+    for (size_t i = 0; i < hintc; i++)
+    {
+        void *cb = vlc_module_map(logger, hints[i]);
+        if (cb == NULL)
+            continue;
+
+        bool probed = false;
+        for (size_t j = 0; j < hintedc; j++)
+            probed = probed || hinted[j] == cb;
+        if (probed)
+            continue;
+
+        int ret = demux_Probe(cb, false, demux);
+        if (ret == VLC_SUCCESS)
+        {
+            msg_Dbg(demux, "using hinted demux module \"%s\"",
+                    module_get_object(hints[i]));
+            return hints[i];
+        }
+        if (ret == VLC_ETIMEOUT)
+            return NULL;
+        hinted[hintedc++] = cb;
+    }
+
+    return vlc_module_load(logger, "demux", names, strict,
+                           demux_ProbeUnhinted, demux, hinted, hintedc);
+}
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *module, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -163,6 +366,10 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
 
     char *modbuf = NULL;
     bool strict = true;
+    struct demux_probe_cache *cache = p_input != NULL
+        ? input_priv(p_input)->probe_cache : NULL;
+    struct demux_probe_key probe_key;
+    bool probe_cache = false;
 
     if (!strcasecmp(module, "any" ) || module[0] == '\0') {
         /* Look up demux by content type for hard to detect formats */
@@ -173,6 +380,9 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
             free(type);
         }
         strict = false;
+
+        if (cache != NULL && strcasecmp(module, "any") == 0)
+            probe_cache = demux_ProbeKey(p_demux, &probe_key);
     }
 
     if (strcasecmp(module, "any") == 0 && p_demux->psz_filepath != NULL)
@@ -189,8 +399,25 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(p_demux, "demux", module, strict,
-                                   demux_Probe, p_demux);
+    /* Only the automatic selection is cached */
+    probe_cache = probe_cache && (module == modbuf
+                                  || strcasecmp(module, "any") == 0);
+
+    char cached[32];
+    module_t *hints[DEMUX_HINTS_MAX];
+    size_t hintc = 0;
+
+    if (!strict && (module == modbuf || strcasecmp(module, "any") == 0))
+    {   /* Automatic selection */
+        bool found = probe_cache
+            && demux_ProbeCacheGet(cache, &probe_key, cached,
+                                   sizeof (cached));
+
+        hintc = demux_Hints(p_demux, found ? cached : NULL,
+                            hints, ARRAY_SIZE(hints));
+    }
+
+    priv->module = demux_Load(p_demux, module, strict, hints, hintc);
     free(modbuf);
 
     if (priv->module == NULL)
@@ -199,6 +426,10 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         goto error;
     }
 
+    if (probe_cache)
+        demux_ProbeCachePut(cache, &probe_key,
+                            module_get_object(priv->module));
+
     return p_demux;
 error:
     free( p_demux->psz_name );
@@ -206,6 +437,16 @@ error:
     return NULL;
 }
 
+static void demux_ReadDirItems(input_item_node_t *node,
+                               input_item_t *const *items, size_t count,
+                               size_t total, void *data)
+{
+    demux_t *demux = data;
+
+    (void) node;
+    es_out_Control(demux->out, ES_OUT_POST_SUBITEMS, items, count, total);
+}
+
 int demux_Demux(demux_t *demux)
 {
     if (demux->pf_demux != NULL)
@@ -217,6 +458,10 @@ int demux_Demux(demux_t *demux)
         if (unlikely(node == NULL))
             return VLC_DEMUXER_EGENERIC;
 
+        /* Post the items by batches while the directory is read */
+        node->pf_read = demux_ReadDirItems;
+        node->p_read_data = demux;
+
         if (vlc_stream_ReadDir(demux, node)) {
              input_item_node_Delete(node);
              return VLC_DEMUXER_EGENERIC;
@@ -348,6 +593,8 @@ int demux_vaControlHelper( stream_t *s,
         case DEMUX_SET_ES:
         case DEMUX_SET_ES_LIST:
         case DEMUX_GET_ATTACHMENTS:
+        case DEMUX_GET_DOWNLOADS:
+        case DEMUX_GET_INDEX_PROGRESS:
         case DEMUX_CAN_RECORD:
         case DEMUX_TEST_AND_CLEAR_FLAGS:
         case DEMUX_GET_TITLE:
@@ -34,6 +34,17 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_parent_input,
                             const char *psz_demux, const char *url,
                             stream_t *s, es_out_t *out, bool );
 
+/**
+ * Cache of the demux modules selected for similar files.
+ *
+ * The preparser shares one cache between its inputs, see
+ * input_CreatePreparser().
+ */
+struct demux_probe_cache;
+
+struct demux_probe_cache *demux_ProbeCacheNew(void) VLC_USED;
+void demux_ProbeCacheDelete(struct demux_probe_cache *);
+
 unsigned demux_TestAndClearFlags( demux_t *, unsigned );
 int demux_GetTitle( demux_t * );
 int demux_GetSeekpoint( demux_t * );
@@ -38,6 +38,7 @@
 #include <vlc_fourcc.h>
 #include <vlc_meta.h>
 #include <vlc_list.h>
+#include <vlc_vector.h>
 #include <vlc_decoder.h>
 #include <vlc_memstream.h>
 #include <vlc_tracer.h>
@@ -133,6 +134,10 @@ struct es_out_id_t
     vlc_input_decoder_t   *p_dec_record;
     vlc_clock_t *p_clock;
 
+    /* p_dec != NULL, readable without the es_out lock: only the blocks of
+     * undecoded ES bypass it, the decoded ones are still sent under it */
+    atomic_bool b_decoding;
+
     /* Used by vlc_clock_cbs, need to be const during the lifetime of the clock */
     bool master;
 
@@ -151,6 +156,7 @@ struct es_out_id_t
     es_out_id_t *p_master;
 
     struct vlc_list node;
+    struct vlc_list decoding_node; /* in es_out_sys_t.decoding */
 
     vlc_mouse_event mouse_event_cb;
     void* mouse_event_userdata;
@@ -182,6 +188,8 @@ typedef struct
     /* all programs */
     struct vlc_list programs;
     es_out_pgrm_t *p_pgrm;  /* Master program */
+    /* all programs, sorted by id and source */
+    struct VLC_VECTOR(es_out_pgrm_t *) pgrm_index;
 
     enum vlc_clock_master_source user_clock_source;
 
@@ -189,6 +197,7 @@ typedef struct
     int         i_id;
     struct vlc_list es;
     struct vlc_list es_slaves; /* Dynamically created es on regular es selection */
+    struct vlc_list decoding; /* es and es slaves with a decoder */
 
     /* mode gestion */
     bool  b_active;
@@ -548,8 +557,10 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
     p_sys->i_mode   = ES_OUT_MODE_NONE;
 
     vlc_list_init(&p_sys->programs);
+    vlc_vector_init(&p_sys->pgrm_index);
     vlc_list_init(&p_sys->es);
     vlc_list_init(&p_sys->es_slaves);
+    vlc_list_init(&p_sys->decoding);
 
     /* */
     EsOutPropsInit( &p_sys->video, true, p_input, ES_OUT_ES_POLICY_AUTO,
@@ -647,7 +658,9 @@ static void EsOutDelete( es_out_t *out )
     assert(vlc_list_is_empty(&p_sys->es));
     assert(vlc_list_is_empty(&p_sys->es_slaves));
     assert(vlc_list_is_empty(&p_sys->programs));
+    assert(vlc_list_is_empty(&p_sys->decoding));
     assert(p_sys->p_pgrm == NULL);
+    vlc_vector_destroy(&p_sys->pgrm_index);
     EsOutPropsCleanup( &p_sys->video );
     EsOutPropsCleanup( &p_sys->audio );
     EsOutPropsCleanup( &p_sys->sub );
@@ -682,6 +695,7 @@ static void EsOutTerminate( es_out_t *out )
         EsTerminate(es);
         EsRelease(es);
     }
+    vlc_list_init(&p_sys->decoding);
 
     es_out_pgrm_t *p_pgrm;
     vlc_list_foreach(p_pgrm, &p_sys->programs, node)
@@ -690,6 +704,7 @@ static void EsOutTerminate( es_out_t *out )
         input_SendEventProgramDel( p_sys->p_input, p_pgrm->i_id );
         ProgramDelete(p_pgrm);
     }
+    vlc_vector_clear(&p_sys->pgrm_index);
 
     p_sys->p_pgrm = NULL;
 
@@ -744,9 +759,9 @@ static bool EsOutDecodersIsEmpty( es_out_t *out )
             return true;
     }
 
-    foreach_es_then_es_slaves(es)
+    vlc_list_foreach(es, &p_sys->decoding, decoding_node)
     {
-        if( es->p_dec && !vlc_input_decoder_IsEmpty( es->p_dec ) )
+        if( !vlc_input_decoder_IsEmpty( es->p_dec ) )
             return false;
         if( es->p_dec_record && !vlc_input_decoder_IsEmpty( es->p_dec_record ) )
             return false;
@@ -923,9 +938,8 @@ static void EsOutChangeRate( es_out_t *out, float rate )
     p_sys->rate = rate;
     EsOutProgramsChangeRate( out );
 
-    foreach_es_then_es_slaves(es)
-        if( es->p_dec != NULL )
-            vlc_input_decoder_ChangeRate( es->p_dec, rate );
+    vlc_list_foreach(es, &p_sys->decoding, decoding_node)
+        vlc_input_decoder_ChangeRate( es->p_dec, rate );
 }
 
 static void EsOutChangePosition( es_out_t *out, bool b_flush )
@@ -1032,9 +1046,9 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
     }
 
     const vlc_tick_t i_decoder_buffering_start = vlc_tick_now();
-    foreach_es_then_es_slaves(p_es)
+    vlc_list_foreach(p_es, &p_sys->decoding, decoding_node)
     {
-        if( !p_es->p_dec || p_es->fmt.i_cat == SPU_ES )
+        if( p_es->fmt.i_cat == SPU_ES )
             continue;
         vlc_input_decoder_Wait( p_es->p_dec );
         if( p_es->p_dec_record )
@@ -1066,11 +1080,8 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
 
     input_clock_ChangeSystemOrigin( p_sys->p_pgrm->p_input_clock, true, update );
 
-    foreach_es_then_es_slaves(p_es)
+    vlc_list_foreach(p_es, &p_sys->decoding, decoding_node)
     {
-        if( !p_es->p_dec )
-            continue;
-
         vlc_input_decoder_StopWait( p_es->p_dec );
         if( p_es->p_dec_record )
             vlc_input_decoder_StopWait( p_es->p_dec_record );
@@ -1082,14 +1093,13 @@ static void EsOutDecodersChangePause( es_out_t *out, bool b_paused, vlc_tick_t i
     es_out_id_t *es;
 
     /* Pause decoders first */
-    foreach_es_then_es_slaves(es)
-        if( es->p_dec )
-        {
-            vlc_input_decoder_ChangePause( es->p_dec, b_paused, i_date );
-            if( es->p_dec_record )
-                vlc_input_decoder_ChangePause( es->p_dec_record, b_paused,
-                                               i_date );
-        }
+    vlc_list_foreach(es, &p_sys->decoding, decoding_node)
+    {
+        vlc_input_decoder_ChangePause( es->p_dec, b_paused, i_date );
+        if( es->p_dec_record )
+            vlc_input_decoder_ChangePause( es->p_dec_record, b_paused,
+                                           i_date );
+    }
 }
 
 static bool EsOutIsExtraBufferingAllowed( es_out_t *out )
@@ -1098,10 +1108,9 @@ static bool EsOutIsExtraBufferingAllowed( es_out_t *out )
     es_out_id_t *p_es;
 
     size_t i_size = 0;
-    foreach_es_then_es_slaves(p_es)
+    vlc_list_foreach(p_es, &p_sys->decoding, decoding_node)
     {
-        if( p_es->p_dec )
-            i_size += vlc_input_decoder_GetFifoSize( p_es->p_dec );
+        i_size += vlc_input_decoder_GetFifoSize( p_es->p_dec );
         if( p_es->p_dec_record )
             i_size += vlc_input_decoder_GetFifoSize( p_es->p_dec_record );
     }
@@ -1475,6 +1484,39 @@ static void EsOutProgramSelect( es_out_t *out, es_out_pgrm_t *p_pgrm )
 /* EsOutAddProgram:
  *  Add a program
  */
+static int EsOutProgramCompare( const es_out_pgrm_t *p_pgrm,
+                                input_source_t *source, int i_group )
+{
+    if( p_pgrm->i_id != i_group )
+        return p_pgrm->i_id < i_group ? -1 : 1;
+    if( p_pgrm->source != source )
+        return (uintptr_t)p_pgrm->source < (uintptr_t)source ? -1 : 1;
+    return 0;
+}
+
+/* EsOutProgramIndexFind:
+ *  Return the position of the program in the sorted index, or the position
+ *  where to insert it
+ */
+static size_t EsOutProgramIndexFind( es_out_sys_t *p_sys, input_source_t *source,
+                                     int i_group, bool *pb_found )
+{
+    size_t i_low = 0, i_high = p_sys->pgrm_index.size;
+
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( EsOutProgramCompare( p_sys->pgrm_index.data[i_mid],
+                                 source, i_group ) < 0 )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    *pb_found = i_low < p_sys->pgrm_index.size &&
+        EsOutProgramCompare( p_sys->pgrm_index.data[i_low], source, i_group ) == 0;
+    return i_low;
+}
+
 static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, int i_group )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
@@ -1485,6 +1527,10 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, in
     if( EsOutIsGroupSticky( out, source, i_group ) )
         return NULL;
 
+    /* Reserve the index entry, so that inserting it cannot fail */
+    if( !vlc_vector_reserve( &p_sys->pgrm_index, p_sys->pgrm_index.size + 1 ) )
+        return NULL;
+
     es_out_pgrm_t *p_pgrm = malloc( sizeof( es_out_pgrm_t ) );
     if( !p_pgrm )
         return NULL;
@@ -1535,6 +1581,12 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, in
     /* Append it */
     vlc_list_append(&p_pgrm->node, &p_sys->programs);
 
+    bool b_found;
+    size_t i_index = EsOutProgramIndexFind( p_sys, source, i_group, &b_found );
+    bool b_inserted = vlc_vector_insert( &p_sys->pgrm_index, i_index, p_pgrm );
+    assert( b_inserted );
+    VLC_UNUSED( b_inserted );
+
     /* Update "program" variable */
     input_SendEventProgramAdd( p_input, i_group, NULL );
 
@@ -1552,13 +1604,10 @@ static es_out_pgrm_t *EsOutProgramSearch( es_out_t *p_out, input_source_t *sourc
                                           int i_group )
 {
     es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
-    es_out_pgrm_t *pgrm;
-
-    vlc_list_foreach(pgrm, &p_sys->programs, node)
-        if (pgrm->i_id == i_group && pgrm->source == source)
-            return pgrm;
+    bool b_found;
 
-    return NULL;
+    size_t i_index = EsOutProgramIndexFind( p_sys, source, i_group, &b_found );
+    return b_found ? p_sys->pgrm_index.data[i_index] : NULL;
 }
 
 /* EsOutProgramInsert
@@ -1606,6 +1655,13 @@ static int EsOutProgramDel( es_out_t *out, input_source_t *source, int i_group )
 
     vlc_list_remove(&p_pgrm->node);
 
+    bool b_found;
+    size_t i_index = EsOutProgramIndexFind( p_sys, source, i_group, &b_found );
+    assert( b_found );
+    while( p_sys->pgrm_index.data[i_index] != p_pgrm )
+        i_index++; /* duplicated ids */
+    vlc_vector_remove( &p_sys->pgrm_index, i_index );
+
     /* If program is selected we need to unselect it */
     if( p_sys->p_pgrm == p_pgrm )
         p_sys->p_pgrm = NULL;
@@ -2213,6 +2269,7 @@ static es_out_id_t *EsOutAddLocked( es_out_t *out, input_source_t *source,
     es->psz_title = EsGetTitle(es);
     es->p_dec = NULL;
     es->p_dec_record = NULL;
+    atomic_init( &es->b_decoding, false );
     es->p_clock = NULL;
     es->master = false;
     es->cc.type = 0;
@@ -2334,6 +2391,9 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         return;
     }
 
+    /* The level was not tracked while the blocks were dropped unlocked */
+    p_es->i_pts_level = VLC_TICK_INVALID;
+
     input_thread_private_t *priv = input_priv(p_input);
     dec = vlc_input_decoder_New( VLC_OBJECT(p_input), &p_es->fmt,
                                  p_es->id.str_id, p_es->p_clock,
@@ -2367,6 +2427,11 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         p_es->p_clock = NULL;
     }
     p_es->p_dec = dec;
+    if( dec != NULL )
+    {
+        vlc_list_append( &p_es->decoding_node, &p_sys->decoding );
+        atomic_store_explicit( &p_es->b_decoding, true, memory_order_relaxed );
+    }
 
     EsOutDecoderChangeDelay( out, p_es );
 }
@@ -2381,6 +2446,8 @@ static void EsOutDestroyDecoder( es_out_t *out, es_out_id_t *p_es )
 
     vlc_input_decoder_Delete( p_es->p_dec );
     p_es->p_dec = NULL;
+    vlc_list_remove( &p_es->decoding_node );
+    atomic_store_explicit( &p_es->b_decoding, false, memory_order_relaxed );
     if( p_es->p_pgrm->p_master_es_clock == p_es->p_clock )
         p_es->p_pgrm->p_master_es_clock = NULL;
     vlc_clock_Delete( p_es->p_clock );
@@ -2926,6 +2993,16 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
                                       memory_order_relaxed);
     }
 
+    /* Most ES of multi-program streams are not decoded: drop their blocks
+     * without taking the lock, their configuration is not being changed.
+     * The blocks of decoded ES are still serialized by the lock, for the
+     * preroll, the sout mode, the format updates and the CC channels. */
+    if( !atomic_load_explicit( &es->b_decoding, memory_order_relaxed ) )
+    {
+        block_Release( p_block );
+        return VLC_SUCCESS;
+    }
+
     vlc_mutex_lock( &p_sys->lock );
 
     /* Mark preroll blocks */
@@ -3615,6 +3692,15 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_POST_SUBITEMS:
+    {
+        input_item_t *const *items = va_arg(args, input_item_t *const *);
+        size_t count = va_arg(args, size_t);
+        size_t total = va_arg(args, size_t);
+        input_SendEventSubitemsRead(p_sys->p_input, items, count, total);
+        return VLC_SUCCESS;
+    }
+
     case ES_OUT_VOUT_SET_MOUSE_EVENT:
     {
         es_out_id_t *p_es = va_arg( args, es_out_id_t * );
@@ -3972,6 +4058,14 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         }
         return ret;
     }
+    case ES_OUT_PRIV_JUMP_TIMESHIFT:
+        return VLC_EGENERIC;
+    case ES_OUT_PRIV_GET_TIMESHIFT_WINDOW:
+    {
+        vlc_tick_t *pi_window = va_arg( args, vlc_tick_t * );
+        *pi_window = 0;
+        return VLC_SUCCESS;
+    }
     default: vlc_assert_unreachable();
     }
 
@@ -3986,6 +4080,22 @@ static int EsOutControl( es_out_t *out, input_source_t *source,
     if( !source )
         source = p_sys->main_source;
 
+    /* Polled for every track on each demux call by some demuxers */
+    if( i_query == ES_OUT_GET_ES_STATE )
+    {
+        va_list ap;
+        va_copy( ap, args );
+        es_out_id_t *es = va_arg( ap, es_out_id_t * );
+        bool *pb = va_arg( ap, bool * );
+        va_end( ap );
+
+        if( es->p_master == NULL )
+        {
+            *pb = atomic_load_explicit( &es->b_decoding, memory_order_relaxed );
+            return VLC_SUCCESS;
+        }
+    }
+
     vlc_mutex_lock( &p_sys->lock );
     i_ret = EsOutVaControlLocked( out, source, i_query, args );
     vlc_mutex_unlock( &p_sys->lock );
@@ -96,7 +96,13 @@ enum es_out_query_private_e
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_PRIV_SET_VBI_TRANSPARENCY                /* arg1=bool res=can fail */
+    ES_OUT_PRIV_SET_VBI_TRANSPARENCY,               /* arg1=bool res=can fail */
+
+    /* Jump inside the timeshift buffer, at keyframes */
+    ES_OUT_PRIV_JUMP_TIMESHIFT,                     /* arg1=vlc_tick_t i_offset res=can fail */
+
+    /* Get the duration buffered ahead of the playback by the timeshift */
+    ES_OUT_PRIV_GET_TIMESHIFT_WINDOW                /* arg1=vlc_tick_t* res=cannot fail */
 };
 
 static inline int es_out_vaPrivControl( es_out_t *out, int query, va_list args )
@@ -241,6 +247,17 @@ static inline int es_out_SetVbiTransparency( es_out_t *p_out, vlc_es_id_t *id,
     return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_VBI_TRANSPARENCY, id,
                                enabled );
 }
+static inline int es_out_JumpTimeshift( es_out_t *p_out, vlc_tick_t i_offset )
+{
+    return es_out_PrivControl( p_out, ES_OUT_PRIV_JUMP_TIMESHIFT, i_offset );
+}
+static inline vlc_tick_t es_out_GetTimeshiftWindow( es_out_t *p_out )
+{
+    vlc_tick_t i_window;
+    int i_ret = es_out_PrivControl( p_out, ES_OUT_PRIV_GET_TIMESHIFT_WINDOW, &i_window );
+    assert( !i_ret );
+    return i_window;
+}
 
 es_out_t  *input_EsOutNew( input_thread_t *, input_source_t *main_source, float rate );
 es_out_t  *input_EsOutTimeshiftNew( input_thread_t *, es_out_t *, float i_rate );
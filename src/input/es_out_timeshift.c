@@ -44,7 +44,9 @@
 #  include <vlc_charset.h>
 #endif
 #include <vlc_es_out.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
+#include <vlc_vector.h>
 #include "input_internal.h"
 #include "es_out.h"
 
@@ -59,6 +61,10 @@
 #   define attribute_packed
 #endif
 
+/* Number of chunks the memory storage is split into, the oldest one is
+ * released when the memory limit is reached */
+#define TS_MEMORY_CHUNKS 8
+
 enum ts_storage_cmd_type_e
 {
     C_ADD = 0,
@@ -192,6 +198,7 @@ typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
     ts_storage_t *p_next;
+    uint64_t     i_seq; /* Order in the storage list */
 
     /* */
 #ifdef _WIN32
@@ -199,8 +206,16 @@ struct ts_storage_t
 #endif
     size_t  i_file_max; /* Max size in bytes */
     int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    FILE    *p_filew;   /* FILE handle for data writing, NULL in memory */
+    FILE    *p_filer;   /* FILE handle for data reading, NULL in memory */
+
+    vlc_tick_t i_date;  /* Date of the first command */
+
+    /* In memory, the played commands are kept to be replayed. Only the data
+     * and the clock references are still owned by the storage, the other
+     * commands were moved out by their execution. */
+    uint8_t *p_cmd_first;   /* First command that can be replayed */
+    uint8_t *p_cmd_played;  /* End of the commands already played */
 
     /* */
     uint8_t *p_cmd_r;
@@ -209,6 +224,15 @@ struct ts_storage_t
     size_t   i_cmd_buf;
 };
 
+/* Position of a command in the storages */
+typedef struct
+{
+    ts_storage_t   *p_storage;
+    size_t         i_offset;   /* Offset of the command in the storage */
+    vlc_tick_t     i_date;
+    es_out_id_t    *p_es;      /* ES of a keyframe */
+} ts_position_t;
+
 typedef struct
 {
     vlc_thread_t   thread;
@@ -217,6 +241,7 @@ typedef struct
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
     const char     *psz_tmp_path;
+    int64_t        i_memory_max;
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -237,16 +262,43 @@ typedef struct
     vlc_tick_t     i_buffering_delay;
 
     /* */
+    ts_storage_t   *p_storage_first;
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    uint64_t       i_storage_seq;
 
     vlc_tick_t     i_cmd_delay;
 
+    /* */
+    int64_t        i_memory_size;
+    vlc_tick_t     i_push_date;
+    vlc_tick_t     i_play_date;
+    vlc_tick_t     i_jump_date;
+    bool           b_jump_slide; /* Cut after i_jump_date to release memory */
+
+    /* Keyframes of the stored commands, in storage order */
+    struct VLC_VECTOR(ts_position_t) keyframes;
+    unsigned       i_seek_mark;
+
+    /* Deleted ES, in deletion order, freed with their last storage */
+    es_out_id_t    *p_del_first;
+    es_out_id_t    **pp_del_last;
+
 } ts_thread_t;
 
 struct es_out_id_t
 {
     es_out_id_t *p_es;
+
+    /* Accessed with the ts_thread_t lock */
+    bool        b_keyframes;     /* The ES flags its keyframes */
+    bool        b_wait_keyframe; /* Drop the data up to the next keyframe */
+    unsigned    i_seek_mark;
+
+    /* Deleted by the timeshift thread, but still referenced by the stored
+     * commands up to the storage i_del_seq - 1 (0 if not deleted) */
+    uint64_t    i_del_seq;
+    es_out_id_t *p_del_next;
 };
 
 typedef struct
@@ -257,6 +309,7 @@ typedef struct
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
     char           *psz_tmp_path;     /* Path for temporary files */
+    int64_t        i_memory_max;      /* Maximal memory size in byte, 0 for files */
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -286,20 +339,31 @@ static void         TsAutoStop( es_out_t * );
 static void         TsStop( ts_thread_t * );
 static void         TsPushCmd( ts_thread_t *, ts_cmd_t * );
 static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool b_flush );
+static void         TsAdvanceReadLocked( ts_thread_t * );
+static void         TsDropStorageLocked( ts_thread_t * );
+static void         TsDeferDelete( ts_thread_t *, es_out_id_t * );
+static bool         TsIsKeptCmd( const ts_cmd_t * );
 static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
+static int          TsJump( ts_thread_t *, vlc_tick_t i_offset );
+static vlc_tick_t   TsGetWindow( ts_thread_t * );
 
 static void         *TsRun( void * );
 
-static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max, bool b_memory );
 static void         TsStorageDelete( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
+static vlc_tick_t   TsStoragePeekDate( ts_storage_t * );
+static size_t       TsStorageSizeofBlock( ts_storage_t *, const block_t * );
+static bool         TsStorageFindDate( ts_storage_t *, vlc_tick_t i_date, size_t *pi_offset, vlc_tick_t *pi_date );
+static void         TsStorageSkipPlayed( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static void         TsStorageRelease( ts_storage_t *, uint8_t *p_end );
 
 static void CmdClean( ts_cmd_t * );
 
@@ -315,6 +379,7 @@ static void CmdCleanSend   ( ts_cmd_send_t * );
 static void CmdCleanControl( ts_cmd_control_t * );
 
 /* */
+static void CmdExecute       ( es_out_t *, ts_cmd_t * );
 static void CmdExecuteAdd    ( es_out_t *, ts_cmd_add_t * );
 static int  CmdExecuteSend   ( es_out_t *, ts_cmd_send_t * );
 static void CmdExecuteDel    ( es_out_t *, ts_cmd_del_t * );
@@ -405,6 +470,12 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     else
         msg_Dbg( p_input, "using default timeshift path" );
 
+    const int64_t i_memory_max = var_InheritInteger( p_input, "input-timeshift-memory" );
+    p_sys->i_memory_max = __MAX( i_memory_max, 0 ) * 1024 * 1024;
+    if( p_sys->i_memory_max > 0 )
+        msg_Dbg( p_input, "using timeshift memory of %"PRId64" MiB",
+                 i_memory_max );
+
 #if 0
 #define S(t) msg_Err( p_input, "SIZEOF("#t")=%zd", sizeof(t) )
     S(ts_cmd_t);
@@ -448,6 +519,11 @@ static es_out_id_t *Add( es_out_t *p_out, input_source_t *in, const es_format_t
     es_out_id_t *p_es = malloc( sizeof( *p_es ) );
     if( !p_es )
         return NULL;
+    p_es->b_keyframes = false;
+    p_es->b_wait_keyframe = false;
+    p_es->i_seek_mark = 0;
+    p_es->i_del_seq = 0;
+    p_es->p_del_next = NULL;
 
     vlc_mutex_lock( &p_sys->lock );
 
@@ -740,6 +816,7 @@ static int ControlLocked( es_out_t *p_out, input_source_t *in, int i_query,
             return VLC_EGENERIC;
         /* fall through */
     case ES_OUT_POST_SUBNODE:
+    case ES_OUT_POST_SUBITEMS:
         return es_out_in_vaControl( p_sys->p_out, in, i_query, args );
 
     case ES_OUT_MODIFY_PCR_SYSTEM:
@@ -829,6 +906,24 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     }
     case ES_OUT_PRIV_GET_GROUP_FORCED:
         return es_out_vaPrivControl( p_sys->p_out, i_query, args );
+    case ES_OUT_PRIV_JUMP_TIMESHIFT:
+    {
+        const vlc_tick_t i_offset = va_arg( args, vlc_tick_t );
+
+        if( !p_sys->b_delayed )
+            return es_out_JumpTimeshift( p_sys->p_out, i_offset );
+        return TsJump( p_sys->p_ts, i_offset );
+    }
+    case ES_OUT_PRIV_GET_TIMESHIFT_WINDOW:
+    {
+        vlc_tick_t *pi_window = va_arg( args, vlc_tick_t * );
+
+        if( !p_sys->b_delayed )
+            *pi_window = es_out_GetTimeshiftWindow( p_sys->p_out );
+        else
+            *pi_window = TsGetWindow( p_sys->p_ts );
+        return VLC_SUCCESS;
+    }
     /* Invalid queries for this es_out level */
     case ES_OUT_PRIV_SET_ES:
     case ES_OUT_PRIV_UNSET_ES:
@@ -892,6 +987,7 @@ static int TsStart( es_out_t *p_out )
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
+    p_ts->i_memory_max = p_sys->i_memory_max;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
     p_ts->p_tsout = p_out;
@@ -906,8 +1002,19 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
+    p_ts->p_storage_first = NULL;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->i_storage_seq = 0;
+    p_ts->i_memory_size = 0;
+    p_ts->i_push_date = VLC_TICK_INVALID;
+    p_ts->i_play_date = VLC_TICK_INVALID;
+    p_ts->i_jump_date = VLC_TICK_INVALID;
+    p_ts->b_jump_slide = false;
+    vlc_vector_init( &p_ts->keyframes );
+    p_ts->i_seek_mark = 0;
+    p_ts->p_del_first = NULL;
+    p_ts->pp_del_last = &p_ts->p_del_first;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -943,18 +1050,9 @@ static void TsStop( ts_thread_t *p_ts )
     vlc_join( p_ts->thread, NULL );
 
     vlc_mutex_lock( &p_ts->lock );
-    for( ;; )
-    {
-        ts_cmd_t cmd;
-
-        if( TsPopCmdLocked( p_ts, &cmd, true ) )
-            break;
-
-        CmdClean( &cmd );
-    }
-    assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+    while( p_ts->p_storage_first != NULL )
+        TsDropStorageLocked( p_ts );
+    vlc_vector_destroy( &p_ts->keyframes );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -965,7 +1063,13 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        /* In memory, use small enough chunks so that dropping the oldest
+         * one does not empty most of the window */
+        const bool b_memory = p_ts->i_memory_max > 0;
+        const int64_t i_size_max = b_memory ?
+            __MIN( p_ts->i_tmp_size_max, p_ts->i_memory_max / TS_MEMORY_CHUNKS ) :
+            p_ts->i_tmp_size_max;
+        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, i_size_max, b_memory );
 
         if( !p_storage )
         {
@@ -975,21 +1079,68 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
             return;
         }
 
+        p_storage->i_seq = p_ts->i_storage_seq++;
         if( !p_ts->p_storage_w )
         {
-            p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
+            p_ts->p_storage_first = p_ts->p_storage_r =
+            p_ts->p_storage_w = p_storage;
         }
         else
         {
             TsStoragePack( p_ts->p_storage_w );
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
+            TsAdvanceReadLocked( p_ts );
+        }
+    }
+
+    if( p_cmd->header.i_type == C_SEND )
+    {
+        es_out_id_t *p_es = p_cmd->send.p_es;
+        const block_t *p_block = p_cmd->send.p_block;
+
+        /* Index the keyframes of the ES flagging them, jumps cut there */
+        if( p_block->i_flags & BLOCK_FLAG_TYPE_MASK )
+            p_es->b_keyframes = true;
+        if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+        {
+            const ts_position_t keyframe = {
+                .p_storage = p_ts->p_storage_w,
+                .i_offset = p_ts->p_storage_w->p_cmd_w -
+                            p_ts->p_storage_w->p_cmd_buf,
+                .i_date = p_cmd->header.i_date,
+                .p_es = p_es,
+            };
+            vlc_vector_push( &p_ts->keyframes, keyframe );
         }
+
+        if( p_ts->i_memory_max > 0 )
+            p_ts->i_memory_size += TsStorageSizeofBlock( p_ts->p_storage_w,
+                                                         p_block );
     }
+    p_ts->i_push_date = p_cmd->header.i_date;
 
     /* TODO return error and warn the user (but only once) */
     TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
 
+    /* Release the played storages first, then slide the window by skipping
+     * what remains of the oldest one */
+    while( p_ts->i_memory_max > 0 && p_ts->i_memory_size > p_ts->i_memory_max )
+    {
+        if( p_ts->p_storage_first != p_ts->p_storage_r )
+        {
+            TsDropStorageLocked( p_ts );
+            continue;
+        }
+        if( p_ts->p_storage_r->p_next != NULL &&
+            p_ts->i_jump_date < p_ts->p_storage_r->p_next->i_date )
+        {
+            p_ts->i_jump_date = p_ts->p_storage_r->p_next->i_date;
+            p_ts->b_jump_slide = true;
+        }
+        break;
+    }
+
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
@@ -998,22 +1149,94 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 {
     vlc_mutex_assert( &p_ts->lock );
 
+    TsAdvanceReadLocked( p_ts );
     if( TsStorageIsEmpty( p_ts->p_storage_r ) )
         return VLC_EGENERIC;
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+    ts_storage_t *p_storage = p_ts->p_storage_r;
+
+    TsStoragePopCmd( p_storage, p_cmd, b_flush );
+
+    /* The data of a deleted ES is skipped when replayed, the ES is only
+     * freed with the storages referencing it (see TsDeferDelete()) */
+    if( p_cmd->header.i_type == C_DEL )
+        p_cmd->del.p_es->i_del_seq = p_storage->i_seq + 1;
+
+    TsAdvanceReadLocked( p_ts );
+    return VLC_SUCCESS;
+}
+/* Move the read position to the next command to play */
+static void TsAdvanceReadLocked( ts_thread_t *p_ts )
+{
+    if( !p_ts->p_storage_r )
+        return;
 
-    while( TsStorageIsEmpty( p_ts->p_storage_r ) )
+    for( ;; )
     {
+        TsStorageSkipPlayed( p_ts->p_storage_r );
+
         ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
+        if( !TsStorageIsEmpty( p_ts->p_storage_r ) || !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
+        /* Files are read once, the memory is released by TsPushCmd */
+        if( p_ts->p_storage_r->p_filew != NULL )
+        {
+            assert( p_ts->p_storage_first == p_ts->p_storage_r );
+            TsDropStorageLocked( p_ts );
+        }
         p_ts->p_storage_r = p_next;
     }
+}
+/* Delete the oldest storage */
+static void TsDropStorageLocked( ts_thread_t *p_ts )
+{
+    ts_storage_t *p_storage = p_ts->p_storage_first;
+    size_t i_count = 0;
 
-    return VLC_SUCCESS;
+    vlc_mutex_assert( &p_ts->lock );
+
+    while( i_count < p_ts->keyframes.size &&
+           p_ts->keyframes.data[i_count].p_storage == p_storage )
+        i_count++;
+    vlc_vector_remove_slice( &p_ts->keyframes, 0, i_count );
+
+    if( p_storage->p_filew == NULL )
+        p_ts->i_memory_size -= p_storage->i_file_size;
+
+    p_ts->p_storage_first = p_storage->p_next;
+    if( p_ts->p_storage_r == p_storage )
+        p_ts->p_storage_r = p_storage->p_next;
+    if( p_ts->p_storage_w == p_storage )
+        p_ts->p_storage_w = NULL;
+
+    /* Free the deleted ES no longer referenced */
+    while( p_ts->p_del_first != NULL &&
+           p_ts->p_del_first->i_del_seq <= p_storage->i_seq + 1 )
+    {
+        es_out_id_t *p_es = p_ts->p_del_first;
+
+        p_ts->p_del_first = p_es->p_del_next;
+        free( p_es );
+    }
+    if( p_ts->p_del_first == NULL )
+        p_ts->pp_del_last = &p_ts->p_del_first;
+
+    TsStorageDelete( p_storage );
+}
+/* Keep a deleted ES until the storages referencing it are dropped */
+static void TsDeferDelete( ts_thread_t *p_ts, es_out_id_t *p_es )
+{
+    vlc_mutex_lock( &p_ts->lock );
+    if( p_ts->p_storage_first == NULL ||
+        p_ts->p_storage_first->i_seq >= p_es->i_del_seq )
+        free( p_es );
+    else
+    {
+        *p_ts->pp_del_last = p_es;
+        p_ts->pp_del_last = &p_es->p_del_next;
+    }
+    vlc_mutex_unlock( &p_ts->lock );
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
@@ -1086,6 +1309,284 @@ static int TsChangeRate( ts_thread_t *p_ts, float src_rate, float rate )
 
     return i_ret;
 }
+/* Date of the first command that can be replayed */
+static vlc_tick_t TsGetFirstDateLocked( ts_thread_t *p_ts )
+{
+    for( ts_storage_t *p_storage = p_ts->p_storage_first; p_storage != NULL;
+         p_storage = p_storage->p_next )
+    {
+        if( p_storage->p_cmd_first < p_storage->p_cmd_w )
+        {
+            ts_cmd_header_t header;
+            memcpy( &header, p_storage->p_cmd_first, sizeof(header) );
+            return header.i_date;
+        }
+    }
+    return p_ts->i_push_date;
+}
+static int TsJump( ts_thread_t *p_ts, vlc_tick_t i_offset )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_ts->lock );
+    if( i_offset != 0 && p_ts->p_storage_r != NULL )
+    {
+        vlc_tick_t i_date = p_ts->i_play_date != VLC_TICK_INVALID ?
+                            p_ts->i_play_date : p_ts->p_storage_r->i_date;
+        const vlc_tick_t i_target = i_date + i_offset;
+        bool b_buffered;
+
+        /* Forward, only what is buffered ahead of the playback can be
+         * reached, backward, only what the memory storage kept */
+        if( i_offset > 0 )
+            b_buffered = i_target <= p_ts->i_push_date;
+        else
+            b_buffered = p_ts->p_storage_first->p_filew == NULL &&
+                         i_target >= TsGetFirstDateLocked( p_ts );
+
+        if( b_buffered )
+        {
+            p_ts->i_jump_date = i_target;
+            p_ts->b_jump_slide = false;
+            vlc_cond_signal( &p_ts->wait );
+            i_ret = VLC_SUCCESS;
+        }
+    }
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return i_ret;
+}
+static vlc_tick_t TsGetWindow( ts_thread_t *p_ts )
+{
+    vlc_tick_t i_window = 0;
+
+    vlc_mutex_lock( &p_ts->lock );
+    if( !TsStorageIsEmpty( p_ts->p_storage_r ) )
+    {
+        vlc_tick_t i_date = p_ts->i_play_date != VLC_TICK_INVALID ?
+                            p_ts->i_play_date : p_ts->p_storage_r->i_date;
+        i_window = p_ts->i_push_date - i_date;
+    }
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return i_window;
+}
+
+static bool TsIsClockCmd( const ts_cmd_t *p_cmd )
+{
+    if( p_cmd->header.i_type != C_CONTROL )
+        return false;
+
+    switch( p_cmd->control.i_query )
+    {
+    case ES_OUT_SET_PCR:
+    case ES_OUT_SET_GROUP_PCR:
+    case ES_OUT_RESET_PCR:
+    case ES_OUT_SET_NEXT_DISPLAY_TIME:
+        return true;
+    default:
+        return false;
+    }
+}
+/* Commands kept in memory once played, to be replayed after a jump back:
+ * the data, the clock references and the times */
+static bool TsIsKeptCmd( const ts_cmd_t *p_cmd )
+{
+    if( p_cmd->header.i_type == C_PRIVCONTROL )
+        return p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES;
+    return p_cmd->header.i_type == C_SEND || TsIsClockCmd( p_cmd );
+}
+
+static int TsComparePosition( const ts_position_t *p_a, const ts_position_t *p_b )
+{
+    if( p_a->p_storage->i_seq != p_b->p_storage->i_seq )
+        return p_a->p_storage->i_seq < p_b->p_storage->i_seq ? -1 : 1;
+    if( p_a->i_offset != p_b->i_offset )
+        return p_a->i_offset < p_b->i_offset ? -1 : 1;
+    return 0;
+}
+static ts_position_t TsGetReadPositionLocked( ts_thread_t *p_ts )
+{
+    ts_storage_t *p_storage = p_ts->p_storage_r;
+
+    return (ts_position_t) {
+        .p_storage = p_storage,
+        .i_offset = p_storage->p_cmd_r - p_storage->p_cmd_buf,
+        .i_date = TsStorageIsEmpty( p_storage ) ? p_ts->i_push_date
+                                                : TsStoragePeekDate( p_storage ),
+        .p_es = NULL,
+    };
+}
+
+/* Find the keyframe to cut at for a jump to i_target, after p_lower
+ *
+ * The cut is at the last keyframe before the target of every ES flagging
+ * them, or with b_after at the first keyframe following the target. */
+static bool TsFindKeyframeLocked( ts_thread_t *p_ts, const ts_position_t *p_lower,
+                                  vlc_tick_t i_target, bool b_after,
+                                  ts_position_t *p_cut )
+{
+    es_out_sys_t *p_sys = container_of(p_ts->p_tsout, es_out_sys_t, out);
+    const ts_position_t *p_data = p_ts->keyframes.data;
+    const size_t i_size = p_ts->keyframes.size;
+
+    /* The keyframes are sorted by position, and by date since the commands
+     * are dated when they are stored */
+    size_t i_first = 0, i_end = i_size;
+    while( i_first < i_end )
+    {
+        const size_t i_mid = i_first + (i_end - i_first) / 2;
+        if( TsComparePosition( &p_data[i_mid], p_lower ) < 0 )
+            i_first = i_mid + 1;
+        else
+            i_end = i_mid;
+    }
+
+    size_t i_last = i_first;
+    i_end = i_size;
+    while( i_last < i_end )
+    {
+        const size_t i_mid = i_last + (i_end - i_last) / 2;
+        if( p_data[i_mid].i_date <= i_target )
+            i_last = i_mid + 1;
+        else
+            i_end = i_mid;
+    }
+
+    if( b_after )
+    {
+        while( i_last < i_size && p_data[i_last].p_es->i_del_seq > 0 )
+            i_last++;
+        if( i_last >= i_size )
+            return false;
+        *p_cut = p_data[i_last];
+        return true;
+    }
+
+    /* Go back until each ES flagging its keyframes got its last one before
+     * the target, or up to the lower bound */
+    size_t i_es = 0;
+    for( int i = 0; i < p_sys->i_es; i++ )
+        if( p_sys->pp_es[i]->b_keyframes )
+            i_es++;
+
+    const unsigned i_mark = ++p_ts->i_seek_mark;
+    size_t i_cut = i_last;
+    for( size_t i = i_last; i > i_first && i_es > 0; i-- )
+    {
+        es_out_id_t *p_es = p_data[i - 1].p_es;
+
+        if( p_es->i_del_seq == 0 && p_es->i_seek_mark != i_mark )
+        {
+            p_es->i_seek_mark = i_mark;
+            i_cut = i - 1;
+            i_es--;
+        }
+    }
+    if( i_cut == i_last )
+        return false;
+    *p_cut = p_data[i_cut];
+    return true;
+}
+
+/* Move the playback to the keyframes around i_jump_date, returns the jumped
+ * duration, negative backward
+ *
+ * Forward, the data and the clock references are discarded but the other
+ * commands are executed, so that the ES and programs states stay coherent.
+ * Backward, the data and the clock references kept in memory are replayed. */
+static vlc_tick_t TsSeekLocked( ts_thread_t *p_ts )
+{
+    es_out_sys_t *p_sys = container_of(p_ts->p_tsout, es_out_sys_t, out);
+    const vlc_tick_t i_target = p_ts->i_jump_date;
+    const bool b_slide = p_ts->b_jump_slide;
+
+    vlc_mutex_assert( &p_ts->lock );
+
+    p_ts->i_jump_date = VLC_TICK_INVALID;
+    p_ts->b_jump_slide = false;
+
+    TsAdvanceReadLocked( p_ts );
+    const ts_position_t read = TsGetReadPositionLocked( p_ts );
+
+    /* Only the memory storage can go back, up to its first kept command */
+    ts_position_t lower = read;
+    if( i_target < read.i_date && p_ts->p_storage_first->p_filew == NULL )
+    {
+        lower.p_storage = p_ts->p_storage_first;
+        lower.i_offset = p_ts->p_storage_first->p_cmd_first -
+                         p_ts->p_storage_first->p_cmd_buf;
+    }
+
+    ts_position_t cut;
+    if( !TsFindKeyframeLocked( p_ts, &lower, i_target, b_slide, &cut ) )
+    {
+        /* No keyframe, cut at the target, the ES flagging keyframes will
+         * wait for the next one */
+        cut.p_storage = NULL;
+        cut.i_offset = lower.i_offset;
+        for( ts_storage_t *p_storage = lower.p_storage; p_storage != NULL;
+             p_storage = p_storage->p_next )
+        {
+            if( TsStorageFindDate( p_storage, i_target, &cut.i_offset, &cut.i_date ) )
+            {
+                cut.p_storage = p_storage;
+                break;
+            }
+            cut.i_offset = 0;
+        }
+        if( cut.p_storage == NULL )
+            return 0;
+    }
+
+    if( TsComparePosition( &cut, &read ) >= 0 )
+    {
+        for( ;; )
+        {
+            const ts_position_t pos = TsGetReadPositionLocked( p_ts );
+            ts_cmd_t cmd;
+
+            if( TsComparePosition( &pos, &cut ) >= 0 ||
+                TsPopCmdLocked( p_ts, &cmd, true ) )
+                break;
+
+            if( TsIsKeptCmd( &cmd ) )
+            {
+                CmdClean( &cmd );
+                continue;
+            }
+
+            vlc_mutex_unlock( &p_ts->lock );
+            CmdExecute( p_ts->p_tsout, &cmd );
+            vlc_mutex_lock( &p_ts->lock );
+        }
+    }
+    else
+    {
+        /* The storages following the cut are read again from their start */
+        for( ts_storage_t *p_storage = cut.p_storage->p_next; p_storage != NULL;
+             p_storage = p_storage->p_next )
+            p_storage->p_cmd_r = p_storage->p_cmd_buf;
+
+        cut.p_storage->p_cmd_r = cut.p_storage->p_cmd_buf + cut.i_offset;
+        p_ts->p_storage_r = cut.p_storage;
+    }
+
+    /* Each ES flagging its keyframes restarts on one */
+    for( int i = 0; i < p_sys->i_es; i++ )
+        p_sys->pp_es[i]->b_wait_keyframe = p_sys->pp_es[i]->b_keyframes;
+
+    /* Flush the decoders, the data around the jump must not be mixed */
+    es_out_Control( p_ts->p_out, ES_OUT_RESET_PCR );
+
+    const vlc_tick_t i_jump = cut.i_date - read.i_date;
+    msg_Dbg( p_ts->p_input, "es out timeshift: jumped %"PRId64" ms",
+             MS_FROM_VLC_TICK( i_jump ) );
+
+    p_ts->i_cmd_delay -= i_jump;
+    p_ts->i_play_date = cut.i_date;
+    return i_jump;
+}
 
 static void *TsRun( void *p_data )
 {
@@ -1098,6 +1599,18 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
 
+        /* Jump or slide the window, even when paused */
+        if( p_ts->i_jump_date != VLC_TICK_INVALID )
+        {
+            const vlc_tick_t i_jump = TsSeekLocked( p_ts );
+
+            if( i_buffering_date > 0 )
+                i_buffering_date += i_jump;
+            if( p_ts->i_rate_date >= 0 )
+                p_ts->i_rate_date += i_jump;
+            continue;
+        }
+
         /* Pop a command to execute */
         bool b_buffering = es_out_GetBuffering( p_ts->p_out );
 
@@ -1107,6 +1620,19 @@ static void *TsRun( void *p_data )
             vlc_cond_wait( &p_ts->wait, &p_ts->lock );
             continue;
         }
+        p_ts->i_play_date = cmd.header.i_date;
+
+        /* Restart on a keyframe after a jump */
+        if( cmd.header.i_type == C_SEND && cmd.send.p_es->b_wait_keyframe )
+        {
+            if( cmd.send.p_block == NULL ||
+                !(cmd.send.p_block->i_flags & BLOCK_FLAG_TYPE_I) )
+            {
+                CmdClean( &cmd );
+                continue;
+            }
+            cmd.send.p_es->b_wait_keyframe = false;
+        }
 
         if( b_buffering && i_buffering_date < 0 )
         {
@@ -1164,30 +1690,7 @@ static void *TsRun( void *p_data )
         }
 
         /* Execute the command  */
-        switch( cmd.header.i_type )
-        {
-        case C_ADD:
-            CmdExecuteAdd( p_ts->p_tsout, &cmd.add );
-            CmdCleanAdd( &cmd.add );
-            break;
-        case C_SEND:
-            CmdExecuteSend( p_ts->p_tsout, &cmd.send );
-            CmdCleanSend( &cmd.send );
-            break;
-        case C_CONTROL:
-            CmdExecuteControl( p_ts->p_tsout, &cmd.control );
-            CmdCleanControl( &cmd.control );
-            break;
-        case C_PRIVCONTROL:
-            CmdExecutePrivControl( p_ts->p_tsout, &cmd.privcontrol );
-            break;
-        case C_DEL:
-            CmdExecuteDel( p_ts->p_tsout, &cmd.del );
-            break;
-        default:
-            vlc_assert_unreachable();
-            break;
-        }
+        CmdExecute( p_ts->p_tsout, &cmd );
         vlc_mutex_lock( &p_ts->lock );
     }
     vlc_mutex_unlock( &p_ts->lock );
@@ -1209,12 +1712,103 @@ static const size_t TsStorageSizeofCommand[] =
     [C_PRIVCONTROL] = sizeof(ts_cmd_privcontrol_t)
 };
 
-static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
+/* In memory, the played blocks are read-only views of the stored ones,
+ * sharing their data instead of copying it */
+typedef struct
+{
+    vlc_atomic_rc_t rc;
+    block_t         *p_block;
+} ts_block_ref_t;
+
+typedef struct
+{
+    block_t         block;
+    ts_block_ref_t  *p_ref;
+} ts_block_view_t;
+
+static void TsBlockViewRelease( block_t *p_block )
+{
+    ts_block_view_t *p_view = container_of( p_block, ts_block_view_t, block );
+    ts_block_ref_t *p_ref = p_view->p_ref;
+
+    if( vlc_atomic_rc_dec( &p_ref->rc ) )
+    {
+        block_Release( p_ref->p_block );
+        free( p_ref );
+    }
+    free( p_view );
+}
+
+static const struct vlc_block_callbacks TsBlockViewCbs =
+{
+    TsBlockViewRelease,
+    false,
+};
+
+static block_t *TsBlockViewNew( ts_block_ref_t *p_ref )
+{
+    const block_t *p_block = p_ref->p_block;
+    ts_block_view_t *p_view = malloc( sizeof(*p_view) );
+    if( unlikely(p_view == NULL) )
+        return NULL;
+
+    /* Only the payload is shared: growing the view reallocates it */
+    block_Init( &p_view->block, &TsBlockViewCbs, p_block->p_buffer,
+                p_block->i_buffer );
+    block_CopyProperties( &p_view->block, p_block );
+    p_view->p_ref = p_ref;
+    return &p_view->block;
+}
+
+/* Wraps a block to store in memory, returns it as is on error */
+static block_t *TsBlockShare( block_t *p_block )
+{
+    ts_block_ref_t *p_ref = malloc( sizeof(*p_ref) );
+    if( unlikely(p_ref == NULL) )
+        return p_block;
+
+    vlc_atomic_rc_init( &p_ref->rc );
+    p_ref->p_block = p_block;
+
+    block_t *p_view = TsBlockViewNew( p_ref );
+    if( unlikely(p_view == NULL) )
+    {
+        free( p_ref );
+        return p_block;
+    }
+    return p_view;
+}
+
+/* Hands a block kept in memory for replay */
+static block_t *TsBlockHold( block_t *p_block )
+{
+    if( p_block->cbs != &TsBlockViewCbs )
+        return block_Duplicate( p_block );
+
+    ts_block_ref_t *p_ref = container_of( p_block, ts_block_view_t, block )->p_ref;
+    block_t *p_view = TsBlockViewNew( p_ref );
+    if( likely(p_view != NULL) )
+        vlc_atomic_rc_inc( &p_ref->rc );
+    return p_view;
+}
+
+static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max, bool b_memory )
 {
     ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
     if( unlikely(p_storage == NULL) )
         return NULL;
 
+    if( b_memory )
+    {
+        /* The blocks are kept as is in the commands */
+#ifdef _WIN32
+        p_storage->psz_file = NULL;
+#endif
+        p_storage->p_filew = NULL;
+        p_storage->p_filer = NULL;
+        goto init;
+    }
+
     char *psz_file;
     int fd = GetTmpFile( &psz_file, psz_tmp_path );
     if( fd == -1 )
@@ -1245,17 +1839,22 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
 #else
     p_storage->psz_file = psz_file;
 #endif
+init:
     p_storage->p_next = NULL;
+    p_storage->i_seq = 0;
 
     /* */
     p_storage->i_file_max = i_tmp_size_max;
     p_storage->i_file_size = 0;
+    p_storage->i_date = VLC_TICK_INVALID;
 
     /* */
     p_storage->p_cmd_buf = vlc_alloc( TS_STORAGE_COMMAND_PREALLOC, MAX_COMMAND_SIZE );
     p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
     p_storage->p_cmd_w = p_storage->p_cmd_buf;
     p_storage->p_cmd_r = p_storage->p_cmd_buf;
+    p_storage->p_cmd_first = p_storage->p_cmd_buf;
+    p_storage->p_cmd_played = p_storage->p_cmd_buf;
     //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
 
     if( !p_storage->p_cmd_buf )
@@ -1272,6 +1871,9 @@ error:
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
+    if( p_storage->p_filew == NULL )
+        TsStorageRelease( p_storage, p_storage->p_cmd_w );
+
     while( p_storage->p_cmd_r < p_storage->p_cmd_w )
     {
         ts_cmd_t cmd;
@@ -1282,12 +1884,15 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd_buf );
 
-    fclose( p_storage->p_filer );
-    fclose( p_storage->p_filew );
+    if( p_storage->p_filew != NULL )
+    {
+        fclose( p_storage->p_filer );
+        fclose( p_storage->p_filew );
 #ifdef _WIN32
-    vlc_unlink( p_storage->psz_file );
-    free( p_storage->psz_file );
+        vlc_unlink( p_storage->psz_file );
+        free( p_storage->psz_file );
 #endif
+    }
     free( p_storage );
 }
 
@@ -1302,6 +1907,8 @@ static void TsStoragePack( ts_storage_t *p_storage )
     if( p_realloc )
     {
         p_storage->p_cmd_r = p_realloc + (p_storage->p_cmd_r - p_storage->p_cmd_buf);
+        p_storage->p_cmd_first = p_realloc + (p_storage->p_cmd_first - p_storage->p_cmd_buf);
+        p_storage->p_cmd_played = p_realloc + (p_storage->p_cmd_played - p_storage->p_cmd_buf);
         p_storage->p_cmd_w = p_realloc + i_realloc;
         p_storage->i_cmd_buf = i_realloc;
         p_storage->p_cmd_buf = p_realloc;
@@ -1312,7 +1919,7 @@ static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     if( p_cmd && p_cmd->header.i_type == C_SEND && p_storage->p_cmd_w )
     {
-        size_t i_size = sizeof(*p_cmd->send.p_block) + p_cmd->send.p_block->i_buffer;
+        size_t i_size = TsStorageSizeofBlock( p_storage, p_cmd->send.p_block );
 
         if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
             return true;
@@ -1325,13 +1932,111 @@ static bool TsStorageIsEmpty( ts_storage_t *p_storage )
     return !p_storage || p_storage->p_cmd_r >= p_storage->p_cmd_w;
 }
 
+static vlc_tick_t TsStoragePeekDate( ts_storage_t *p_storage )
+{
+    assert( !TsStorageIsEmpty( p_storage ) );
+
+    ts_cmd_header_t header;
+    memcpy( &header, p_storage->p_cmd_r, sizeof(header) );
+    return header.i_date;
+}
+
+/* Size of a block in the storage: in the file, or allocated in memory */
+static size_t TsStorageSizeofBlock( ts_storage_t *p_storage, const block_t *p_block )
+{
+    if( p_storage->p_filew == NULL )
+    {
+        if( p_block->cbs == &TsBlockViewCbs )
+            p_block = container_of( p_block, ts_block_view_t, block )->p_ref->p_block;
+        return sizeof(*p_block) + p_block->i_size;
+    }
+    return sizeof(*p_block) + p_block->i_buffer;
+}
+
+/* Find the first command to play dated from i_date, after *pi_offset */
+static bool TsStorageFindDate( ts_storage_t *p_storage, vlc_tick_t i_date,
+                               size_t *pi_offset, vlc_tick_t *pi_date )
+{
+    uint8_t *p_cmd = p_storage->p_cmd_buf + *pi_offset;
+
+    while( p_cmd < p_storage->p_cmd_w )
+    {
+        ts_cmd_t cmd;
+        const size_t i_cmdsize = TsStorageSizeofCommand[p_cmd[0]];
+
+        memcpy( &cmd, p_cmd, i_cmdsize );
+        if( cmd.header.i_date >= i_date &&
+            ( p_cmd >= p_storage->p_cmd_played || TsIsKeptCmd( &cmd ) ) )
+        {
+            *pi_offset = p_cmd - p_storage->p_cmd_buf;
+            *pi_date = cmd.header.i_date;
+            return true;
+        }
+        p_cmd += i_cmdsize;
+    }
+    return false;
+}
+
+/* Skip the played commands that were moved out by their execution */
+static void TsStorageSkipPlayed( ts_storage_t *p_storage )
+{
+    while( p_storage->p_cmd_r < p_storage->p_cmd_played )
+    {
+        ts_cmd_t cmd;
+        const size_t i_cmdsize = TsStorageSizeofCommand[p_storage->p_cmd_r[0]];
+
+        memcpy( &cmd, p_storage->p_cmd_r, i_cmdsize );
+        if( TsIsKeptCmd( &cmd ) )
+            break;
+        p_storage->p_cmd_r += i_cmdsize;
+    }
+}
+
+/* Clean the commands in [p_cmd_first, p_end) still owned by the memory */
+static void TsStorageRelease( ts_storage_t *p_storage, uint8_t *p_end )
+{
+    uint8_t *p_cmd = p_storage->p_cmd_first;
+
+    assert( p_storage->p_filew == NULL );
+
+    while( p_cmd < p_end )
+    {
+        ts_cmd_t cmd;
+        const size_t i_cmdsize = TsStorageSizeofCommand[p_cmd[0]];
+
+        memcpy( &cmd, p_cmd, i_cmdsize );
+        if( p_cmd >= p_storage->p_cmd_played || TsIsKeptCmd( &cmd ) )
+        {
+            if( cmd.header.i_type == C_SEND )
+                p_storage->i_file_size -= TsStorageSizeofBlock( p_storage,
+                                                                cmd.send.p_block );
+            CmdClean( &cmd );
+        }
+        p_cmd += i_cmdsize;
+    }
+    p_storage->p_cmd_first = p_end;
+    if( p_storage->p_cmd_r < p_end )
+        p_storage->p_cmd_r = p_end;
+    if( p_storage->p_cmd_played < p_end )
+        p_storage->p_cmd_played = p_end;
+}
+
 static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsFull( p_storage, p_cmd ) );
     ts_cmd_t cmd;
     memcpy(&cmd, p_cmd, TsStorageSizeofCommand[p_cmd->header.i_type]);
 
-    if( cmd.header.i_type == C_SEND )
+    if( p_storage->p_cmd_w == p_storage->p_cmd_buf )
+        p_storage->i_date = cmd.header.i_date;
+
+    if( cmd.header.i_type == C_SEND && p_storage->p_filew == NULL )
+    {
+        cmd.send.p_block = TsBlockShare( cmd.send.p_block );
+        p_storage->i_file_size += TsStorageSizeofBlock( p_storage,
+                                                        cmd.send.p_block );
+    }
+    else if( cmd.header.i_type == C_SEND )
     {
         block_t *p_block = cmd.send.p_block;
 
@@ -1371,8 +2076,20 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     size_t i_cmdsize = TsStorageSizeofCommand[ p_cmd->header.i_type ];
     memcpy(p_cmd, p_storage->p_cmd_r, i_cmdsize);
     p_storage->p_cmd_r += i_cmdsize;
+    if( p_storage->p_cmd_played < p_storage->p_cmd_r )
+        p_storage->p_cmd_played = p_storage->p_cmd_r;
 
-    if( p_cmd->header.i_type == C_SEND )
+    if( p_storage->p_filer == NULL )
+    {
+        /* Hand a reference to the kept commands, the memory keeps them for
+         * replay, the others are moved out */
+        if( p_cmd->header.i_type == C_SEND )
+            p_cmd->send.p_block = b_flush ? NULL :
+                                  TsBlockHold( p_cmd->send.p_block );
+        else if( TsIsClockCmd( p_cmd ) && p_cmd->control.in )
+            input_source_Hold( p_cmd->control.in );
+    }
+    else if( p_cmd->header.i_type == C_SEND )
     {
         block_t block;
 
@@ -1403,6 +2120,34 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
 /*****************************************************************************
  *
  *****************************************************************************/
+static void CmdExecute( es_out_t *p_tsout, ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_ADD:
+        CmdExecuteAdd( p_tsout, &p_cmd->add );
+        CmdCleanAdd( &p_cmd->add );
+        break;
+    case C_SEND:
+        CmdExecuteSend( p_tsout, &p_cmd->send );
+        CmdCleanSend( &p_cmd->send );
+        break;
+    case C_CONTROL:
+        CmdExecuteControl( p_tsout, &p_cmd->control );
+        CmdCleanControl( &p_cmd->control );
+        break;
+    case C_PRIVCONTROL:
+        CmdExecutePrivControl( p_tsout, &p_cmd->privcontrol );
+        break;
+    case C_DEL:
+        CmdExecuteDel( p_tsout, &p_cmd->del );
+        break;
+    default:
+        vlc_assert_unreachable();
+        break;
+    }
+}
+
 static void CmdClean( ts_cmd_t *p_cmd )
 {
     switch( p_cmd->header.i_type )
@@ -1500,10 +2245,21 @@ static int CmdInitDel( ts_cmd_del_t *p_cmd, es_out_id_t *p_es )
 static void CmdExecuteDel( es_out_t *p_tsout, ts_cmd_del_t *p_cmd )
 {
     es_out_sys_t *p_sys = container_of(p_tsout, es_out_sys_t, out);
-    if( p_cmd->p_es->p_es )
-        es_out_Del( p_sys->p_out, p_cmd->p_es->p_es );
-    TAB_REMOVE( p_sys->i_es, p_sys->pp_es, p_cmd->p_es );
-    free( p_cmd->p_es );
+    es_out_id_t *p_es = p_cmd->p_es;
+
+    if( p_es->p_es )
+        es_out_Del( p_sys->p_out, p_es->p_es );
+    TAB_REMOVE( p_sys->i_es, p_sys->pp_es, p_es );
+
+    if( p_sys->b_delayed && p_es->i_del_seq > 0 )
+    {
+        /* Its stored data may be replayed, and is then dropped */
+        p_es->p_es = NULL;
+        p_es->b_wait_keyframe = false;
+        TsDeferDelete( p_sys->p_ts, p_es );
+    }
+    else
+        free( p_es );
 }
 
 static int CmdInitControl( ts_cmd_control_t *p_cmd, input_source_t *in,
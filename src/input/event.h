@@ -149,6 +149,15 @@ static inline void input_SendEventCache(input_thread_t *p_input, double f_level)
     });
 }
 
+static inline void input_SendEventIndexProgress(input_thread_t *p_input,
+                                                double f_progress)
+{
+    input_SendEvent(p_input, &(struct vlc_input_event) {
+        .type = INPUT_EVENT_INDEX_PROGRESS,
+        .index_progress = f_progress
+    });
+}
+
 static inline void input_SendEventMeta(input_thread_t *p_input)
 {
     input_SendEvent(p_input, &(struct vlc_input_event) {
@@ -258,6 +267,16 @@ static inline void input_SendEventParsing(input_thread_t *p_input,
     });
 }
 
+static inline void input_SendEventSubitemsRead(input_thread_t *p_input,
+                                               input_item_t *const *items,
+                                               size_t count, size_t total)
+{
+    input_SendEvent(p_input, &(struct vlc_input_event) {
+        .type = INPUT_EVENT_SUBITEMS_READ,
+        .subitems_read = { items, count, total },
+    });
+}
+
 static inline void input_SendEventVbiPage(input_thread_t *p_input, unsigned page)
 {
     input_SendEvent(p_input, &(struct vlc_input_event) {
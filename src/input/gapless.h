@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * gapless.h: audio encoder delay and padding trimming
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef INPUT_GAPLESS_H
+#define INPUT_GAPLESS_H
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+
+/**
+ * Computes the part of a decoded audio buffer to play.
+ *
+ * The buffer is located from its date: this also works after a seek, as
+ * long as the decoder dates its output from the start of the ES.
+ *
+ * \param gapless gapless information of the ES
+ * \param rate sample rate, not 0
+ * \param pts date of the first sample of the buffer, not before VLC_TICK_0
+ * \param samples number of samples of the buffer
+ * \param[out] skip number of samples to skip at the start of the buffer
+ * \return number of samples to play after the skipped ones, 0 to drop the
+ * whole buffer
+ */
+static inline size_t
+audio_gapless_Trim( const audio_gapless_t *gapless, unsigned rate,
+                    vlc_tick_t pts, size_t samples, size_t *skip )
+{
+    *skip = 0;
+    if( gapless->i_delay == 0 && gapless->i_samples == 0 )
+        return samples;
+
+    /* Round up: the decoder dates are rounded down */
+    const uint64_t first = ( (uint64_t)( pts - VLC_TICK_0 ) * rate
+                             + CLOCK_FREQ - 1 ) / CLOCK_FREQ;
+    const uint64_t last = first + samples;
+    const uint64_t start = gapless->i_delay;
+    const uint64_t end = gapless->i_samples > gapless->i_padding ?
+                         gapless->i_samples - gapless->i_padding : UINT64_MAX;
+
+    if( last <= start || first >= end )
+        return 0;
+
+    *skip = first < start ? start - first : 0;
+    return ( last > end ? end : last ) - first - *skip;
+}
+
+#endif
@@ -143,10 +143,15 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
 
 input_thread_t *input_CreatePreparser( vlc_object_t *parent,
                                        input_thread_events_cb events_cb,
-                                       void *events_data, input_item_t *item )
+                                       void *events_data, input_item_t *item,
+                                       struct demux_probe_cache *probe_cache )
 {
-    return Create( parent, events_cb, events_data, item,
-                   INPUT_CREATE_OPTION_PREPARSING, NULL, NULL );
+    input_thread_t *input = Create( parent, events_cb, events_data, item,
+                                    INPUT_CREATE_OPTION_PREPARSING, NULL,
+                                    NULL );
+    if( input != NULL )
+        input_priv(input)->probe_cache = probe_cache;
+    return input;
 }
 
 input_thread_t *input_CreateThumbnailer(vlc_object_t *obj,
@@ -303,6 +308,7 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     priv->events_cb = events_cb;
     priv->events_data = events_data;
     priv->b_preparsing = option == INPUT_CREATE_OPTION_PREPARSING;
+    priv->probe_cache = NULL;
     priv->b_thumbnailing = option == INPUT_CREATE_OPTION_THUMBNAILING;
     priv->i_start = 0;
     priv->i_stop  = 0;
@@ -610,6 +616,42 @@ static int MainLoopTryRepeat( input_thread_t *p_input )
     return VLC_SUCCESS;
 }
 
+/**
+ * Summarize the last segment downloads of adaptive streams.
+ */
+static void MainLoopDownloadStatistics( input_thread_t *p_input,
+                                        struct input_stats_t *p_stats )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+    demux_download_t *p_downloads;
+    size_t i_downloads;
+
+    p_stats->i_download_bandwidth = 0;
+    p_stats->f_download_bitrate = 0.f;
+    p_stats->i_download_latency = 0;
+
+    if( demux_Control( priv->master->p_demux, DEMUX_GET_DOWNLOADS,
+                       &p_downloads, &i_downloads ) )
+        return;
+
+    uint64_t i_size = 0;
+    vlc_tick_t i_duration = 0;
+    for( size_t i = 0; i < i_downloads; i++ )
+    {
+        i_size += p_downloads[i].i_size;
+        i_duration += p_downloads[i].i_duration;
+    }
+    if( i_downloads > 0 )
+    {
+        const demux_download_t *p_last = &p_downloads[i_downloads - 1];
+        p_stats->i_download_bandwidth = p_last->i_bandwidth;
+        p_stats->i_download_latency = p_last->i_latency;
+    }
+    if( i_duration > 0 )
+        p_stats->f_download_bitrate = i_size / (float)i_duration;
+    free( p_downloads );
+}
+
 /**
  * Update timing infos and statistics.
  */
@@ -640,7 +682,12 @@ static void MainLoopStatistics( input_thread_t *p_input )
 
     struct input_stats_t new_stats;
     if( priv->stats != NULL )
+    {
         input_stats_Compute( priv->stats, &new_stats );
+        new_stats.i_timeshift_window =
+            es_out_GetTimeshiftWindow( priv->p_es_out );
+        MainLoopDownloadStatistics( p_input, &new_stats );
+    }
 
     vlc_mutex_lock( &priv->p_item->lock );
     if( priv->stats != NULL )
@@ -1360,6 +1407,10 @@ static int Init( input_thread_t * p_input )
         LoadSlaves( p_input );
         InitPrograms( p_input );
 
+        /* The ES are selected once the programs are known */
+        if( master->p_pretune != NULL )
+            input_pretune_Replay( master->p_pretune, priv->p_es_out );
+
         double f_rate = var_GetFloat( p_input, "rate" );
         if( f_rate != 0.0 && f_rate != 1.0 )
         {
@@ -2019,6 +2070,14 @@ static bool Control( input_thread_t *p_input,
                 break;
             }
 
+            /* Jump inside the timeshift buffer when possible */
+            if( !absolute && param.time.i_val != 0 &&
+                !es_out_JumpTimeshift( priv->p_es_out, param.time.i_val ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_Control( priv->p_es_out, ES_OUT_RESET_PCR );
 
@@ -2483,7 +2542,8 @@ static int UpdateTitleSeekpointFromDemux( input_thread_t *p_input )
 
 static void UpdateGenericFromDemux( input_thread_t *p_input )
 {
-    demux_t *p_demux = input_priv(p_input)->master->p_demux;
+    input_source_t *in = input_priv(p_input)->master;
+    demux_t *p_demux = in->p_demux;
 
     if( demux_TestAndClearFlags( p_demux, INPUT_UPDATE_META ) )
         InputUpdateMeta( p_input, p_demux );
@@ -2495,6 +2555,17 @@ static void UpdateGenericFromDemux( input_thread_t *p_input )
         if( !demux_Control( p_demux, DEMUX_GET_SIGNAL, &quality, &strength ) )
             input_SendEventSignal( p_input, quality, strength );
     }
+
+    {
+        double progress;
+
+        if( !demux_Control( p_demux, DEMUX_GET_INDEX_PROGRESS, &progress )
+         && progress != in->f_index_progress )
+        {
+            in->f_index_progress = progress;
+            input_SendEventIndexProgress( p_input, progress );
+        }
+    }
 }
 
 static void UpdateTitleListfromDemux( input_thread_t *p_input )
@@ -2600,6 +2671,30 @@ error:
 static void input_SplitMRL( const char **, const char **, const char **,
                             const char **, char * );
 
+static demux_t *InputDemuxAdopt( input_thread_t *p_input,
+                                 input_source_t *p_source, const char *url,
+                                 const char *psz_demux )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+
+    input_pretune_t *pt = input_resource_TakePreTuned( priv->p_resource,
+                                                       priv->p_item );
+    if( pt == NULL )
+        return NULL;
+
+    demux_t *demux = input_pretune_Adopt( pt, url, psz_demux );
+    if( demux == NULL )
+    {
+        /* It may still be opening its item */
+        input_resource_ReleasePreTuned( priv->p_resource, pt );
+        return NULL;
+    }
+
+    msg_Dbg( p_input, "using pre-tuned demux" );
+    p_source->p_pretune = pt;
+    return demux;
+}
+
 static input_source_t *InputSourceNew( const char *psz_mrl )
 {
     input_source_t *in = calloc(1, sizeof(*in) );
@@ -2720,7 +2815,9 @@ static int InputSourceInit( input_source_t *in, input_thread_t *p_input,
         else
             es_out = priv->p_es_out;
 
-        if( es_out )
+        if( master && !priv->b_preparsing && psz_forced_demux == NULL )
+            in->p_demux = InputDemuxAdopt( p_input, in, url, psz_demux );
+        if( es_out && in->p_demux == NULL )
             in->p_demux = InputDemuxNew( p_input, es_out, in, url,
                                          psz_demux, psz_anchor );
         free( url );
@@ -2831,6 +2928,7 @@ static int InputSourceInit( input_source_t *in, input_thread_t *p_input,
 
     if( demux_Control( in->p_demux, DEMUX_GET_FPS, &in->f_fps ) )
         in->f_fps = 0.f;
+    in->f_index_progress = -1.;
 
     if( var_GetInteger( p_input, "clock-synchro" ) != -1 )
         in->b_can_pace_control = !var_GetInteger( p_input, "clock-synchro" );
@@ -2877,6 +2975,8 @@ static void InputSourceDestroy( input_source_t *in )
 
     if( in->p_demux )
         demux_Delete( in->p_demux );
+    if( in->p_pretune )
+        input_pretune_Delete( in->p_pretune );
     if( in->p_slave_es_out )
         es_out_Delete( in->p_slave_es_out );
 
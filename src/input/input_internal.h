@@ -36,6 +36,7 @@
 #include "misc/interrupt.h"
 
 struct input_stats;
+struct demux_probe_cache;
 
 /*****************************************************************************
  * input defines/constants.
@@ -126,12 +127,15 @@ typedef enum input_event_type_e
 
     /* cache" has changed */
     INPUT_EVENT_CACHE,
+    /* The progress of the index built by the demuxer has changed */
+    INPUT_EVENT_INDEX_PROGRESS,
 
     /* A vout_thread_t object has been created/deleted by *the input* */
     INPUT_EVENT_VOUT,
 
     /* (pre-)parsing events */
     INPUT_EVENT_SUBITEMS,
+    INPUT_EVENT_SUBITEMS_READ,
 
     /* vbi_page has changed */
     INPUT_EVENT_VBI_PAGE,
@@ -247,6 +251,13 @@ struct vlc_input_event_signal {
     float strength;
 };
 
+struct vlc_input_event_subitems_read
+{
+    input_item_t *const *items;
+    size_t count;
+    size_t total;
+};
+
 struct vlc_input_event_vout
 {
     enum {
@@ -289,10 +300,14 @@ struct vlc_input_event
         struct vlc_input_event_signal signal;
         /* INPUT_EVENT_CACHE */
         float cache;
+        /* INPUT_EVENT_INDEX_PROGRESS */
+        float index_progress;
         /* INPUT_EVENT_VOUT */
         struct vlc_input_event_vout vout;
         /* INPUT_EVENT_SUBITEMS */
         input_item_node_t *subitems;
+        /* INPUT_EVENT_SUBITEMS_READ */
+        struct vlc_input_event_subitems_read subitems_read;
         /* INPUT_EVENT_VBI_PAGE */
         unsigned vbi_page;
         /* INPUT_EVENT_VBI_TRANSPARENCY */
@@ -326,11 +341,14 @@ input_thread_t * input_Create( vlc_object_t *p_parent,
  *
  * @param obj parent object
  * @param item input item to preparse
+ * @param probe_cache demux probe cache shared with other preparsing inputs,
+ * or NULL
  * @return an input thread or NULL on error
  */
 input_thread_t *input_CreatePreparser(vlc_object_t *obj,
                                       input_thread_events_cb events_cb,
-                                      void *events_data, input_item_t *item)
+                                      void *events_data, input_item_t *item,
+                                      struct demux_probe_cache *probe_cache)
 VLC_USED;
 
 VLC_API
@@ -376,6 +394,7 @@ struct input_source_t
 
     demux_t  *p_demux; /**< Demux object (most downstream) */
     es_out_t *p_slave_es_out; /**< Slave es out */
+    struct input_pretune_t *p_pretune; /**< Pre-tuned item the demux comes from */
 
     char *str_id;
     int auto_id;
@@ -401,6 +420,7 @@ struct input_source_t
     bool b_can_stream_record;
     bool b_rescale_ts;
     double f_fps;
+    double f_index_progress; /* last one sent, negative if none */
 
     /* sub-fps handling */
     bool b_slave_sub;
@@ -471,6 +491,7 @@ typedef struct input_thread_private_t
 
     /* Global properties */
     bool        b_preparsing;
+    struct demux_probe_cache *probe_cache; /**< shared by the preparser */
 
     /* Current state */
     int         i_state;
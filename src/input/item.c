@@ -33,6 +33,7 @@
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_strings.h>
+#include <vlc_vector.h>
 
 #include "item.h"
 #include "info.h"
@@ -1236,6 +1237,8 @@ input_item_node_t *input_item_node_Create( input_item_t *p_input )
 
     p_node->i_children = 0;
     p_node->pp_children = NULL;
+    p_node->pf_read = NULL;
+    p_node->p_read_data = NULL;
 
     return p_node;
 }
@@ -1367,14 +1370,23 @@ input_item_parser_InputEvent(input_thread_t *input,
                 parser->cbs->on_subtree_added(input_GetItem(input),
                                               event->subitems, parser->userdata);
             break;
+        case INPUT_EVENT_SUBITEMS_READ:
+            if (parser->cbs->on_subitems_read)
+                parser->cbs->on_subitems_read(input_GetItem(input),
+                                              event->subitems_read.items,
+                                              event->subitems_read.count,
+                                              event->subitems_read.total,
+                                              parser->userdata);
+            break;
         default:
             break;
     }
 }
 
 input_item_parser_id_t *
-input_item_Parse(input_item_t *item, vlc_object_t *obj,
-                 const input_item_parser_cbs_t *cbs, void *userdata)
+input_item_ParseCached(input_item_t *item, vlc_object_t *obj,
+                       const input_item_parser_cbs_t *cbs, void *userdata,
+                       struct demux_probe_cache *probe_cache)
 {
     assert(cbs && cbs->on_ended);
     input_item_parser_id_t *parser = malloc(sizeof(*parser));
@@ -1385,7 +1397,7 @@ input_item_Parse(input_item_t *item, vlc_object_t *obj,
     parser->cbs = cbs;
     parser->userdata = userdata;
     parser->input = input_CreatePreparser(obj, input_item_parser_InputEvent,
-                                          parser, item);
+                                          parser, item, probe_cache);
     if (!parser->input || input_Start(parser->input))
     {
         if (parser->input)
@@ -1396,6 +1408,13 @@ input_item_Parse(input_item_t *item, vlc_object_t *obj,
     return parser;
 }
 
+input_item_parser_id_t *
+input_item_Parse(input_item_t *item, vlc_object_t *obj,
+                 const input_item_parser_cbs_t *cbs, void *userdata)
+{
+    return input_item_ParseCached(item, obj, cbs, userdata, NULL);
+}
+
 void
 input_item_parser_id_Interrupt(input_item_parser_id_t *parser)
 {
@@ -1493,7 +1512,23 @@ struct rdh_slave
 {
     input_item_slave_t *p_slave;
     char *psz_filename;
+    char *psz_name; /* see rdh_name_from_filename() */
     input_item_node_t *p_node;
+    bool b_held; /* item read but not notified, see rdh_push_read() */
+};
+
+/* Item of a node that can have slaves */
+struct rdh_master
+{
+    char *psz_name; /* see rdh_name_from_filename() */
+    int i_index;
+};
+
+/* Item that can be matched with a slave */
+struct rdh_match
+{
+    int i_index;
+    size_t i_slave;
 };
 
 struct rdh_dir
@@ -1629,68 +1664,257 @@ static int rdh_should_match_idx(struct vlc_readdir_helper *p_rdh,
     return false;
 }
 
-static void rdh_attach_slaves(struct vlc_readdir_helper *p_rdh,
-                              input_item_node_t *p_parent_node)
+/* Attaches a slave to an item, if they match closely enough */
+static int rdh_attach_slave(struct vlc_readdir_helper *p_rdh,
+                            input_item_node_t *p_parent_node,
+                            input_item_node_t *p_node,
+                            struct rdh_slave *p_rdh_slave)
 {
-    if (p_rdh->i_sub_autodetect_fuzzy == 0)
-        return;
+    input_item_t *p_item = p_node->p_item;
 
-    /* Try to match slaves for each items of the node */
-    for (int i = 0; i < p_parent_node->i_children; i++)
+    /* Don't try to match slaves with themselves or slaves already
+     * attached with the higher priority */
+    if (p_rdh_slave->p_node == p_node
+     || p_rdh_slave->p_slave->i_priority == SLAVE_PRIORITY_MATCH_ALL)
+        return VLC_SUCCESS;
+
+    uint8_t i_priority =
+        rdh_get_slave_priority(p_item, p_rdh_slave->p_slave,
+                                 p_rdh_slave->psz_filename);
+
+    if (i_priority < p_rdh->i_sub_autodetect_fuzzy)
+        return VLC_SUCCESS;
+
+    /* Drop the ".sub" slave if a ".idx" slave matches */
+    if (p_rdh_slave->p_slave->i_type == SLAVE_TYPE_SPU
+     && rdh_should_match_idx(p_rdh, p_rdh_slave))
+        return VLC_SUCCESS;
+
+    input_item_slave_t *p_slave =
+        input_item_slave_New(p_rdh_slave->p_slave->psz_uri,
+                             p_rdh_slave->p_slave->i_type,
+                             i_priority);
+    if (p_slave == NULL)
+        return VLC_ENOMEM;
+
+    if (input_item_AddSlave(p_item, p_slave) != VLC_SUCCESS)
     {
-        input_item_node_t *p_node = p_parent_node->pp_children[i];
-        input_item_t *p_item = p_node->p_item;
+        input_item_slave_Delete(p_slave);
+        return VLC_ENOMEM;
+    }
 
-        enum slave_type unused;
-        if (!input_item_IsMaster(p_item->psz_name)
-         || input_item_slave_GetType(p_item->psz_name, &unused))
-            continue; /* don't match 2 possible slaves between each others */
+    /* Remove the corresponding node if any: This slave won't be
+     * added in the parent node */
+    if (p_rdh_slave->p_node != NULL)
+    {
+        input_item_node_RemoveNode(p_parent_node, p_rdh_slave->p_node);
+        input_item_node_Delete(p_rdh_slave->p_node);
+        p_rdh_slave->p_node = NULL;
+    }
 
-        for (size_t j = 0; j < p_rdh->i_slaves; j++)
-        {
-            struct rdh_slave *p_rdh_slave = p_rdh->pp_slaves[j];
+    p_rdh_slave->p_slave->i_priority = i_priority;
+    return VLC_SUCCESS;
+}
 
-            /* Don't try to match slaves with themselves or slaves already
-             * attached with the higher priority */
-            if (p_rdh_slave->p_node == p_node
-             || p_rdh_slave->p_slave->i_priority == SLAVE_PRIORITY_MATCH_ALL)
-                continue;
+static bool rdh_is_master(input_item_t *p_item)
+{
+    enum slave_type unused;
 
-            uint8_t i_priority =
-                rdh_get_slave_priority(p_item, p_rdh_slave->p_slave,
-                                         p_rdh_slave->psz_filename);
+    /* don't match 2 possible slaves between each others */
+    return input_item_IsMaster(p_item->psz_name)
+        && !input_item_slave_GetType(p_item->psz_name, &unused);
+}
 
-            if (i_priority < p_rdh->i_sub_autodetect_fuzzy)
-                continue;
+static int rdh_master_cmp(const void *a, const void *b)
+{
+    const struct rdh_master *ma = a, *mb = b;
+    int i_ret = strcmp(ma->psz_name, mb->psz_name);
 
-            /* Drop the ".sub" slave if a ".idx" slave matches */
-            if (p_rdh_slave->p_slave->i_type == SLAVE_TYPE_SPU
-             && rdh_should_match_idx(p_rdh, p_rdh_slave))
-                continue;
+    return i_ret != 0 ? i_ret : ma->i_index - mb->i_index;
+}
 
-            input_item_slave_t *p_slave =
-                input_item_slave_New(p_rdh_slave->p_slave->psz_uri,
-                                     p_rdh_slave->p_slave->i_type,
-                                     i_priority);
-            if (p_slave == NULL)
-                break;
+static int rdh_match_cmp(const void *a, const void *b)
+{
+    const struct rdh_match *ma = a, *mb = b;
 
-            if (input_item_AddSlave(p_item, p_slave) != VLC_SUCCESS)
-            {
-                input_item_slave_Delete(p_slave);
-                break;
-            }
+    if (ma->i_index != mb->i_index)
+        return ma->i_index - mb->i_index;
+    return (ma->i_slave > mb->i_slave) - (ma->i_slave < mb->i_slave);
+}
+
+/* Compares a master name with the first len characters of psz_sub */
+static int rdh_master_cmp_sub(const struct rdh_master *p_master,
+                              const char *psz_sub, size_t len)
+{
+    int i_ret = strncmp(p_master->psz_name, psz_sub, len);
+
+    if (i_ret == 0 && p_master->psz_name[len] != '\0')
+        i_ret = 1;
+    return i_ret;
+}
 
-            /* Remove the corresponding node if any: This slave won't be
-             * added in the parent node */
-            if (p_rdh_slave->p_node != NULL)
+/**
+ * Lists the masters that can be matched with the slaves.
+ *
+ * Slaves only match items whose name is contained in the slave name, and at
+ * least half as long. Instead of trying every slave on every item, the
+ * substrings of each slave name are looked up in the sorted item names.
+ */
+static int rdh_match_slaves(struct vlc_readdir_helper *p_rdh,
+                            const struct rdh_master *p_masters,
+                            size_t i_masters,
+                            struct rdh_match **pp_matches, size_t *pi_matches)
+{
+    struct VLC_VECTOR(struct rdh_match) matches = VLC_VECTOR_INITIALIZER;
+
+    for (size_t j = 0; j < p_rdh->i_slaves; j++)
+    {
+        struct rdh_slave *p_rdh_slave = p_rdh->pp_slaves[j];
+        const char *psz_name = p_rdh_slave->psz_name;
+        size_t i_slave_len = strlen(psz_name);
+
+        for (size_t len = (i_slave_len + 1) / 2; len <= i_slave_len; len++)
+            for (size_t start = 0; start + len <= i_slave_len; start++)
             {
-                input_item_node_RemoveNode(p_parent_node, p_rdh_slave->p_node);
-                input_item_node_Delete(p_rdh_slave->p_node);
-                p_rdh_slave->p_node = NULL;
+                const char *psz_sub = psz_name + start;
+                size_t lo = 0, hi = i_masters;
+
+                /* Find the first master named after the substring */
+                while (lo < hi)
+                {
+                    size_t mid = (lo + hi) / 2;
+
+                    if (rdh_master_cmp_sub(&p_masters[mid], psz_sub, len) < 0)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+
+                for (; lo < i_masters
+                    && rdh_master_cmp_sub(&p_masters[lo], psz_sub, len) == 0;
+                     lo++)
+                {
+                    struct rdh_match match = {
+                        .i_index = p_masters[lo].i_index,
+                        .i_slave = j,
+                    };
+
+                    if (!vlc_vector_push(&matches, match))
+                    {
+                        vlc_vector_destroy(&matches);
+                        return VLC_ENOMEM;
+                    }
+                }
             }
+    }
+
+    /* Match in the node order, then in the slaves order */
+    qsort(matches.data, matches.size, sizeof (*matches.data), rdh_match_cmp);
+
+    *pp_matches = matches.data;
+    *pi_matches = matches.size;
+    return VLC_SUCCESS;
+}
+
+static int rdh_attach_matching_slaves(struct vlc_readdir_helper *p_rdh,
+                                      input_item_node_t *p_parent_node)
+{
+    struct rdh_master *p_masters =
+        vlc_alloc(p_parent_node->i_children, sizeof (*p_masters));
+    size_t i_masters = 0;
+    int i_ret = VLC_ENOMEM;
+
+    if (p_masters == NULL)
+        return VLC_ENOMEM;
+
+    for (int i = 0; i < p_parent_node->i_children; i++)
+    {
+        input_item_t *p_item = p_parent_node->pp_children[i]->p_item;
+
+        if (!rdh_is_master(p_item))
+            continue;
+
+        char *psz_name = rdh_name_from_filename(p_item->psz_name);
+        if (psz_name == NULL)
+            goto end;
+
+        p_masters[i_masters].psz_name = psz_name;
+        p_masters[i_masters].i_index = i;
+        i_masters++;
+    }
+    qsort(p_masters, i_masters, sizeof (*p_masters), rdh_master_cmp);
+
+    struct rdh_match *p_matches;
+    size_t i_matches;
+
+    i_ret = rdh_match_slaves(p_rdh, p_masters, i_masters,
+                             &p_matches, &i_matches);
+    if (i_ret != VLC_SUCCESS)
+        goto end;
+
+    /* The slave nodes are removed while matching: keep the nodes */
+    input_item_node_t **pp_nodes =
+        vlc_alloc(p_parent_node->i_children, sizeof (*pp_nodes));
+    if (pp_nodes == NULL)
+    {
+        free(p_matches);
+        i_ret = VLC_ENOMEM;
+        goto end;
+    }
+    memcpy(pp_nodes, p_parent_node->pp_children,
+           p_parent_node->i_children * sizeof (*pp_nodes));
+
+    for (size_t i = 0; i < i_matches; i++)
+    {
+        const struct rdh_match *p_match = &p_matches[i];
+
+        if (i > 0 && p_match->i_index == p_matches[i - 1].i_index
+         && p_match->i_slave == p_matches[i - 1].i_slave)
+            continue; /* duplicate */
+
+        if (rdh_attach_slave(p_rdh, p_parent_node, pp_nodes[p_match->i_index],
+                             p_rdh->pp_slaves[p_match->i_slave]))
+        {
+            /* Skip the other slaves of this item */
+            while (i + 1 < i_matches
+                && p_matches[i + 1].i_index == p_match->i_index)
+                i++;
+        }
+    }
+    free(pp_nodes);
+    free(p_matches);
+
+end:
+    for (size_t i = 0; i < i_masters; i++)
+        free(p_masters[i].psz_name);
+    free(p_masters);
+    return i_ret;
+}
+
+static void rdh_attach_slaves(struct vlc_readdir_helper *p_rdh,
+                              input_item_node_t *p_parent_node)
+{
+    if (p_rdh->i_sub_autodetect_fuzzy == 0 || p_rdh->i_slaves == 0
+     || p_parent_node->i_children == 0)
+        return;
+
+    /* Try to match slaves for each items of the node. Unless any slave
+     * can match, only the items named like a slave need to be tried. */
+    if (p_rdh->i_sub_autodetect_fuzzy >= SLAVE_PRIORITY_MATCH_RIGHT)
+        rdh_attach_matching_slaves(p_rdh, p_parent_node);
+    else
+    {
+        for (int i = 0; i < p_parent_node->i_children; i++)
+        {
+            input_item_node_t *p_node = p_parent_node->pp_children[i];
+
+            if (!rdh_is_master(p_node->p_item))
+                continue;
 
-            p_rdh_slave->p_slave->i_priority = i_priority;
+            for (size_t j = 0; j < p_rdh->i_slaves; j++)
+                if (rdh_attach_slave(p_rdh, p_parent_node, p_node,
+                                     p_rdh->pp_slaves[j]))
+                    break;
         }
     }
 
@@ -1765,6 +1989,51 @@ static int rdh_unflatten(struct vlc_readdir_helper *p_rdh,
     return VLC_SUCCESS;
 }
 
+/* Notify the items read at least by this number, or after this delay, so that
+ * large or slow directories are listed progressively */
+#define RDH_READ_BATCH 512
+#define RDH_READ_DELAY VLC_TICK_FROM_MS(100)
+
+static void rdh_notify_read(struct vlc_readdir_helper *p_rdh)
+{
+    input_item_node_t *p_node = p_rdh->p_node;
+
+    if (p_rdh->i_read > 0 || p_rdh->i_read_held > 0)
+        p_node->pf_read(p_node, p_rdh->pp_read, p_rdh->i_read,
+                        p_rdh->i_read_total, p_node->p_read_data);
+    p_rdh->i_read = 0;
+    p_rdh->i_read_held = 0;
+    p_rdh->i_read_date = vlc_tick_now();
+}
+
+static int rdh_push_read(struct vlc_readdir_helper *p_rdh, input_item_t *p_item)
+{
+    if (p_rdh->pp_read == NULL)
+    {
+        p_rdh->pp_read = vlc_alloc(RDH_READ_BATCH, sizeof (*p_rdh->pp_read));
+        if (unlikely(p_rdh->pp_read == NULL))
+            return VLC_ENOMEM;
+    }
+    if (p_rdh->i_read == RDH_READ_BATCH)
+        rdh_notify_read(p_rdh);
+    p_rdh->pp_read[p_rdh->i_read++] = p_item;
+    return VLC_SUCCESS;
+}
+
+/* Notifies the items held as possible slaves that were not attached */
+static void rdh_flush_held(struct vlc_readdir_helper *p_rdh)
+{
+    for (size_t i = 0; i < p_rdh->i_slaves; i++)
+    {
+        struct rdh_slave *p_rdh_slave = p_rdh->pp_slaves[i];
+
+        if (p_rdh_slave->b_held && p_rdh_slave->p_node != NULL
+         && rdh_push_read(p_rdh, p_rdh_slave->p_node->p_item) != VLC_SUCCESS)
+            break;
+    }
+    rdh_notify_read(p_rdh);
+}
+
 #undef vlc_readdir_helper_init
 void vlc_readdir_helper_init(struct vlc_readdir_helper *p_rdh,
                              vlc_object_t *p_obj, input_item_node_t *p_node)
@@ -1789,6 +2058,11 @@ void vlc_readdir_helper_init(struct vlc_readdir_helper *p_rdh,
     p_rdh->b_flatten = var_InheritBool(p_obj, "extractor-flatten");
     TAB_INIT(p_rdh->i_slaves, p_rdh->pp_slaves);
     TAB_INIT(p_rdh->i_dirs, p_rdh->pp_dirs);
+    p_rdh->pp_read = NULL;
+    p_rdh->i_read = 0;
+    p_rdh->i_read_held = 0;
+    p_rdh->i_read_total = 0;
+    p_rdh->i_read_date = vlc_tick_now();
 
     if (p_var_obj != NULL)
         vlc_object_delete(p_var_obj);
@@ -1798,8 +2072,12 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
 {
     if (b_success)
     {
+        /* Sort once, when all the items are read */
         rdh_sort(p_rdh->p_node);
         rdh_attach_slaves(p_rdh, p_rdh->p_node);
+
+        if (p_rdh->p_node->pf_read != NULL)
+            rdh_flush_held(p_rdh);
     }
     free(p_rdh->psz_ignored_exts);
 
@@ -1811,6 +2089,7 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
         {
             input_item_slave_Delete(p_rdh_slave->p_slave);
             free(p_rdh_slave->psz_filename);
+            free(p_rdh_slave->psz_name);
             free(p_rdh_slave);
         }
     }
@@ -1819,6 +2098,7 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
     for (size_t i = 0; i < p_rdh->i_dirs; i++)
         free(p_rdh->pp_dirs[i]);
     TAB_CLEAN(p_rdh->i_dirs, p_rdh->pp_dirs);
+    free(p_rdh->pp_read);
 }
 
 int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
@@ -1830,6 +2110,13 @@ int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
     struct rdh_slave *p_rdh_slave = NULL;
     assert(psz_flatpath || psz_filename);
 
+    /* Notify the previous items, now that the caller is done with them */
+    size_t i_pending = p_rdh->i_read + p_rdh->i_read_held;
+    if (i_pending >= RDH_READ_BATCH
+     || (i_pending > 0
+      && vlc_tick_now() - p_rdh->i_read_date >= RDH_READ_DELAY))
+        rdh_notify_read(p_rdh);
+
     if (!p_rdh->b_flatten)
     {
         if (psz_filename == NULL)
@@ -1856,12 +2143,18 @@ int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
             return VLC_ENOMEM;
 
         p_rdh_slave->p_node = NULL;
+        p_rdh_slave->b_held = false;
         p_rdh_slave->psz_filename = strdup(psz_filename);
+        p_rdh_slave->psz_name = rdh_name_from_filename(psz_filename);
         p_rdh_slave->p_slave = input_item_slave_New(psz_uri, i_slave_type,
                                                       SLAVE_PRIORITY_MATCH_NONE);
-        if (!p_rdh_slave->p_slave || !p_rdh_slave->psz_filename)
+        if (!p_rdh_slave->p_slave || !p_rdh_slave->psz_filename
+         || !p_rdh_slave->psz_name)
         {
+            if (p_rdh_slave->p_slave)
+                input_item_slave_Delete(p_rdh_slave->p_slave);
             free(p_rdh_slave->psz_filename);
+            free(p_rdh_slave->psz_name);
             free(p_rdh_slave);
             return VLC_ENOMEM;
         }
@@ -1890,6 +2183,7 @@ int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
     if (p_item == NULL)
         return VLC_ENOMEM;
 
+    const bool b_top = p_node == p_rdh->p_node;
     input_item_CopyOptions(p_item, p_node->p_item);
     p_node = input_item_node_AppendItem(p_node, p_item);
     input_item_Release(p_item);
@@ -1901,6 +2195,24 @@ int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
      * slaves will be ignored by rdh_file_is_ignored() */
     if (p_rdh_slave != NULL)
         p_rdh_slave->p_node = p_node;
+    if (b_top && p_rdh->p_node->pf_read != NULL)
+    {
+        p_rdh->i_read_total++;
+
+        /* Slaves may be removed from the node, so only count them until
+         * they are matched */
+        if (p_rdh_slave != NULL)
+        {
+            p_rdh_slave->b_held = true;
+            p_rdh->i_read_held++;
+        }
+        else
+        {
+            int i_ret = rdh_push_read(p_rdh, p_item);
+            if (i_ret != VLC_SUCCESS)
+                return i_ret;
+        }
+    }
 
     if (created_item != NULL)
         *created_item = p_item;
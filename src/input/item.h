@@ -30,6 +30,17 @@ void input_item_SetErrorWhenReading( input_item_t *p_i, bool b_error );
 void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt );
 bool input_item_ShouldPreparseSubItems( input_item_t *p_i );
 
+struct demux_probe_cache;
+
+/**
+ * Parses an item like input_item_Parse(), sharing a demux probe cache
+ * between the parsers.
+ */
+input_item_parser_id_t *
+input_item_ParseCached(input_item_t *item, vlc_object_t *obj,
+                       const input_item_parser_cbs_t *cbs, void *userdata,
+                       struct demux_probe_cache *probe_cache);
+
 typedef struct input_item_owner
 {
     input_item_t item;
@@ -0,0 +1,995 @@
+/*****************************************************************************
+ * pretune.c: background opening of the playlist neighbours
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_input_item.h>
+#include <vlc_mouse.h>
+#include <vlc_block.h>
+#include <vlc_meta.h>
+#include <vlc_epg.h>
+
+#include "../misc/interrupt.h"
+#include "demux.h"
+#include "pretune.h"
+
+/*
+ * A pre-tuned item is opened with its own access and demuxer, exactly as the
+ * input thread would, but the demuxer sends to a caching ES output instead
+ * of the decoders. Once the input thread adopts the demuxer, the cache is
+ * replayed to the real ES output and the caching ES output only forwards.
+ */
+
+struct es_out_id_t
+{
+    struct vlc_list node; /**< node of input_pretune_t.es */
+    es_format_t fmt;
+    decoder_t *packetizer; /**< finds the key frames of unpacketized video */
+    bool packetize; /**< a packetizer is still to be created */
+    es_out_id_t *id; /**< ES of the adopting output */
+};
+
+struct pretune_cmd
+{
+    struct vlc_list node; /**< node of input_pretune_t.cmds */
+    es_out_id_t *es; /**< NULL for a PCR */
+    block_t *block;
+    int group; /**< -1 for ES_OUT_SET_PCR */
+    vlc_tick_t pcr;
+};
+
+/* Program, metadata and EPG controls, replayed before the ES */
+struct pretune_ctrl
+{
+    struct vlc_list node; /**< node of input_pretune_t.ctrls */
+    int query;
+    int group;
+    union
+    {
+        vlc_meta_t *meta;
+        vlc_epg_t *epg;
+        vlc_epg_event_t *event;
+        int64_t time;
+    };
+};
+
+struct input_pretune_t
+{
+    struct vlc_object_t obj;
+
+    input_item_t *item;
+    char *url;
+    char *demux_name;
+    demux_t *demux;
+
+    es_out_t out;
+    es_out_t *target; /**< adopting output, NULL while pre-tuning */
+
+    vlc_mutex_t lock;
+    struct vlc_list es;
+    struct vlc_list cmds;
+    struct vlc_list ctrls;
+    es_out_id_t *video; /**< first video ES, the cache starts on its key frames */
+    size_t size;
+    size_t max_size;
+    bool wait_keyframe; /**< the video is dropped up to its next key frame */
+    bool ready; /**< opened and neither failed nor reached the end */
+    bool live; /**< demuxed continuously, otherwise only kept opened */
+    vlc_cond_t wait; /**< signaled on live or stop changes */
+
+    vlc_thread_t thread;
+    vlc_interrupt_t interrupt;
+    atomic_bool stop;
+    bool started;
+    bool joined;
+    bool adopted;
+};
+
+static void
+PreTuneDropCmd(input_pretune_t *pt, struct pretune_cmd *cmd)
+{
+    if (cmd->block)
+    {
+        pt->size -= cmd->block->i_buffer;
+        block_Release(cmd->block);
+    }
+    vlc_list_remove(&cmd->node);
+    free(cmd);
+}
+
+static void
+PreTuneDropUntil(input_pretune_t *pt, struct pretune_cmd *end)
+{
+    struct pretune_cmd *cmd;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+    {
+        if (cmd == end)
+            break;
+        PreTuneDropCmd(pt, cmd);
+    }
+}
+
+/* Drops everything preceding the last PCR */
+static void
+PreTuneCut(input_pretune_t *pt)
+{
+    struct pretune_cmd *cmd, *last = NULL;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+        if (cmd->es == NULL)
+            last = cmd;
+
+    if (last != NULL)
+        PreTuneDropUntil(pt, last);
+}
+
+static bool
+PreTuneIsKeyFrame(input_pretune_t *pt, const struct pretune_cmd *cmd)
+{
+    return cmd->es != NULL && cmd->es == pt->video
+        && (cmd->block->i_flags & BLOCK_FLAG_TYPE_I);
+}
+
+/* Drops the oldest GOP, up to the last PCR before the next key frame */
+static bool
+PreTuneCutGOP(input_pretune_t *pt)
+{
+    struct pretune_cmd *cmd, *first = NULL, *pcr = NULL;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+    {
+        if (first == NULL)
+            first = cmd;
+        else if (PreTuneIsKeyFrame(pt, cmd))
+        {
+            PreTuneDropUntil(pt, pcr != NULL ? pcr : cmd);
+            return true;
+        }
+        else if (cmd->es == NULL)
+            pcr = cmd;
+    }
+    return false;
+}
+
+static void
+PreTuneDropVideo(input_pretune_t *pt)
+{
+    struct pretune_cmd *cmd;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+        if (cmd->es != NULL && cmd->es == pt->video)
+            PreTuneDropCmd(pt, cmd);
+    pt->wait_keyframe = true;
+}
+
+static void
+PreTuneFlush(input_pretune_t *pt)
+{
+    struct pretune_cmd *cmd;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+        PreTuneDropCmd(pt, cmd);
+    assert(pt->size == 0);
+}
+
+static void
+PreTuneQueue(input_pretune_t *pt, struct pretune_cmd *cmd)
+{
+    vlc_list_append(&cmd->node, &pt->cmds);
+    if (cmd->block)
+        pt->size += cmd->block->i_buffer;
+
+    /* Over budget, the oldest GOP goes first. If the current one does not
+     * fit, the video restarts on the next key frame. The other data has no
+     * key frames and goes from the oldest. */
+    while (pt->size > pt->max_size)
+    {
+        if (pt->video != NULL)
+        {
+            if (PreTuneCutGOP(pt))
+                continue;
+            if (!pt->wait_keyframe)
+            {
+                PreTuneDropVideo(pt);
+                continue;
+            }
+        }
+
+        struct pretune_cmd *first =
+            vlc_list_first_entry_or_null(&pt->cmds, struct pretune_cmd, node);
+        assert(first != NULL);
+        PreTuneDropCmd(pt, first);
+    }
+}
+
+static void
+PreTuneQueueBlock(input_pretune_t *pt, es_out_id_t *id, block_t *block)
+{
+    if (id == pt->video)
+    {
+        if (block->i_flags & BLOCK_FLAG_TYPE_I)
+        {
+            pt->wait_keyframe = false;
+            PreTuneCut(pt);
+        }
+        else if (pt->wait_keyframe)
+        {
+            block_Release(block);
+            return;
+        }
+    }
+
+    struct pretune_cmd *cmd = malloc(sizeof(*cmd));
+    if (unlikely(cmd == NULL))
+    {
+        block_Release(block);
+        return;
+    }
+    cmd->es = id;
+    cmd->block = block;
+    PreTuneQueue(pt, cmd);
+}
+
+static void
+PreTuneQueuePCR(input_pretune_t *pt, int group, vlc_tick_t pcr)
+{
+    /* Without video, only the last PCR interval is kept */
+    if (pt->video == NULL)
+        PreTuneCut(pt);
+
+    struct pretune_cmd *cmd = malloc(sizeof(*cmd));
+    if (unlikely(cmd == NULL))
+        return;
+    cmd->es = NULL;
+    cmd->block = NULL;
+    cmd->group = group;
+    cmd->pcr = pcr;
+    PreTuneQueue(pt, cmd);
+}
+
+static void
+PreTuneSendTarget(input_pretune_t *pt, es_out_id_t *id, block_t *block)
+{
+    if (id->id != NULL)
+        es_out_Send(pt->target, id->id, block);
+    else
+        block_Release(block);
+}
+
+static void
+PreTunePacketize(input_pretune_t *pt, es_out_id_t *id, block_t **pp_block)
+{
+    block_t *out_block;
+    while ((out_block = id->packetizer->pf_packetize(id->packetizer,
+                                                      pp_block)))
+    {
+        while (out_block)
+        {
+            block_t *next = out_block->p_next;
+            out_block->p_next = NULL;
+            if (pt->target)
+                PreTuneSendTarget(pt, id, out_block);
+            else
+                PreTuneQueueBlock(pt, id, out_block);
+            out_block = next;
+        }
+    }
+}
+
+static void
+PreTuneDelPacketizer(input_pretune_t *pt, es_out_id_t *id)
+{
+    if (id->packetizer == NULL)
+        return;
+
+    /* Drain the last access unit */
+    if (pt->target)
+        PreTunePacketize(pt, id, NULL);
+    demux_PacketizerDestroy(id->packetizer);
+    id->packetizer = NULL;
+}
+
+static es_out_id_t *
+PreTuneAdd(es_out_t *out, input_source_t *in, const es_format_t *fmt)
+{
+    input_pretune_t *pt = container_of(out, input_pretune_t, out);
+    VLC_UNUSED(in);
+
+    es_out_id_t *id = malloc(sizeof(*id));
+    if (unlikely(id == NULL))
+        return NULL;
+
+    if (es_format_Copy(&id->fmt, fmt) != VLC_SUCCESS)
+    {
+        free(id);
+        return NULL;
+    }
+    id->packetizer = NULL;
+    id->packetize = fmt->i_cat == VIDEO_ES && !fmt->b_packetized;
+    id->id = NULL;
+
+    vlc_mutex_lock(&pt->lock);
+    if (pt->target)
+        id->id = es_out_Add(pt->target, fmt);
+    else if (fmt->i_cat == VIDEO_ES && pt->video == NULL)
+        pt->video = id;
+    vlc_list_append(&id->node, &pt->es);
+    vlc_mutex_unlock(&pt->lock);
+    return id;
+}
+
+static int
+PreTuneSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    input_pretune_t *pt = container_of(out, input_pretune_t, out);
+
+    vlc_mutex_lock(&pt->lock);
+    /* The packetizer is only created while pre-tuning: the adopting output
+     * then receives packetized data until the format changes */
+    if (!pt->target && id->packetize && pt->demux != NULL)
+    {
+        es_format_t fmt;
+        if (es_format_Copy(&fmt, &id->fmt) == VLC_SUCCESS)
+            id->packetizer = demux_PacketizerNew(pt->demux, &fmt, "pretune");
+        id->packetize = false;
+    }
+
+    if (id->packetizer)
+        PreTunePacketize(pt, id, &block);
+    else if (pt->target)
+        PreTuneSendTarget(pt, id, block);
+    else
+        PreTuneQueueBlock(pt, id, block);
+    vlc_mutex_unlock(&pt->lock);
+    return VLC_SUCCESS;
+}
+
+static void
+PreTuneDelLocked(input_pretune_t *pt, es_out_id_t *id)
+{
+    PreTuneDelPacketizer(pt, id);
+
+    if (pt->target)
+    {
+        if (id->id != NULL)
+            es_out_Del(pt->target, id->id);
+    }
+    else
+    {
+        struct pretune_cmd *cmd;
+        vlc_list_foreach(cmd, &pt->cmds, node)
+            if (cmd->es == id)
+                PreTuneDropCmd(pt, cmd);
+    }
+
+    if (pt->video == id)
+    {
+        pt->video = NULL;
+        pt->wait_keyframe = false;
+    }
+    es_format_Clean(&id->fmt);
+    vlc_list_remove(&id->node);
+    free(id);
+}
+
+static void
+PreTuneDel(es_out_t *out, es_out_id_t *id)
+{
+    input_pretune_t *pt = container_of(out, input_pretune_t, out);
+
+    vlc_mutex_lock(&pt->lock);
+    PreTuneDelLocked(pt, id);
+    vlc_mutex_unlock(&pt->lock);
+}
+
+static int
+PreTuneSetFmt(input_pretune_t *pt, es_out_id_t *id, const es_format_t *fmt)
+{
+    es_format_t copy;
+    if (es_format_Copy(&copy, fmt) != VLC_SUCCESS)
+        return VLC_ENOMEM;
+
+    PreTuneDelPacketizer(pt, id);
+    es_format_Clean(&id->fmt);
+    id->fmt = copy;
+    id->packetize = !pt->target && copy.i_cat == VIDEO_ES
+                 && !copy.b_packetized;
+    return VLC_SUCCESS;
+}
+
+static void
+PreTuneDropCtrl(struct pretune_ctrl *ctrl)
+{
+    switch (ctrl->query)
+    {
+        case ES_OUT_SET_META:
+        case ES_OUT_SET_GROUP_META:
+            vlc_meta_Delete(ctrl->meta);
+            break;
+        case ES_OUT_SET_GROUP_EPG:
+            vlc_epg_Delete(ctrl->epg);
+            break;
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+            vlc_epg_event_Delete(ctrl->event);
+            break;
+    }
+    vlc_list_remove(&ctrl->node);
+    free(ctrl);
+}
+
+/* Whether a new control overrides a cached one */
+static bool
+PreTuneCtrlReplaces(const struct pretune_ctrl *ctrl,
+                    const struct pretune_ctrl *old)
+{
+    if (ctrl->query == ES_OUT_DEL_GROUP)
+        return old->group == ctrl->group;
+    if (ctrl->query != old->query)
+        return false;
+
+    switch (ctrl->query)
+    {
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+            return old->group == ctrl->group;
+        case ES_OUT_SET_GROUP_EPG:
+            return old->group == ctrl->group
+                && old->epg->i_id == ctrl->epg->i_id
+                && old->epg->i_source_id == ctrl->epg->i_source_id;
+        default:
+            /* SET_GROUP, SET_META and SET_EPG_TIME */
+            return true;
+    }
+}
+
+static int
+PreTuneCacheCtrl(input_pretune_t *pt, int query, va_list args)
+{
+    struct pretune_ctrl *ctrl = malloc(sizeof(*ctrl));
+    if (unlikely(ctrl == NULL))
+        return VLC_ENOMEM;
+
+    ctrl->query = query;
+    ctrl->group = -1;
+    switch (query)
+    {
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_DEL_GROUP:
+            ctrl->group = va_arg(args, int);
+            break;
+        case ES_OUT_SET_GROUP_META:
+            ctrl->group = va_arg(args, int);
+            /* fall through */
+        case ES_OUT_SET_META:
+            ctrl->meta = vlc_meta_New();
+            if (ctrl->meta == NULL)
+                goto error;
+            vlc_meta_Merge(ctrl->meta, va_arg(args, const vlc_meta_t *));
+            break;
+        case ES_OUT_SET_GROUP_EPG:
+            ctrl->group = va_arg(args, int);
+            ctrl->epg = vlc_epg_Duplicate(va_arg(args, const vlc_epg_t *));
+            if (ctrl->epg == NULL)
+                goto error;
+            break;
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+            ctrl->group = va_arg(args, int);
+            ctrl->event =
+                vlc_epg_event_Duplicate(va_arg(args, const vlc_epg_event_t *));
+            if (ctrl->event == NULL)
+                goto error;
+            break;
+        case ES_OUT_SET_EPG_TIME:
+            ctrl->time = va_arg(args, int64_t);
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    /* Only the latest state is replayed */
+    struct pretune_ctrl *old;
+    vlc_list_foreach(old, &pt->ctrls, node)
+        if (PreTuneCtrlReplaces(ctrl, old))
+            PreTuneDropCtrl(old);
+
+    /* A deleted group has nothing left to replay */
+    if (query == ES_OUT_DEL_GROUP)
+        free(ctrl);
+    else
+        vlc_list_append(&ctrl->node, &pt->ctrls);
+    return VLC_SUCCESS;
+
+error:
+    free(ctrl);
+    return VLC_ENOMEM;
+}
+
+static void
+PreTuneReplayCtrl(es_out_t *out, const struct pretune_ctrl *ctrl)
+{
+    switch (ctrl->query)
+    {
+        case ES_OUT_SET_GROUP:
+            es_out_Control(out, ctrl->query, ctrl->group);
+            break;
+        case ES_OUT_SET_META:
+            es_out_Control(out, ctrl->query, ctrl->meta);
+            break;
+        case ES_OUT_SET_GROUP_META:
+            es_out_Control(out, ctrl->query, ctrl->group, ctrl->meta);
+            break;
+        case ES_OUT_SET_GROUP_EPG:
+            es_out_Control(out, ctrl->query, ctrl->group, ctrl->epg);
+            break;
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+            es_out_Control(out, ctrl->query, ctrl->group, ctrl->event);
+            break;
+        case ES_OUT_SET_EPG_TIME:
+            es_out_Control(out, ctrl->query, ctrl->time);
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
+static int
+PreTuneControlCache(input_pretune_t *pt, int query, va_list args)
+{
+    switch (query)
+    {
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_DEL_GROUP:
+        case ES_OUT_SET_META:
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG:
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+        case ES_OUT_SET_EPG_TIME:
+            return PreTuneCacheCtrl(pt, query, args);
+        case ES_OUT_GET_ES_STATE:
+        {
+            /* Everything is buffered, the selection is done once adopted */
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_SET_PCR:
+        {
+            vlc_tick_t pcr = va_arg(args, vlc_tick_t);
+            PreTuneQueuePCR(pt, -1, pcr);
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_SET_GROUP_PCR:
+        {
+            int group = va_arg(args, int);
+            vlc_tick_t pcr = va_arg(args, vlc_tick_t);
+            PreTuneQueuePCR(pt, group, pcr);
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_RESET_PCR:
+        {
+            es_out_id_t *id;
+            vlc_list_foreach(id, &pt->es, node)
+                if (id->packetizer && id->packetizer->pf_flush)
+                    id->packetizer->pf_flush(id->packetizer);
+            PreTuneFlush(pt);
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_SET_ES_FMT:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            const es_format_t *fmt = va_arg(args, const es_format_t *);
+            return PreTuneSetFmt(pt, id, fmt);
+        }
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static int
+PreTuneControlForward(input_pretune_t *pt, int query, va_list args)
+{
+    es_out_t *target = pt->target;
+
+    switch (query)
+    {
+        case ES_OUT_SET_ES:
+        case ES_OUT_UNSET_ES:
+        case ES_OUT_RESTART_ES:
+        case ES_OUT_SET_ES_DEFAULT:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            return id->id ? es_out_Control(target, query, id->id)
+                          : VLC_EGENERIC;
+        }
+        case ES_OUT_SET_ES_STATE:
+        case ES_OUT_SET_ES_SCRAMBLED_STATE:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            int state = va_arg(args, int);
+            return id->id ? es_out_Control(target, query, id->id, state)
+                          : VLC_EGENERIC;
+        }
+        case ES_OUT_GET_ES_STATE:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            bool *state = va_arg(args, bool *);
+            if (id->id == NULL)
+            {
+                *state = false;
+                return VLC_SUCCESS;
+            }
+            return es_out_Control(target, query, id->id, state);
+        }
+        case ES_OUT_SET_ES_FMT:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            const es_format_t *fmt = va_arg(args, const es_format_t *);
+            int ret = PreTuneSetFmt(pt, id, fmt);
+            if (ret != VLC_SUCCESS || id->id == NULL)
+                return ret;
+            return es_out_Control(target, query, id->id, fmt);
+        }
+        case ES_OUT_VOUT_SET_MOUSE_EVENT:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            vlc_mouse_event cb = va_arg(args, vlc_mouse_event);
+            void *opaque = va_arg(args, void *);
+            return id->id ? es_out_Control(target, query, id->id, cb, opaque)
+                          : VLC_EGENERIC;
+        }
+        case ES_OUT_VOUT_ADD_OVERLAY:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            subpicture_t *sub = va_arg(args, subpicture_t *);
+            size_t *channel = va_arg(args, size_t *);
+            return id->id ? es_out_Control(target, query, id->id, sub, channel)
+                          : VLC_EGENERIC;
+        }
+        case ES_OUT_VOUT_DEL_OVERLAY:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            size_t channel = va_arg(args, size_t);
+            return id->id ? es_out_Control(target, query, id->id, channel)
+                          : VLC_EGENERIC;
+        }
+        case ES_OUT_SPU_SET_HIGHLIGHT:
+        {
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            const vlc_spu_highlight_t *hl =
+                va_arg(args, const vlc_spu_highlight_t *);
+            return id->id ? es_out_Control(target, query, id->id, hl)
+                          : VLC_EGENERIC;
+        }
+        default:
+            return es_out_vaControl(target, query, args);
+    }
+}
+
+static int
+PreTuneControl(es_out_t *out, input_source_t *in, int query, va_list args)
+{
+    input_pretune_t *pt = container_of(out, input_pretune_t, out);
+    VLC_UNUSED(in);
+
+    vlc_mutex_lock(&pt->lock);
+    int ret = pt->target ? PreTuneControlForward(pt, query, args)
+                         : PreTuneControlCache(pt, query, args);
+    vlc_mutex_unlock(&pt->lock);
+    return ret;
+}
+
+static void
+PreTuneDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks pretune_es_out_cbs =
+{
+    .add = PreTuneAdd,
+    .send = PreTuneSend,
+    .del = PreTuneDel,
+    .control = PreTuneControl,
+    .destroy = PreTuneDestroy,
+};
+
+static demux_t *
+PreTuneOpen(input_pretune_t *pt)
+{
+    vlc_object_t *obj = VLC_OBJECT(pt);
+
+    stream_t *stream = stream_AccessNew(obj, NULL, &pt->out, false, pt->url);
+    if (stream == NULL)
+        return NULL;
+
+    stream = stream_FilterAutoNew(stream);
+    if (stream->pf_read == NULL && stream->pf_block == NULL
+     && stream->pf_readdir == NULL)
+        /* Combined access/demux */
+        return stream;
+
+    char *filters = var_InheritString(obj, "stream-filter");
+    if (filters != NULL)
+    {
+        stream = stream_FilterChainNew(stream, filters);
+        free(filters);
+    }
+
+    demux_t *demux = demux_NewAdvanced(obj, NULL, pt->demux_name, pt->url,
+                                       stream, &pt->out, false);
+    if (demux == NULL)
+        vlc_stream_Delete(stream);
+    return demux;
+}
+
+static void *
+PreTuneThread(void *data)
+{
+    input_pretune_t *pt = data;
+
+    vlc_interrupt_set(&pt->interrupt);
+
+    demux_t *demux = PreTuneOpen(pt);
+    if (demux == NULL)
+    {
+        msg_Dbg(pt, "cannot pre-tune %s", pt->url);
+        return NULL;
+    }
+
+    bool can_pace;
+    if (demux_Control(demux, DEMUX_CAN_CONTROL_PACE, &can_pace))
+        can_pace = false;
+
+    vlc_mutex_lock(&pt->lock);
+    pt->demux = demux;
+    pt->ready = true;
+    vlc_mutex_unlock(&pt->lock);
+
+    /* Files are read on demand, only the opening is worth saving. Threaded
+     * demuxers and directories do not need to be driven. */
+    if (can_pace || demux->pf_demux == NULL)
+        return NULL;
+
+    while (!atomic_load(&pt->stop))
+    {
+        /* Out of the live budget, the stale data is not kept */
+        vlc_mutex_lock(&pt->lock);
+        if (!pt->live)
+        {
+            PreTuneFlush(pt);
+            pt->wait_keyframe = pt->video != NULL;
+            while (!pt->live && !atomic_load(&pt->stop))
+                vlc_cond_wait(&pt->wait, &pt->lock);
+        }
+        vlc_mutex_unlock(&pt->lock);
+
+        /* A read interrupted by the adoption is not the end of the stream */
+        if (!atomic_load(&pt->stop) && demux_Demux(demux) <= 0
+         && !atomic_load(&pt->stop))
+        {
+            vlc_mutex_lock(&pt->lock);
+            pt->ready = false;
+            vlc_mutex_unlock(&pt->lock);
+            break;
+        }
+    }
+    return NULL;
+}
+
+input_pretune_t *
+input_pretune_New(vlc_object_t *parent, input_item_t *item, size_t max_size,
+                  bool live)
+{
+    input_pretune_t *pt = vlc_custom_create(parent, sizeof(*pt), "pretune");
+    if (unlikely(pt == NULL))
+        return NULL;
+
+    vlc_mutex_lock(&item->lock);
+    pt->url = item->psz_uri ? strdup(item->psz_uri) : NULL;
+    vlc_mutex_unlock(&item->lock);
+    if (pt->url == NULL)
+    {
+        vlc_object_delete(pt);
+        return NULL;
+    }
+
+    /* Access and demux options, as the input would see them */
+    input_item_ApplyOptions(VLC_OBJECT(pt), item);
+    pt->demux_name = var_InheritString(pt, "demux");
+    if (pt->demux_name == NULL)
+        pt->demux_name = strdup("any");
+    if (unlikely(pt->demux_name == NULL))
+    {
+        free(pt->url);
+        vlc_object_delete(pt);
+        return NULL;
+    }
+
+    pt->item = input_item_Hold(item);
+    pt->demux = NULL;
+    pt->out.cbs = &pretune_es_out_cbs;
+    pt->target = NULL;
+    vlc_mutex_init(&pt->lock);
+    vlc_list_init(&pt->es);
+    vlc_list_init(&pt->cmds);
+    vlc_list_init(&pt->ctrls);
+    pt->video = NULL;
+    pt->size = 0;
+    pt->max_size = max_size;
+    pt->wait_keyframe = false;
+    pt->ready = false;
+    pt->live = live;
+    vlc_cond_init(&pt->wait);
+    vlc_interrupt_init(&pt->interrupt);
+    atomic_init(&pt->stop, false);
+    pt->started = false;
+    pt->joined = false;
+    pt->adopted = false;
+    return pt;
+}
+
+int
+input_pretune_Start(input_pretune_t *pt)
+{
+    if (atomic_load(&pt->stop))
+        return VLC_EGENERIC;
+
+    /* The thread handle is set before the demuxer can be adopted */
+    vlc_mutex_lock(&pt->lock);
+    int ret = vlc_clone(&pt->thread, PreTuneThread, pt,
+                        VLC_THREAD_PRIORITY_LOW);
+    pt->started = ret == 0;
+    vlc_mutex_unlock(&pt->lock);
+    return ret == 0 ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+void
+input_pretune_Stop(input_pretune_t *pt)
+{
+    vlc_mutex_lock(&pt->lock);
+    atomic_store(&pt->stop, true);
+    vlc_cond_signal(&pt->wait);
+    vlc_mutex_unlock(&pt->lock);
+    vlc_interrupt_kill(&pt->interrupt);
+}
+
+void
+input_pretune_SetLive(input_pretune_t *pt, bool live)
+{
+    vlc_mutex_lock(&pt->lock);
+    pt->live = live;
+    vlc_cond_signal(&pt->wait);
+    vlc_mutex_unlock(&pt->lock);
+}
+
+void
+input_pretune_Delete(input_pretune_t *pt)
+{
+    if (pt->started && !pt->joined)
+    {
+        input_pretune_Stop(pt);
+        vlc_join(pt->thread, NULL);
+    }
+
+    /* An adopted demuxer was deleted by the input */
+    if (!pt->adopted && pt->demux != NULL)
+        demux_Delete(pt->demux);
+
+    /* Not all the demuxers delete their ES */
+    es_out_id_t *id;
+    vlc_list_foreach(id, &pt->es, node)
+        PreTuneDelLocked(pt, id);
+    PreTuneFlush(pt);
+
+    struct pretune_ctrl *ctrl;
+    vlc_list_foreach(ctrl, &pt->ctrls, node)
+        PreTuneDropCtrl(ctrl);
+
+    vlc_interrupt_deinit(&pt->interrupt);
+    input_item_Release(pt->item);
+    free(pt->demux_name);
+    free(pt->url);
+    vlc_object_delete(pt);
+}
+
+input_item_t *
+input_pretune_GetItem(input_pretune_t *pt)
+{
+    return pt->item;
+}
+
+demux_t *
+input_pretune_Adopt(input_pretune_t *pt, const char *url, const char *demux)
+{
+    assert(!pt->joined);
+
+    if (strcmp(url, pt->url) || strcasecmp(demux, pt->demux_name))
+        return NULL;
+
+    /* Do not wait for an opening in progress: the input will open the item
+     * itself as fast */
+    vlc_mutex_lock(&pt->lock);
+    bool opened = pt->demux != NULL;
+    vlc_mutex_unlock(&pt->lock);
+    if (!opened)
+        return NULL;
+
+    /* Interrupt the current demux call, the demuxer goes on reading from
+     * the input thread */
+    input_pretune_Stop(pt);
+    vlc_join(pt->thread, NULL);
+    pt->joined = true;
+
+    if (!pt->ready)
+        return NULL;
+
+    pt->adopted = true;
+    return pt->demux;
+}
+
+void
+input_pretune_Replay(input_pretune_t *pt, es_out_t *out)
+{
+    assert(pt->adopted);
+
+    vlc_mutex_lock(&pt->lock);
+    assert(pt->target == NULL);
+    pt->target = out;
+
+    /* The programs exist before their ES are added */
+    struct pretune_ctrl *ctrl;
+    vlc_list_foreach(ctrl, &pt->ctrls, node)
+    {
+        PreTuneReplayCtrl(out, ctrl);
+        PreTuneDropCtrl(ctrl);
+    }
+
+    es_out_id_t *id;
+    vlc_list_foreach(id, &pt->es, node)
+        id->id = es_out_Add(out, id->packetizer ? &id->packetizer->fmt_out
+                                                : &id->fmt);
+
+    msg_Dbg(pt, "replaying %zu pre-tuned bytes", pt->size);
+
+    struct pretune_cmd *cmd;
+    vlc_list_foreach(cmd, &pt->cmds, node)
+    {
+        if (cmd->es != NULL)
+        {
+            pt->size -= cmd->block->i_buffer;
+            PreTuneSendTarget(pt, cmd->es, cmd->block);
+        }
+        else if (cmd->group < 0)
+            es_out_SetPCR(out, cmd->pcr);
+        else
+            es_out_Control(out, ES_OUT_SET_GROUP_PCR, cmd->group, cmd->pcr);
+        vlc_list_remove(&cmd->node);
+        free(cmd);
+    }
+    vlc_mutex_unlock(&pt->lock);
+}
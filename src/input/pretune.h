@@ -0,0 +1,92 @@
+/*****************************************************************************
+ * pretune.h: background opening of the playlist neighbours
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_PRETUNE_H
+#define LIBVLC_INPUT_PRETUNE_H 1
+
+#include <vlc_common.h>
+#include <vlc_es_out.h>
+
+typedef struct input_pretune_t input_pretune_t;
+
+/**
+ * Creates a pre-tuned item.
+ *
+ * Once started, the access and the demuxer of the item are opened in a
+ * background thread. If live, live streams are then demuxed continuously, and
+ * the data from the last video key frame onwards is kept, up to max_size
+ * bytes, so that playback can start from it as soon as the item is played.
+ * Otherwise, the item is only kept opened.
+ */
+input_pretune_t *input_pretune_New(vlc_object_t *parent, input_item_t *item,
+                                   size_t max_size, bool live);
+
+/**
+ * Starts the background thread of a pre-tuned item.
+ *
+ * Nothing is started once the pre-tuned item is stopped.
+ */
+int input_pretune_Start(input_pretune_t *);
+
+/**
+ * Interrupts the background thread of a pre-tuned item, without waiting.
+ */
+void input_pretune_Stop(input_pretune_t *);
+
+/**
+ * Starts or stops demuxing a pre-tuned item continuously.
+ *
+ * The data buffered so far is dropped when it stops.
+ */
+void input_pretune_SetLive(input_pretune_t *, bool live);
+
+/**
+ * Deletes a pre-tuned item.
+ *
+ * This waits for the background thread, that may still be opening the item.
+ * If the demuxer was adopted, this must be called after it is deleted.
+ */
+void input_pretune_Delete(input_pretune_t *);
+
+input_item_t *input_pretune_GetItem(input_pretune_t *);
+
+/**
+ * Hands the pre-tuned demuxer over to an input.
+ *
+ * The background thread is stopped, its demux call is interrupted. This does
+ * not wait for an opening in progress: the item is not ready then. The
+ * demuxer keeps on buffering until input_pretune_Replay() is called.
+ *
+ * @param url the URL the input would open, it must match the pre-tuned one
+ * @param demux the demuxer name the input would use
+ * @return the demuxer, or NULL if the item is not ready or does not match
+ */
+demux_t *input_pretune_Adopt(input_pretune_t *, const char *url,
+                             const char *demux);
+
+/**
+ * Replays the cached programs, metadata and EPG to the given ES output, then
+ * adds the ES and sends the buffered data to it.
+ *
+ * The adopted demuxer sends to the ES output from then on.
+ */
+void input_pretune_Replay(input_pretune_t *, es_out_t *out);
+
+#endif
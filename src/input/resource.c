@@ -36,6 +36,8 @@
 #include <vlc_spu.h>
 #include <vlc_aout.h>
 #include <vlc_sout.h>
+#include <vlc_vector.h>
+#include <vlc_executor.h>
 #include "../libvlc.h"
 #include "../stream_output/stream_output.h"
 #include "../audio_output/aout_internal.h"
@@ -84,6 +86,10 @@ struct input_resource_t
 
     bool            b_aout_busy;
     audio_output_t *p_aout;
+
+    /* Pre-tuned items, protected by lock */
+    struct VLC_VECTOR(input_pretune_t *) pretunes;
+    vlc_executor_t *pretune_worker; /**< created on first use */
 };
 
 #define resource_GetFirstVoutRsc(resource) \
@@ -304,6 +310,14 @@ void input_resource_ResetAout( input_resource_t *p_resource )
         aout_Destroy( p_aout );
 }
 
+void input_resource_StopFreeAout( input_resource_t *p_resource )
+{
+    vlc_mutex_lock( &p_resource->lock_hold );
+    if( p_resource->p_aout != NULL && !p_resource->b_aout_busy )
+        aout_DecStopParked( p_resource->p_aout );
+    vlc_mutex_unlock( &p_resource->lock_hold );
+}
+
 /* Common */
 input_resource_t *input_resource_New( vlc_object_t *p_parent )
 {
@@ -319,6 +333,7 @@ input_resource_t *input_resource_New( vlc_object_t *p_parent )
     }
 
     vlc_list_init( &p_resource->vout_rscs );
+    vlc_vector_init( &p_resource->pretunes );
 
     vlc_atomic_rc_init( &p_resource->rc );
     p_resource->p_parent = p_parent;
@@ -332,6 +347,18 @@ void input_resource_Release( input_resource_t *p_resource )
     if( !vlc_atomic_rc_dec( &p_resource->rc ) )
         return;
 
+    input_pretune_t *pt;
+    vlc_vector_foreach( pt, &p_resource->pretunes )
+        input_pretune_Stop( pt );
+    if( p_resource->pretune_worker != NULL )
+    {
+        vlc_executor_WaitIdle( p_resource->pretune_worker );
+        vlc_executor_Delete( p_resource->pretune_worker );
+    }
+    vlc_vector_foreach( pt, &p_resource->pretunes )
+        input_pretune_Delete( pt );
+    vlc_vector_destroy( &p_resource->pretunes );
+
     DestroySout( p_resource );
     DestroyVout( p_resource );
     if( p_resource->p_aout != NULL )
@@ -651,3 +678,164 @@ void input_resource_TerminateSout( input_resource_t *p_resource )
     DestroySout(p_resource);
     vlc_mutex_unlock( &p_resource->lock );
 }
+
+/* */
+struct pretune_task
+{
+    struct vlc_runnable runnable;
+    input_pretune_t *pt;
+    bool b_delete;
+};
+
+static void PreTuneTaskRun( void *userdata )
+{
+    struct pretune_task *task = userdata;
+
+    if( task->b_delete )
+        input_pretune_Delete( task->pt );
+    else
+        input_pretune_Start( task->pt );
+    free( task );
+}
+
+/* Deleting waits for the pre-tune thread, that may be opening its item:
+ * the worker starts and deletes the pre-tuned items off the caller thread,
+ * in order */
+static void PreTuneSubmitLocked( input_resource_t *p_resource,
+                                 input_pretune_t *pt, bool b_delete )
+{
+    vlc_mutex_assert( &p_resource->lock );
+
+    if( b_delete )
+        input_pretune_Stop( pt );
+
+    if( p_resource->pretune_worker == NULL )
+        p_resource->pretune_worker = vlc_executor_New( 1 );
+
+    struct pretune_task *task = NULL;
+    if( p_resource->pretune_worker != NULL )
+        task = malloc( sizeof(*task) );
+    if( unlikely(task == NULL) )
+    {
+        if( b_delete )
+            input_pretune_Delete( pt );
+        return;
+    }
+
+    task->runnable.run = PreTuneTaskRun;
+    task->runnable.userdata = task;
+    task->pt = pt;
+    task->b_delete = b_delete;
+    vlc_executor_Submit( p_resource->pretune_worker, &task->runnable );
+}
+
+static void PreTuneAddLocked( input_resource_t *p_resource,
+                              input_item_t *p_item, size_t i_max, bool b_live )
+{
+    input_pretune_t *pt = input_pretune_New( p_resource->p_parent, p_item,
+                                             i_max, b_live );
+    if( pt == NULL )
+        return;
+    if( !vlc_vector_push( &p_resource->pretunes, pt ) )
+    {
+        input_pretune_Delete( pt );
+        return;
+    }
+    PreTuneSubmitLocked( p_resource, pt, false );
+}
+
+void input_resource_SetPreTuned( input_resource_t *p_resource,
+                                 input_item_t *const *pp_items, size_t i_items,
+                                 input_item_t *p_current )
+{
+    const size_t i_max = (size_t)var_InheritInteger( p_resource->p_parent,
+                                                     "zap-ahead-memory" ) << 20;
+    /* The items are listed nearest first: only the nearest ones are demuxed
+     * continuously, the others are kept opened */
+    const size_t i_live = var_InheritInteger( p_resource->p_parent,
+                                              "zap-ahead-live" );
+
+    vlc_mutex_lock( &p_resource->lock );
+
+    /* Keep the pre-tuned items still listed */
+    for( size_t i = 0; i < p_resource->pretunes.size; )
+    {
+        input_pretune_t *pt = p_resource->pretunes.data[i];
+        input_item_t *p_item = input_pretune_GetItem( pt );
+        size_t j = 0;
+
+        while( j < i_items && pp_items[j] != p_item )
+            j++;
+        if( j < i_items || p_item == p_current )
+        {
+            input_pretune_SetLive( pt, j < i_live );
+            i++;
+            continue;
+        }
+        vlc_vector_remove( &p_resource->pretunes, i );
+        PreTuneSubmitLocked( p_resource, pt, true );
+    }
+
+    /* Start the new ones */
+    for( size_t j = 0; j < i_items; j++ )
+    {
+        input_pretune_t *pt;
+        bool b_found = pp_items[j] == p_current;
+
+        vlc_vector_foreach( pt, &p_resource->pretunes )
+            if( input_pretune_GetItem( pt ) == pp_items[j] )
+                b_found = true;
+        if( b_found )
+            continue;
+
+        PreTuneAddLocked( p_resource, pp_items[j], i_max, j < i_live );
+    }
+
+    vlc_mutex_unlock( &p_resource->lock );
+}
+
+input_pretune_t *input_resource_TakePreTuned( input_resource_t *p_resource,
+                                              input_item_t *p_item )
+{
+    input_pretune_t *pt = NULL;
+
+    vlc_mutex_lock( &p_resource->lock );
+    for( size_t i = 0; i < p_resource->pretunes.size; i++ )
+    {
+        if( input_pretune_GetItem( p_resource->pretunes.data[i] ) == p_item )
+        {
+            pt = p_resource->pretunes.data[i];
+            vlc_vector_remove( &p_resource->pretunes, i );
+            break;
+        }
+    }
+    vlc_mutex_unlock( &p_resource->lock );
+    return pt;
+}
+
+void input_resource_AddPreTuned( input_resource_t *p_resource,
+                                 input_item_t *p_item )
+{
+    const size_t i_max = (size_t)var_InheritInteger( p_resource->p_parent,
+                                                     "zap-ahead-memory" ) << 20;
+    input_pretune_t *pt;
+
+    vlc_mutex_lock( &p_resource->lock );
+    vlc_vector_foreach( pt, &p_resource->pretunes )
+        if( input_pretune_GetItem( pt ) == p_item )
+        {
+            vlc_mutex_unlock( &p_resource->lock );
+            return;
+        }
+
+    PreTuneAddLocked( p_resource, p_item, i_max, true );
+    vlc_mutex_unlock( &p_resource->lock );
+}
+
+void input_resource_ReleasePreTuned( input_resource_t *p_resource,
+                                     input_pretune_t *pt )
+{
+    vlc_mutex_lock( &p_resource->lock );
+    PreTuneSubmitLocked( p_resource, pt, true );
+    vlc_mutex_unlock( &p_resource->lock );
+}
@@ -26,6 +26,7 @@
 #include <vlc_common.h>
 #include <vlc_mouse.h>
 #include "../video_output/vout_internal.h"
+#include "pretune.h"
 
 enum input_resource_vout_state
 {
@@ -80,4 +81,42 @@ input_resource_t *input_resource_Hold( input_resource_t * );
 
 void input_resource_ResetAout( input_resource_t * );
 
+/**
+ * This function stops the output stream the free aout kept open for the next
+ * item, if any.
+ */
+void input_resource_StopFreeAout( input_resource_t * );
+
+/**
+ * This function sets the items to keep pre-tuned.
+ *
+ * The pre-tuned items not listed are deleted, the new ones are started. The
+ * current item is kept until its input takes it, but never started.
+ */
+void input_resource_SetPreTuned( input_resource_t *, input_item_t *const *,
+                                 size_t, input_item_t *p_current );
+
+/**
+ * This function takes the pre-tuned item matching the given item, if any.
+ *
+ * The caller must release it with input_resource_ReleasePreTuned(), or
+ * delete it with input_pretune_Delete() once its demuxer is adopted.
+ */
+input_pretune_t *input_resource_TakePreTuned( input_resource_t *, input_item_t * );
+
+/**
+ * This function deletes a pre-tuned item taken from the resource.
+ *
+ * It does not wait for the pre-tune thread, the deletion is done in the
+ * background.
+ */
+void input_resource_ReleasePreTuned( input_resource_t *, input_pretune_t * );
+
+/**
+ * This function pre-tunes one more item, if it is not already.
+ *
+ * It is kept until it is taken or the pre-tuned items are set again.
+ */
+void input_resource_AddPreTuned( input_resource_t *, input_item_t * );
+
 #endif
@@ -26,7 +26,15 @@
 
 #include <vlc_thumbnailer.h>
 #include <vlc_executor.h>
+#include <vlc_codec.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_image.h>
+#include <vlc_interrupt.h>
+#include <vlc_modules.h>
 #include "input_internal.h"
+#include "demux.h"
+#include "stream.h"
 
 struct vlc_thumbnailer_t
 {
@@ -70,10 +78,19 @@ struct vlc_thumbnailer_request_t
     vlc_thumbnailer_cb cb;
     void* userdata;
 
+    /* Strip requests, NULL otherwise */
+    vlc_thumbnailer_strip_cb strip_cb;
+    vlc_tick_t *times;
+    size_t count;
+    unsigned width;
+    unsigned height;
+
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
     bool ended;
+    bool canceled;
     picture_t *pic;
+    vlc_interrupt_t *interrupt;
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
@@ -91,6 +108,13 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
     if (!task)
         return NULL;
 
+    task->interrupt = vlc_interrupt_create();
+    if (!task->interrupt)
+    {
+        free(task);
+        return NULL;
+    }
+
     task->thumbnailer = thumbnailer;
     task->item = item;
     task->seek_target = seek_target;
@@ -99,9 +123,15 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
     task->userdata = userdata;
     task->timeout = timeout;
 
+    task->strip_cb = NULL;
+    task->times = NULL;
+    task->count = 1;
+    task->width = task->height = 0;
+
     vlc_mutex_init(&task->lock);
     vlc_cond_init(&task->cond_ended);
     task->ended = false;
+    task->canceled = false;
     task->pic = NULL;
 
     task->runnable.run = RunnableRun;
@@ -116,6 +146,8 @@ static void
 TaskDelete(task_t *task)
 {
     input_item_Release(task->item);
+    vlc_interrupt_destroy(task->interrupt);
+    free(task->times);
     free(task);
 }
 
@@ -135,14 +167,47 @@ ThumbnailerRemoveTask(vlc_thumbnailer_t *thumbnailer, task_t *task)
     vlc_mutex_unlock(&thumbnailer->lock);
 }
 
-static void NotifyThumbnail(task_t *task, picture_t *pic)
+static void NotifyThumbnail(task_t *task, size_t index, picture_t *pic)
 {
-    assert(task->cb);
-    task->cb(task->userdata, pic);
+    if (task->strip_cb)
+        task->strip_cb(task->userdata, index, pic);
+    else
+    {
+        assert(task->cb);
+        task->cb(task->userdata, pic);
+    }
     if (pic)
         picture_Release(pic);
 }
 
+static void NotifyFailure(task_t *task, size_t from)
+{
+    for (size_t i = from; i < task->count; ++i)
+        NotifyThumbnail(task, i, NULL);
+}
+
+static bool
+TaskIsCanceled(task_t *task)
+{
+    vlc_mutex_lock(&task->lock);
+    bool canceled = task->canceled;
+    vlc_mutex_unlock(&task->lock);
+    return canceled;
+}
+
+static struct seek_target
+TaskTarget(const task_t *task, size_t index)
+{
+    if (!task->times)
+        return task->seek_target;
+
+    struct seek_target seek_target = {
+        .type = VLC_THUMBNAILER_SEEK_TIME,
+        .time = task->times[index],
+    };
+    return seek_target;
+}
+
 static void
 on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
@@ -175,44 +240,574 @@ on_thumbnailer_input_event( input_thread_t *input,
     vlc_cond_signal(&task->cond_ended);
 }
 
+/*
+ * Direct extraction, without an input thread
+ *
+ * The media is demuxed straight from the executor thread, and only the video
+ * frames from the nearest keyframe are decoded by a single threaded decoder.
+ * Several pictures of the same media can be extracted in one pass.
+ */
+
+/* Give up on a target once that many video blocks did not produce a picture */
+#define THUMBNAILER_MAX_BLOCKS 300
+
+struct thumbnail_source;
+
+struct es_out_id_t
+{
+    struct vlc_list node; /**< node of thumbnail_source.es */
+};
+
+struct thumbnail_decoder
+{
+    decoder_t dec;
+    struct thumbnail_source *source;
+};
+
+struct thumbnail_source
+{
+    es_out_t out;
+    vlc_object_t *parent;
+    demux_t *demux;
+
+    struct vlc_list es;
+    es_out_id_t *video; /**< first video ES, the only one decoded */
+    es_format_t fmt;
+    decoder_t *packetizer;
+    decoder_t *decoder;
+
+    bool wait_key; /**< drop the frames preceding the first keyframe */
+    bool unsupported; /**< the decoder cannot be created */
+    bool no_video; /**< the media was demuxed to the end without video */
+    unsigned blocks;
+    picture_t *pic;
+};
+
+static inline struct thumbnail_source *
+dec_get_source(decoder_t *dec)
+{
+    return container_of(dec, struct thumbnail_decoder, dec)->source;
+}
+
+static vlc_decoder_device *
+ThumbnailGetDevice(decoder_t *dec)
+{
+    VLC_UNUSED(dec);
+    return NULL; /* the picture must be readable from the CPU */
+}
+
 static void
-RunnableRun(void *userdata)
+ThumbnailQueueVideo(decoder_t *dec, picture_t *pic)
+{
+    struct thumbnail_source *source = dec_get_source(dec);
+    if (source->pic)
+        picture_Release(pic);
+    else
+        source->pic = pic;
+}
+
+static decoder_t *
+ThumbnailDecoderNew(struct thumbnail_source *source, const es_format_t *fmt)
+{
+    struct thumbnail_decoder *owner =
+        vlc_custom_create(source->parent, sizeof(*owner), "thumbnail decoder");
+    if (!owner)
+        return NULL;
+
+    decoder_t *dec = &owner->dec;
+    owner->source = source;
+    decoder_Init(dec, fmt);
+
+    static const struct decoder_owner_callbacks dec_cbs =
+    {
+        .video = {
+            .get_device = ThumbnailGetDevice,
+            .queue = ThumbnailQueueVideo,
+        },
+    };
+    dec->cbs = &dec_cbs;
+
+    /* A single frame is decoded at a time: frame threads would only add
+     * latency and memory */
+    var_Create(dec, "dec-threads", VLC_VAR_INTEGER);
+    var_SetInteger(dec, "dec-threads", 1);
+
+    dec->p_module = module_need_var(dec, "video decoder", "codec");
+    if (!dec->p_module)
+    {
+        msg_Dbg(source->parent, "no thumbnail decoder for fourcc `%4.4s'",
+                (char *)&fmt->i_codec);
+        decoder_Destroy(dec);
+        return NULL;
+    }
+    return dec;
+}
+
+static void
+SourceDecode(struct thumbnail_source *source, block_t *block)
+{
+    if (source->pic || source->unsupported)
+    {
+        block_Release(block);
+        return;
+    }
+
+    if (!source->decoder)
+    {
+        const es_format_t *fmt = source->packetizer
+                               ? &source->packetizer->fmt_out : &source->fmt;
+        source->decoder = ThumbnailDecoderNew(source, fmt);
+        if (!source->decoder)
+        {
+            source->unsupported = true;
+            block_Release(block);
+            return;
+        }
+    }
+
+    const bool key = block->i_flags & BLOCK_FLAG_TYPE_I;
+    if (key)
+        source->wait_key = false;
+    else if (source->wait_key && (block->i_flags & BLOCK_FLAG_TYPE_MASK))
+    {
+        /* Not decodable on its own */
+        block_Release(block);
+        return;
+    }
+
+    decoder_t *dec = source->decoder;
+    source->blocks++;
+    dec->pf_decode(dec, block);
+
+    if (key && !source->pic)
+    {
+        /* Drain, so that the keyframe is output without waiting for the
+         * following frames */
+        dec->pf_decode(dec, NULL);
+        if (!source->pic && dec->pf_flush)
+        {
+            dec->pf_flush(dec);
+            source->wait_key = true;
+        }
+    }
+}
+
+static es_out_id_t *
+SourceAdd(es_out_t *out, input_source_t *in, const es_format_t *fmt)
+{
+    struct thumbnail_source *source =
+        container_of(out, struct thumbnail_source, out);
+    VLC_UNUSED(in);
+
+    es_out_id_t *id = malloc(sizeof(*id));
+    if (unlikely(!id))
+        return NULL;
+
+    if (fmt->i_cat == VIDEO_ES && !source->video)
+    {
+        if (es_format_Copy(&source->fmt, fmt) != VLC_SUCCESS)
+        {
+            free(id);
+            return NULL;
+        }
+        source->video = id;
+        source->wait_key = true;
+    }
+
+    vlc_list_append(&id->node, &source->es);
+    return id;
+}
+
+static void
+SourceDelDecoder(struct thumbnail_source *source)
+{
+    if (source->decoder)
+    {
+        decoder_Destroy(source->decoder);
+        source->decoder = NULL;
+    }
+    if (source->packetizer)
+    {
+        demux_PacketizerDestroy(source->packetizer);
+        source->packetizer = NULL;
+    }
+}
+
+static void
+SourceDel(es_out_t *out, es_out_id_t *id)
+{
+    struct thumbnail_source *source =
+        container_of(out, struct thumbnail_source, out);
+
+    if (id == source->video)
+    {
+        SourceDelDecoder(source);
+        es_format_Clean(&source->fmt);
+        source->video = NULL;
+    }
+    vlc_list_remove(&id->node);
+    free(id);
+}
+
+static int
+SourceSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct thumbnail_source *source =
+        container_of(out, struct thumbnail_source, out);
+
+    if (id != source->video || source->pic || source->unsupported)
+    {
+        block_Release(block);
+        return VLC_SUCCESS;
+    }
+
+    if (source->fmt.b_packetized)
+    {
+        SourceDecode(source, block);
+        return VLC_SUCCESS;
+    }
+
+    if (!source->packetizer)
+    {
+        es_format_t fmt;
+        /* The demuxer is not known yet while it is opening */
+        if (source->demux && es_format_Copy(&fmt, &source->fmt) == VLC_SUCCESS)
+            source->packetizer = demux_PacketizerNew(source->demux, &fmt,
+                                                     "thumbnail");
+        if (!source->packetizer)
+        {
+            block_Release(block);
+            return VLC_SUCCESS;
+        }
+    }
+
+    block_t *out_block;
+    while ((out_block = source->packetizer->pf_packetize(source->packetizer,
+                                                          &block)))
+    {
+        while (out_block)
+        {
+            block_t *next = out_block->p_next;
+            out_block->p_next = NULL;
+            SourceDecode(source, out_block);
+            out_block = next;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static int
+SourceControl(es_out_t *out, input_source_t *in, int query, va_list args)
+{
+    struct thumbnail_source *source =
+        container_of(out, struct thumbnail_source, out);
+    VLC_UNUSED(in);
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+        {
+            /* Let the demuxer skip the tracks which are not decoded */
+            es_out_id_t *id = va_arg(args, es_out_id_t *);
+            bool *selected = va_arg(args, bool *);
+            *selected = id == source->video;
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void
+SourceDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks thumbnail_es_out_cbs =
+{
+    .add = SourceAdd,
+    .send = SourceSend,
+    .del = SourceDel,
+    .control = SourceControl,
+    .destroy = SourceDestroy,
+};
+
+static void
+SourceDelete(struct thumbnail_source *source)
+{
+    demux_Delete(source->demux);
+
+    /* Not all the demuxers delete their ES */
+    es_out_id_t *id;
+    vlc_list_foreach(id, &source->es, node)
+        SourceDel(&source->out, id);
+
+    if (source->pic)
+        picture_Release(source->pic);
+    free(source);
+}
+
+static struct thumbnail_source *
+SourceNew(vlc_object_t *parent, const char *mrl)
+{
+    struct thumbnail_source *source = malloc(sizeof(*source));
+    if (unlikely(!source))
+        return NULL;
+
+    source->out.cbs = &thumbnail_es_out_cbs;
+    source->parent = parent;
+    source->demux = NULL;
+    vlc_list_init(&source->es);
+    source->video = NULL;
+    source->packetizer = NULL;
+    source->decoder = NULL;
+    source->wait_key = true;
+    source->unsupported = false;
+    source->no_video = false;
+    source->blocks = 0;
+    source->pic = NULL;
+
+    stream_t *stream = stream_AccessNew(parent, NULL, &source->out, false, mrl);
+    if (!stream)
+        goto error;
+
+    stream = stream_FilterAutoNew(stream);
+    if (stream->pf_read == NULL && stream->pf_block == NULL
+     && stream->pf_readdir == NULL)
+        /* Combined access/demux */
+        source->demux = stream;
+    else
+    {
+        source->demux = demux_NewAdvanced(parent, NULL, "any", mrl, stream,
+                                          &source->out, false);
+        if (!source->demux)
+        {
+            vlc_stream_Delete(stream);
+            goto error;
+        }
+    }
+
+    if (source->demux->pf_demux == NULL)
+    {
+        /* Directories and playlists */
+        SourceDelete(source);
+        return NULL;
+    }
+    return source;
+
+error:
+    free(source);
+    return NULL;
+}
+
+static void
+SourceFlush(struct thumbnail_source *source)
+{
+    if (source->packetizer && source->packetizer->pf_flush)
+        source->packetizer->pf_flush(source->packetizer);
+    if (source->decoder && source->decoder->pf_flush)
+        source->decoder->pf_flush(source->decoder);
+    if (source->pic)
+    {
+        picture_Release(source->pic);
+        source->pic = NULL;
+    }
+    source->wait_key = true;
+    source->blocks = 0;
+}
+
+static picture_t *
+SourceExtract(struct thumbnail_source *source, task_t *task,
+              struct seek_target seek_target, vlc_tick_t deadline)
+{
+    /* Audio only media: do not demux it to the end again for each target */
+    if (source->no_video)
+        return NULL;
+
+    SourceFlush(source);
+
+    /* A failed seek is not fatal: the picture is taken from where the
+     * demuxer stands, like the input thread would */
+    if (seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
+        demux_Control(source->demux, DEMUX_SET_TIME,
+                      __MAX(seek_target.time, 0), false);
+    else
+    {
+        assert(seek_target.type == VLC_THUMBNAILER_SEEK_POS);
+        demux_Control(source->demux, DEMUX_SET_POSITION,
+                      (double) __MAX(seek_target.pos, 0.f), false);
+    }
+
+    while (!source->pic && !source->unsupported)
+    {
+        if (source->blocks >= THUMBNAILER_MAX_BLOCKS || TaskIsCanceled(task)
+         || (deadline != VLC_TICK_INVALID && vlc_tick_now() >= deadline))
+            break;
+
+        if (demux_Demux(source->demux) != VLC_DEMUXER_SUCCESS)
+        {
+            /* Output the frames held by the decoder */
+            if (source->decoder)
+                source->decoder->pf_decode(source->decoder, NULL);
+            /* Tracks can be added at any time, so the lack of video is only
+             * known for sure once the end is reached */
+            if (!source->video)
+                source->no_video = true;
+            break;
+        }
+    }
+
+    picture_t *pic = source->pic;
+    source->pic = NULL;
+    return pic;
+}
+
+static picture_t *
+ScalePicture(image_handler_t *image, picture_t *pic,
+             unsigned width, unsigned height)
+{
+    const video_format_t *fmt = &pic->format;
+    if ((!width && !height) || !fmt->i_visible_width || !fmt->i_visible_height)
+        return pic;
+
+    /* Fit in width x height, keeping the display aspect ratio */
+    uint64_t dw = (uint64_t) fmt->i_visible_width * __MAX(fmt->i_sar_num, 1);
+    uint64_t dh = (uint64_t) fmt->i_visible_height * __MAX(fmt->i_sar_den, 1);
+    if (!height || (width && dw * height >= dh * width))
+        height = __MAX(width * dh / dw, 1);
+    else
+        width = __MAX(height * dw / dh, 1);
+
+    video_format_t fmt_out;
+    video_format_Init(&fmt_out, fmt->i_chroma);
+    fmt_out.i_width = fmt_out.i_visible_width = width;
+    fmt_out.i_height = fmt_out.i_visible_height = height;
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    picture_t *scaled = image_Convert(image, pic, fmt, &fmt_out);
+    picture_Release(pic);
+    return scaled;
+}
+
+static bool
+CanRunDirect(const task_t *task)
+{
+    /* Options may be required by the access or the demuxer; a precise seek
+     * needs the input thread frame dropping */
+    input_item_t *item = task->item;
+    vlc_mutex_lock(&item->lock);
+    bool ret = item->i_options == 0 && item->psz_uri != NULL;
+    vlc_mutex_unlock(&item->lock);
+    return ret && task->fast_seek;
+}
+
+/**
+ * Extract all the pictures of a task without input thread
+ *
+ * \retval VLC_SUCCESS if every picture has been notified
+ * \retval VLC_ENOTSUP if nothing has been notified, the input thread must be
+ * used instead
+ */
+static int
+RunDirect(task_t *task, vlc_tick_t deadline)
+{
+    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
+
+    if (!CanRunDirect(task))
+        return VLC_ENOTSUP;
+
+    char *mrl = input_item_GetURI(task->item);
+    if (!mrl)
+        return VLC_ENOTSUP;
+
+    vlc_interrupt_t *oldctx = vlc_interrupt_set(task->interrupt);
+    int ret = VLC_ENOTSUP;
+
+    struct thumbnail_source *source = SourceNew(thumbnailer->parent, mrl);
+    if (!source)
+        goto end;
+
+    image_handler_t *image = NULL;
+    if (task->width || task->height)
+        image = image_HandlerCreate(thumbnailer->parent);
+
+    for (size_t i = 0; i < task->count; ++i)
+    {
+        picture_t *pic = SourceExtract(source, task, TaskTarget(task, i),
+                                       deadline);
+        if (i == 0 && !pic && source->unsupported)
+            goto end_source;
+
+        if (pic && image)
+            pic = ScalePicture(image, pic, task->width, task->height);
+        else if (pic && (task->width || task->height))
+        {
+            picture_Release(pic);
+            pic = NULL;
+        }
+
+        NotifyThumbnail(task, i, pic);
+    }
+    ret = VLC_SUCCESS;
+
+end_source:
+    if (image)
+        image_HandlerDelete(image);
+    SourceDelete(source);
+end:
+    vlc_interrupt_set(oldctx);
+    free(mrl);
+    return ret;
+}
+
+static void
+RunInput(task_t *task, size_t index, vlc_tick_t deadline)
 {
-    task_t *task = userdata;
     vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
+    struct seek_target seek_target = TaskTarget(task, index);
 
-    vlc_tick_t now = vlc_tick_now();
+    vlc_mutex_lock(&task->lock);
+    task->ended = task->canceled;
+    vlc_mutex_unlock(&task->lock);
 
     input_thread_t* input =
         input_CreateThumbnailer(thumbnailer->parent, on_thumbnailer_input_event,
                                 task, task->item);
     if (!input)
-        goto end;
+    {
+        NotifyThumbnail(task, index, NULL);
+        return;
+    }
 
-    if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
-        input_SetTime(input, task->seek_target.time, task->fast_seek);
+    if (seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
+        input_SetTime(input, seek_target.time, task->fast_seek);
     else
     {
-        assert(task->seek_target.type == VLC_THUMBNAILER_SEEK_POS);
-        input_SetPosition(input, task->seek_target.pos, task->fast_seek);
+        assert(seek_target.type == VLC_THUMBNAILER_SEEK_POS);
+        input_SetPosition(input, seek_target.pos, task->fast_seek);
     }
 
     int ret = input_Start(input);
     if (ret != VLC_SUCCESS)
     {
         input_Close(input);
-        goto end;
+        NotifyThumbnail(task, index, NULL);
+        return;
     }
 
     vlc_mutex_lock(&task->lock);
-    if (task->timeout == VLC_TICK_INVALID)
+    if (deadline == VLC_TICK_INVALID)
     {
         while (!task->ended)
             vlc_cond_wait(&task->cond_ended, &task->lock);
     }
     else
     {
-        vlc_tick_t deadline = now + task->timeout;
         bool timeout = false;
         while (!task->ended && !timeout)
             timeout =
@@ -222,12 +817,42 @@ RunnableRun(void *userdata)
     task->pic = NULL;
     vlc_mutex_unlock(&task->lock);
 
-    NotifyThumbnail(task, pic);
+    if (pic && (task->width || task->height))
+    {
+        image_handler_t *image = image_HandlerCreate(thumbnailer->parent);
+        if (image)
+        {
+            pic = ScalePicture(image, pic, task->width, task->height);
+            image_HandlerDelete(image);
+        }
+        else
+        {
+            picture_Release(pic);
+            pic = NULL;
+        }
+    }
+
+    NotifyThumbnail(task, index, pic);
 
     input_Stop(input);
     input_Close(input);
+}
+
+static void
+RunnableRun(void *userdata)
+{
+    task_t *task = userdata;
+    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
+
+    vlc_tick_t deadline = task->timeout == VLC_TICK_INVALID
+                        ? VLC_TICK_INVALID : vlc_tick_now() + task->timeout;
+
+    if (RunDirect(task, deadline) != VLC_SUCCESS)
+    {
+        for (size_t i = 0; i < task->count; ++i)
+            RunInput(task, i, deadline);
+    }
 
-end:
     ThumbnailerRemoveTask(thumbnailer, task);
     TaskDelete(task);
 }
@@ -235,11 +860,14 @@ end:
 static void
 Interrupt(task_t *task)
 {
-    /* Wake up RunnableRun() which will call input_Stop() */
+    /* Wake up RunnableRun() which will call input_Stop(), or abort the
+     * direct extraction */
     vlc_mutex_lock(&task->lock);
     task->ended = true;
+    task->canceled = true;
     vlc_mutex_unlock(&task->lock);
     vlc_cond_signal(&task->cond_ended);
+    vlc_interrupt_kill(task->interrupt);
 }
 
 static task_t *
@@ -293,6 +921,45 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                          userdata);
 }
 
+task_t *
+vlc_thumbnailer_RequestStrip( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              unsigned width, unsigned height,
+                              input_item_t *item, vlc_tick_t timeout,
+                              vlc_thumbnailer_strip_cb cb, void* userdata )
+{
+    assert(count > 0);
+
+    vlc_tick_t *copy = vlc_alloc(count, sizeof(*copy));
+    if (!copy)
+        return NULL;
+    memcpy(copy, times, count * sizeof(*copy));
+
+    struct seek_target seek_target = {
+        .type = VLC_THUMBNAILER_SEEK_TIME,
+        .time = times[0],
+    };
+    task_t *task = TaskNew(thumbnailer, item, seek_target, true, NULL,
+                           userdata, timeout);
+    if (!task)
+    {
+        free(copy);
+        return NULL;
+    }
+
+    task->strip_cb = cb;
+    task->times = copy;
+    task->count = count;
+    task->width = width;
+    task->height = height;
+
+    ThumbnailerAddTask(thumbnailer, task);
+
+    vlc_executor_Submit(thumbnailer->executor, &task->runnable);
+
+    return task;
+}
+
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer, task_t* task )
 {
     (void) thumbnailer;
@@ -332,7 +999,7 @@ CancelAllTasks(vlc_thumbnailer_t *thumbnailer)
                                             &task->runnable);
         if (canceled)
         {
-            NotifyThumbnail(task, NULL);
+            NotifyFailure(task, 0);
             vlc_list_remove(&task->node);
             TaskDelete(task);
         }
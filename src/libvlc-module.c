@@ -748,6 +748,13 @@ static const char* const ppsz_restore_playback_desc[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_MEMORY_TEXT N_("Timeshift memory size")
+#define INPUT_TIMESHIFT_MEMORY_LONGTEXT N_( \
+    "Maximum amount of memory (in MiB) used to store the timeshifted " \
+    "streams instead of temporary files. The played data is kept to jump " \
+    "backward until it is reached, then the oldest data is dropped. " \
+    "0 uses temporary files." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -988,6 +995,19 @@ static const char* const ppsz_restore_playback_desc[] = {
     "VLC will fallback automatically to software decoders in case of " \
     "hardware decoder failure." )
 
+#define DEC_THREADS_TEXT N_("Decoding threads")
+#define DEC_THREADS_LONGTEXT N_( \
+    "Number of threads used by each decoder supporting threads, unless " \
+    "set by a decoder specific option (0 = automatic)." )
+
+#define DEC_THREADS_SHARED_TEXT N_("Share the CPUs between video decoders")
+#define DEC_THREADS_SHARED_LONGTEXT N_( \
+    "Divide the decoding threads among the videos decoded concurrently, " \
+    "instead of using one thread per CPU for each video. Each video gets " \
+    "its share of the CPUs left by the others when it starts, so the total " \
+    "number of threads stays below the number of CPUs plus the number of " \
+    "videos." )
+
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
@@ -1136,6 +1156,11 @@ static const char* const ppsz_restore_playback_desc[] = {
     "all the processor time and render the whole system unresponsive which " \
     "might require a reboot of your machine.")
 
+#define FRAME_POOL_TEXT N_("Recycle data frames")
+#define FRAME_POOL_LONGTEXT N_( \
+    "Keep the released data frames in per-thread caches to reuse them " \
+    "instead of allocating new ones. This can be changed while playing.")
+
 #define CLOCK_SOURCE_TEXT N_("Clock source")
 #ifdef _WIN32
 static const char *const clock_sources[] = {
@@ -1258,6 +1283,30 @@ static const char *const psz_recursive_list_text[] = {
     "If pending audio communication is detected, playback will be paused " \
     "automatically." )
 
+#define ZAP_AHEAD_TEXT N_("Pre-tuned neighbours")
+#define ZAP_AHEAD_LONGTEXT N_( \
+    "Number of playlist items before and after the current one that are " \
+    "kept opened and demuxed in the background, so that switching to them " \
+    "starts from the last buffered key frame. 0 disables pre-tuning." )
+
+#define ZAP_AHEAD_MEMORY_TEXT N_("Pre-tuned memory size")
+#define ZAP_AHEAD_MEMORY_LONGTEXT N_( \
+    "Maximum amount of memory (in MiB) buffered by each pre-tuned item." )
+
+#define ZAP_AHEAD_LIVE_TEXT N_("Pre-tuned live neighbours")
+#define ZAP_AHEAD_LIVE_LONGTEXT N_( \
+    "Maximum number of pre-tuned items, nearest first, that are demuxed " \
+    "continuously in the background. The other ones are only kept opened. " \
+    "This bounds the CPU and network usage of pre-tuning." )
+
+#define NEXT_PREOPEN_TEXT N_("Next item pre-opening (ms)")
+#define NEXT_PREOPEN_LONGTEXT N_( \
+    "Time before the end of the current item at which the access and the " \
+    "demuxer of the next one are opened in the background. Its decoders " \
+    "are created when the current item ends, but the audio output is kept " \
+    "open from one item to the next when their formats match. This " \
+    "shortens the transition, it does not remove it. 0 disables it." )
+
 #define ML_TEXT N_("Use media library")
 #define ML_LONGTEXT N_( \
     "The media library is automatically saved and reloaded each time you " \
@@ -1984,6 +2033,9 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT )
+    add_integer( "input-timeshift-memory", 0, INPUT_TIMESHIFT_MEMORY_TEXT,
+                 INPUT_TIMESHIFT_MEMORY_LONGTEXT )
+        change_integer_range( 0, 1 << 20 )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT );
 
@@ -2003,6 +2055,10 @@ vlc_module_begin ()
 
     add_string( "codec", NULL, CODEC_TEXT, CODEC_LONGTEXT )
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
+    add_integer( "dec-threads", 0, DEC_THREADS_TEXT, DEC_THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
+    add_bool( "dec-threads-shared", false, DEC_THREADS_SHARED_TEXT,
+              DEC_THREADS_SHARED_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
 
@@ -2092,6 +2148,8 @@ vlc_module_begin ()
               HPRIORITY_LONGTEXT )
 #endif
 
+    add_bool( "frame-pool", true, FRAME_POOL_TEXT, FRAME_POOL_LONGTEXT )
+
 #ifdef _WIN32
     add_string( "clock-source", NULL, CLOCK_SOURCE_TEXT, NULL )
         change_string_list( clock_sources, clock_sources_text )
@@ -2120,6 +2178,17 @@ vlc_module_begin ()
     add_bool( "playlist-autostart", true,
               AUTOSTART_TEXT, AUTOSTART_LONGTEXT )
     add_bool( "playlist-cork", true, CORK_TEXT, CORK_LONGTEXT )
+    add_integer( "zap-ahead", 0, ZAP_AHEAD_TEXT, ZAP_AHEAD_LONGTEXT )
+        change_integer_range( 0, 8 )
+    add_integer( "zap-ahead-memory", 8, ZAP_AHEAD_MEMORY_TEXT,
+                 ZAP_AHEAD_MEMORY_LONGTEXT )
+        change_integer_range( 1, 1 << 10 )
+    add_integer( "zap-ahead-live", 2, ZAP_AHEAD_LIVE_TEXT,
+                 ZAP_AHEAD_LIVE_LONGTEXT )
+        change_integer_range( 0, 16 )
+    add_integer( "next-preopen", 0, NEXT_PREOPEN_TEXT,
+                 NEXT_PREOPEN_LONGTEXT )
+        change_integer_range( 0, 60000 )
 #if defined(_WIN32) || defined(HAVE_DBUS) || defined(__OS2__)
     add_bool( "one-instance", false, ONEINSTANCE_TEXT,
               ONEINSTANCE_LONGTEXT )
@@ -59,6 +59,7 @@
 #include <vlc_keystore.h>
 #include <vlc_fs.h>
 #include <vlc_cpu.h>
+#include <vlc_frame.h>
 #include <vlc_url.h>
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
@@ -101,6 +102,15 @@ libvlc_int_t * libvlc_InternalCreate( void )
     return p_libvlc;
 }
 
+static int FramePoolCallback(vlc_object_t *obj, const char *varname,
+                             vlc_value_t oldval, vlc_value_t newval,
+                             void *data)
+{
+    (void) obj; (void) varname; (void) oldval; (void) data;
+    vlc_frame_SetPooling(newval.b_bool);
+    return VLC_SUCCESS;
+}
+
 static void libvlc_AddInterfaces(libvlc_int_t *libvlc, const char *varname)
 {
     char *str = var_InheritString(libvlc, varname);
@@ -206,6 +216,11 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
+    /* Frame pool, switchable at run-time */
+    var_Create( p_libvlc, "frame-pool", VLC_VAR_BOOL | VLC_VAR_DOINHERIT );
+    var_AddCallback( p_libvlc, "frame-pool", FramePoolCallback, NULL );
+    vlc_frame_SetPooling( var_GetBool( p_libvlc, "frame-pool" ) );
+
     if( var_InheritBool( p_libvlc, "media-library") )
     {
         priv->p_media_library = libvlc_MlCreate( p_libvlc );
@@ -389,6 +404,11 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
 
+    struct vlc_frame_pool_stats stats;
+    vlc_frame_GetPoolStats( &stats );
+    msg_Dbg( p_libvlc, "frame pool: %"PRIu64" hits, %"PRIu64" misses, "
+             "peak %zu KiB", stats.hits, stats.misses, stats.peak_bytes / 1024 );
+
     vlc_LogDestroy(p_libvlc->obj.logger);
     vlc_tracer_Destroy(p_libvlc);
     /* Free module bank. It is refcounted, so we call this each time  */
@@ -464,6 +484,22 @@ int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                                  cbs_userdata, timeout, id );
 }
 
+int vlc_MetadataRequestBatch(libvlc_int_t *libvlc, input_item_t *const *items,
+                             size_t count,
+                             input_item_meta_request_option_t i_options,
+                             const input_preparser_callbacks_t *cbs,
+                             void *cbs_userdata,
+                             int timeout, void *id)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    if (unlikely(priv->parser == NULL))
+        return VLC_ENOMEM;
+
+    return input_preparser_PushBatch( priv->parser, items, count, i_options,
+                                      cbs, cbs_userdata, timeout, id );
+}
+
 /**
  * Requests extraction of the meta data for an input item (a.k.a. preparsing).
  * The actual extraction is asynchronous. It can be cancelled with
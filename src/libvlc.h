@@ -214,6 +214,13 @@ int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         void *cbs_userdata,
                         int timeout, void *id);
 
+int vlc_MetadataRequestBatch(libvlc_int_t *libvlc, input_item_t *const *items,
+                             size_t count,
+                             input_item_meta_request_option_t i_options,
+                             const input_preparser_callbacks_t *cbs,
+                             void *cbs_userdata,
+                             int timeout, void *id);
+
 /*
  * Variables stuff
  */
@@ -35,7 +35,7 @@
  * This structure contains the data specific to one thread.
  */
 struct vlc_executor_thread {
-    /** Node of vlc_executor.threads list */
+    /** Node of vlc_executor.threads or vlc_executor.exited list */
     struct vlc_list node;
 
     /** The executor owning the thread */
@@ -64,6 +64,9 @@ struct vlc_executor {
     /** Thread count (in a separate field to quickly compare to max_threads) */
     unsigned nthreads;
 
+    /** List of vlc_executor_thread which exited and must be joined */
+    struct vlc_list exited;
+
     /* Number of tasks requested but not finished. */
     unsigned unfinished;
 
@@ -94,10 +97,12 @@ QueueTake(vlc_executor_t *executor)
 {
     vlc_mutex_assert(&executor->lock);
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
+    while (!executor->closing && vlc_list_is_empty(&executor->queue)
+           && executor->nthreads <= executor->max_threads)
         vlc_cond_wait(&executor->queue_wait, &executor->lock);
 
-    if (executor->closing)
+    /* Idle threads above the maximum exit */
+    if (executor->closing || vlc_list_is_empty(&executor->queue))
         return NULL;
 
     struct vlc_runnable *runnable =
@@ -122,7 +127,8 @@ ThreadRun(void *userdata)
     vlc_mutex_lock(&executor->lock);
 
     struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
+    /* When the executor is closing, or has too many threads, QueueTake()
+     * returns NULL */
     while ((runnable = QueueTake(executor)))
     {
         thread->current_task = runnable;
@@ -140,11 +146,34 @@ ThreadRun(void *userdata)
             vlc_cond_signal(&executor->idle_wait);
     }
 
+    if (!executor->closing)
+    {
+        /* The thread is joined later, by a thread holding the lock, so
+         * once it has released it */
+        executor->nthreads--;
+        vlc_list_remove(&thread->node);
+        vlc_list_append(&thread->node, &executor->exited);
+    }
+
     vlc_mutex_unlock(&executor->lock);
 
     return NULL;
 }
 
+static void
+JoinExitedThreads(vlc_executor_t *executor)
+{
+    vlc_mutex_assert(&executor->lock);
+
+    struct vlc_executor_thread *thread;
+    vlc_list_foreach(thread, &executor->exited, node)
+    {
+        vlc_join(thread->thread, NULL);
+        vlc_list_remove(&thread->node);
+        free(thread);
+    }
+}
+
 static int
 SpawnThread(vlc_executor_t *executor)
 {
@@ -184,6 +213,7 @@ vlc_executor_New(unsigned max_threads)
     executor->unfinished = 0;
 
     vlc_list_init(&executor->threads);
+    vlc_list_init(&executor->exited);
     vlc_list_init(&executor->queue);
 
     vlc_cond_init(&executor->idle_wait);
@@ -210,6 +240,7 @@ vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
     assert(!executor->closing);
 
     QueuePush(executor, runnable);
+    JoinExitedThreads(executor);
 
     if (++executor->unfinished > executor->nthreads
             && executor->nthreads < executor->max_threads)
@@ -243,6 +274,28 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
     return in_queue;
 }
 
+void
+vlc_executor_SetMaxThreads(vlc_executor_t *executor, unsigned max_threads)
+{
+    assert(max_threads);
+
+    vlc_mutex_lock(&executor->lock);
+
+    executor->max_threads = max_threads;
+    JoinExitedThreads(executor);
+
+    if (executor->nthreads > max_threads)
+        /* Wake up the idle threads, so that the extra ones exit */
+        vlc_cond_broadcast(&executor->queue_wait);
+    else
+        while (executor->unfinished > executor->nthreads
+               && executor->nthreads < max_threads)
+            if (SpawnThread(executor) != VLC_SUCCESS)
+                break;
+
+    vlc_mutex_unlock(&executor->lock);
+}
+
 void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
@@ -277,6 +330,11 @@ vlc_executor_Delete(vlc_executor_t *executor)
         vlc_join(thread->thread, NULL);
         free(thread);
     }
+    vlc_list_foreach(thread, &executor->exited, node)
+    {
+        vlc_join(thread->thread, NULL);
+        free(thread);
+    }
 
     /* The queue must still be empty (no runnable submitted a new runnable) */
     assert(vlc_list_is_empty(&executor->queue));
@@ -31,6 +31,7 @@
 #include <vlc_spu.h>
 #include <libvlc.h>
 #include <assert.h>
+#include "../modules/modules.h"
 
 typedef struct chained_filter_t
 {
@@ -203,6 +204,40 @@ void filter_chain_Reset( filter_chain_t *p_chain,
     es_format_Copy( &p_chain->fmt_out, p_fmt_out );
 }
 
+/* Parameters of a converter request, for the modules memo */
+struct filter_chain_key
+{
+    vlc_fourcc_t i_codec_in, i_codec_out;
+    video_format_t video_in, video_out;
+    /* Converters may only handle some video contexts and devices */
+    const vlc_video_context *vctx;
+    const vlc_decoder_device *device;
+    enum vlc_video_context_type vctx_type;
+    enum vlc_decoder_device_type device_type;
+    bool b_allow_fmt_out_change;
+};
+
+static void filter_chain_KeyVideo( video_format_t *key,
+                                   const video_format_t *fmt )
+{
+    key->i_chroma = fmt->i_chroma;
+    key->i_width = fmt->i_width;
+    key->i_height = fmt->i_height;
+    key->i_x_offset = fmt->i_x_offset;
+    key->i_y_offset = fmt->i_y_offset;
+    key->i_visible_width = fmt->i_visible_width;
+    key->i_visible_height = fmt->i_visible_height;
+    key->i_sar_num = fmt->i_sar_num;
+    key->i_sar_den = fmt->i_sar_den;
+    key->orientation = fmt->orientation;
+    key->primaries = fmt->primaries;
+    key->transfer = fmt->transfer;
+    key->space = fmt->space;
+    key->color_range = fmt->color_range;
+    key->chroma_location = fmt->chroma_location;
+    key->multiview_mode = fmt->multiview_mode;
+}
+
 static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
     const char *name, const char *capability, const config_chain_t *cfg,
     const es_format_t *fmt_out )
@@ -255,6 +290,35 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
         sprintf( name_chained, "%s,chain", name );
         filter->p_module = module_need( filter, capability, name_chained, true );
     }
+    else if( name == NULL && cfg == NULL && fmt_in->i_cat == VIDEO_ES )
+    {
+        /* Converters are requested over and over for the same formats:
+         * try the converter that worked last time first, and skip the
+         * converters that just failed. */
+        struct filter_chain_key key;
+
+        memset( &key, 0, sizeof (key) );
+        key.i_codec_in = fmt_in->i_codec;
+        key.i_codec_out = fmt_out->i_codec;
+        filter_chain_KeyVideo( &key.video_in, &fmt_in->video );
+        filter_chain_KeyVideo( &key.video_out, &fmt_out->video );
+        key.vctx = vctx_in;
+        if( vctx_in != NULL )
+        {
+            vlc_decoder_device *device = vlc_video_context_HoldDevice( vctx_in );
+
+            key.vctx_type = vlc_video_context_GetType( vctx_in );
+            key.device = device;
+            if( device != NULL )
+            {
+                key.device_type = device->type;
+                vlc_decoder_device_Release( device );
+            }
+        }
+        key.b_allow_fmt_out_change = chain->b_allow_fmt_out_change;
+        filter->p_module = module_need_memo( VLC_OBJECT(filter), capability,
+                                             NULL, false, &key, sizeof (key) );
+    }
     else
         filter->p_module = module_need( filter, capability, name, name != NULL );
 
@@ -101,6 +101,7 @@ static void vlc_frame_generic_Release (vlc_frame_t *frame)
 static const struct vlc_frame_callbacks vlc_frame_generic_cbs =
 {
     vlc_frame_generic_Release,
+    true,
 };
 
 /** Initial memory alignment of data frame.
@@ -111,6 +112,317 @@ static const struct vlc_frame_callbacks vlc_frame_generic_cbs =
 /** Initial reserved header and footer size. */
 #define VLC_FRAME_PADDING      32
 
+/*
+ * Frame pool
+ *
+ * Frames of up to 64 KiB are recycled through per-thread caches, with one
+ * free list per power-of-two size class. A frame released by another thread
+ * than the one that allocated it, typically a decoder thread, is pushed to
+ * a lock-free list of its cache, that the owner takes back as a whole once
+ * its own list is empty. That list is bounded like the owner one: past it,
+ * the frames are freed to the heap.
+ */
+#define VLC_FRAME_POOL_MIN_SHIFT  9 /* 512 bytes */
+#define VLC_FRAME_POOL_CLASSES    8 /* up to 64 KiB */
+/** Maximum of bytes kept per size class and per thread */
+#define VLC_FRAME_POOL_CACHE_SIZE (256 * 1024)
+
+struct vlc_frame_cache;
+
+struct vlc_frame_pooled
+{
+    vlc_frame_t frame;
+    struct vlc_frame_cache *cache;
+    unsigned cls;
+};
+
+struct vlc_frame_cache
+{
+    struct
+    {
+        vlc_frame_t *head; /* owner thread only */
+        size_t count;
+        _Atomic(vlc_frame_t *) remote;
+        atomic_size_t remote_count; /* frames pushed to remote, or being */
+    } classes[VLC_FRAME_POOL_CLASSES];
+    atomic_size_t refs; /* owner thread and frames in use */
+    atomic_bool dead;
+};
+
+static struct
+{
+    vlc_once_t once;
+    vlc_threadvar_t key;
+    atomic_bool enabled;
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_size_t bytes;
+    atomic_size_t peak;
+} vlc_frame_pool = {
+    .once = VLC_STATIC_ONCE,
+    .enabled = true,
+};
+
+static size_t vlc_frame_pool_ClassSize(unsigned cls)
+{
+    return (size_t)1 << (VLC_FRAME_POOL_MIN_SHIFT + cls);
+}
+
+static void vlc_frame_pool_Free(vlc_frame_t *frame)
+{
+    struct vlc_frame_pooled *p =
+        container_of(frame, struct vlc_frame_pooled, frame);
+
+    atomic_fetch_sub_explicit(&vlc_frame_pool.bytes,
+                              vlc_frame_pool_ClassSize(p->cls),
+                              memory_order_relaxed);
+    free(p);
+}
+
+static size_t vlc_frame_pool_FreeList(vlc_frame_t *frame)
+{
+    size_t count = 0;
+
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+
+        vlc_frame_pool_Free(frame);
+        frame = next;
+        count++;
+    }
+    return count;
+}
+
+static size_t vlc_frame_pool_ClassMax(unsigned cls)
+{
+    return VLC_FRAME_POOL_CACHE_SIZE / vlc_frame_pool_ClassSize(cls);
+}
+
+static void vlc_frame_cache_Destroy(struct vlc_frame_cache *cache)
+{
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        vlc_frame_pool_FreeList(cache->classes[i].head);
+        vlc_frame_pool_FreeList(atomic_load_explicit(&cache->classes[i].remote,
+                                                     memory_order_acquire));
+    }
+    free(cache);
+}
+
+static void vlc_frame_cache_Release(struct vlc_frame_cache *cache)
+{
+    if (atomic_fetch_sub_explicit(&cache->refs, 1, memory_order_acq_rel) == 1)
+        vlc_frame_cache_Destroy(cache);
+}
+
+/* Thread exit: the frames still in use keep the cache alive */
+static void vlc_frame_cache_Exit(void *data)
+{
+    struct vlc_frame_cache *cache = data;
+
+    atomic_store_explicit(&cache->dead, true, memory_order_relaxed);
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        vlc_frame_pool_FreeList(cache->classes[i].head);
+        cache->classes[i].head = NULL;
+        cache->classes[i].count = 0;
+        vlc_frame_pool_FreeList(atomic_exchange_explicit(
+            &cache->classes[i].remote, NULL, memory_order_acquire));
+    }
+    vlc_frame_cache_Release(cache);
+}
+
+static void vlc_frame_pool_Init(void *data)
+{
+    (void) data;
+    if (vlc_threadvar_create(&vlc_frame_pool.key, vlc_frame_cache_Exit))
+        atomic_store_explicit(&vlc_frame_pool.enabled, false,
+                              memory_order_relaxed);
+}
+
+static struct vlc_frame_cache *vlc_frame_cache_Get(void)
+{
+    struct vlc_frame_cache *cache = vlc_threadvar_get(vlc_frame_pool.key);
+    if (likely(cache != NULL))
+        return cache;
+
+    cache = malloc(sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        cache->classes[i].head = NULL;
+        cache->classes[i].count = 0;
+        atomic_init(&cache->classes[i].remote, NULL);
+        atomic_init(&cache->classes[i].remote_count, 0);
+    }
+    atomic_init(&cache->refs, 1);
+    atomic_init(&cache->dead, false);
+
+    if (vlc_threadvar_set(vlc_frame_pool.key, cache))
+    {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static vlc_frame_t *vlc_frame_cache_Pop(struct vlc_frame_cache *cache,
+                                        unsigned cls)
+{
+    vlc_frame_t *frame = cache->classes[cls].head;
+
+    if (frame == NULL)
+    {
+        /* Take back the frames released by other threads */
+        frame = atomic_exchange_explicit(&cache->classes[cls].remote, NULL,
+                                         memory_order_acquire);
+        if (frame == NULL)
+            return NULL;
+
+        const size_t max = vlc_frame_pool_ClassMax(cls);
+        size_t count = 1;
+        vlc_frame_t *last = frame;
+
+        while (last->p_next != NULL && count < max)
+        {
+            last = last->p_next;
+            count++;
+        }
+        size_t taken = count + vlc_frame_pool_FreeList(last->p_next);
+        last->p_next = NULL;
+        cache->classes[cls].count = count;
+        atomic_fetch_sub_explicit(&cache->classes[cls].remote_count, taken,
+                                  memory_order_relaxed);
+    }
+
+    cache->classes[cls].head = frame->p_next;
+    cache->classes[cls].count--;
+    return frame;
+}
+
+static void vlc_frame_pool_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_pooled *p =
+        container_of(frame, struct vlc_frame_pooled, frame);
+    struct vlc_frame_cache *cache = p->cache;
+    unsigned cls = p->cls;
+
+    if (!atomic_load_explicit(&vlc_frame_pool.enabled, memory_order_relaxed)
+     || atomic_load_explicit(&cache->dead, memory_order_relaxed))
+        vlc_frame_pool_Free(frame);
+    else if (cache == vlc_threadvar_get(vlc_frame_pool.key))
+    {
+        if (cache->classes[cls].count < vlc_frame_pool_ClassMax(cls))
+        {
+            frame->p_next = cache->classes[cls].head;
+            cache->classes[cls].head = frame;
+            cache->classes[cls].count++;
+        }
+        else
+            vlc_frame_pool_Free(frame);
+    }
+    else if (atomic_fetch_add_explicit(&cache->classes[cls].remote_count, 1,
+                                       memory_order_relaxed)
+               >= vlc_frame_pool_ClassMax(cls))
+    {
+        /* The owner is not taking its frames back fast enough */
+        atomic_fetch_sub_explicit(&cache->classes[cls].remote_count, 1,
+                                  memory_order_relaxed);
+        vlc_frame_pool_Free(frame);
+    }
+    else
+    {
+        vlc_frame_t *head = atomic_load_explicit(&cache->classes[cls].remote,
+                                                 memory_order_relaxed);
+        do
+            frame->p_next = head;
+        while (!atomic_compare_exchange_weak_explicit(
+                    &cache->classes[cls].remote, &head, frame,
+                    memory_order_release, memory_order_relaxed));
+    }
+
+    vlc_frame_cache_Release(cache);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_pool_cbs =
+{
+    vlc_frame_pool_Release,
+    true,
+};
+
+static vlc_frame_t *vlc_frame_pool_Alloc(size_t alloc)
+{
+    if (alloc > vlc_frame_pool_ClassSize(VLC_FRAME_POOL_CLASSES - 1)
+     || !atomic_load_explicit(&vlc_frame_pool.enabled, memory_order_relaxed))
+        return NULL;
+
+    vlc_once(&vlc_frame_pool.once, vlc_frame_pool_Init, NULL);
+
+    struct vlc_frame_cache *cache = vlc_frame_cache_Get();
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    unsigned cls = 0;
+    while (vlc_frame_pool_ClassSize(cls) < alloc)
+        cls++;
+
+    struct vlc_frame_pooled *p;
+    vlc_frame_t *frame = vlc_frame_cache_Pop(cache, cls);
+
+    if (frame != NULL)
+    {
+        p = container_of(frame, struct vlc_frame_pooled, frame);
+        atomic_fetch_add_explicit(&vlc_frame_pool.hits, 1,
+                                  memory_order_relaxed);
+    }
+    else
+    {
+        const size_t size = vlc_frame_pool_ClassSize(cls);
+
+        p = malloc(size);
+        if (unlikely(p == NULL))
+            return NULL;
+        p->cache = cache;
+        p->cls = cls;
+
+        atomic_fetch_add_explicit(&vlc_frame_pool.misses, 1,
+                                  memory_order_relaxed);
+        size_t bytes = atomic_fetch_add_explicit(&vlc_frame_pool.bytes, size,
+                                                 memory_order_relaxed) + size;
+        size_t peak = atomic_load_explicit(&vlc_frame_pool.peak,
+                                           memory_order_relaxed);
+        while (peak < bytes
+            && !atomic_compare_exchange_weak_explicit(&vlc_frame_pool.peak,
+                        &peak, bytes, memory_order_relaxed,
+                        memory_order_relaxed));
+    }
+
+    atomic_fetch_add_explicit(&cache->refs, 1, memory_order_relaxed);
+    return vlc_frame_Init(&p->frame, &vlc_frame_pool_cbs, p + 1,
+                          vlc_frame_pool_ClassSize(cls) - sizeof (*p));
+}
+
+void vlc_frame_SetPooling(bool enabled)
+{
+    atomic_store_explicit(&vlc_frame_pool.enabled, enabled,
+                          memory_order_relaxed);
+}
+
+void vlc_frame_GetPoolStats(struct vlc_frame_pool_stats *stats)
+{
+    stats->hits = atomic_load_explicit(&vlc_frame_pool.hits,
+                                       memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&vlc_frame_pool.misses,
+                                         memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&vlc_frame_pool.bytes,
+                                        memory_order_relaxed);
+    stats->peak_bytes = atomic_load_explicit(&vlc_frame_pool.peak,
+                                             memory_order_relaxed);
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -120,16 +432,22 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
     }
 
     /* 2 * VLC_FRAME_PADDING: pre + post padding */
-    const size_t alloc = sizeof (vlc_frame_t) + VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING)
-                       + size;
-    if (unlikely(alloc <= size))
-        return NULL;
+    const size_t extra = VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING);
 
-    vlc_frame_t *f = malloc (alloc);
-    if (unlikely(f == NULL))
-        return NULL;
+    vlc_frame_t *f = vlc_frame_pool_Alloc(sizeof (struct vlc_frame_pooled)
+                                          + extra + size);
+    if (f == NULL)
+    {
+        const size_t alloc = sizeof (vlc_frame_t) + extra + size;
+        if (unlikely(alloc <= size))
+            return NULL;
 
-    vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
+        f = malloc (alloc);
+        if (unlikely(f == NULL))
+            return NULL;
+
+        vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
+    }
     static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
                    "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
     f->p_buffer += VLC_FRAME_PADDING + VLC_FRAME_ALIGN - 1;
@@ -257,6 +575,7 @@ static void vlc_frame_heap_Release (vlc_frame_t *frame)
 static const struct vlc_frame_callbacks vlc_frame_heap_cbs =
 {
     vlc_frame_heap_Release,
+    true,
 };
 
 vlc_frame_t *vlc_frame_heap_Alloc (void *addr, size_t length)
@@ -271,6 +590,13 @@ vlc_frame_t *vlc_frame_heap_Alloc (void *addr, size_t length)
     return vlc_frame_Init(frame, &vlc_frame_heap_cbs, addr, length);
 }
 
+bool vlc_frame_IsWritable(const vlc_frame_t *frame)
+{
+    /* Frames that do not own a private buffer may map read-only files or
+     * memory shared with someone else. */
+    return frame->cbs->writable;
+}
+
 #ifdef HAVE_MMAP
 # include <sys/mman.h>
 
@@ -283,6 +609,7 @@ static void vlc_frame_mmap_Release (vlc_frame_t *frame)
 static const struct vlc_frame_callbacks vlc_frame_mmap_cbs =
 {
     vlc_frame_mmap_Release,
+    false,
 };
 
 vlc_frame_t *vlc_frame_mmap_Alloc (void *addr, size_t length)
@@ -332,6 +659,7 @@ static void vlc_frame_mapview_Release (vlc_frame_t *frame)
 static const struct vlc_frame_callbacks vlc_frame_mapview_cbs =
 {
     vlc_frame_mapview_Release,
+    false,
 };
 
 static vlc_frame_t *vlc_frame_mapview_Alloc(HANDLE hMap, void *addr, size_t length)
@@ -363,6 +691,7 @@ static void vlc_frame_shm_Release (vlc_frame_t *frame)
 static const struct vlc_frame_callbacks vlc_frame_shm_cbs =
 {
     vlc_frame_shm_Release,
+    false,
 };
 
 vlc_frame_t *vlc_frame_shm_Alloc (void *addr, size_t length)
@@ -49,11 +49,26 @@
 #include "config/configuration.h"
 #include "modules/modules.h"
 
+typedef struct vlc_modsig
+{
+    uint32_t key; /**< Signature offset and first magic byte */
+    const struct vlc_module_signature *sig;
+    module_t *module;
+} vlc_modsig_t;
+
 typedef struct vlc_modcap
 {
     char *name;
     module_t **modv;
     size_t modc;
+    size_t modmax; /**< Allocated size of modv */
+    vlc_modsig_t *sigv; /**< Signatures of the modules, sorted by key */
+    size_t sigc;
+    uint16_t *offv; /**< Distinct signature offsets */
+    size_t offc;
+    struct vlc_module_shortcut *shortcutv; /**< Shortcuts, sorted by name */
+    size_t shortcutc;
+    struct vlc_module_memo *memov; /**< Probe memo (or NULL) */
 } vlc_modcap_t;
 
 static int vlc_modcap_cmp(const void *a, const void *b)
@@ -66,6 +81,10 @@ static void vlc_modcap_free(void *data)
 {
     vlc_modcap_t *cap = data;
 
+    free(cap->memov);
+    free(cap->shortcutv);
+    free(cap->offv);
+    free(cap->sigv);
     free(cap->modv);
     free(cap->name);
     free(cap);
@@ -79,6 +98,118 @@ static int vlc_module_cmp (const void *a, const void *b)
     return (*mb)->i_score - (*ma)->i_score;
 }
 
+static uint32_t vlc_modsig_key(unsigned offset, uint8_t byte)
+{
+    return (offset << 8) | byte;
+}
+
+static int vlc_modsig_cmp(const void *a, const void *b)
+{
+    const vlc_modsig_t *sa = a, *sb = b;
+
+    if (sa->key != sb->key)
+        return (sa->key < sb->key) ? -1 : 1;
+    return sb->module->i_score - sa->module->i_score;
+}
+
+/**
+ * Builds the signatures dispatch table of a capability: the signatures are
+ * sorted by offset and first magic byte, so that only the few signatures
+ * starting with the byte peeked at each offset need to be compared.
+ */
+static void vlc_modcap_index(vlc_modcap_t *cap)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < cap->modc; i++)
+        count += cap->modv[i]->i_signatures;
+    if (count == 0)
+        return;
+
+    vlc_modsig_t *sigv = vlc_alloc(count, sizeof (*sigv));
+    uint16_t *offv = vlc_alloc(count, sizeof (*offv));
+    if (unlikely(sigv == NULL || offv == NULL))
+    {
+        free(offv);
+        free(sigv);
+        return;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < cap->modc; i++)
+    {
+        module_t *module = cap->modv[i];
+
+        for (unsigned j = 0; j < module->i_signatures; j++)
+        {
+            const struct vlc_module_signature *sig = &module->p_signatures[j];
+
+            sigv[n].key = vlc_modsig_key(sig->offset, sig->magic[0]);
+            sigv[n].sig = sig;
+            sigv[n].module = module;
+            n++;
+        }
+    }
+    qsort(sigv, count, sizeof (*sigv), vlc_modsig_cmp);
+
+    size_t offc = 0;
+    for (size_t i = 0; i < count; i++)
+        if (offc == 0 || offv[offc - 1] != sigv[i].sig->offset)
+            offv[offc++] = sigv[i].sig->offset;
+
+    cap->sigv = sigv;
+    cap->sigc = count;
+    cap->offv = offv;
+    cap->offc = offc;
+}
+
+static int vlc_modshortcut_cmp(const void *a, const void *b)
+{
+    const struct vlc_module_shortcut *sa = a, *sb = b;
+    int ret = strcasecmp(sa->name, sb->name);
+
+    if (ret == 0)
+        ret = (sa->index > sb->index) - (sa->index < sb->index);
+    return ret;
+}
+
+/**
+ * Builds the shortcuts table of a capability, sorted by name then by
+ * decreasing module score, so that the modules matching a name are found
+ * without comparing all the shortcuts of all the modules.
+ */
+static void vlc_modcap_index_shortcuts(vlc_modcap_t *cap)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < cap->modc; i++)
+        count += cap->modv[i]->i_shortcuts;
+    if (count == 0)
+        return;
+
+    struct vlc_module_shortcut *shortcutv = vlc_alloc(count,
+                                                      sizeof (*shortcutv));
+    if (unlikely(shortcutv == NULL))
+        return;
+
+    size_t n = 0;
+    for (size_t i = 0; i < cap->modc; i++)
+    {
+        const module_t *module = cap->modv[i];
+
+        for (unsigned j = 0; j < module->i_shortcuts; j++)
+        {
+            shortcutv[n].name = module->pp_shortcuts[j];
+            shortcutv[n].index = i;
+            n++;
+        }
+    }
+    qsort(shortcutv, count, sizeof (*shortcutv), vlc_modshortcut_cmp);
+
+    cap->shortcutv = shortcutv;
+    cap->shortcutc = count;
+}
+
 static void vlc_modcap_sort(const void *node, const VISIT which,
                             const int depth)
 {
@@ -88,6 +219,8 @@ static void vlc_modcap_sort(const void *node, const VISIT which,
         return;
 
     qsort(cap->modv, cap->modc, sizeof (*cap->modv), vlc_module_cmp);
+    vlc_modcap_index(cap);
+    vlc_modcap_index_shortcuts(cap);
     (void) depth;
 }
 
@@ -103,43 +236,78 @@ static struct
 vlc_plugin_t *vlc_plugins = NULL;
 
 /**
- * Adds a module to the bank
+ * Finds or creates a capability in the bank
  */
-static int vlc_module_store(module_t *mod)
+static vlc_modcap_t *vlc_modcap_get(const char *name)
 {
-    const char *name = module_get_capability(mod);
+    const void **cp = tfind(&name, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp != NULL)
+        return (vlc_modcap_t *)*cp;
+
     vlc_modcap_t *cap = malloc(sizeof (*cap));
     if (unlikely(cap == NULL))
-        return -1;
+        return NULL;
 
     cap->name = strdup(name);
     cap->modv = NULL;
     cap->modc = 0;
-
-    if (unlikely(cap->name == NULL))
-        goto error;
-
-    void **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
-    if (unlikely(cp == NULL))
-        goto error;
-
-    if (*cp != cap)
+    cap->modmax = 0;
+    cap->sigv = NULL;
+    cap->sigc = 0;
+    cap->offv = NULL;
+    cap->offc = 0;
+    cap->shortcutv = NULL;
+    cap->shortcutc = 0;
+    cap->memov = NULL;
+
+    if (unlikely(cap->name == NULL)
+     || unlikely(tsearch(cap, &modules.caps_tree, vlc_modcap_cmp) == NULL))
     {
         vlc_modcap_free(cap);
-        cap = *cp;
+        return NULL;
     }
+    return cap;
+}
+
+static int vlc_modcap_grow(vlc_modcap_t *cap, size_t count)
+{
+    if (count <= cap->modmax)
+        return 0;
 
-    module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
+    module_t **modv = realloc(cap->modv, sizeof (*modv) * count);
     if (unlikely(modv == NULL))
         return -1;
 
     cap->modv = modv;
+    cap->modmax = count;
+    return 0;
+}
+
+void module_ReserveCap(const char *name, size_t count)
+{
+    vlc_mutex_assert(&modules.lock);
+
+    vlc_modcap_t *cap = vlc_modcap_get(name);
+    if (likely(cap != NULL))
+        vlc_modcap_grow(cap, cap->modc + count);
+}
+
+/**
+ * Adds a module to the bank
+ */
+static int vlc_module_store(module_t *mod)
+{
+    vlc_modcap_t *cap = vlc_modcap_get(module_get_capability(mod));
+    if (unlikely(cap == NULL))
+        return -1;
+
+    if (cap->modc == cap->modmax
+     && vlc_modcap_grow(cap, 2 * cap->modmax + 1))
+        return -1;
+
     cap->modv[cap->modc] = mod;
     cap->modc++;
     return 0;
-error:
-    vlc_modcap_free(cap);
-    return -1;
 }
 
 /**
@@ -293,6 +461,16 @@ typedef enum
     CACHE_WRITE_FILE = 0x4,
 } cache_mode_t;
 
+/** Plug-in file found while browsing the plug-ins directories */
+typedef struct module_bank_entry
+{
+    vlc_plugin_t *plugin; /**< Cached or loaded plug-in (or NULL) */
+    char *abspath;
+    char *relpath;
+    int64_t mtime;
+    uint64_t size;
+} module_bank_entry_t;
+
 typedef struct module_bank
 {
     vlc_object_t *obj;
@@ -302,10 +480,21 @@ typedef struct module_bank
     size_t        size;
     vlc_plugin_t **plugins;
     vlc_plugin_t *cache;
+
+    /* Plug-in files, in browsing order */
+    module_bank_entry_t *entries;
+    size_t        count;
+    atomic_size_t next; /**< Next entry to load */
 } module_bank_t;
 
+/* Maximum number of threads loading the plug-ins missing from the cache */
+#define PLUGIN_SCAN_THREADS_MAX 16
+
 /**
  * Scans a plug-in from a file.
+ *
+ * The plug-in is looked up in the cache. Otherwise, it is loaded later by
+ * AllocatePluginEntries().
  */
 static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
                                const char *relpath, const struct stat *st)
@@ -328,38 +517,134 @@ static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
         }
     }
 
-    if (plugin == NULL)
+    module_bank_entry_t *entries =
+        realloc(bank->entries, (bank->count + 1) * sizeof (*entries));
+    if (unlikely(entries == NULL))
+        goto error;
+    bank->entries = entries;
+
+    module_bank_entry_t *entry = &entries[bank->count];
+
+    entry->plugin = plugin;
+    entry->abspath = strdup(abspath);
+    entry->relpath = strdup(relpath);
+    entry->mtime = st->st_mtime;
+    entry->size = st->st_size;
+    if (unlikely(entry->abspath == NULL || entry->relpath == NULL))
+    {
+        free(entry->relpath);
+        free(entry->abspath);
+        goto error;
+    }
+    bank->count++;
+    return 0;
+
+error:
+    if (plugin != NULL)
+        vlc_plugin_destroy(plugin);
+    return -1;
+}
+
+static void *AllocatePluginThread(void *data)
+{
+    module_bank_t *bank = data;
+    size_t i;
+
+    while ((i = atomic_fetch_add_explicit(&bank->next, 1,
+                                          memory_order_relaxed)) < bank->count)
     {
-        char *path = strdup(relpath);
-        if (path == NULL)
-            return -1;
+        module_bank_entry_t *entry = &bank->entries[i];
 
-        plugin = module_InitDynamic(bank->obj, abspath, true);
+        if (entry->plugin != NULL)
+            continue;
 
+        vlc_plugin_t *plugin = module_InitDynamic(bank->obj, entry->abspath,
+                                                  true);
         if (plugin != NULL)
         {
-            plugin->path = path;
-            plugin->mtime = st->st_mtime;
-            plugin->size = st->st_size;
+            plugin->path = entry->relpath;
+            plugin->mtime = entry->mtime;
+            plugin->size = entry->size;
+            entry->relpath = NULL;
         }
-        else free(path);
+        entry->plugin = plugin;
     }
+    return NULL;
+}
 
-    if (plugin == NULL)
-        return -1;
+/**
+ * Loads the plug-ins missing from the cache, and adds all the scanned
+ * plug-ins to the bank.
+ *
+ * Loading a plug-in maps and relocates the shared object, so the missing
+ * plug-ins are loaded by several threads. They are then stored in browsing
+ * order, so that the bank content does not depend on threads scheduling.
+ */
+static void AllocatePluginEntries(module_bank_t *bank)
+{
+    size_t missing = 0;
 
-    vlc_plugin_store(plugin);
+    for (size_t i = 0; i < bank->count; i++)
+        if (bank->entries[i].plugin == NULL)
+            missing++;
 
-    if (bank->mode & CACHE_WRITE_FILE) /* Add entry to to-be-saved cache */
+    if (missing > 0)
     {
-        bank->plugins = xrealloc(bank->plugins,
-                                 (bank->size + 1) * sizeof (vlc_plugin_t *));
-        bank->plugins[bank->size] = plugin;
-        bank->size++;
+        unsigned threads = vlc_GetCPUCount();
+        if (threads > PLUGIN_SCAN_THREADS_MAX)
+            threads = PLUGIN_SCAN_THREADS_MAX;
+        if (threads > missing)
+            threads = missing;
+
+        vlc_thread_t *th = NULL;
+        unsigned started = 0;
+        vlc_tick_t start = vlc_tick_now();
+
+        atomic_init(&bank->next, 0);
+        if (threads > 1)
+            th = vlc_alloc(threads - 1, sizeof (*th));
+        if (th != NULL)
+            while (started < threads - 1
+                && vlc_clone(&th[started], AllocatePluginThread, bank,
+                             VLC_THREAD_PRIORITY_LOW) == 0)
+                started++;
+
+        /* This thread loads plug-ins too */
+        AllocatePluginThread(bank);
+
+        for (unsigned i = 0; i < started; i++)
+            vlc_join(th[i], NULL);
+        free(th);
+
+        msg_Dbg(bank->obj, "loaded %zu plug-ins in %"PRId64" ms "
+                "with %u threads", missing,
+                MS_FROM_VLC_TICK(vlc_tick_now() - start), started + 1);
     }
 
-    /* TODO: deal with errors */
-    return  0;
+    for (size_t i = 0; i < bank->count; i++)
+    {
+        module_bank_entry_t *entry = &bank->entries[i];
+        vlc_plugin_t *plugin = entry->plugin;
+
+        free(entry->relpath);
+        free(entry->abspath);
+
+        if (plugin == NULL)
+            continue;
+
+        vlc_plugin_store(plugin);
+
+        if (bank->mode & CACHE_WRITE_FILE) /* Add entry to to-be-saved cache */
+        {
+            bank->plugins = xrealloc(bank->plugins,
+                                     (bank->size + 1) * sizeof (vlc_plugin_t *));
+            bank->plugins[bank->size] = plugin;
+            bank->size++;
+        }
+    }
+    free(bank->entries);
+    bank->entries = NULL;
+    bank->count = 0;
 }
 
 #ifdef __APPLE__
@@ -530,6 +815,7 @@ static void AllocatePluginPath(vlc_object_t *obj, const char *path,
 
         /* Don't go deeper than 5 subdirectories */
         AllocatePluginDir(&bank, 5, path, NULL);
+        AllocatePluginEntries(&bank);
     }
 
     /* Deal with unmatched cache entries from cache file */
@@ -856,3 +1142,173 @@ size_t module_list_cap(module_t *const **restrict list, const char *name)
     *list = cap->modv;
     return cap->modc;
 }
+
+/* Checks every occurrence of the magic bytes of a signature */
+static bool vlc_modsig_match(const struct vlc_module_signature *sig,
+                             const uint8_t *peek, size_t size)
+{
+    if (vlc_module_signature_end(sig) > size)
+        return false;
+
+    for (unsigned i = 0; i < sig->repeat; i++)
+        if (memcmp(peek + sig->offset + (size_t)i * sig->stride, sig->magic,
+                   sig->length))
+            return false;
+    return true;
+}
+
+size_t module_list_signature(module_t **list, size_t max, const char *name,
+                             const uint8_t *peek, size_t size)
+{
+    const void **cp = tfind(&name, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp == NULL)
+        return 0;
+
+    const vlc_modcap_t *cap = *cp;
+    size_t count = 0;
+
+    for (size_t i = 0; i < cap->offc; i++)
+    {
+        const unsigned offset = cap->offv[i];
+        if (offset >= size)
+            continue;
+
+        /* Find the first signature starting with the peeked byte */
+        const uint32_t key = vlc_modsig_key(offset, peek[offset]);
+        size_t lo = 0, hi = cap->sigc;
+
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+
+            if (cap->sigv[mid].key < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        for (size_t j = lo; j < cap->sigc && cap->sigv[j].key == key; j++)
+        {
+            const struct vlc_module_signature *sig = cap->sigv[j].sig;
+            module_t *module = cap->sigv[j].module;
+
+            if (!vlc_modsig_match(sig, peek, size))
+                continue;
+
+            bool found = false;
+            for (size_t k = 0; k < count && !found; k++)
+                found = list[k] == module;
+            if (found)
+                continue;
+
+            /* Insert by decreasing score */
+            size_t pos = count;
+            while (pos > 0 && list[pos - 1]->i_score < module->i_score)
+                pos--;
+            if (pos >= max)
+                continue;
+
+            if (count == max)
+                count--;
+            memmove(list + pos + 1, list + pos, (count - pos) * sizeof (*list));
+            list[pos] = module;
+            count++;
+        }
+    }
+    return count;
+}
+
+/* Compares a shortcut with the first len characters of name */
+static int vlc_modshortcut_match(const char *shortcut, const char *name,
+                                 size_t len)
+{
+    int ret = strncasecmp(shortcut, name, len);
+
+    if (ret == 0 && shortcut[len] != '\0')
+        ret = 1;
+    return ret;
+}
+
+ssize_t module_list_shortcut(const struct vlc_module_shortcut **list,
+                             const char *cap, const char *name, size_t len)
+{
+    const void **cp = tfind(&cap, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp == NULL)
+        return 0;
+
+    const vlc_modcap_t *capv = *cp;
+    if (unlikely(capv->shortcutv == NULL && capv->modc > 0))
+        return -1;
+
+    size_t lo = 0, hi = capv->shortcutc;
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        if (vlc_modshortcut_match(capv->shortcutv[mid].name, name, len) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    size_t end = lo;
+    while (end < capv->shortcutc
+        && vlc_modshortcut_match(capv->shortcutv[end].name, name, len) == 0)
+        end++;
+
+    *list = capv->shortcutv + lo;
+    return end - lo;
+}
+
+static vlc_mutex_t memo_lock = VLC_STATIC_MUTEX;
+
+static struct vlc_module_memo *vlc_modcap_memo(const vlc_modcap_t *cap,
+                                               uint64_t key)
+{
+    return &cap->memov[key % MODULE_MEMO_SIZE];
+}
+
+bool module_memo_Get(const char *name, uint64_t key,
+                     struct vlc_module_memo *restrict memo)
+{
+    const void **cp = tfind(&name, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp == NULL)
+        return false;
+
+    const vlc_modcap_t *cap = *cp;
+    bool found = false;
+
+    vlc_mutex_lock(&memo_lock);
+    if (cap->memov != NULL)
+    {
+        const struct vlc_module_memo *entry = vlc_modcap_memo(cap, key);
+
+        if (entry->date != VLC_TICK_INVALID && entry->key == key)
+        {
+            *memo = *entry;
+            found = true;
+        }
+    }
+    vlc_mutex_unlock(&memo_lock);
+    return found;
+}
+
+void module_memo_Put(const char *name, const struct vlc_module_memo *memo)
+{
+    const void **cp = tfind(&name, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp == NULL)
+        return;
+
+    vlc_modcap_t *cap = (vlc_modcap_t *)*cp;
+
+    vlc_mutex_lock(&memo_lock);
+    if (cap->memov == NULL)
+    {
+        cap->memov = calloc(MODULE_MEMO_SIZE, sizeof (*cap->memov));
+        static_assert(VLC_TICK_INVALID == 0, "Unused entries are zeroed");
+    }
+    if (likely(cap->memov != NULL))
+        *vlc_modcap_memo(cap, memo->key) = *memo;
+    vlc_mutex_unlock(&memo_lock);
+}
@@ -29,6 +29,7 @@
 
 #include <stdalign.h>
 #include <stdatomic.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -36,9 +37,13 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <assert.h>
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_vector.h>
 #include "libvlc.h"
 
 #include <vlc_plugin.h>
@@ -57,13 +62,150 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 39
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
 /* Magic for the cache filename */
 #define CACHE_STRING "cache "PACKAGE_NAME" "PACKAGE_VERSION
 
+/*
+ * After the version header, the cache is a table of sections, each an array
+ * of fixed-size records, so that it can be used in place from the mapped
+ * file. Strings are stored once in the strings section and referred to by
+ * their byte offset therein, zero meaning NULL. Tables of strings are ranges
+ * of such offsets in the references section.
+ */
+enum vlc_cache_section_id
+{
+    CACHE_PLUGINS, /**< struct vlc_cache_plugin */
+    CACHE_MODULES, /**< struct vlc_cache_module */
+    CACHE_PARAMS, /**< struct vlc_cache_param */
+    CACHE_SIGNATURES, /**< struct vlc_cache_signature */
+    CACHE_CAPS, /**< struct vlc_cache_cap, sorted by name */
+    CACHE_REFS, /**< uint32_t, string offsets */
+    CACHE_INTS, /**< int, integer choices */
+    CACHE_STRINGS, /**< char, strings and signatures magic bytes */
+    CACHE_SECTIONS
+};
+
+/* Alignment of the header and sections within the file */
+#define CACHE_ALIGN 8
+
+struct vlc_cache_section
+{
+    uint32_t offset; /**< Byte offset from the start of the file */
+    uint32_t count; /**< Number of records */
+};
+
+struct vlc_cache_plugin
+{
+    int64_t mtime;
+    uint64_t size;
+    uint32_t path;
+    uint32_t textdomain;
+    uint32_t modules; /**< Index of the first module */
+    uint32_t modules_count;
+    uint32_t params; /**< Index of the first parameter */
+    uint32_t params_count;
+    uint8_t unloadable;
+    uint8_t padding[7];
+};
+
+struct vlc_cache_module
+{
+    uint32_t shortname;
+    uint32_t longname;
+    uint32_t help;
+    uint32_t capability;
+    uint32_t activate;
+    uint32_t deactivate;
+    int32_t score;
+    uint32_t shortcuts; /**< Index of the first shortcut reference */
+    uint32_t signatures; /**< Index of the first signature */
+    uint16_t shortcuts_count;
+    uint16_t signatures_count;
+};
+
+struct vlc_cache_signature
+{
+    uint16_t offset;
+    uint16_t length;
+    uint16_t stride;
+    uint16_t repeat;
+    uint32_t magic; /**< Offset of the magic bytes in the strings */
+};
+
+union vlc_cache_value
+{
+    int64_t i;
+    float f;
+    uint32_t str;
+};
+
+#define CACHE_PARAM_INTERNAL 0x1
+#define CACHE_PARAM_UNSAVED  0x2
+#define CACHE_PARAM_SAFE     0x4
+#define CACHE_PARAM_OBSOLETE 0x8
+
+struct vlc_cache_param
+{
+    union vlc_cache_value orig;
+    union vlc_cache_value min;
+    union vlc_cache_value max;
+    uint32_t type;
+    uint32_t name;
+    uint32_t text;
+    uint32_t longtext;
+    uint32_t list; /**< Index of the first choice (reference or integer) */
+    uint32_t list_text; /**< Index of the first choice text reference */
+    uint16_t list_count;
+    uint8_t item_type;
+    uint8_t shortname;
+    uint8_t flags;
+    uint8_t padding[3];
+};
+
+struct vlc_cache_cap
+{
+    uint32_t name;
+    uint32_t count; /**< Number of modules with the capability */
+};
+
+static const size_t vlc_cache_record_sizes[CACHE_SECTIONS] = {
+    [CACHE_PLUGINS] = sizeof (struct vlc_cache_plugin),
+    [CACHE_MODULES] = sizeof (struct vlc_cache_module),
+    [CACHE_PARAMS] = sizeof (struct vlc_cache_param),
+    [CACHE_SIGNATURES] = sizeof (struct vlc_cache_signature),
+    [CACHE_CAPS] = sizeof (struct vlc_cache_cap),
+    [CACHE_REFS] = sizeof (uint32_t),
+    [CACHE_INTS] = sizeof (int),
+    [CACHE_STRINGS] = sizeof (char),
+};
+
+static_assert(alignof (struct vlc_cache_plugin) <= CACHE_ALIGN
+           && alignof (struct vlc_cache_param) <= CACHE_ALIGN
+           && alignof (struct vlc_cache_section) <= CACHE_ALIGN,
+              "Misaligned cache records");
+
+static size_t vlc_cache_align(size_t offset)
+{
+    return (offset + CACHE_ALIGN - 1) & ~(size_t)(CACHE_ALIGN - 1);
+}
+
+/** Mapped plugins cache */
+struct vlc_cache
+{
+    const void *sections[CACHE_SECTIONS];
+    uint32_t counts[CACHE_SECTIONS];
+
+    /* Descriptors pointing into the mapped file */
+    vlc_plugin_t *plugins;
+    module_t *modules;
+    struct vlc_param *params;
+    struct vlc_module_signature *signatures;
+    const char **refs;
+};
 
 static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
 {
@@ -76,292 +218,331 @@ static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
     return 0;
 }
 
-static int vlc_cache_load_bool(bool *out, block_t *in)
+/**
+ * Finds the sections of a plugins cache.
+ *
+ * \param base start of the cache file
+ * \param length size of the cache file
+ * \param offset offset of the sections table (before alignment)
+ */
+static int vlc_cache_map(struct vlc_cache *cache, const uint8_t *base,
+                         size_t length, size_t offset)
 {
-    unsigned char b;
+    struct vlc_cache_section sections[CACHE_SECTIONS];
 
-    if (vlc_cache_load_immediate(&b, in, 1) || b > 1)
+    if (((uintptr_t)base % CACHE_ALIGN) != 0)
         return -1;
 
-    *out = b;
-    return 0;
-}
+    offset = vlc_cache_align(offset);
+    if (offset > length || length - offset < sizeof (sections))
+        return -1;
 
-static int vlc_cache_load_array(const void **p, size_t size, size_t n,
-                                block_t *file)
-{
-    if (n == 0)
+    memcpy(sections, base + offset, sizeof (sections));
+
+    for (size_t i = 0; i < CACHE_SECTIONS; i++)
     {
-        *p = NULL;
-        return 0;
+        const struct vlc_cache_section *s = &sections[i];
+
+        if ((s->offset % CACHE_ALIGN) != 0 || s->offset > length
+         || (length - s->offset) / vlc_cache_record_sizes[i] < s->count)
+            return -1;
+
+        cache->sections[i] = base + s->offset;
+        cache->counts[i] = s->count;
     }
 
-    if (unlikely(size * n < size))
+    /* All strings are terminated, so they need not be checked one by one. */
+    const char *strings = cache->sections[CACHE_STRINGS];
+    size_t size = cache->counts[CACHE_STRINGS];
+
+    if (size == 0 || strings[0] != '\0' || strings[size - 1] != '\0')
         return -1;
+    return 0;
+}
 
-    size *= n;
+static bool vlc_cache_range(const struct vlc_cache *cache,
+                            enum vlc_cache_section_id id,
+                            uint32_t first, size_t count)
+{
+    return first <= cache->counts[id] && count <= cache->counts[id] - first;
+}
+
+static int vlc_cache_string(const struct vlc_cache *cache, uint32_t offset,
+                            const char **restrict strp)
+{
+    const char *strings = cache->sections[CACHE_STRINGS];
 
-    if (file->i_buffer < size)
+    if (offset >= cache->counts[CACHE_STRINGS])
         return -1;
 
-    *p = file->p_buffer;
-    file->p_buffer += size;
-    file->i_buffer -= size;
+    *strp = (offset != 0) ? strings + offset : NULL;
     return 0;
 }
 
-static int vlc_cache_load_string(const char **restrict p, block_t *file)
+static size_t vlc_cache_reserve(size_t *restrict size, size_t count,
+                                size_t elsize)
 {
-    uint16_t size;
+    size_t offset = (*size + alignof (max_align_t) - 1)
+                    & ~(alignof (max_align_t) - 1);
 
-    if (vlc_cache_load_immediate(&size, file, sizeof (size)) || size > 16384)
-        return -1;
-
-    if (size == 0)
-    {
-        *p = NULL;
-        return 0;
-    }
+    *size = offset + count * elsize;
+    return offset;
+}
 
-    const char *str = (char *)file->p_buffer;
+/**
+ * Allocates the descriptors of all the cached plugins in a single block.
+ */
+static block_t *vlc_cache_alloc(struct vlc_cache *cache)
+{
+    size_t size = 0;
+    size_t plugins = vlc_cache_reserve(&size, cache->counts[CACHE_PLUGINS],
+                                       sizeof (vlc_plugin_t));
+    size_t modules = vlc_cache_reserve(&size, cache->counts[CACHE_MODULES],
+                                       sizeof (module_t));
+    size_t params = vlc_cache_reserve(&size, cache->counts[CACHE_PARAMS],
+                                      sizeof (struct vlc_param));
+    size_t signatures = vlc_cache_reserve(&size,
+                                          cache->counts[CACHE_SIGNATURES],
+                                          sizeof (struct vlc_module_signature));
+    size_t refs = vlc_cache_reserve(&size, cache->counts[CACHE_REFS],
+                                    sizeof (const char *));
+
+    unsigned char *mem = calloc(1, size);
+    if (unlikely(mem == NULL))
+        return NULL;
 
-    if (file->i_buffer < size || str[size - 1] != '\0')
-        return -1;
+    block_t *block = block_heap_Alloc(mem, size);
+    if (unlikely(block == NULL))
+        return NULL;
 
-    file->p_buffer += size;
-    file->i_buffer -= size;
-    *p = str;
-    return 0;
+    cache->plugins = (vlc_plugin_t *)(mem + plugins);
+    cache->modules = (module_t *)(mem + modules);
+    cache->params = (struct vlc_param *)(mem + params);
+    cache->signatures = (struct vlc_module_signature *)(mem + signatures);
+    cache->refs = (const char **)(mem + refs);
+    return block;
 }
 
-static int vlc_cache_load_align(size_t align, block_t *file)
+/**
+ * Resolves the strings references and the signatures.
+ */
+static int vlc_cache_load_tables(struct vlc_cache *cache)
 {
-    assert(align > 0);
+    const uint32_t *refs = cache->sections[CACHE_REFS];
 
-    size_t skip = (-(uintptr_t)file->p_buffer) % align;
-    if (skip == 0)
-        return 0;
+    for (size_t i = 0; i < cache->counts[CACHE_REFS]; i++)
+    {
+        const char *str;
 
-    assert(skip < align);
+        if (vlc_cache_string(cache, refs[i], &str))
+            return -1;
+        cache->refs[i] = (str != NULL) ? str : ""; /* NULL -> empty string */
+    }
 
-    if (file->i_buffer < skip)
-        return -1;
+    const struct vlc_cache_signature *sigs = cache->sections[CACHE_SIGNATURES];
+    const uint8_t *strings = cache->sections[CACHE_STRINGS];
 
-    file->p_buffer += skip;
-    file->i_buffer -= skip;
-    assert((((uintptr_t)file->p_buffer) % align) == 0);
+    for (size_t i = 0; i < cache->counts[CACHE_SIGNATURES]; i++)
+    {
+        const struct vlc_cache_signature *rec = &sigs[i];
+        struct vlc_module_signature *sig = &cache->signatures[i];
+
+        sig->offset = rec->offset;
+        sig->length = rec->length;
+        sig->stride = rec->stride;
+        sig->repeat = rec->repeat;
+        sig->magic = strings + rec->magic;
+
+        if (sig->length == 0 || sig->repeat == 0
+         || vlc_module_signature_end(sig) > MODULE_SIGNATURE_SIZE
+         || !vlc_cache_range(cache, CACHE_STRINGS, rec->magic, rec->length))
+            return -1;
+    }
     return 0;
 }
 
-#define LOAD_IMMEDIATE(a) \
-    if (vlc_cache_load_immediate(&(a), file, sizeof (a))) \
-        goto error
-#define LOAD_FLAG(a) \
-    do \
-    { \
-        bool b; \
-        if (vlc_cache_load_bool(&b, file)) \
-            goto error; \
-        (a) = b; \
-    } while (0)
-#define LOAD_ARRAY(a,n) \
-    do \
-    { \
-        const void *base; \
-        if (vlc_cache_load_array(&base, sizeof (*(a)), (n), file)) \
-            goto error; \
-        (a) = base; \
-    } while (0)
-#define LOAD_STRING(a) \
-    if (vlc_cache_load_string(&(a), file)) \
-        goto error
-#define LOAD_ALIGNOF(t) \
-    if (vlc_cache_load_align(alignof(t), file)) \
+#define LOAD_STRING(a, offset) \
+    if (vlc_cache_string(cache, (offset), &(a))) \
         goto error
 
-static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
+static int vlc_cache_load_config(const struct vlc_cache *cache,
+                                 const struct vlc_cache_param *rec,
+                                 struct vlc_param *param)
 {
     module_config_t *cfg = &param->item;
 
-    LOAD_IMMEDIATE (cfg->i_type);
-    LOAD_IMMEDIATE (param->shortname);
-    LOAD_FLAG (param->internal);
-    LOAD_FLAG (param->unsaved);
-    LOAD_FLAG (param->safe);
-    LOAD_FLAG (param->obsolete);
-    LOAD_STRING (cfg->psz_type);
-    LOAD_STRING (cfg->psz_name);
-    LOAD_STRING (cfg->psz_text);
-    LOAD_STRING (cfg->psz_longtext);
-    LOAD_IMMEDIATE (cfg->list_count);
+    cfg->i_type = rec->item_type;
+    param->shortname = rec->shortname;
+    param->internal = (rec->flags & CACHE_PARAM_INTERNAL) != 0;
+    param->unsaved = (rec->flags & CACHE_PARAM_UNSAVED) != 0;
+    param->safe = (rec->flags & CACHE_PARAM_SAFE) != 0;
+    param->obsolete = (rec->flags & CACHE_PARAM_OBSOLETE) != 0;
+    LOAD_STRING (cfg->psz_type, rec->type);
+    LOAD_STRING (cfg->psz_name, rec->name);
+    LOAD_STRING (cfg->psz_text, rec->text);
+    LOAD_STRING (cfg->psz_longtext, rec->longtext);
+    cfg->list_count = rec->list_count;
+
+    if (!vlc_cache_range(cache, CACHE_REFS, rec->list_text, cfg->list_count))
+        goto error;
+    cfg->list_text = cfg->list_count ? cache->refs + rec->list_text : NULL;
 
     if (IsConfigStringType (cfg->i_type))
     {
         const char *psz;
-        LOAD_STRING(psz);
+        LOAD_STRING (psz, rec->orig.str);
         cfg->orig.psz = (char *)psz;
-        atomic_init(&param->value.str, NULL);
-        vlc_param_SetString(param, psz);
 
-        if (cfg->list_count)
-            cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
-        for (unsigned i = 0; i < cfg->list_count; i++)
+        /* The parameter is not visible yet: no need to synchronize */
+        char *value = NULL;
+        if (psz != NULL && psz[0] != '\0')
         {
-            LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
+            value = strdup(psz);
+            if (unlikely(value == NULL))
                 goto error;
         }
+        atomic_init(&param->value.str, value);
+        cfg->value.psz = value;
+
+        if (!vlc_cache_range(cache, CACHE_REFS, rec->list, cfg->list_count))
+            goto error;
+        cfg->list.psz = cfg->list_count ? cache->refs + rec->list : NULL;
     }
     else
     {
-        LOAD_IMMEDIATE (cfg->orig);
-        LOAD_IMMEDIATE (cfg->min);
-        LOAD_IMMEDIATE (cfg->max);
-        if (IsConfigFloatType(cfg->i_type))
-            atomic_store_explicit(&param->value.f, cfg->orig.f,
-                                  memory_order_relaxed);
+        if (IsConfigFloatType (cfg->i_type))
+        {
+            cfg->orig.f = rec->orig.f;
+            cfg->min.f = rec->min.f;
+            cfg->max.f = rec->max.f;
+            atomic_init(&param->value.f, cfg->orig.f);
+        }
         else
-            atomic_store_explicit(&param->value.i, cfg->orig.i,
-                                  memory_order_relaxed);
-        cfg->value = cfg->orig;
-
-        if (cfg->list_count)
         {
-            LOAD_ALIGNOF(int);
+            cfg->orig.i = rec->orig.i;
+            cfg->min.i = rec->min.i;
+            cfg->max.i = rec->max.i;
+            atomic_init(&param->value.i, cfg->orig.i);
         }
+        cfg->value = cfg->orig;
 
-        LOAD_ARRAY(cfg->list.i, cfg->list_count);
-    }
-
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
-    for (unsigned i = 0; i < cfg->list_count; i++)
-    {
-        LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
+        if (!vlc_cache_range(cache, CACHE_INTS, rec->list, cfg->list_count))
             goto error;
+        cfg->list.i = cfg->list_count
+                      ? (const int *)cache->sections[CACHE_INTS] + rec->list
+                      : NULL;
     }
-
     return 0;
 error:
-    return -1; /* FIXME: leaks */
+    return -1;
 }
 
-static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_module(const struct vlc_cache *cache,
+                                 const struct vlc_cache_module *rec,
+                                 module_t *module)
 {
-    uint16_t lines;
-
-    /* Calculate the structure length */
-    LOAD_IMMEDIATE (lines);
-
-    /* Allocate memory */
-    if (lines)
-    {
-        plugin->conf.params = calloc(sizeof (struct vlc_param), lines);
-        if (unlikely(plugin->conf.params == NULL))
-        {
-            plugin->conf.size = 0;
-            return -1;
-        }
-    }
-    else
-        plugin->conf.params = NULL;
-
-    plugin->conf.size = lines;
-
-    /* Do the duplication job */
-    for (size_t i = 0; i < lines; i++)
-    {
-        struct vlc_param *param = plugin->conf.params + i;
-        module_config_t *item = &param->item;
-
-        if (vlc_cache_load_config(param, file))
-            return -1;
-
-        if (CONFIG_ITEM(item->i_type))
-        {
-            plugin->conf.count++;
-            if (item->i_type == CONFIG_ITEM_BOOL)
-                plugin->conf.booleans++;
-        }
-        param->owner = plugin;
-    }
+    LOAD_STRING(module->psz_shortname, rec->shortname);
+    LOAD_STRING(module->psz_longname, rec->longname);
+    LOAD_STRING(module->psz_help, rec->help);
+    LOAD_STRING(module->activate_name, rec->activate);
+    LOAD_STRING(module->deactivate_name, rec->deactivate);
+    LOAD_STRING(module->psz_capability, rec->capability);
+    module->i_score = rec->score;
+
+    if (rec->shortcuts_count > MODULE_SHORTCUT_MAX
+     || !vlc_cache_range(cache, CACHE_REFS, rec->shortcuts,
+                         rec->shortcuts_count))
+        goto error;
+    module->i_shortcuts = rec->shortcuts_count;
+    module->pp_shortcuts = cache->refs + rec->shortcuts;
 
+    if (rec->signatures_count > MODULE_SIGNATURE_MAX
+     || !vlc_cache_range(cache, CACHE_SIGNATURES, rec->signatures,
+                         rec->signatures_count))
+        goto error;
+    module->i_signatures = rec->signatures_count;
+    module->p_signatures = cache->signatures + rec->signatures;
     return 0;
 error:
-    return -1; /* FIXME: leaks */
+    return -1;
 }
 
-static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_plugin(const struct vlc_cache *cache,
+                                 const struct vlc_cache_plugin *rec,
+                                 vlc_plugin_t *plugin)
 {
-    module_t *module = vlc_module_create(plugin);
-    if (unlikely(module == NULL))
-        return -1;
+    /* The descriptors were zeroed when allocated. */
+    plugin->cached = true;
+    plugin->unloadable = rec->unloadable != 0;
+    atomic_init(&plugin->handle, 0);
+    plugin->mtime = rec->mtime;
+    plugin->size = rec->size;
 
-    LOAD_STRING(module->psz_shortname);
-    LOAD_STRING(module->psz_longname);
-    LOAD_STRING(module->psz_help);
+    const char *path;
+    LOAD_STRING(path, rec->path);
+    if (path == NULL)
+        goto error;
+    plugin->path = (char *)path;
 
-    LOAD_IMMEDIATE(module->i_shortcuts);
-    if (module->i_shortcuts > MODULE_SHORTCUT_MAX)
+    LOAD_STRING(plugin->textdomain, rec->textdomain);
+
+    if (!vlc_cache_range(cache, CACHE_MODULES, rec->modules,
+                         rec->modules_count))
         goto error;
-    else
-    {
-        module->pp_shortcuts =
-            xmalloc (sizeof (*module->pp_shortcuts) * module->i_shortcuts);
-        for (unsigned j = 0; j < module->i_shortcuts; j++)
-            LOAD_STRING(module->pp_shortcuts[j]);
-    }
 
-    LOAD_STRING(module->activate_name);
-    LOAD_STRING(module->deactivate_name);
-    LOAD_STRING(module->psz_capability);
-    LOAD_IMMEDIATE(module->i_score);
-    return 0;
-error:
-    return -1;
-}
+    const struct vlc_cache_module *modrecs = cache->sections[CACHE_MODULES];
+    module_t **tailp = &plugin->module;
 
-static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
-{
-    vlc_plugin_t *plugin = vlc_plugin_create();
-    if (unlikely(plugin == NULL))
-        return NULL;
+    for (size_t i = 0; i < rec->modules_count; i++)
+    {
+        module_t *module = cache->modules + rec->modules + i;
 
-    uint32_t modules;
-    LOAD_IMMEDIATE(modules);
+        if (module->plugin != NULL) /* shared with another plugin */
+            goto error;
 
-    for (size_t i = 0; i < modules; i++)
-        if (vlc_cache_load_module(plugin, file))
+        module->plugin = plugin;
+        if (vlc_cache_load_module(cache, modrecs + rec->modules + i, module))
             goto error;
 
-    if (vlc_cache_load_plugin_config(plugin, file))
+        *tailp = module;
+        tailp = &module->next;
+        plugin->modules_count++;
+    }
+
+    if (!vlc_cache_range(cache, CACHE_PARAMS, rec->params, rec->params_count))
         goto error;
 
-    LOAD_STRING(plugin->textdomain);
+    const struct vlc_cache_param *paramrecs = cache->sections[CACHE_PARAMS];
 
-    const char *path;
-    LOAD_STRING(path);
-    if (path == NULL)
-        goto error;
+    if (rec->params_count > 0)
+        plugin->conf.params = cache->params + rec->params;
 
-    plugin->path = strdup(path);
-    if (unlikely(plugin->path == NULL))
-        goto error;
+    for (size_t i = 0; i < rec->params_count; i++)
+    {
+        struct vlc_param *param = plugin->conf.params + i;
+        const module_config_t *item = &param->item;
 
-    LOAD_FLAG(plugin->unloadable);
-    LOAD_IMMEDIATE(plugin->mtime);
-    LOAD_IMMEDIATE(plugin->size);
+        if (param->owner != NULL) /* shared with another plugin */
+            goto error;
 
-    if (plugin->textdomain != NULL)
-        vlc_bindtextdomain(plugin->textdomain);
+        param->owner = plugin;
+        if (vlc_cache_load_config(cache, paramrecs + rec->params + i, param))
+            goto error;
+        plugin->conf.size++;
 
-    return plugin;
+        if (CONFIG_ITEM(item->i_type))
+        {
+            plugin->conf.count++;
+            if (item->i_type == CONFIG_ITEM_BOOL)
+                plugin->conf.booleans++;
+        }
+    }
 
+    if (plugin->textdomain != NULL)
+        vlc_bindtextdomain(plugin->textdomain);
+    return 0;
 error:
-    vlc_plugin_destroy(plugin);
-    return NULL;
+    return -1;
 }
 
 /**
@@ -371,6 +552,10 @@ error:
  * will in turn be queried by AllocateAllPlugins() to see if it needs to
  * actually load the dynamically loadable module.
  * This allows us to only fully load plugins when they are actually used.
+ *
+ * The strings, integer choices and signatures are used in place from the
+ * mapped file. The descriptors of all plugins, modules and parameters are
+ * allocated at once, and kept with the mapping in *backingp.
  */
 vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
                              block_t **backingp)
@@ -392,6 +577,9 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     if (file == NULL)
         return NULL;
 
+    const uint8_t *base = file->p_buffer;
+    size_t length = file->i_buffer;
+
     /* Check the file is a plugins cache */
     char cachestr[sizeof (CACHE_STRING) - 1];
 
@@ -429,13 +617,15 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     }
 
     /* Check header marker */
+    struct vlc_cache cache;
+
     if (vlc_cache_load_immediate(&marker, file, sizeof (marker))
 #ifdef DISTRO_VERSION
      || marker != (sizeof (cachestr) + sizeof (distrostr) + sizeof (marker))
 #else
      || marker != (sizeof (cachestr) + sizeof (marker))
 #endif
-        )
+     || vlc_cache_map(&cache, base, length, file->p_buffer - base))
     {
         msg_Warn( p_this, "This doesn't look like a valid plugins cache "
                   "(corrupted header)" );
@@ -443,162 +633,457 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    size_t count = cache.counts[CACHE_PLUGINS];
+    if (count == 0)
+    {
+        block_Release(file);
+        return NULL;
+    }
+
+    block_t *descs = vlc_cache_alloc(&cache);
+    if (unlikely(descs == NULL))
+    {
+        block_Release(file);
+        return NULL;
+    }
+
+    const struct vlc_cache_plugin *recs = cache.sections[CACHE_PLUGINS];
+    size_t loaded = 0;
 
-    while (file->i_buffer > 0)
+    if (vlc_cache_load_tables(&cache))
+        goto error;
+
+    for (size_t i = 0; i < count; i++)
     {
-        vlc_plugin_t *plugin = vlc_cache_load_plugin(file);
-        if (plugin == NULL)
+        vlc_plugin_t *plugin = cache.plugins + i;
+
+        loaded = i + 1;
+        if (vlc_cache_load_plugin(&cache, recs + i, plugin))
             goto error;
 
         if (unlikely(asprintf(&plugin->abspath, "%s" DIR_SEP "%s", dir,
                               plugin->path) == -1))
         {
             plugin->abspath = NULL;
-            vlc_plugin_destroy(plugin);
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        /* Keep the file order, which is the directory scan order, so that
+         * vlc_cache_lookup() usually finds the plugin at the list head. */
+        plugin->next = (i + 1 < count) ? plugin + 1 : NULL;
+    }
+
+    /* Make room in the bank for the cached modules of each capability */
+    const struct vlc_cache_cap *caps = cache.sections[CACHE_CAPS];
+
+    for (size_t i = 0; i < cache.counts[CACHE_CAPS]; i++)
+    {
+        const char *name;
+
+        if (vlc_cache_string(&cache, caps[i].name, &name))
+            goto error;
+        if (name != NULL)
+            module_ReserveCap(name, caps[i].count);
     }
 
     file->p_next = *backingp;
-    *backingp = file;
-    return cache;
+    descs->p_next = file;
+    *backingp = descs;
+    return cache.plugins;
 
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    for (size_t i = 0; i < loaded; i++)
+        vlc_plugin_destroy(cache.plugins + i);
+    block_Release(descs);
     block_Release(file);
     return NULL;
 }
 
-#define SAVE_IMMEDIATE( a ) \
-    if (fwrite (&(a), sizeof(a), 1, file) != 1) \
-        goto error
-#define SAVE_FLAG(a) \
-    do { \
-        char b = (a); \
-        SAVE_IMMEDIATE(b); \
-    } while (0)
+/** Plugins cache being saved */
+struct vlc_cache_writer
+{
+    struct VLC_VECTOR(struct vlc_cache_plugin) plugins;
+    struct VLC_VECTOR(struct vlc_cache_module) modules;
+    struct VLC_VECTOR(struct vlc_cache_param) params;
+    struct VLC_VECTOR(struct vlc_cache_signature) signatures;
+    struct VLC_VECTOR(struct vlc_cache_cap) caps;
+    struct VLC_VECTOR(uint32_t) refs;
+    struct VLC_VECTOR(int) ints;
+    struct VLC_VECTOR(char) strings;
+    void *strings_tree; /**< Strings already in the table */
+};
+
+/** String in the strings table */
+struct vlc_cache_string
+{
+    const char *str;
+    uint32_t offset;
+};
 
-static int CacheSaveString (FILE *file, const char *str)
+static int vlc_cache_string_cmp(const void *a, const void *b)
 {
-    uint16_t size = (str != NULL) ? (strlen (str) + 1) : 0;
+    const struct vlc_cache_string *sa = a, *sb = b;
+    return strcmp(sa->str, sb->str);
+}
+
+static int CacheSaveBytes(struct vlc_cache_writer *w, const void *data,
+                          size_t size, uint32_t *restrict offsetp)
+{
+    if (w->strings.size + size > UINT32_MAX
+     || !vlc_vector_push_all(&w->strings, (const char *)data, size))
+        return -1;
+
+    *offsetp = w->strings.size - size;
+    return 0;
+}
 
-    SAVE_IMMEDIATE (size);
-    if (size != 0 && fwrite(str, 1, size, file) != size)
+static int CacheSaveString(struct vlc_cache_writer *w, const char *str,
+                           uint32_t *restrict offsetp)
+{
+    if (str == NULL)
     {
-error:
+        *offsetp = 0;
+        return 0;
+    }
+
+    struct vlc_cache_string *entry = malloc(sizeof (*entry));
+    if (unlikely(entry == NULL))
         return -1;
+
+    entry->str = str;
+
+    void **ep = tsearch(entry, &w->strings_tree, vlc_cache_string_cmp);
+    if (unlikely(ep == NULL))
+    {
+        free(entry);
+        return -1;
+    }
+
+    if (*ep != entry)
+    {   /* Already in the table */
+        free(entry);
+        entry = *ep;
     }
+    else if (CacheSaveBytes(w, str, strlen(str) + 1, &entry->offset))
+    {
+        tdelete(entry, &w->strings_tree, vlc_cache_string_cmp);
+        free(entry);
+        return -1;
+    }
+
+    *offsetp = entry->offset;
     return 0;
 }
 
-#define SAVE_STRING( a ) \
-    if (CacheSaveString (file, (a))) \
+#define SAVE_STRING(a, str) \
+    if (CacheSaveString(w, (str), &(a))) \
         goto error
 
-static int CacheSaveAlign(FILE *file, size_t align)
+static int CacheSaveRefs(struct vlc_cache_writer *w, const char **strv,
+                         size_t count, uint32_t *restrict firstp)
 {
-    assert(align > 0);
+    *firstp = w->refs.size;
 
-    size_t skip = (-ftell(file)) % align;
-    if (skip == 0)
-        return 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t offset;
 
-    assert(((ftell(file) + skip) % align) == 0);
-    return fseek(file, skip, SEEK_CUR);
+        SAVE_STRING(offset, strv[i]);
+        if (!vlc_vector_push(&w->refs, offset))
+            goto error;
+    }
+    return 0;
+error:
+    return -1;
 }
 
-#define SAVE_ALIGNOF(t) \
-    if (CacheSaveAlign(file, alignof (t))) \
-        goto error
-
-static int CacheSaveConfig(FILE *file, const struct vlc_param *param)
+static int CacheSaveConfig(struct vlc_cache_writer *w,
+                           const struct vlc_param *param)
 {
     const module_config_t *cfg = &param->item;
-
-    SAVE_IMMEDIATE (cfg->i_type);
-    SAVE_IMMEDIATE (param->shortname);
-    SAVE_FLAG (param->internal);
-    SAVE_FLAG (param->unsaved);
-    SAVE_FLAG (param->safe);
-    SAVE_FLAG (param->obsolete);
-    SAVE_STRING (cfg->psz_type);
-    SAVE_STRING (cfg->psz_name);
-    SAVE_STRING (cfg->psz_text);
-    SAVE_STRING (cfg->psz_longtext);
-    SAVE_IMMEDIATE (cfg->list_count);
+    struct vlc_cache_param rec;
+
+    memset(&rec, 0, sizeof (rec));
+    rec.item_type = cfg->i_type;
+    rec.shortname = param->shortname;
+    rec.flags = (param->internal ? CACHE_PARAM_INTERNAL : 0)
+              | (param->unsaved ? CACHE_PARAM_UNSAVED : 0)
+              | (param->safe ? CACHE_PARAM_SAFE : 0)
+              | (param->obsolete ? CACHE_PARAM_OBSOLETE : 0);
+    SAVE_STRING (rec.type, cfg->psz_type);
+    SAVE_STRING (rec.name, cfg->psz_name);
+    SAVE_STRING (rec.text, cfg->psz_text);
+    SAVE_STRING (rec.longtext, cfg->psz_longtext);
+    rec.list_count = cfg->list_count;
 
     if (IsConfigStringType (cfg->i_type))
     {
-        SAVE_STRING (cfg->orig.psz);
+        SAVE_STRING (rec.orig.str, cfg->orig.psz);
 
-        for (unsigned i = 0; i < cfg->list_count; i++)
-            SAVE_STRING (cfg->list.psz[i]);
+        if (CacheSaveRefs(w, cfg->list.psz, cfg->list_count, &rec.list))
+            goto error;
     }
     else
     {
-        SAVE_IMMEDIATE (cfg->orig);
-        SAVE_IMMEDIATE (cfg->min);
-        SAVE_IMMEDIATE (cfg->max);
-
-        if (cfg->list_count > 0)
+        if (IsConfigFloatType (cfg->i_type))
+        {
+            rec.orig.f = cfg->orig.f;
+            rec.min.f = cfg->min.f;
+            rec.max.f = cfg->max.f;
+        }
+        else
         {
-            SAVE_ALIGNOF(int);
+            rec.orig.i = cfg->orig.i;
+            rec.min.i = cfg->min.i;
+            rec.max.i = cfg->max.i;
         }
 
-        for (unsigned i = 0; i < cfg->list_count; i++)
-             SAVE_IMMEDIATE (cfg->list.i[i]);
+        rec.list = w->ints.size;
+        if (cfg->list_count > 0
+         && !vlc_vector_push_all(&w->ints, cfg->list.i, cfg->list_count))
+            goto error;
+    }
+
+    if (CacheSaveRefs(w, cfg->list_text, cfg->list_count, &rec.list_text)
+     || !vlc_vector_push(&w->params, rec))
+        goto error;
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheSaveModule(struct vlc_cache_writer *w, const module_t *module)
+{
+    struct vlc_cache_module rec;
+
+    memset(&rec, 0, sizeof (rec));
+    SAVE_STRING(rec.shortname, module->psz_shortname);
+    SAVE_STRING(rec.longname, module->psz_longname);
+    SAVE_STRING(rec.help, module->psz_help);
+    SAVE_STRING(rec.activate, module->activate_name);
+    SAVE_STRING(rec.deactivate, module->deactivate_name);
+    SAVE_STRING(rec.capability, module->psz_capability);
+    rec.score = module->i_score;
+
+    rec.shortcuts_count = module->i_shortcuts;
+    if (CacheSaveRefs(w, module->pp_shortcuts, module->i_shortcuts,
+                      &rec.shortcuts))
+        goto error;
+
+    rec.signatures = w->signatures.size;
+    rec.signatures_count = module->i_signatures;
+
+    for (size_t j = 0; j < module->i_signatures; j++)
+    {
+        const struct vlc_module_signature *sig = &module->p_signatures[j];
+        struct vlc_cache_signature sigrec = {
+            .offset = sig->offset,
+            .length = sig->length,
+            .stride = sig->stride,
+            .repeat = sig->repeat,
+        };
+
+        if (CacheSaveBytes(w, sig->magic, sig->length, &sigrec.magic)
+         || !vlc_vector_push(&w->signatures, sigrec))
+            goto error;
     }
-    for (unsigned i = 0; i < cfg->list_count; i++)
-        SAVE_STRING (cfg->list_text[i]);
 
+    if (!vlc_vector_push(&w->modules, rec))
+        goto error;
     return 0;
 error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSavePlugin(struct vlc_cache_writer *w,
+                           const vlc_plugin_t *plugin)
 {
-    uint16_t lines = plugin->conf.size;
+    struct vlc_cache_plugin rec;
+
+    memset(&rec, 0, sizeof (rec));
+    rec.mtime = plugin->mtime;
+    rec.size = plugin->size;
+    rec.unloadable = plugin->unloadable;
+    SAVE_STRING(rec.path, plugin->path);
+    SAVE_STRING(rec.textdomain, plugin->textdomain);
+
+    rec.modules = w->modules.size;
+    rec.modules_count = plugin->modules_count;
+
+    for (const module_t *module = plugin->module;
+         module != NULL;
+         module = module->next)
+        if (CacheSaveModule(w, module))
+            goto error;
 
-    SAVE_IMMEDIATE (lines);
+    rec.params = w->params.size;
+    rec.params_count = plugin->conf.size;
 
-    for (size_t i = 0; i < lines; i++)
-        if (CacheSaveConfig(file, plugin->conf.params + i))
-           goto error;
+    for (size_t i = 0; i < plugin->conf.size; i++)
+        if (CacheSaveConfig(w, plugin->conf.params + i))
+            goto error;
 
+    if (!vlc_vector_push(&w->plugins, rec))
+        goto error;
     return 0;
 error:
     return -1;
 }
 
-static int CacheSaveModule(FILE *file, const module_t *module)
+static int vlc_cache_cap_cmp(const void *a, const void *b)
 {
-    SAVE_STRING(module->psz_shortname);
-    SAVE_STRING(module->psz_longname);
-    SAVE_STRING(module->psz_help);
-    SAVE_IMMEDIATE(module->i_shortcuts);
+    const char *const *na = a, *const *nb = b;
+    return strcmp(*na, *nb);
+}
+
+/**
+ * Saves the capabilities index: the count of modules of each capability,
+ * sorted by capability name.
+ */
+static int CacheSaveCaps(struct vlc_cache_writer *w,
+                         vlc_plugin_t *const *cache, size_t n)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++)
+        count += cache[i]->modules_count;
+    if (count == 0)
+        return 0;
+
+    const char **names = vlc_alloc(count, sizeof (*names));
+    if (unlikely(names == NULL))
+        return -1;
+
+    count = 0;
+    for (size_t i = 0; i < n; i++)
+        for (const module_t *module = cache[i]->module;
+             module != NULL;
+             module = module->next)
+            if (module->psz_capability != NULL)
+                names[count++] = module->psz_capability;
+
+    qsort(names, count, sizeof (*names), vlc_cache_cap_cmp);
+
+    for (size_t i = 0; i < count;)
+    {
+        struct vlc_cache_cap rec;
+        size_t j = i + 1;
+
+        while (j < count && strcmp(names[i], names[j]) == 0)
+            j++;
 
-    for (size_t j = 0; j < module->i_shortcuts; j++)
-         SAVE_STRING(module->pp_shortcuts[j]);
+        rec.count = j - i;
+        SAVE_STRING(rec.name, names[i]);
+        if (!vlc_vector_push(&w->caps, rec))
+            goto error;
+        i = j;
+    }
 
-    SAVE_STRING(module->activate_name);
-    SAVE_STRING(module->deactivate_name);
-    SAVE_STRING(module->psz_capability);
-    SAVE_IMMEDIATE(module->i_score);
+    free(names);
     return 0;
 error:
+    free(names);
     return -1;
 }
 
+static int CacheSaveAlign(FILE *file, size_t align)
+{
+    assert(align > 0);
+
+    size_t skip = (-ftell(file)) % align;
+    if (skip == 0)
+        return 0;
+
+    assert(((ftell(file) + skip) % align) == 0);
+    return fseek(file, skip, SEEK_CUR);
+}
+
+static int CacheSaveSections(FILE *file, const struct vlc_cache_writer *w)
+{
+    const void *const data[CACHE_SECTIONS] = {
+        [CACHE_PLUGINS] = w->plugins.data,
+        [CACHE_MODULES] = w->modules.data,
+        [CACHE_PARAMS] = w->params.data,
+        [CACHE_SIGNATURES] = w->signatures.data,
+        [CACHE_CAPS] = w->caps.data,
+        [CACHE_REFS] = w->refs.data,
+        [CACHE_INTS] = w->ints.data,
+        [CACHE_STRINGS] = w->strings.data,
+    };
+    const size_t counts[CACHE_SECTIONS] = {
+        [CACHE_PLUGINS] = w->plugins.size,
+        [CACHE_MODULES] = w->modules.size,
+        [CACHE_PARAMS] = w->params.size,
+        [CACHE_SIGNATURES] = w->signatures.size,
+        [CACHE_CAPS] = w->caps.size,
+        [CACHE_REFS] = w->refs.size,
+        [CACHE_INTS] = w->ints.size,
+        [CACHE_STRINGS] = w->strings.size,
+    };
+    struct vlc_cache_section sections[CACHE_SECTIONS];
+    long pos = ftell(file);
+
+    if (pos < 0)
+        return -1;
+
+    size_t offset = vlc_cache_align(pos) + sizeof (sections);
+
+    for (size_t i = 0; i < CACHE_SECTIONS; i++)
+    {
+        offset = vlc_cache_align(offset);
+        if (offset > UINT32_MAX || counts[i] > UINT32_MAX)
+            return -1;
+
+        sections[i].offset = offset;
+        sections[i].count = counts[i];
+        offset += counts[i] * vlc_cache_record_sizes[i];
+    }
+
+    if (CacheSaveAlign(file, CACHE_ALIGN)
+     || fwrite(sections, sizeof (sections), 1, file) != 1)
+        return -1;
+
+    for (size_t i = 0; i < CACHE_SECTIONS; i++)
+    {
+        if (counts[i] == 0)
+            continue;
+
+        if (CacheSaveAlign(file, CACHE_ALIGN)
+         || fwrite(data[i], vlc_cache_record_sizes[i], counts[i], file)
+                != counts[i])
+            return -1;
+    }
+    return 0;
+}
+
 static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 {
+    struct vlc_cache_writer w;
     uint32_t i_file_size = 0;
+    int ret = -1;
+
+    vlc_vector_init(&w.plugins);
+    vlc_vector_init(&w.modules);
+    vlc_vector_init(&w.params);
+    vlc_vector_init(&w.signatures);
+    vlc_vector_init(&w.caps);
+    vlc_vector_init(&w.refs);
+    vlc_vector_init(&w.ints);
+    vlc_vector_init(&w.strings);
+    w.strings_tree = NULL;
+
+    /* The offset zero stands for NULL strings */
+    if (!vlc_vector_push(&w.strings, '\0'))
+        goto error;
+
+    for (size_t i = 0; i < n; i++)
+        if (CacheSavePlugin(&w, cache[i]))
+            goto error;
+
+    if (CacheSaveCaps(&w, cache, n))
+        goto error;
 
     /* Contains version number */
     if (fputs (CACHE_STRING, file) == EOF)
@@ -619,37 +1104,24 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1)
         goto error;
 
-    for (size_t i = 0; i < n; i++)
-    {
-        const vlc_plugin_t *plugin = cache[i];
-        uint32_t count = plugin->modules_count;
-
-        SAVE_IMMEDIATE(count);
-
-        for (module_t *module = plugin->module;
-             module != NULL;
-             module = module->next)
-            if (CacheSaveModule(file, module))
-                goto error;
-
-        /* Config stuff */
-        if (CacheSaveModuleConfig(file, plugin))
-            goto error;
-
-        /* Save common info */
-        SAVE_STRING(plugin->textdomain);
-        SAVE_STRING(plugin->path);
-        SAVE_FLAG(plugin->unloadable);
-        SAVE_IMMEDIATE(plugin->mtime);
-        SAVE_IMMEDIATE(plugin->size);
-    }
+    if (CacheSaveSections(file, &w))
+        goto error;
 
     if (fflush (file)) /* flush libc buffers */
         goto error;
-    return 0; /* success! */
+    ret = 0; /* success! */
 
 error:
-    return -1;
+    tdestroy(w.strings_tree, free);
+    vlc_vector_destroy(&w.strings);
+    vlc_vector_destroy(&w.ints);
+    vlc_vector_destroy(&w.refs);
+    vlc_vector_destroy(&w.caps);
+    vlc_vector_destroy(&w.signatures);
+    vlc_vector_destroy(&w.params);
+    vlc_vector_destroy(&w.modules);
+    vlc_vector_destroy(&w.plugins);
+    return ret;
 }
 
 /**
@@ -70,6 +70,8 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->i_shortcuts = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
+    module->i_signatures = 0;
+    module->p_signatures = NULL;
     module->activate_name = NULL;
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
@@ -87,6 +89,7 @@ void vlc_module_destroy (module_t *module)
         module_t *next = module->next;
 
         free(module->pp_shortcuts);
+        free(module->p_signatures);
         free(module);
         module = next;
     }
@@ -106,6 +109,7 @@ vlc_plugin_t *vlc_plugin_create(void)
     plugin->conf.booleans = 0;
 #ifdef HAVE_DYNAMIC_PLUGINS
     plugin->unloadable = true;
+    plugin->cached = false;
     atomic_init(&plugin->handle, 0);
     plugin->abspath = NULL;
     plugin->path = NULL;
@@ -125,6 +129,20 @@ void vlc_plugin_destroy(vlc_plugin_t *plugin)
     assert(plugin != NULL);
 #ifdef HAVE_DYNAMIC_PLUGINS
     assert(!plugin->unloadable || atomic_load(&plugin->handle) == 0);
+
+    if (plugin->cached)
+    {   /* Only the values and the absolute path are not from the cache */
+        for (size_t i = 0; i < plugin->conf.size; i++)
+        {
+            struct vlc_param *param = plugin->conf.params + i;
+
+            if (IsConfigStringType(param->item.i_type))
+                free(atomic_load_explicit(&param->value.str,
+                                          memory_order_relaxed));
+        }
+        free(plugin->abspath);
+        return;
+    }
 #endif
 
     if (plugin->module != NULL)
@@ -314,6 +332,37 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             plugin->textdomain = va_arg(ap, const char *);
             break;
 
+        case VLC_MODULE_SIGNATURE:
+        {
+            unsigned offset = va_arg (ap, unsigned);
+            const char *magic = va_arg (ap, const char *);
+            size_t length = va_arg (ap, size_t);
+            unsigned stride = va_arg (ap, unsigned);
+            unsigned repeat = va_arg (ap, unsigned);
+            unsigned index = module->i_signatures;
+            /* Signatures must fit in the peeked bytes */
+            assert(length > 0 && repeat > 0 && (repeat == 1 || stride > 0));
+            assert(offset + (size_t)(repeat - 1) * stride + length
+                   <= MODULE_SIGNATURE_SIZE);
+            assert(index < MODULE_SIGNATURE_MAX);
+
+            struct vlc_module_signature *sigs =
+                realloc (module->p_signatures, sizeof (*sigs) * (index + 1));
+            if (unlikely(sigs == NULL))
+            {
+                ret = -1;
+                break;
+            }
+            module->p_signatures = sigs;
+            module->i_signatures = index + 1;
+            sigs[index].offset = offset;
+            sigs[index].length = length;
+            sigs[index].stride = stride;
+            sigs[index].repeat = repeat;
+            sigs[index].magic = (const uint8_t *)magic;
+            break;
+        }
+
         case VLC_CONFIG_NAME:
         {
             struct vlc_param *param = tgt;
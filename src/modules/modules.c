@@ -145,6 +145,25 @@ ssize_t vlc_module_match(const char *capability, const char *names,
                 break;
             }
 
+            const struct vlc_module_shortcut *shortcuts;
+            ssize_t count = module_list_shortcut(&shortcuts, capability,
+                                                 shortcut, slen);
+
+            if (likely(count >= 0)) {
+                /* Shortcuts of a given name are sorted by module score */
+                for (ssize_t i = 0; i < count; i++) {
+                    size_t index = shortcuts[i].index;
+                    module_t *cand = unsorted[index];
+
+                    if (cand != NULL) {
+                        assert(matches < total);
+                        sorted[matches++] = cand;
+                        unsorted[index] = NULL;
+                    }
+                }
+                continue;
+            }
+
             for (size_t i = 0; i < total; i++) {
                 module_t *cand = unsorted[i];
 
@@ -188,28 +207,18 @@ void *vlc_module_map(vlc_logger_t *log, module_t *module)
 }
 
 /**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
+ * Probes the candidate modules, like vlc_module_load().
  *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
+ * With a memo of the same request, the module that was loaded is probed
+ * first, and the modules that just failed are not probed again. The modules
+ * that fail are added to the result, if any.
  */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+static module_t *vlc_module_vload(struct vlc_logger *log,
+                                  const char *capability, const char *name,
+                                  bool strict,
+                                  const struct vlc_module_memo *memo,
+                                  struct vlc_module_memo *result,
+                                  vlc_activate_t probe, va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -223,41 +232,60 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
     if (unlikely(total < 0))
         return NULL;
 
-    vlc_debug(log, "looking for %s module matching \"%s\": %zd candidates",
-              capability, name, total);
+    if (memo != NULL)
+        vlc_debug(log, "looking for %s module matching \"%s\": %zd "
+                  "candidates, %s%u skipped", capability, name, total,
+                  memo->module != NULL ? "1 memoized, " : "", memo->failedc);
+    else
+        vlc_debug(log, "looking for %s module matching \"%s\": %zd "
+                  "candidates", capability, name, total);
 
     module_t *module = NULL;
-    va_list args;
 
-    va_start(args, probe);
+    /* The memoized module is probed alone first */
+    for (int pass = (memo != NULL && memo->module != NULL) ? 0 : 1;
+         pass < 2; pass++)
+    {
+        for (size_t i = 0; i < (size_t)total; i++) {
+            module_t *cand = mods[i];
+
+            if (memo != NULL) {
+                bool skip = (pass == 0) != (cand == memo->module);
 
-    for (size_t i = 0; i < (size_t)total; i++) {
-        module_t *cand = mods[i];
-        int ret = VLC_EGENERIC;
-        void *cb = vlc_module_map(log, cand);
+                /* Do not probe again the modules that just failed */
+                for (unsigned j = 0; j < memo->failedc && !skip; j++)
+                    skip = memo->failed[j] == cand;
+                if (skip)
+                    continue;
+            }
 
-        if (cb != NULL) {
-            va_list ap;
+            int ret = VLC_EGENERIC;
+            void *cb = vlc_module_map(log, cand);
 
-            va_copy(ap, args);
-            ret = probe(cb, i < strict_total, ap);
-            va_end(ap);
-        }
+            if (cb != NULL) {
+                va_list ap;
 
-        switch (ret) {
-            case VLC_SUCCESS:
-                vlc_debug(log, "using %s module \"%s\"", capability,
-                          module_get_object(cand));
-                module = cand;
-                /* fall through */
-            case VLC_ETIMEOUT:
-                goto done;
+                va_copy(ap, args);
+                ret = probe(cb, i < strict_total, ap);
+                va_end(ap);
+            }
+
+            switch (ret) {
+                case VLC_SUCCESS:
+                    vlc_debug(log, "using %s module \"%s\"", capability,
+                              module_get_object(cand));
+                    module = cand;
+                    /* fall through */
+                case VLC_ETIMEOUT:
+                    goto done;
+            }
+
+            if (result != NULL && result->failedc < MODULE_MEMO_FAILED_MAX)
+                result->failed[result->failedc++] = cand;
         }
     }
 
 done:
-    va_end (args);
-
     if (module == NULL)
         vlc_debug(log, "no %s modules matched with name %s", capability, name);
 
@@ -265,6 +293,39 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vload(log, capability, name, strict,
+                                        NULL, NULL, probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
@@ -278,13 +339,19 @@ static int generic_start(void *func, bool forced, va_list ap)
     return ret;
 }
 
-#undef module_need
-module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
-                      bool strict)
+static module_t *module_need_common(vlc_object_t *obj, const char *cap,
+                                    const char *name, bool strict,
+                                    const struct vlc_module_memo *memo,
+                                    struct vlc_module_memo *result, ...)
 {
     const bool b_force_backup = obj->force; /* FIXME: remove this */
-    module_t *module = vlc_module_load(obj->logger, cap, name, strict,
-                                       generic_start, obj);
+    va_list args;
+
+    va_start(args, result);
+    module_t *module = vlc_module_vload(obj->logger, cap, name, strict,
+                                        memo, result, generic_start, args);
+    va_end(args);
+
     if (module != NULL) {
         var_Create(obj, "module-name", VLC_VAR_STRING);
         var_SetString(obj, "module-name", module_get_object(module));
@@ -294,6 +361,68 @@ module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
     return module;
 }
 
+#undef module_need
+module_t *module_need(vlc_object_t *obj, const char *cap, const char *name,
+                      bool strict)
+{
+    return module_need_common(obj, cap, name, strict, NULL, NULL, obj);
+}
+
+/* FNV-1a */
+static uint64_t module_memo_Hash(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ p[i]) * UINT64_C(0x100000001b3);
+    return hash;
+}
+
+module_t *module_need_memo(vlc_object_t *obj, const char *cap,
+                           const char *name, bool strict,
+                           const void *key, size_t keylen)
+{
+    if (name == NULL || name[0] == '\0')
+        name = "any";
+
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    hash = module_memo_Hash(hash, name, strlen(name) + 1);
+    hash = module_memo_Hash(hash, key, keylen);
+
+    vlc_tick_t now = vlc_tick_now();
+    struct vlc_module_memo memo;
+
+    if (!module_memo_Get(cap, hash, &memo)
+     || (memo.module == NULL && now - memo.date > MODULE_MEMO_FAILED_DELAY))
+    {
+        memo.module = NULL;
+        memo.failedc = 0;
+    }
+
+    struct vlc_module_memo result = { .key = hash, .date = now };
+    module_t *module = module_need_common(obj, cap, name, strict, &memo,
+                                          &result, obj);
+
+    if (module == NULL)
+    {
+        /* Keep the modules that failed earlier, until they are retried */
+        for (unsigned j = 0; j < memo.failedc
+                          && result.failedc < MODULE_MEMO_FAILED_MAX; j++)
+            result.failed[result.failedc++] = memo.failed[j];
+        if (memo.failedc > 0)
+            result.date = memo.date;
+        module_memo_Put(cap, &result);
+    }
+    else if (module != memo.module)
+    {
+        result.module = module;
+        result.failedc = 0;
+        module_memo_Put(cap, &result);
+    }
+    return module;
+}
+
 #undef module_unneed
 void module_unneed(vlc_object_t *obj, module_t *module)
 {
@@ -49,6 +49,7 @@ typedef struct vlc_plugin_t
 
 #ifdef HAVE_DYNAMIC_PLUGINS
     bool unloadable; /**< Whether the plug-in can be unloaded safely */
+    bool cached; /**< Whether the descriptors belong to the plugins cache */
     atomic_uintptr_t handle; /**< Run-time linker handle (or nul) */
     char *abspath; /**< Absolute path */
 
@@ -64,6 +65,27 @@ typedef struct vlc_plugin_t
 extern struct vlc_plugin_t *vlc_plugins;
 
 #define MODULE_SHORTCUT_MAX 20
+#define MODULE_SIGNATURE_MAX 8
+/** Stream bytes covered by the module signatures */
+#define MODULE_SIGNATURE_SIZE 1024
+
+/** Magic bytes recognized by a module */
+struct vlc_module_signature
+{
+    uint16_t offset; /**< Offset of the magic bytes within the stream */
+    uint16_t length; /**< Length of the magic bytes */
+    uint16_t stride; /**< Distance between the repeated magic bytes */
+    uint16_t repeat; /**< Number of occurrences of the magic bytes */
+    const uint8_t *magic;
+};
+
+/** Stream bytes covered by a signature */
+static inline size_t vlc_module_signature_end(
+    const struct vlc_module_signature *sig)
+{
+    return sig->offset + (size_t)(sig->repeat - 1) * sig->stride
+           + sig->length;
+}
 
 /** Plugin entry point prototype */
 typedef int (*vlc_plugin_cb) (int (*)(void *, void *, int, ...), void *);
@@ -96,6 +118,10 @@ struct module_t
     const char *psz_capability;                              /**< Capability */
     int      i_score;                          /**< Score for the capability */
 
+    /** Signatures of the streams handled by the module */
+    unsigned    i_signatures;
+    struct vlc_module_signature *p_signatures;
+
     /* Callbacks */
     const char *activate_name;
     const char *deactivate_name;
@@ -129,6 +155,97 @@ void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
  */
 size_t module_list_cap(module_t *const **, const char *);
 
+/**
+ * Reserves room in the bank for modules of a given capability.
+ *
+ * This is only an allocation hint, used with the capabilities index of the
+ * plugins cache.
+ *
+ * @param name name of the capability
+ * @param count number of modules to reserve room for
+ */
+void module_ReserveCap(const char *name, size_t count);
+
+/**
+ * Lists the VLC modules with a given capability recognizing a stream.
+ *
+ * The modules are found from the signatures table of the capability, built
+ * when the plugins are loaded. The list is sorted by decreasing module score.
+ *
+ * @param list table of modules [OUT]
+ * @param max size of the table
+ * @param name name of capability of modules to look for
+ * @param peek first bytes of the stream
+ * @param size number of bytes in peek
+ * @return the number of modules in the list (possibly zero)
+ */
+size_t module_list_signature(module_t **list, size_t max, const char *name,
+                             const uint8_t *peek, size_t size);
+
+/** Shortcut of a module, in the shortcuts table of a capability */
+struct vlc_module_shortcut
+{
+    const char *name;
+    size_t index; /**< Index of the module in the module_list_cap() list */
+};
+
+/**
+ * Lists the VLC modules with a given capability and shortcut.
+ *
+ * The list is sorted by decreasing module score.
+ *
+ * @param list pointer to the table of shortcuts [OUT]
+ * @param cap name of capability of modules to look for
+ * @param name shortcut (not nul-terminated)
+ * @param len length of the shortcut in bytes
+ * @return the number of shortcuts in the list (possibly zero),
+ *         or -1 if the table could not be built
+ */
+ssize_t module_list_shortcut(const struct vlc_module_shortcut **list,
+                             const char *cap, const char *name, size_t len);
+
+#define MODULE_MEMO_SIZE 64
+#define MODULE_MEMO_FAILED_MAX 8
+/* Delay before probing again the modules that failed */
+#define MODULE_MEMO_FAILED_DELAY VLC_TICK_FROM_SEC(5)
+
+/**
+ * Outcome of a module request, by capability
+ */
+struct vlc_module_memo
+{
+    uint64_t key; /**< Hash of the request names and parameters */
+    vlc_tick_t date; /**< Date of the request */
+    module_t *module; /**< Module that was loaded (or NULL) */
+    module_t *failed[MODULE_MEMO_FAILED_MAX]; /**< Modules that failed */
+    unsigned failedc;
+};
+
+/**
+ * Looks up the outcome of the last identical request of a capability.
+ */
+bool module_memo_Get(const char *cap, uint64_t key,
+                     struct vlc_module_memo *memo);
+
+/**
+ * Remembers the outcome of a request of a capability.
+ */
+void module_memo_Put(const char *cap, const struct vlc_module_memo *memo);
+
+/**
+ * Finds and instantiates the best module of a certain type, like
+ * module_need(), remembering the outcome for the given request parameters.
+ *
+ * The module that was loaded for the same parameters is probed first, and the
+ * modules that just failed for the same parameters are not probed again.
+ *
+ * @param key request parameters, without padding
+ * @param keylen size of the request parameters in bytes
+ */
+module_t *module_need_memo(vlc_object_t *obj, const char *cap,
+                           const char *name, bool strict,
+                           const void *key, size_t keylen);
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
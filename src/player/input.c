@@ -26,6 +26,7 @@
 #include <vlc_interface.h>
 #include <vlc_memstream.h>
 #include "player.h"
+#include "input/resource.h"
 
 struct vlc_player_track_priv *
 vlc_player_input_FindTrackById(struct vlc_player_input *input, vlc_es_id_t *id,
@@ -90,6 +91,25 @@ vlc_player_input_UpdateTime(struct vlc_player_input *input)
                                         vlc_player_input_GetPos(input));
 }
 
+static void
+vlc_player_input_PreOpenNext(struct vlc_player_input *input)
+{
+    vlc_player_t *player = input->player;
+
+    if (input->preopen == 0 || input->preopened || input != player->input
+     || input->length <= 0 || input->time == VLC_TICK_INVALID
+     || input->time < input->length - input->preopen)
+        return;
+
+    input->preopened = true;
+    vlc_player_PrepareNextMedia(player);
+    if (player->next_media)
+    {
+        msg_Dbg(player, "pre-opening the next media");
+        input_resource_AddPreTuned(player->resource, player->next_media);
+    }
+}
+
 int
 vlc_player_input_Start(struct vlc_player_input *input)
 {
@@ -795,6 +815,8 @@ input_thread_Events(input_thread_t *input_thread,
                 vlc_player_SendEvent(player, on_length_changed, input->length);
                 changed = true;
             }
+            if (changed)
+                vlc_player_input_PreOpenNext(input);
 
             if (input->normal_time != event->times.normal_time)
             {
@@ -847,6 +869,10 @@ input_thread_Events(input_thread_t *input_thread,
             input->cache = event->cache;
             vlc_player_SendEvent(player, on_buffering_changed, event->cache);
             break;
+        case INPUT_EVENT_INDEX_PROGRESS:
+            vlc_player_SendEvent(player, on_index_progress_changed,
+                                 event->index_progress);
+            break;
         case INPUT_EVENT_VOUT:
             vlc_player_input_HandleVoutEvent(input, &event->vout);
             break;
@@ -935,6 +961,9 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
     input->player = player;
     input->started = false;
     input->playing = false;
+    input->preopen =
+        VLC_TICK_FROM_MS(var_InheritInteger(player, "next-preopen"));
+    input->preopened = false;
 
     input->state = VLC_PLAYER_STATE_STOPPED;
     input->error = VLC_PLAYER_ERROR_NONE;
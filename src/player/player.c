@@ -116,6 +116,16 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
     return ret;
 }
 
+void
+vlc_player_SetPreTunedMedias(vlc_player_t *player, input_item_t *const *medias,
+                             size_t count)
+{
+    vlc_player_assert_locked(player);
+
+    /* The current media may not be taken by its input yet */
+    input_resource_SetPreTuned(player->resource, medias, count, player->media);
+}
+
 static void
 vlc_player_CancelWaitError(vlc_player_t *player)
 {
@@ -244,7 +254,10 @@ vlc_player_destructor_Thread(void *data)
             const bool started = player->started;
             vlc_player_Unlock(player);
             if (!started)
+            {
                 input_resource_StopFreeVout(player->resource);
+                input_resource_StopFreeAout(player->resource);
+            }
             if (!keep_sout)
                 input_resource_TerminateSout(player->resource);
             vlc_player_Lock(player);
@@ -1124,9 +1137,19 @@ vlc_player_InvalidateNextMedia(vlc_player_t *player)
     vlc_player_assert_locked(player);
     if (player->next_media)
     {
+        if (player->input && player->input->preopened)
+        {
+            input_pretune_t *pt =
+                input_resource_TakePreTuned(player->resource,
+                                            player->next_media);
+            if (pt)
+                input_resource_ReleasePreTuned(player->resource, pt);
+        }
         input_item_Release(player->next_media);
         player->next_media = NULL;
     }
+    if (player->input)
+        player->input->preopened = false;
     player->next_media_requested = false;
 
 }
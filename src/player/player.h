@@ -62,6 +62,11 @@ struct vlc_player_input
     /* Monitor the OPENING_S -> PLAYING_S transition. */
     bool playing;
 
+    /* Open the access and demuxer of the next media this long before the
+     * end (0 to disable), its decoders are created at the end */
+    vlc_tick_t preopen;
+    bool preopened;
+
     enum vlc_player_state state;
     enum vlc_player_error error;
     float rate;
@@ -225,6 +230,11 @@ struct vlc_player_timer
     struct vlc_player_timer_source sources[VLC_PLAYER_TIMER_TYPE_COUNT];
 #define best_source sources[VLC_PLAYER_TIMER_TYPE_BEST]
 #define smpte_source sources[VLC_PLAYER_TIMER_TYPE_SMPTE]
+
+    /* Updates the periodic listeners between sparse clock updates */
+    vlc_timer_t timer;
+    bool has_timer;
+    vlc_tick_t deadline; /* date the timer is armed for, or VLC_TICK_INVALID */
 };
 
 struct vlc_player_t
@@ -343,6 +353,10 @@ vlc_player_OpenNextMedia(vlc_player_t *player);
 void
 vlc_player_PrepareNextMedia(vlc_player_t *player);
 
+void
+vlc_player_SetPreTunedMedias(vlc_player_t *player, input_item_t *const *medias,
+                             size_t count);
+
 void
 vlc_player_destructor_AddStoppingInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
@@ -26,6 +26,97 @@
 
 #include "player.h"
 
+/* Earliest date a periodic listener of the best source is due at */
+static vlc_tick_t
+vlc_player_GetTimerDeadline(vlc_player_t *player)
+{
+    struct vlc_player_timer_source *source = &player->timer.best_source;
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+
+    /* Nothing to interpolate when paused or before the first points */
+    if (player->timer.state != VLC_PLAYER_TIMER_STATE_PLAYING
+     || source->point.system_date == VLC_TICK_INVALID
+     || source->point.system_date == VLC_TICK_MAX)
+        return VLC_TICK_INVALID;
+
+    vlc_player_timer_id *timer;
+    vlc_list_foreach(timer, &source->listeners, node)
+    {
+        if (timer->period == VLC_TICK_INVALID
+         || timer->last_update_date == VLC_TICK_INVALID)
+            continue;
+
+        vlc_tick_t date = timer->last_update_date + timer->period;
+        if (deadline == VLC_TICK_INVALID || date < deadline)
+            deadline = date;
+    }
+    return deadline;
+}
+
+static void
+vlc_player_ScheduleTimer(vlc_player_t *player)
+{
+    if (!player->timer.has_timer)
+        return;
+
+    vlc_tick_t deadline = vlc_player_GetTimerDeadline(player);
+    if (deadline == player->timer.deadline)
+        return;
+
+    player->timer.deadline = deadline;
+    if (deadline == VLC_TICK_INVALID)
+        vlc_timer_disarm(player->timer.timer);
+    else
+        vlc_timer_schedule(player->timer.timer, true, deadline, 0);
+}
+
+/*
+ * Updates the periodic listeners that did not get any clock update during
+ * their period (e.g. sparse audio clock updates), with a point interpolated
+ * to the current date.
+ */
+static void
+vlc_player_OnTimer(void *data)
+{
+    vlc_player_t *player = data;
+    struct vlc_player_timer_source *source = &player->timer.best_source;
+
+    vlc_mutex_lock(&player->timer.lock);
+    player->timer.deadline = VLC_TICK_INVALID;
+
+    if (vlc_player_GetTimerDeadline(player) == VLC_TICK_INVALID)
+    {
+        vlc_mutex_unlock(&player->timer.lock);
+        return;
+    }
+
+    vlc_tick_t now = vlc_tick_now();
+    struct vlc_player_timer_point point = source->point;
+
+    if (vlc_player_timer_point_Interpolate(&source->point, now, &point.ts,
+                                           &point.position) != VLC_SUCCESS)
+    {   /* Wait for the next clock update */
+        vlc_mutex_unlock(&player->timer.lock);
+        return;
+    }
+    point.system_date = now;
+
+    vlc_player_timer_id *timer;
+    vlc_list_foreach(timer, &source->listeners, node)
+    {
+        if (timer->period == VLC_TICK_INVALID
+         || timer->last_update_date == VLC_TICK_INVALID
+         || now - timer->last_update_date < timer->period)
+            continue;
+
+        timer->cbs->on_update(&point, timer->data);
+        timer->last_update_date = now;
+    }
+
+    vlc_player_ScheduleTimer(player);
+    vlc_mutex_unlock(&player->timer.lock);
+}
+
 void
 vlc_player_ResetTimer(vlc_player_t *player)
 {
@@ -37,6 +128,7 @@ vlc_player_ResetTimer(vlc_player_t *player)
     player->timer.last_ts = VLC_TICK_INVALID;
     player->timer.input_position = 0.f;
     player->timer.smpte_source.smpte.last_framenum = ULONG_MAX;
+    vlc_player_ScheduleTimer(player);
 
     vlc_mutex_unlock(&player->timer.lock);
 }
@@ -211,6 +303,7 @@ vlc_player_UpdateTimerState(vlc_player_t *player, vlc_es_id_t *es_source,
     }
 
     player->timer.state = state;
+    vlc_player_ScheduleTimer(player);
 
     if (!notify)
     {
@@ -344,6 +437,7 @@ vlc_player_UpdateTimer(vlc_player_t *player, vlc_es_id_t *es_source,
                 vlc_player_SendTimerSourceUpdates(player, source, force_update,
                                                   &source->point);
         }
+        vlc_player_ScheduleTimer(player);
     }
 
     source = &player->timer.smpte_source;
@@ -533,6 +627,9 @@ void
 vlc_player_InitTimer(vlc_player_t *player)
 {
     vlc_mutex_init(&player->timer.lock);
+    player->timer.has_timer =
+        vlc_timer_create(&player->timer.timer, vlc_player_OnTimer, player) == 0;
+    player->timer.deadline = VLC_TICK_INVALID;
 
     for (size_t i = 0; i < VLC_PLAYER_TIMER_TYPE_COUNT; ++i)
     {
@@ -546,6 +643,9 @@ vlc_player_InitTimer(vlc_player_t *player)
 void
 vlc_player_DestroyTimer(vlc_player_t *player)
 {
+    if (player->timer.has_timer)
+        vlc_timer_destroy(player->timer.timer);
+
     for (size_t i = 0; i < VLC_PLAYER_TIMER_TYPE_COUNT; ++i)
         assert(vlc_list_is_empty(&player->timer.sources[i].listeners));
 }
@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * playlist/bench.c
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the playlist operations on large playlists:
+ *
+ *   make -C src bench_playlist && src/bench_playlist [count]
+ *
+ * The default count is 100000 items.
+ */
+
+#ifndef DOC
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vlc_common.h>
+#include <vlc_rand.h>
+#include "item.h"
+#include "playlist.h"
+
+#define CHUNK_SIZE 1000
+#define RANDOM_OPS 10000
+
+static input_item_t *
+CreateDummyMedia(size_t num)
+{
+    char url[64];
+    char name[32];
+
+    snprintf(url, sizeof(url), "vlc://item-%zu", num);
+    snprintf(name, sizeof(name), "item-%zu", num);
+    return input_item_New(url, name);
+}
+
+static vlc_tick_t
+BenchStart(const char *name, size_t count)
+{
+    printf("%-32s %8zu items: ", name, count);
+    fflush(stdout);
+    return vlc_tick_now();
+}
+
+static void
+BenchEnd(vlc_tick_t start)
+{
+    printf("%8" PRId64 " ms\n", MS_FROM_VLC_TICK(vlc_tick_now() - start));
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    if (count < CHUNK_SIZE)
+        count = CHUNK_SIZE;
+
+    input_item_t **media = malloc(count * sizeof(*media));
+    assert(media);
+    for (size_t i = 0; i < count; ++i)
+    {
+        media[i] = CreateDummyMedia(i);
+        assert(media[i]);
+    }
+
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    unsigned short xsubi[3] = { 0x1234, 0x5678, 0x9abc };
+    vlc_tick_t start;
+    int ret;
+
+    start = BenchStart("append by chunks", count);
+    for (size_t i = 0; i < count; i += CHUNK_SIZE)
+    {
+        size_t n = count - i < CHUNK_SIZE ? count - i : CHUNK_SIZE;
+        ret = vlc_playlist_Append(playlist, &media[i], n);
+        assert(ret == VLC_SUCCESS);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("index of item", count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, i);
+        ssize_t index = vlc_playlist_IndexOf(playlist, item);
+        assert(index == (ssize_t) i);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("index of media and id", count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ssize_t index = vlc_playlist_IndexOfMedia(playlist, media[i]);
+        assert(index == (ssize_t) i);
+        index = vlc_playlist_IndexOfId(playlist, i);
+        assert(index == (ssize_t) i);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("move chunks to front", count / CHUNK_SIZE);
+    for (size_t i = 0; i < count / CHUNK_SIZE; ++i)
+        vlc_playlist_Move(playlist, count - CHUNK_SIZE, CHUNK_SIZE, 0);
+    BenchEnd(start);
+
+    start = BenchStart("shuffle", count);
+    vlc_playlist_Shuffle(playlist);
+    BenchEnd(start);
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+    start = BenchStart("sort by title", count);
+    ret = vlc_playlist_Sort(playlist, criteria, ARRAY_SIZE(criteria));
+    assert(ret == VLC_SUCCESS);
+    BenchEnd(start);
+
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+
+    start = BenchStart("random order, remove one", RANDOM_OPS);
+    for (size_t i = 0; i < RANDOM_OPS; ++i)
+    {
+        size_t index = nrand48(xsubi) % vlc_playlist_Count(playlist);
+        vlc_playlist_RemoveOne(playlist, index);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("random order, insert one", RANDOM_OPS);
+    for (size_t i = 0; i < RANDOM_OPS; ++i)
+    {
+        size_t index = nrand48(xsubi) % (vlc_playlist_Count(playlist) + 1);
+        ret = vlc_playlist_InsertOne(playlist, index, media[i]);
+        assert(ret == VLC_SUCCESS);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("remove one then index of", RANDOM_OPS);
+    for (size_t i = 0; i < RANDOM_OPS; ++i)
+    {
+        size_t index = nrand48(xsubi) % vlc_playlist_Count(playlist);
+        vlc_playlist_RemoveOne(playlist, index);
+        size_t last = vlc_playlist_Count(playlist) - 1;
+        input_item_t *lastmedia = vlc_playlist_Get(playlist, last)->media;
+        ssize_t found = vlc_playlist_IndexOfMedia(playlist, lastmedia);
+        assert(found != -1);
+    }
+    BenchEnd(start);
+
+    start = BenchStart("random order, remove all", vlc_playlist_Count(playlist));
+    while (vlc_playlist_Count(playlist) > 0)
+    {
+        size_t size = vlc_playlist_Count(playlist);
+        size_t n = size < CHUNK_SIZE ? size : CHUNK_SIZE;
+        vlc_playlist_Remove(playlist, size - n, n);
+    }
+    BenchEnd(start);
+
+    vlc_playlist_Delete(playlist);
+    for (size_t i = 0; i < count; ++i)
+        input_item_Release(media[i]);
+    free(media);
+    return 0;
+}
+
+#endif
@@ -37,6 +37,118 @@ vlc_playlist_ClearItems(vlc_playlist_t *playlist)
     vlc_vector_foreach(item, &playlist->items)
         vlc_playlist_item_Release(item);
     vlc_vector_clear(&playlist->items);
+    playlist_index_Clear(&playlist->ids);
+    playlist_index_Clear(&playlist->medias);
+    playlist->indexed = 0;
+}
+
+void
+vlc_playlist_InvalidateIndexes(vlc_playlist_t *playlist, size_t index)
+{
+    if (index < playlist->indexed)
+        playlist->indexed = index;
+}
+
+static ssize_t
+vlc_playlist_ItemIndex(vlc_playlist_t *playlist,
+                       const vlc_playlist_item_t *item)
+{
+    /* the item may have been removed, or belong to another playlist */
+    size_t index = item->index;
+    if (index < playlist->indexed && playlist->items.data[index] == item)
+        return index;
+
+    if (playlist->indexed == playlist->items.size)
+        return -1;
+
+    /* some items moved since the last lookup, update their positions */
+    for (size_t i = playlist->indexed; i < playlist->items.size; ++i)
+        playlist->items.data[i]->index = i;
+    playlist->indexed = playlist->items.size;
+
+    index = item->index;
+    if (index < playlist->items.size && playlist->items.data[index] == item)
+        return index;
+    return -1;
+}
+
+static bool
+vlc_playlist_ReserveIndexes(vlc_playlist_t *playlist, size_t count)
+{
+    size_t size = playlist->items.size + count;
+    return playlist_index_Reserve(&playlist->ids, size)
+        && playlist_index_Reserve(&playlist->medias, size);
+}
+
+/* A media present several times is mapped to its number of occurrences,
+ * tagged by the lowest bit (items are aligned), rather than to an item */
+static inline bool
+vlc_playlist_MediaIsShared(uintptr_t value)
+{
+    return value & 1;
+}
+
+static inline uintptr_t
+vlc_playlist_MediaShared(size_t count)
+{
+    return (uintptr_t) count << 1 | 1;
+}
+
+/* the indexes must have been reserved by vlc_playlist_ReserveIndexes() */
+static void
+vlc_playlist_IndexItem(vlc_playlist_t *playlist, vlc_playlist_item_t *item)
+{
+    bool ok = playlist_index_Put(&playlist->ids, item->id, (uintptr_t) item);
+    assert(ok);
+
+    uintptr_t value;
+    uintptr_t key = (uintptr_t) item->media;
+    if (!playlist_index_Get(&playlist->medias, key, &value))
+        ok = playlist_index_Put(&playlist->medias, key, (uintptr_t) item);
+    else if (!vlc_playlist_MediaIsShared(value))
+        /* the same media is present several times, do not guess which one
+         * comes first */
+        ok = playlist_index_Put(&playlist->medias, key,
+                                vlc_playlist_MediaShared(2));
+    else
+        ok = playlist_index_Put(&playlist->medias, key, value + 2);
+    assert(ok);
+    VLC_UNUSED(ok);
+}
+
+static void
+vlc_playlist_UnindexItem(vlc_playlist_t *playlist, vlc_playlist_item_t *item)
+{
+    playlist_index_Remove(&playlist->ids, item->id);
+
+    /* if the media was present several times, it is kept unresolved until
+     * no item refers to it anymore */
+    uintptr_t value;
+    uintptr_t key = (uintptr_t) item->media;
+    if (!playlist_index_Get(&playlist->medias, key, &value))
+        return;
+    if (!vlc_playlist_MediaIsShared(value))
+    {
+        assert(value == (uintptr_t) item);
+        playlist_index_Remove(&playlist->medias, key);
+    }
+    else if (value == vlc_playlist_MediaShared(1))
+        playlist_index_Remove(&playlist->medias, key);
+    else
+    {
+        /* the key exists, no allocation is needed */
+        bool ok = playlist_index_Put(&playlist->medias, key, value - 2);
+        assert(ok);
+        VLC_UNUSED(ok);
+    }
+}
+
+static void
+vlc_playlist_IndexItems(vlc_playlist_t *playlist, size_t index, size_t count)
+{
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_IndexItem(playlist, playlist->items.data[i]);
+    vlc_playlist_InvalidateIndexes(playlist, index);
 }
 
 static void
@@ -76,11 +188,7 @@ vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
     vlc_playlist_Notify(playlist, on_items_added, index, items, count);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    for (size_t i = index; i < index + count; ++i)
-    {
-        vlc_playlist_item_t *item = playlist->items.data[i];
-        vlc_playlist_AutoPreparse(playlist, item->media);
-    }
+    vlc_playlist_AutoPreparseItems(playlist, items, count);
 }
 
 static void
@@ -196,10 +304,7 @@ ssize_t
 vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return vlc_playlist_ItemIndex(playlist, item);
 }
 
 ssize_t
@@ -207,6 +312,14 @@ vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
 
+    uintptr_t value;
+    if (!playlist_index_Get(&playlist->medias, (uintptr_t) media, &value))
+        return -1;
+
+    if (!vlc_playlist_MediaIsShared(value))
+        return vlc_playlist_ItemIndex(playlist, (vlc_playlist_item_t *) value);
+
+    /* several items share this media, return the first one */
     playlist_item_vector_t *items = &playlist->items;
     for (size_t i = 0; i < items->size; ++i)
         if (items->data[i]->media == media)
@@ -219,11 +332,10 @@ vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    uintptr_t value;
+    if (!playlist_index_Get(&playlist->ids, id, &value))
+        return -1;
+    return vlc_playlist_ItemIndex(playlist, (vlc_playlist_item_t *) value);
 }
 
 void
@@ -268,6 +380,9 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index <= playlist->items.size);
 
+    if (!vlc_playlist_ReserveIndexes(playlist, count))
+        return VLC_ENOMEM;
+
     /* make space in the vector */
     if (!vlc_vector_insert_hole(&playlist->items, index, count))
         return VLC_ENOMEM;
@@ -282,6 +397,7 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
         return ret;
     }
 
+    vlc_playlist_IndexItems(playlist, index, count);
     vlc_playlist_ItemsInserted(playlist, index, count);
     vlc_player_InvalidateNextMedia(playlist->player);
 
@@ -297,6 +413,7 @@ vlc_playlist_Move(vlc_playlist_t *playlist, size_t index, size_t count,
     assert(target + count <= playlist->items.size);
 
     vlc_vector_move_slice(&playlist->items, index, count, target);
+    vlc_playlist_InvalidateIndexes(playlist, index < target ? index : target);
 
     vlc_playlist_ItemsMoved(playlist, index, count, target);
     vlc_player_InvalidateNextMedia(playlist->player);
@@ -311,9 +428,14 @@ vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
     vlc_playlist_ItemsRemoving(playlist, index, count);
 
     for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_Release(playlist->items.data[index + i]);
+    {
+        vlc_playlist_item_t *item = playlist->items.data[index + i];
+        vlc_playlist_UnindexItem(playlist, item);
+        vlc_playlist_item_Release(item);
+    }
 
     vlc_vector_remove_slice(&playlist->items, index, count);
+    vlc_playlist_InvalidateIndexes(playlist, index);
 
     bool current_media_changed = vlc_playlist_ItemsRemoved(playlist, index,
                                                            count);
@@ -330,6 +452,9 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index < playlist->items.size);
 
+    if (!vlc_playlist_ReserveIndexes(playlist, 1))
+        return VLC_ENOMEM;
+
     uint64_t id = playlist->idgen++;
     vlc_playlist_item_t *item = vlc_playlist_item_New(media, id);
     if (!item)
@@ -342,8 +467,11 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
         randomizer_Add(&playlist->randomizer, &item, 1);
     }
 
+    vlc_playlist_UnindexItem(playlist, playlist->items.data[index]);
     vlc_playlist_item_Release(playlist->items.data[index]);
     playlist->items.data[index] = item;
+    item->index = index;
+    vlc_playlist_IndexItem(playlist, item);
 
     vlc_playlist_ItemReplaced(playlist, index);
     return VLC_SUCCESS;
@@ -366,6 +494,9 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
 
         if (count > 1)
         {
+            if (!vlc_playlist_ReserveIndexes(playlist, count - 1))
+                return VLC_ENOMEM;
+
             /* make space in the vector */
             if (!vlc_vector_insert_hole(&playlist->items, index + 1, count - 1))
                 return VLC_ENOMEM;
@@ -379,6 +510,7 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
                 vlc_vector_remove_slice(&playlist->items, index + 1, count - 1);
                 return ret;
             }
+            vlc_playlist_IndexItems(playlist, index + 1, count - 1);
             vlc_playlist_ItemsInserted(playlist, index + 1, count - 1);
         }
 
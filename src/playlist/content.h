@@ -28,6 +28,11 @@ typedef struct input_item_t input_item_t;
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist);
 
+/* invalidate the position stored in the items from index, after they moved
+ * (they are updated lazily on the next lookup) */
+void
+vlc_playlist_InvalidateIndexes(vlc_playlist_t *playlist, size_t index);
+
 /* expand an item (replace it by the given media array) */
 int
 vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
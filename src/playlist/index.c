@@ -0,0 +1,184 @@
+/*****************************************************************************
+ * playlist/index.c
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "index.h"
+
+#define PLAYLIST_INDEX_MIN_CAPACITY 16
+
+static inline size_t
+playlist_index_Hash(const struct playlist_index *index, uint64_t key)
+{
+    /* Fibonacci hashing, so that aligned pointers spread over all buckets */
+    return (key * UINT64_C(0x9E3779B97F4A7C15)) >> 32 & (index->capacity - 1);
+}
+
+void
+playlist_index_Init(struct playlist_index *index)
+{
+    index->entries = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+void
+playlist_index_Destroy(struct playlist_index *index)
+{
+    free(index->entries);
+}
+
+void
+playlist_index_Clear(struct playlist_index *index)
+{
+    for (size_t i = 0; i < index->capacity; ++i)
+        index->entries[i].used = false;
+    index->count = 0;
+}
+
+static void
+playlist_index_Insert(struct playlist_index *index, uint64_t key,
+                      uintptr_t value)
+{
+    size_t i = playlist_index_Hash(index, key);
+    while (index->entries[i].used)
+    {
+        if (index->entries[i].key == key)
+        {
+            index->entries[i].value = value;
+            return;
+        }
+        i = (i + 1) & (index->capacity - 1);
+    }
+    index->entries[i].key = key;
+    index->entries[i].value = value;
+    index->entries[i].used = true;
+    index->count++;
+}
+
+bool
+playlist_index_Reserve(struct playlist_index *index, size_t count)
+{
+    /* keep the load factor below 3/4 */
+    if (count <= index->capacity / 4 * 3)
+        return true;
+
+    size_t capacity = index->capacity ? index->capacity
+                                      : PLAYLIST_INDEX_MIN_CAPACITY;
+    while (count > capacity / 4 * 3)
+    {
+        if (unlikely(capacity > SIZE_MAX / 2 / sizeof(*index->entries)))
+            return false;
+        capacity *= 2;
+    }
+
+    struct playlist_index_entry *entries = calloc(capacity, sizeof(*entries));
+    if (unlikely(!entries))
+        return false;
+
+    struct playlist_index_entry *old = index->entries;
+    size_t old_capacity = index->capacity;
+
+    index->entries = entries;
+    index->capacity = capacity;
+    index->count = 0;
+    for (size_t i = 0; i < old_capacity; ++i)
+        if (old[i].used)
+            playlist_index_Insert(index, old[i].key, old[i].value);
+
+    free(old);
+    return true;
+}
+
+static ssize_t
+playlist_index_Find(const struct playlist_index *index, uint64_t key)
+{
+    if (!index->count)
+        return -1;
+
+    size_t i = playlist_index_Hash(index, key);
+    while (index->entries[i].used)
+    {
+        if (index->entries[i].key == key)
+            return i;
+        i = (i + 1) & (index->capacity - 1);
+    }
+    return -1;
+}
+
+bool
+playlist_index_Put(struct playlist_index *index, uint64_t key,
+                   uintptr_t value)
+{
+    /* replacing a value never allocates */
+    ssize_t found = playlist_index_Find(index, key);
+    if (found != -1)
+    {
+        index->entries[found].value = value;
+        return true;
+    }
+
+    if (!playlist_index_Reserve(index, index->count + 1))
+        return false;
+    playlist_index_Insert(index, key, value);
+    return true;
+}
+
+bool
+playlist_index_Get(const struct playlist_index *index, uint64_t key,
+                   uintptr_t *value)
+{
+    ssize_t i = playlist_index_Find(index, key);
+    if (i == -1)
+        return false;
+    *value = index->entries[i].value;
+    return true;
+}
+
+void
+playlist_index_Remove(struct playlist_index *index, uint64_t key)
+{
+    ssize_t found = playlist_index_Find(index, key);
+    if (found == -1)
+        return;
+
+    /* backward shift deletion, so that no tombstone is needed */
+    const size_t mask = index->capacity - 1;
+    size_t hole = found;
+    size_t i = (hole + 1) & mask;
+    while (index->entries[i].used)
+    {
+        size_t home = playlist_index_Hash(index, index->entries[i].key);
+        /* move the entry to the hole if its home is not in (hole, i] */
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            index->entries[hole] = index->entries[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+    index->entries[hole].used = false;
+    index->count--;
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * playlist/index.h
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_INDEX_H
+#define VLC_PLAYLIST_INDEX_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup playlist_index Playlist lookup index
+ * \ingroup playlist
+ *  @{ */
+
+struct playlist_index_entry {
+    uint64_t key;
+    uintptr_t value;
+    bool used;
+};
+
+/**
+ * Hash table mapping integer keys (ids, or pointers converted to uintptr_t)
+ * to a value, to avoid linear scans of the playlist and randomizer vectors.
+ *
+ * It uses open addressing with linear probing, so that lookups stay cache
+ * friendly.
+ */
+struct playlist_index {
+    struct playlist_index_entry *entries;
+    size_t capacity; /* 0 or a power of 2 */
+    size_t count;
+};
+
+/**
+ * Initialize an empty index.
+ */
+void
+playlist_index_Init(struct playlist_index *index);
+
+/**
+ * Destroy an index.
+ */
+void
+playlist_index_Destroy(struct playlist_index *index);
+
+/**
+ * Remove all the entries, keeping the allocated storage.
+ */
+void
+playlist_index_Clear(struct playlist_index *index);
+
+/**
+ * Make sure count entries can be stored without further allocations.
+ *
+ * \return true on success, false on allocation failure
+ */
+bool
+playlist_index_Reserve(struct playlist_index *index, size_t count);
+
+/**
+ * Insert an entry, or replace the value of an existing key.
+ *
+ * Replacing the value of an existing key never fails.
+ *
+ * \return true on success, false on allocation failure
+ */
+bool
+playlist_index_Put(struct playlist_index *index, uint64_t key,
+                   uintptr_t value);
+
+/**
+ * Find the value for a key.
+ *
+ * \retval true if the key was found, value is then set
+ * \retval false if the key is not in the index
+ */
+bool
+playlist_index_Get(const struct playlist_index *index, uint64_t key,
+                   uintptr_t *value);
+
+/**
+ * Remove a key, if present.
+ */
+void
+playlist_index_Remove(struct playlist_index *index, uint64_t key);
+
+/** @} */
+
+#endif
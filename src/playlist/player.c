@@ -31,6 +31,49 @@
 #include "playlist.h"
 #include "preparse.h"
 
+#define ZAP_AHEAD_MAX 8 /* range of the "zap-ahead" option */
+
+static void
+vlc_playlist_PreTuneNeighbours(vlc_playlist_t *playlist)
+{
+    input_item_t *medias[2 * ZAP_AHEAD_MAX];
+    size_t count = 0;
+
+    /* The neighbours are only predictable in the normal order */
+    if (playlist->current != -1
+     && playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_NORMAL)
+    {
+        ssize_t size = playlist->items.size;
+        bool wrap = playlist->repeat == VLC_PLAYLIST_PLAYBACK_REPEAT_ALL;
+        unsigned ahead = __MIN(playlist->zap_ahead, ZAP_AHEAD_MAX);
+
+        for (unsigned i = 1; i <= ahead; ++i)
+        {
+            ssize_t indices[] = {
+                playlist->current + i,
+                playlist->current - i,
+            };
+            for (size_t j = 0; j < ARRAY_SIZE(indices); ++j)
+            {
+                ssize_t index = indices[j];
+                if (wrap)
+                    index = (index % size + size) % size;
+                if (index < 0 || index >= size || index == playlist->current)
+                    continue;
+
+                input_item_t *media = playlist->items.data[index]->media;
+                size_t k = 0;
+                while (k < count && medias[k] != media)
+                    k++;
+                if (k == count)
+                    medias[count++] = media;
+            }
+        }
+    }
+
+    vlc_player_SetPreTunedMedias(playlist->player, medias, count);
+}
+
 static void
 player_on_current_media_changed(vlc_player_t *player, input_item_t *new_media,
                                 void *userdata)
@@ -45,8 +88,12 @@ player_on_current_media_changed(vlc_player_t *player, input_item_t *new_media,
                         ? playlist->items.data[playlist->current]->media
                         : NULL;
     if (new_media == media)
-        /* nothing to do */
+    {
+        /* the playlist already selected it, only the neighbours changed */
+        if (playlist->zap_ahead)
+            vlc_playlist_PreTuneNeighbours(playlist);
         return;
+    }
 
     ssize_t index;
     if (new_media)
@@ -69,6 +116,9 @@ player_on_current_media_changed(vlc_player_t *player, input_item_t *new_media,
     playlist->has_prev = vlc_playlist_ComputeHasPrev(playlist);
     playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
 
+    if (playlist->zap_ahead)
+        vlc_playlist_PreTuneNeighbours(playlist);
+
     vlc_playlist_state_NotifyChanges(playlist, &state);
 }
 
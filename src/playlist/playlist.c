@@ -45,6 +45,9 @@ vlc_playlist_New(vlc_object_t *parent)
     }
 
     vlc_vector_init(&playlist->items);
+    playlist_index_Init(&playlist->ids);
+    playlist_index_Init(&playlist->medias);
+    playlist->indexed = 0;
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
@@ -56,10 +59,12 @@ vlc_playlist_New(vlc_object_t *parent)
 #ifdef TEST_PLAYLIST
     playlist->libvlc = NULL;
     playlist->auto_preparse = false;
+    playlist->zap_ahead = 0;
 #else
     assert(parent);
     playlist->libvlc = vlc_object_instance(parent);
     playlist->auto_preparse = var_InheritBool(parent, "auto-preparse");
+    playlist->zap_ahead = var_InheritInteger(parent, "zap-ahead");
 #endif
 
     return playlist;
@@ -73,6 +78,8 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
+    playlist_index_Destroy(&playlist->ids);
+    playlist_index_Destroy(&playlist->medias);
     free(playlist);
 }
 
@@ -26,6 +26,7 @@
 #include <vlc_vector.h>
 #include "../player/player.h"
 #include "randomizer.h"
+#include "index.h"
 
 typedef struct input_item_t input_item_t;
 
@@ -40,6 +41,7 @@ typedef struct input_item_t input_item_t;
 # define vlc_player_RemoveListener(a,b) free(b)
 # define vlc_player_SetCurrentMedia(a,b) (VLC_UNUSED(b), VLC_SUCCESS)
 # define vlc_player_InvalidateNextMedia(p) VLC_UNUSED(p)
+# define vlc_player_SetPreTunedMedias(p, m, c) (VLC_UNUSED(m), VLC_UNUSED(c))
 # define vlc_player_osd_Message(p, fmt...) VLC_UNUSED(p)
 #endif /* TEST_PLAYLIST */
 
@@ -50,9 +52,14 @@ struct vlc_playlist
     vlc_player_t *player;
     libvlc_int_t *libvlc;
     bool auto_preparse;
+    unsigned zap_ahead; /**< neighbours pre-tuned on each side */
     /* all remaining fields are protected by the lock of the player */
     struct vlc_player_listener_id *player_listener;
     playlist_item_vector_t items;
+    struct playlist_index ids; /**< id -> item */
+    struct playlist_index medias; /**< media -> item, or (count << 1 | 1)
+                                       if several items share the media */
+    size_t indexed; /**< items before have their index up to date */
     struct randomizer randomizer;
     ssize_t current;
     bool has_prev;
@@ -133,3 +133,35 @@ vlc_playlist_AutoPreparse(vlc_playlist_t *playlist, input_item_t *input)
     if (playlist->auto_preparse && !input_item_IsPreparsed(input))
         vlc_playlist_Preparse(playlist, input);
 }
+
+void
+vlc_playlist_AutoPreparseItems(vlc_playlist_t *playlist,
+                               vlc_playlist_item_t *const items[],
+                               size_t count)
+{
+    if (!playlist->auto_preparse)
+        return;
+
+    media_vector_t medias = VLC_VECTOR_INITIALIZER;
+    for (size_t i = 0; i < count; ++i)
+    {
+        input_item_t *media = items[i]->media;
+        if (!input_item_IsPreparsed(media) && !vlc_vector_push(&medias, media))
+        {
+            /* preparse the remaining medias one by one */
+            vlc_playlist_Preparse(playlist, media);
+        }
+    }
+
+#ifdef TEST_PLAYLIST
+    VLC_UNUSED(input_preparser_callbacks);
+#else
+    if (medias.size)
+        vlc_MetadataRequestBatch(playlist->libvlc, medias.data, medias.size,
+                                 META_REQUEST_OPTION_SCOPE_LOCAL |
+                                 META_REQUEST_OPTION_FETCH_LOCAL,
+                                 &input_preparser_callbacks, playlist, -1,
+                                 NULL);
+#endif
+    vlc_vector_destroy(&medias);
+}
@@ -260,6 +260,7 @@ void
 randomizer_Init(struct randomizer *r)
 {
     vlc_vector_init(&r->items);
+    playlist_index_Init(&r->positions);
 
     /* initialize separately instead of using vlc_lrand48() to avoid locking
      * the mutex for every random number generation */
@@ -275,6 +276,7 @@ void
 randomizer_Destroy(struct randomizer *r)
 {
     vlc_vector_destroy(&r->items);
+    playlist_index_Destroy(&r->positions);
 }
 
 void
@@ -286,11 +288,27 @@ randomizer_SetLoop(struct randomizer *r, bool loop)
 static inline ssize_t
 randomizer_IndexOf(struct randomizer *r, const vlc_playlist_item_t *item)
 {
-    ssize_t index;
-    vlc_vector_index_of(&r->items, item, &index);
+    uintptr_t index;
+    if (!playlist_index_Get(&r->positions, (uintptr_t) item, &index))
+        return -1;
+    assert(r->items.data[index] == item);
     return index;
 }
 
+/* update the positions of the items in [from, to), after they moved
+ * (the index has been reserved for all the items) */
+static void
+randomizer_UpdatePositions(struct randomizer *r, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; ++i)
+    {
+        bool ok = playlist_index_Put(&r->positions,
+                                     (uintptr_t) r->items.data[i], i);
+        assert(ok);
+        VLC_UNUSED(ok);
+    }
+}
+
 bool
 randomizer_Count(struct randomizer *r)
 {
@@ -312,6 +330,8 @@ swap_items(struct randomizer *r, int i, int j)
     vlc_playlist_item_t *item = r->items.data[i];
     r->items.data[i] = r->items.data[j];
     r->items.data[j] = item;
+    randomizer_UpdatePositions(r, i, i + 1);
+    randomizer_UpdatePositions(r, j, j + 1);
 }
 
 static inline void
@@ -423,8 +443,11 @@ randomizer_Next(struct randomizer *r)
 bool
 randomizer_Add(struct randomizer *r, vlc_playlist_item_t *items[], size_t count)
 {
+    if (!playlist_index_Reserve(&r->positions, r->items.size + count))
+        return false;
     if (!vlc_vector_insert_all(&r->items, r->history, items, count))
         return false;
+    randomizer_UpdatePositions(r, r->history, r->items.size);
     /* the insertion shifted history (and possibly next) */
     if (r->next > r->history)
         r->next += count;
@@ -443,6 +466,8 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
             memmove(&r->items.data[r->history + 1],
                     &r->items.data[r->history],
                     (index - r->history) * sizeof(selected));
+            r->items.data[r->history] = selected;
+            randomizer_UpdatePositions(r, r->history, index + 1);
             index = r->history;
         }
         r->history = (r->history + 1) % r->items.size;
@@ -452,6 +477,8 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
     {
         r->items.data[index] = r->items.data[r->head];
         r->items.data[r->head] = selected;
+        randomizer_UpdatePositions(r, index, index + 1);
+        randomizer_UpdatePositions(r, r->head, r->head + 1);
         r->head++;
     }
     else if (index < r->items.size - 1)
@@ -460,6 +487,7 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
                 &r->items.data[index + 1],
                 (r->head - index - 1) * sizeof(selected));
         r->items.data[r->head - 1] = selected;
+        randomizer_UpdatePositions(r, index, r->head);
     }
 
     r->next = r->head;
@@ -473,63 +501,71 @@ randomizer_Select(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_SelectIndex(r, (size_t) index);
 }
 
-static void
-randomizer_RemoveAt(struct randomizer *r, size_t index)
+void
+randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
+                  size_t count)
 {
     /*
      * 0          head                                history   next  size
      * |-----------|...................................|---------|-----|
      * |<--------->|                                   |<------------->|
      *    ordered            order irrelevant               ordered
+     *
+     * The items of the unordered part are replaced by its last item, so that
+     * its free slots gather at its end. The other removed slots are just
+     * cleared. Then the vector is compacted in a single pass from the first
+     * free slot, keeping the ordered parts ordered, so that the positions
+     * are updated once per call rather than once per removed item.
      */
-
-    /* update next before index may be updated */
-    if (index < r->next)
-        r->next--;
-
-    if (index < r->head)
+    size_t end = r->history; /* end of the unordered items left */
+    size_t first = r->items.size;
+    for (size_t i = 0; i < count; ++i)
     {
-        /* item was selected, keep the selected part ordered */
-        memmove(&r->items.data[index],
-                &r->items.data[index + 1],
-                (r->head - index - 1) * sizeof(*r->items.data));
-        r->head--;
-        index = r->head; /* the new index to remove */
-    }
+        ssize_t found = randomizer_IndexOf(r, items[i]);
+        assert(found >= 0); /* item must exist */
+        size_t index = found;
 
-    if (index < r->history)
-    {
-        /* this part is unordered, no need to shift all items */
-        r->items.data[index] = r->items.data[r->history - 1];
-        index = r->history - 1;
-        r->history--;
+        playlist_index_Remove(&r->positions, (uintptr_t) items[i]);
+        if (index >= r->head && index < end)
+        {
+            end--;
+            if (index < end)
+            {
+                r->items.data[index] = r->items.data[end];
+                randomizer_UpdatePositions(r, index, index + 1);
+            }
+            index = end;
+        }
+        r->items.data[index] = NULL;
+        if (index < first)
+            first = index;
     }
 
-    if (index < r->items.size - 1)
+    size_t head = r->head;
+    size_t next = r->next;
+    size_t history = r->history;
+    size_t size = first;
+    for (size_t i = first; i < r->items.size; ++i)
     {
-        /* shift the ordered history part by one */
-        memmove(&r->items.data[index],
-                &r->items.data[index + 1],
-                (r->items.size - index - 1) * sizeof(*r->items.data));
+        vlc_playlist_item_t *item = r->items.data[i];
+        if (item)
+        {
+            r->items.data[size++] = item;
+            continue;
+        }
+        if (i < r->head)
+            head--;
+        if (i < r->next)
+            next--;
+        if (i < r->history)
+            history--;
     }
 
-    r->items.size--;
-}
-
-static void
-randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
-{
-    ssize_t index = randomizer_IndexOf(r, item);
-    assert(index >= 0); /* item must exist */
-    randomizer_RemoveAt(r, index);
-}
-
-void
-randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
-                  size_t count)
-{
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    r->items.size = size;
+    r->head = head;
+    r->next = next;
+    r->history = history;
+    randomizer_UpdatePositions(r, first, size);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -538,6 +574,7 @@ void
 randomizer_Clear(struct randomizer *r)
 {
     vlc_vector_clear(&r->items);
+    playlist_index_Clear(&r->positions);
     r->head = 0;
     r->next = 0;
     r->history = 0;
@@ -23,6 +23,7 @@
 
 #include <vlc_common.h>
 #include <vlc_vector.h>
+#include "index.h"
 
 typedef struct vlc_playlist_item vlc_playlist_item_t;
 
@@ -38,6 +39,7 @@ typedef struct vlc_playlist_item vlc_playlist_item_t;
  */
 struct randomizer {
     struct VLC_VECTOR(vlc_playlist_item_t *) items;
+    struct playlist_index positions; /* item -> index in items */
     unsigned short xsubi[3]; /* random state */
     bool loop;
     size_t head;
@@ -26,6 +26,7 @@
 #include <vlc_rand.h>
 #include <vlc_sort.h>
 #include <vlc_strings.h>
+#include "content.h"
 #include "control.h"
 #include "item.h"
 #include "notify.h"
@@ -404,6 +405,7 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
     /* apply the sorting result to the playlist */
     for (size_t i = 0; i < playlist->items.size; ++i)
         playlist->items.data[i] = array[i]->item;
+    vlc_playlist_InvalidateIndexes(playlist, 0);
 
     vlc_playlist_DeleteMetaArray(array, playlist->items.size);
 
@@ -1056,11 +1056,36 @@ test_index_of(void)
     vlc_playlist_item_t *item = vlc_playlist_Get(playlist, 4);
     assert(vlc_playlist_IndexOf(playlist, item) == 4);
 
+    uint64_t id = vlc_playlist_item_GetId(item);
+    assert(vlc_playlist_IndexOfId(playlist, id) == 4);
+
     vlc_playlist_item_Hold(item);
     vlc_playlist_RemoveOne(playlist, 4);
     assert(vlc_playlist_IndexOf(playlist, item) == -1);
+    assert(vlc_playlist_IndexOfId(playlist, id) == -1);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[4]) == -1);
     vlc_playlist_item_Release(item);
 
+    /* the indexes follow the moves */
+    vlc_playlist_Move(playlist, 5, 3, 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[6]) == 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 3);
+    item = vlc_playlist_Get(playlist, 7);
+    id = vlc_playlist_item_GetId(item);
+    assert(vlc_playlist_IndexOf(playlist, item) == 7);
+    assert(vlc_playlist_IndexOfId(playlist, id) == 7);
+
+    /* the first occurrence of a duplicated media is returned */
+    ret = vlc_playlist_InsertOne(playlist, 1, media[0]);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 1);
+    vlc_playlist_RemoveOne(playlist, 1);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 3);
+
+    vlc_playlist_Clear(playlist);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == -1);
+    assert(vlc_playlist_IndexOfId(playlist, id) == -1);
+
     DestroyMediaArray(media, 10);
     vlc_playlist_Delete(playlist);
 }
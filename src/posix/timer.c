@@ -1,5 +1,5 @@
 /*****************************************************************************
- * timer.c: simple threaded timer
+ * timer.c: shared threaded timers
  *****************************************************************************
  * Copyright (C) 2009-2012 Rémi Denis-Courmont
  *
@@ -28,6 +28,7 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_list.h>
 
 /*
  * POSIX timers are essentially unusable from a library: there provide no safe
@@ -35,40 +36,391 @@
  * they typically require one thread per timer plus one thread per iteration,
  * which is inefficient and overkill (unless you need multiple iteration
  * of the same timer concurrently).
- * Thus, this is a generic manual implementation of timers using a thread.
+ *
+ * Thus, this is a generic manual implementation of timers. All the timers of
+ * the process share a single scheduling thread, so that hundreds of timers
+ * (e.g. from many concurrent players) do not need hundreds of threads, and
+ * timers expiring together are processed with a single wake-up.
+ *
+ * The callbacks are run by a pool of worker threads, so that a callback
+ * blocking for a while (e.g. on network I/O) does not delay the other timers.
+ * Usually, a single worker runs all the callbacks. Another worker is started
+ * when expired timers wait for longer than TIMER_STALL_DELAY, i.e. when all
+ * the workers are blocked, up to TIMER_WORKERS_MAX workers. Past that, the
+ * expired timers wait, and their iterations are merged as overruns. Workers
+ * exit after staying idle for TIMER_IDLE_TIMEOUT.
+ *
+ * Armed timers are stored in a hierarchical timer wheel: each level has
+ * TIMER_SLOTS slots, and each slot of a level spans TIMER_SLOTS slots of the
+ * level below. Timers are (re)scheduled in constant time, and are cascaded
+ * down one level at a time as their deadline draws near.
  */
 
+#define TIMER_RESOLUTION VLC_TICK_FROM_MS(1)
+#define TIMER_LEVEL_BITS 6
+#define TIMER_SLOTS      (1 << TIMER_LEVEL_BITS)
+#define TIMER_LEVELS     4
+/* Timers further away than this are re-cascaded from the last level */
+#define TIMER_RANGE      ((UINT64_C(1) << (TIMER_LEVEL_BITS * TIMER_LEVELS)) - 1)
+/* Delay before another worker thread is started for waiting timers */
+#define TIMER_STALL_DELAY  VLC_TICK_FROM_MS(10)
+/* Delay before an idle worker thread exits */
+#define TIMER_IDLE_TIMEOUT VLC_TICK_FROM_SEC(5)
+/* Maximum number of worker threads */
+#define TIMER_WORKERS_MAX  8
+
 struct vlc_timer
 {
-    vlc_thread_t thread;
-    vlc_cond_t   reschedule;
-    vlc_mutex_t  lock;
+    struct vlc_list node; /**< node in the wheel (if armed) */
+    struct vlc_list run_node; /**< node in the run queue */
     void       (*func) (void *);
     void        *data;
     vlc_tick_t   value, interval;
-    bool         live;
+    uint64_t     expiry; /**< value in wheel ticks (if armed) */
+    vlc_tick_t   dispatched; /**< date when queued (if queued) */
+    unsigned long thread_id; /**< worker running the callback (if running) */
+    bool         armed;
+    bool         queued; /**< whether an iteration is pending */
+    bool         running; /**< whether the callback is running */
     atomic_uint  overruns;
 };
 
+struct vlc_timer_worker
+{
+    vlc_thread_t thread;
+    struct vlc_list node;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t reschedule; /**< signaled when the next expiry is earlier */
+    vlc_cond_t work; /**< signaled when a timer is queued */
+    vlc_cond_t done; /**< signaled when a callback returns */
+    struct vlc_list wheel[TIMER_LEVELS][TIMER_SLOTS];
+    struct vlc_list queue; /**< expired timers waiting for a worker */
+    size_t queued; /**< number of timers in the queue */
+    uint64_t now; /**< current wheel tick */
+    size_t armed; /**< number of armed timers */
+    size_t refs; /**< number of timers */
+    size_t workers; /**< number of running workers */
+    size_t idle; /**< number of idle workers */
+    struct vlc_list exited; /**< workers to be joined */
+    vlc_thread_t thread;
+    bool live; /**< whether the threads are running or should run */
+    bool stopping; /**< whether the threads are being joined */
+} vlc_timers = {
+    .lock = VLC_STATIC_MUTEX,
+    .reschedule = VLC_STATIC_COND,
+    .work = VLC_STATIC_COND,
+    .done = VLC_STATIC_COND,
+};
+
+static uint64_t vlc_timer_ticks(vlc_tick_t value)
+{
+    /* Round up: timers never fire early */
+    return (value + TIMER_RESOLUTION - 1) / TIMER_RESOLUTION;
+}
+
+static void vlc_timer_wheel_init(void)
+{
+    for (size_t i = 0; i < TIMER_LEVELS; i++)
+        for (size_t j = 0; j < TIMER_SLOTS; j++)
+            vlc_list_init(&vlc_timers.wheel[i][j]);
+    vlc_timers.now = vlc_timer_ticks(vlc_tick_now());
+}
+
+static void vlc_timer_wheel_insert(struct vlc_timer *timer)
+{
+    uint64_t expiry = timer->expiry;
+    uint64_t delta;
+    size_t level = 0;
+
+    if (expiry < vlc_timers.now)
+        expiry = vlc_timers.now; /* overdue: fire at the current tick */
+
+    delta = expiry - vlc_timers.now;
+    if (delta > TIMER_RANGE)
+    {
+        delta = TIMER_RANGE;
+        expiry = vlc_timers.now + delta;
+    }
+
+    while (delta >> (TIMER_LEVEL_BITS * (level + 1)))
+        level++;
+    assert(level < TIMER_LEVELS);
+
+    size_t slot = (expiry >> (TIMER_LEVEL_BITS * level)) & (TIMER_SLOTS - 1);
+
+    vlc_list_append(&timer->node, &vlc_timers.wheel[level][slot]);
+}
+
+/**
+ * Returns the next wheel tick at which the wheel needs to be processed,
+ * i.e. a timer expires or a slot must be cascaded, or UINT64_MAX.
+ */
+static uint64_t vlc_timer_wheel_next(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    if (vlc_timers.armed == 0)
+        return next;
+
+    for (size_t level = 0; level < TIMER_LEVELS; level++)
+    {
+        const unsigned shift = TIMER_LEVEL_BITS * level;
+        const uint64_t base = vlc_timers.now >> shift;
+
+        /* The current slot of the first level is due now; the current slot
+         * of the other levels can only contain timers a full turn later. */
+        for (unsigned i = (level == 0) ? 0 : 1; i <= TIMER_SLOTS; i++)
+        {
+            size_t slot = (base + i) & (TIMER_SLOTS - 1);
+
+            if (!vlc_list_is_empty(&vlc_timers.wheel[level][slot]))
+            {
+                uint64_t tick = (base + i) << shift;
+
+                if (tick < next)
+                    next = tick;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+static void vlc_timer_wheel_cascade(size_t level)
+{
+    const unsigned shift = TIMER_LEVEL_BITS * level;
+    size_t slot = (vlc_timers.now >> shift) & (TIMER_SLOTS - 1);
+    struct vlc_list list;
+    struct vlc_timer *timer;
+
+    /* Cascade the upper levels first, they can refill this slot */
+    if (slot == 0 && level + 1 < TIMER_LEVELS)
+        vlc_timer_wheel_cascade(level + 1);
+
+    vlc_list_init(&list);
+    vlc_list_foreach(timer, &vlc_timers.wheel[level][slot], node)
+    {
+        vlc_list_remove(&timer->node);
+        vlc_list_append(&timer->node, &list);
+    }
+    vlc_list_foreach(timer, &list, node)
+    {
+        vlc_list_remove(&timer->node);
+        vlc_timer_wheel_insert(timer);
+    }
+}
+
+/**
+ * Advances the wheel up to the given tick, or up to the first expired timer.
+ *
+ * \return the first expired timer (removed from the wheel), or NULL
+ */
+static struct vlc_timer *vlc_timer_wheel_advance(uint64_t tick)
+{
+    while (vlc_timers.now <= tick)
+    {
+        struct vlc_list *head =
+            &vlc_timers.wheel[0][vlc_timers.now & (TIMER_SLOTS - 1)];
+        struct vlc_timer *timer = vlc_list_first_entry_or_null(head,
+                                                  struct vlc_timer, node);
+        if (timer != NULL)
+        {
+            assert(timer->expiry <= vlc_timers.now);
+            vlc_list_remove(&timer->node);
+            return timer;
+        }
+
+        uint64_t next = vlc_timer_wheel_next();
+
+        /* Skip the ticks where nothing happens at once */
+        if (next <= vlc_timers.now)
+            next = vlc_timers.now + 1;
+        if (next > tick)
+        {
+            vlc_timers.now = tick + 1;
+            if ((vlc_timers.now & (TIMER_SLOTS - 1)) == 0)
+                vlc_timer_wheel_cascade(1);
+            break;
+        }
+
+        vlc_timers.now = next;
+        if ((vlc_timers.now & (TIMER_SLOTS - 1)) == 0)
+            vlc_timer_wheel_cascade(1);
+    }
+    return NULL;
+}
+
+/* Joins the workers that exited (unlocks temporarily) */
+static void vlc_timer_join_workers(void)
+{
+    struct vlc_list exited;
+    struct vlc_timer_worker *worker;
+
+    if (vlc_list_is_empty(&vlc_timers.exited))
+        return;
+
+    vlc_list_init(&exited);
+    vlc_list_foreach(worker, &vlc_timers.exited, node)
+    {
+        vlc_list_remove(&worker->node);
+        vlc_list_append(&worker->node, &exited);
+    }
+
+    vlc_mutex_unlock(&vlc_timers.lock);
+    vlc_list_foreach(worker, &exited, node)
+    {
+        vlc_join(worker->thread, NULL);
+        free(worker);
+    }
+    vlc_mutex_lock(&vlc_timers.lock);
+}
+
+static void *vlc_timer_worker_thread(void *data)
+{
+    struct vlc_timer_worker *worker = data;
+
+    vlc_mutex_lock(&vlc_timers.lock);
+    for (;;)
+    {
+        struct vlc_timer *timer =
+            vlc_list_first_entry_or_null(&vlc_timers.queue, struct vlc_timer,
+                                         run_node);
+        if (timer == NULL)
+        {
+            if (!vlc_timers.live)
+                break;
+
+            vlc_timers.idle++;
+            int val = vlc_cond_timedwait(&vlc_timers.work, &vlc_timers.lock,
+                                         vlc_tick_now() + TIMER_IDLE_TIMEOUT);
+            vlc_timers.idle--;
+            if (val != 0 && vlc_list_is_empty(&vlc_timers.queue))
+                break;
+            continue;
+        }
+
+        vlc_list_remove(&timer->run_node);
+        vlc_timers.queued--;
+
+        /* Run the iterations that expired while the callback was running */
+        do
+        {
+            timer->queued = false;
+            timer->running = true;
+            timer->thread_id = vlc_thread_id();
+            vlc_mutex_unlock(&vlc_timers.lock);
+            timer->func(timer->data);
+            vlc_mutex_lock(&vlc_timers.lock);
+            timer->running = false;
+        }
+        while (timer->queued);
+
+        vlc_cond_broadcast(&vlc_timers.done);
+    }
+
+    assert(vlc_timers.workers > 0);
+    vlc_timers.workers--;
+    vlc_list_append(&worker->node, &vlc_timers.exited);
+    vlc_cond_broadcast(&vlc_timers.done);
+    /* Let the scheduling thread join this worker */
+    vlc_cond_signal(&vlc_timers.reschedule);
+    vlc_mutex_unlock(&vlc_timers.lock);
+    return NULL;
+}
+
+static void vlc_timer_spawn(void)
+{
+    if (vlc_timers.workers >= TIMER_WORKERS_MAX)
+        return;
+
+    struct vlc_timer_worker *worker = malloc(sizeof (*worker));
+    if (unlikely(worker == NULL))
+        return;
+
+    if (vlc_clone(&worker->thread, vlc_timer_worker_thread, worker,
+                  VLC_THREAD_PRIORITY_INPUT))
+    {
+        free(worker);
+        return;
+    }
+    vlc_timers.workers++;
+}
+
+/* Hands an expired timer over to the workers */
+static void vlc_timer_dispatch(struct vlc_timer *timer, vlc_tick_t now)
+{
+    if (timer->queued)
+    {   /* The previous iteration did not even start: merge them */
+        atomic_fetch_add_explicit(&timer->overruns, 1, memory_order_relaxed);
+        return;
+    }
+
+    timer->queued = true;
+    if (timer->running)
+        return; /* the worker runs the callback again when it returns */
+
+    timer->dispatched = now;
+    vlc_list_append(&timer->run_node, &vlc_timers.queue);
+    vlc_timers.queued++;
+
+    if (vlc_timers.workers == 0)
+        vlc_timer_spawn();
+    /* Idle workers are woken up once all the expired timers are queued */
+}
+
 static void *vlc_timer_thread (void *data)
 {
-    struct vlc_timer *timer = data;
+    (void) data;
 
-    vlc_mutex_lock (&timer->lock);
+    vlc_mutex_lock(&vlc_timers.lock);
 
-    while (timer->live)
+    while (vlc_timers.live)
     {
-        if (timer->value == 0)
+        vlc_timer_join_workers();
+
+        vlc_tick_t now = vlc_tick_now();
+        struct vlc_timer *timer =
+            vlc_timer_wheel_advance(now / TIMER_RESOLUTION);
+
+        if (timer == NULL)
         {
-            assert(timer->interval == 0);
-            vlc_cond_wait (&timer->reschedule, &timer->lock);
+            uint64_t next = vlc_timer_wheel_next();
+            vlc_tick_t deadline = (next != UINT64_MAX)
+                                  ? (vlc_tick_t)(next * TIMER_RESOLUTION)
+                                  : VLC_TICK_MAX;
+            struct vlc_timer *head =
+                vlc_list_first_entry_or_null(&vlc_timers.queue,
+                                             struct vlc_timer, run_node);
+            if (head != NULL && vlc_timers.idle > 0)
+                vlc_cond_signal(&vlc_timers.work);
+            else if (head != NULL && vlc_timers.workers < TIMER_WORKERS_MAX)
+            {   /* All the workers are busy: start another one if stuck */
+                vlc_tick_t stall = head->dispatched + TIMER_STALL_DELAY;
+
+                if (stall <= now)
+                {
+                    vlc_timer_spawn();
+                    head->dispatched = now;
+                    stall = now + TIMER_STALL_DELAY;
+                }
+                if (stall < deadline)
+                    deadline = stall;
+            }
+
+            if (deadline == VLC_TICK_MAX)
+                vlc_cond_wait(&vlc_timers.reschedule, &vlc_timers.lock);
+            else
+                vlc_cond_timedwait(&vlc_timers.reschedule, &vlc_timers.lock,
+                                   deadline);
             continue;
         }
 
         if (timer->interval != 0)
         {
-            vlc_tick_t now = vlc_tick_now();
-
             if (now > timer->value)
             {   /* Update overrun counter */
                 unsigned misses = (now - timer->value) / timer->interval;
@@ -78,52 +430,101 @@ static void *vlc_timer_thread (void *data)
                 atomic_fetch_add_explicit(&timer->overruns, misses,
                                           memory_order_relaxed);
             }
-        }
-
-        vlc_tick_t value = timer->value;
 
-        if (vlc_cond_timedwait(&timer->reschedule, &timer->lock, value) == 0)
-            continue;
-
-        if (likely(timer->value <= value))
-        {
             timer->value += timer->interval; /* rearm */
-
-            if (timer->interval == 0)
-                timer->value = 0; /* disarm */
+            timer->expiry = vlc_timer_ticks(timer->value);
+            vlc_timer_wheel_insert(timer);
+        }
+        else
+        {
+            timer->value = 0; /* disarm */
+            timer->armed = false;
+            vlc_timers.armed--;
         }
 
-        vlc_mutex_unlock (&timer->lock);
-        timer->func (timer->data);
-        vlc_mutex_lock (&timer->lock);
+        vlc_timer_dispatch(timer, now);
     }
 
-    vlc_mutex_unlock (&timer->lock);
+    vlc_mutex_unlock(&vlc_timers.lock);
     return NULL;
 }
 
+/* Drops the pending iteration of a timer, if any */
+static void vlc_timer_unqueue(struct vlc_timer *timer)
+{
+    if (!timer->queued)
+        return;
+
+    if (!timer->running)
+    {
+        vlc_list_remove(&timer->run_node);
+        vlc_timers.queued--;
+    }
+    timer->queued = false;
+}
+
+/* Stops and joins all the threads (unlocks temporarily) */
+static void vlc_timer_stop(void)
+{
+    vlc_timers.live = false;
+    vlc_timers.stopping = true;
+    vlc_cond_signal(&vlc_timers.reschedule);
+    vlc_cond_broadcast(&vlc_timers.work);
+
+    while (vlc_timers.workers > 0)
+        vlc_cond_wait(&vlc_timers.done, &vlc_timers.lock);
+
+    vlc_mutex_unlock(&vlc_timers.lock);
+    vlc_join(vlc_timers.thread, NULL);
+    vlc_mutex_lock(&vlc_timers.lock);
+
+    vlc_timer_join_workers();
+    vlc_timers.stopping = false;
+    vlc_cond_broadcast(&vlc_timers.done);
+}
+
 int vlc_timer_create (vlc_timer_t *id, void (*func) (void *), void *data)
 {
     struct vlc_timer *timer = malloc (sizeof (*timer));
 
     if (unlikely(timer == NULL))
         return ENOMEM;
-    vlc_mutex_init (&timer->lock);
-    vlc_cond_init (&timer->reschedule);
     assert (func);
     timer->func = func;
     timer->data = data;
     timer->value = 0;
     timer->interval = 0;
-    timer->live = true;
+    timer->expiry = 0;
+    timer->dispatched = 0;
+    timer->thread_id = 0;
+    timer->armed = false;
+    timer->queued = false;
+    timer->running = false;
     atomic_init(&timer->overruns, 0);
 
-    if (vlc_clone (&timer->thread, vlc_timer_thread, timer,
-                   VLC_THREAD_PRIORITY_INPUT))
+    vlc_mutex_lock(&vlc_timers.lock);
+    /* The previous threads can still be stopping */
+    while (vlc_timers.stopping)
+        vlc_cond_wait(&vlc_timers.done, &vlc_timers.lock);
+
+    if (!vlc_timers.live)
     {
-        free (timer);
-        return ENOMEM;
+        vlc_timer_wheel_init();
+        vlc_list_init(&vlc_timers.queue);
+        vlc_list_init(&vlc_timers.exited);
+        vlc_timers.queued = 0;
+        vlc_timers.live = true;
+        if (vlc_clone(&vlc_timers.thread, vlc_timer_thread, NULL,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_timers.live = false;
+            vlc_mutex_unlock(&vlc_timers.lock);
+            free (timer);
+            return ENOMEM;
+        }
     }
+    vlc_timers.refs++;
+    vlc_mutex_unlock(&vlc_timers.lock);
 
     *id = timer;
     return 0;
@@ -131,12 +532,26 @@ int vlc_timer_create (vlc_timer_t *id, void (*func) (void *), void *data)
 
 void vlc_timer_destroy (vlc_timer_t timer)
 {
-    vlc_mutex_lock(&timer->lock);
-    timer->live = false;
-    vlc_cond_signal(&timer->reschedule);
-    vlc_mutex_unlock(&timer->lock);
+    vlc_mutex_lock(&vlc_timers.lock);
+    if (timer->armed)
+    {
+        vlc_list_remove(&timer->node);
+        vlc_timers.armed--;
+    }
+
+    vlc_timer_unqueue(timer);
+
+    /* The callback cannot wait for itself to return */
+    assert(!timer->running || timer->thread_id != vlc_thread_id());
+
+    /* Wait for the pending iteration */
+    while (timer->running)
+        vlc_cond_wait(&vlc_timers.done, &vlc_timers.lock);
 
-    vlc_join (timer->thread, NULL);
+    assert(vlc_timers.refs > 0);
+    if (--vlc_timers.refs == 0)
+        vlc_timer_stop();
+    vlc_mutex_unlock(&vlc_timers.lock);
     free (timer);
 }
 
@@ -149,11 +564,34 @@ void vlc_timer_schedule (vlc_timer_t timer, bool absolute,
     if (!absolute)
         value += vlc_tick_now();
 
-    vlc_mutex_lock (&timer->lock);
+    vlc_mutex_lock(&vlc_timers.lock);
+    if (timer->armed)
+    {
+        vlc_list_remove(&timer->node);
+        timer->armed = false;
+        vlc_timers.armed--;
+    }
+
+    /* The iteration of the previous schedule that did not start yet is
+     * dropped (a running callback still returns normally) */
+    vlc_timer_unqueue(timer);
+
     timer->value = value;
     timer->interval = interval;
-    vlc_cond_signal (&timer->reschedule);
-    vlc_mutex_unlock (&timer->lock);
+
+    if (value != VLC_TIMER_DISARM)
+    {
+        uint64_t next = vlc_timer_wheel_next();
+
+        timer->expiry = vlc_timer_ticks(value);
+        timer->armed = true;
+        vlc_timers.armed++;
+        vlc_timer_wheel_insert(timer);
+
+        if (timer->expiry < next)
+            vlc_cond_signal(&vlc_timers.reschedule);
+    }
+    vlc_mutex_unlock(&vlc_timers.lock);
 }
 
 unsigned vlc_timer_getoverrun (vlc_timer_t timer)
@@ -22,25 +22,45 @@
 # include "config.h"
 #endif
 
+#include <search.h>
+
 #include <vlc_common.h>
 #include <vlc_atomic.h>
 #include <vlc_executor.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
+#include "input/demux.h"
+#include "input/item.h"
 #include "preparser.h"
 #include "fetcher.h"
 
+/* Up to "preparse-threads" times this factor may run in parallel */
+#define PREPARSER_THREADS_FACTOR 4
+/* Average preparsing durations driving the number of parallel tasks: slow
+ * medias (network shares) are bound by the I/O latency, fast ones by the CPU */
+#define PREPARSER_SLOW_DURATION VLC_TICK_FROM_MS(200)
+#define PREPARSER_FAST_DURATION VLC_TICK_FROM_MS(50)
+
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
     vlc_executor_t *executor;
+    struct demux_probe_cache *probe_cache; /**< shared by the tasks */
     vlc_tick_t default_timeout;
     atomic_bool deactivated;
 
     vlc_mutex_t lock;
     struct vlc_list submitted_tasks; /**< list of struct task */
+    struct vlc_list pending_tasks; /**< tasks not submitted to the executor */
+    void *tasks_by_item; /**< tree of the tasks preparsing each item */
+
+    unsigned min_threads;
+    unsigned max_threads;
+    unsigned threads; /**< maximum number of tasks run in parallel */
+    unsigned running; /**< number of tasks submitted to the executor */
+    vlc_tick_t duration; /**< average preparsing duration */
 };
 
 struct task
@@ -63,6 +83,12 @@ struct task
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
     struct vlc_list node; /**< node of input_preparser_t.submitted_tasks */
+    struct vlc_list pending_node; /**< node of input_preparser_t.pending_tasks */
+    bool pending;
+
+    struct task *leader; /**< task preparsing the item, if a duplicate */
+    struct vlc_list duplicates; /**< tasks finished with this one */
+    struct vlc_list duplicate_node; /**< node of task.duplicates */
 };
 
 static void RunnableRun(void *);
@@ -97,6 +123,10 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
 
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
+    task->pending = false;
+
+    task->leader = NULL;
+    vlc_list_init(&task->duplicates);
 
     return task;
 }
@@ -108,19 +138,176 @@ TaskDelete(struct task *task)
     free(task);
 }
 
+static void
+PreparserDispatch(input_preparser_t *preparser)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    while (preparser->running < preparser->threads)
+    {
+        struct task *task =
+            vlc_list_first_entry_or_null(&preparser->pending_tasks,
+                                         struct task, pending_node);
+        if (!task)
+            break;
+
+        vlc_list_remove(&task->pending_node);
+        task->pending = false;
+        preparser->running++;
+        vlc_executor_Submit(preparser->executor, &task->runnable);
+    }
+}
+
+static int
+TaskCompareItem(const void *a_, const void *b_)
+{
+    const struct task *a = a_, *b = b_;
+    uintptr_t ia = (uintptr_t) a->item, ib = (uintptr_t) b->item;
+
+    return (ia > ib) - (ia < ib);
+}
+
+/**
+ * Finds a task preparsing the same item for the same requester, that the
+ * given task can wait for instead of preparsing the item again.
+ */
+static struct task *
+PreparserFindLeader(input_preparser_t *preparser, const struct task *task)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    void **node = tfind(task, &preparser->tasks_by_item, TaskCompareItem);
+    if (node == NULL)
+        return NULL;
+
+    struct task *leader = *node;
+    /* The sub-items are only notified to the callbacks of the leader */
+    if (leader->cbs != task->cbs || leader->userdata != task->userdata
+     || leader->timeout != task->timeout
+     || atomic_load(&leader->interrupted))
+        return NULL;
+
+    if (leader->pending)
+        leader->options |= task->options;
+    else if ((task->options & ~leader->options) != 0)
+        return NULL; /* Too late to fetch more */
+
+    return leader;
+}
+
+static void
+PreparserForgetTask(input_preparser_t *preparser, struct task *task)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    void **node = tfind(task, &preparser->tasks_by_item, TaskCompareItem);
+    if (node != NULL && *node == task)
+        tdelete(task, &preparser->tasks_by_item, TaskCompareItem);
+}
+
 static void
 PreparserAddTask(input_preparser_t *preparser, struct task *task)
 {
-    vlc_mutex_lock(&preparser->lock);
+    vlc_mutex_assert(&preparser->lock);
+
     vlc_list_append(&task->node, &preparser->submitted_tasks);
-    vlc_mutex_unlock(&preparser->lock);
+
+    struct task *leader = PreparserFindLeader(preparser, task);
+    if (leader != NULL)
+    {
+        task->leader = leader;
+        vlc_list_append(&task->duplicate_node, &leader->duplicates);
+        return;
+    }
+
+    /* Only the first task of an item can be found (and the tree may fail
+     * to allocate a node, in which case the item is not deduplicated) */
+    tsearch(task, &preparser->tasks_by_item, TaskCompareItem);
+
+    vlc_list_append(&task->pending_node, &preparser->pending_tasks);
+    task->pending = true;
+}
+
+/**
+ * Hands the duplicates of a canceled task over to the first of them, which
+ * is queued in its place.
+ */
+static void
+PreparserPromoteDuplicate(input_preparser_t *preparser, struct task *task)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    PreparserForgetTask(preparser, task);
+
+    struct task *leader =
+        vlc_list_first_entry_or_null(&task->duplicates, struct task,
+                                     duplicate_node);
+    if (leader == NULL)
+        return;
+
+    vlc_list_remove(&leader->duplicate_node);
+    leader->leader = NULL;
+
+    struct task *dup;
+    vlc_list_foreach(dup, &task->duplicates, duplicate_node)
+    {
+        vlc_list_remove(&dup->duplicate_node);
+        vlc_list_append(&dup->duplicate_node, &leader->duplicates);
+        dup->leader = leader;
+        leader->options |= dup->options;
+    }
+
+    tsearch(leader, &preparser->tasks_by_item, TaskCompareItem);
+
+    if (task->pending)
+        vlc_list_add_after(&leader->pending_node, &task->pending_node);
+    else
+        vlc_list_prepend(&leader->pending_node, &preparser->pending_tasks);
+    leader->pending = true;
 }
 
 static void
-PreparserRemoveTask(input_preparser_t *preparser, struct task *task)
+PreparserUpdateThreads(input_preparser_t *preparser, vlc_tick_t duration)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    preparser->duration = preparser->duration == VLC_TICK_INVALID ? duration
+                        : (preparser->duration * 7 + duration) / 8;
+
+    unsigned threads = preparser->threads;
+    if (preparser->duration > PREPARSER_SLOW_DURATION
+     && threads < preparser->max_threads)
+        threads++;
+    else if (preparser->duration < PREPARSER_FAST_DURATION
+          && threads > preparser->min_threads)
+        threads--;
+
+    if (threads != preparser->threads)
+    {
+        /* The executor only keeps the threads needed by the current load */
+        preparser->threads = threads;
+        vlc_executor_SetMaxThreads(preparser->executor, threads);
+    }
+}
+
+static void
+PreparserRemoveTask(input_preparser_t *preparser, struct task *task,
+                    vlc_tick_t duration)
 {
     vlc_mutex_lock(&preparser->lock);
+    PreparserForgetTask(preparser, task);
     vlc_list_remove(&task->node);
+
+    /* The duplicates end with the task, see RunnableRun() */
+    struct task *dup;
+    vlc_list_foreach(dup, &task->duplicates, duplicate_node)
+        vlc_list_remove(&dup->node);
+
+    assert(preparser->running > 0);
+    preparser->running--;
+    if (duration != VLC_TICK_INVALID)
+        PreparserUpdateThreads(preparser, duration);
+    PreparserDispatch(preparser);
     vlc_mutex_unlock(&preparser->lock);
 }
 
@@ -165,6 +352,18 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
 
+static void
+OnParserSubitemsRead(input_item_t *item, input_item_t *const *subitems,
+                     size_t count, size_t total, void *task_)
+{
+    VLC_UNUSED(item);
+    struct task *task = task_;
+
+    if (task->cbs && task->cbs->on_subitems_read)
+        task->cbs->on_subitems_read(task->item, subitems, count, total,
+                                    task->userdata);
+}
+
 static void
 OnArtFetchEnded(input_item_t *item, bool fetched, void *userdata)
 {
@@ -186,10 +385,12 @@ Parse(struct task *task, vlc_tick_t deadline)
     static const input_item_parser_cbs_t cbs = {
         .on_ended = OnParserEnded,
         .on_subtree_added = OnParserSubtreeAdded,
+        .on_subitems_read = OnParserSubitemsRead,
     };
 
     vlc_object_t *obj = task->preparser->owner;
-    task->parser = input_item_Parse(task->item, obj, &cbs, task);
+    task->parser = input_item_ParseCached(task->item, obj, &cbs, task,
+                                          task->preparser->probe_cache);
     if (!task->parser)
     {
         atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_FAILED,
@@ -235,13 +436,19 @@ RunnableRun(void *userdata)
 {
     struct task *task = userdata;
 
-    vlc_tick_t deadline = task->timeout ? vlc_tick_now() + task->timeout
+    vlc_tick_t start = vlc_tick_now();
+    vlc_tick_t deadline = task->timeout ? start + task->timeout
                                         : VLC_TICK_INVALID;
+    vlc_tick_t duration = VLC_TICK_INVALID;
 
     if (atomic_load(&task->interrupted))
         goto end;
 
     Parse(task, deadline);
+    /* Timed out medias would only account for the timeout value */
+    if (atomic_load_explicit(&task->preparse_status,
+                             memory_order_relaxed) != ITEM_PREPARSE_TIMEOUT)
+        duration = vlc_tick_now() - start;
 
     if (atomic_load(&task->interrupted))
         goto end;
@@ -256,7 +463,20 @@ RunnableRun(void *userdata)
 end:
     NotifyPreparseEnded(task);
     input_preparser_t *preparser = task->preparser;
-    PreparserRemoveTask(preparser, task);
+    PreparserRemoveTask(preparser, task, duration);
+
+    /* The duplicate requests share the result of the task */
+    int status = atomic_load_explicit(&task->preparse_status,
+                                      memory_order_relaxed);
+    struct task *dup;
+    vlc_list_foreach(dup, &task->duplicates, duplicate_node)
+    {
+        atomic_store_explicit(&dup->preparse_status, status,
+                              memory_order_relaxed);
+        NotifyPreparseEnded(dup);
+        TaskDelete(dup);
+    }
+
     TaskDelete(task);
 }
 
@@ -281,13 +501,21 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (max_threads < 1)
         max_threads = 1;
 
-    preparser->executor = vlc_executor_New(max_threads);
+    preparser->min_threads = preparser->threads = max_threads;
+    preparser->max_threads = max_threads * PREPARSER_THREADS_FACTOR;
+    preparser->running = 0;
+    preparser->duration = VLC_TICK_INVALID;
+
+    preparser->executor = vlc_executor_New(preparser->threads);
     if (!preparser->executor)
     {
         free(preparser);
         return NULL;
     }
 
+    /* Without cache, the demuxers are probed as usual */
+    preparser->probe_cache = demux_ProbeCacheNew();
+
     preparser->default_timeout =
         VLC_TICK_FROM_MS(var_InheritInteger(parent, "preparse-timeout"));
     if (preparser->default_timeout < 0)
@@ -299,6 +527,8 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
 
     vlc_mutex_init(&preparser->lock);
     vlc_list_init(&preparser->submitted_tasks);
+    vlc_list_init(&preparser->pending_tasks);
+    preparser->tasks_by_item = NULL;
 
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
@@ -306,14 +536,9 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     return preparser;
 }
 
-int input_preparser_Push( input_preparser_t *preparser,
-    input_item_t *item, input_item_meta_request_option_t i_options,
-    const input_preparser_callbacks_t *cbs, void *cbs_userdata,
-    int timeout_ms, void *id )
+static bool
+PreparserAccepts( input_item_t *item, input_item_meta_request_option_t i_options )
 {
-    if( atomic_load( &preparser->deactivated ) )
-        return VLC_EGENERIC;
-
     vlc_mutex_lock( &item->lock );
     enum input_item_type_e i_type = item->i_type;
     int b_net = item->b_net;
@@ -328,27 +553,122 @@ int input_preparser_Push( input_preparser_t *preparser,
         case ITEM_TYPE_DIRECTORY:
         case ITEM_TYPE_PLAYLIST:
             if( !b_net || i_options & META_REQUEST_OPTION_SCOPE_NETWORK )
-                break;
+                return true;
             /* fallthrough */
         default:
-            if (cbs && cbs->on_preparse_ended)
-                cbs->on_preparse_ended(item, ITEM_PREPARSE_SKIPPED, cbs_userdata);
-            return VLC_SUCCESS;
+            return false;
     }
+}
+
+struct batch_entry
+{
+    input_item_t *item;
+    struct task *task; /**< NULL if the item is skipped */
+    char *uri;
+    size_t dirlen;
+    size_t index;
+};
+
+static int
+BatchEntryCompare( const void *a_, const void *b_ )
+{
+    const struct batch_entry *a = a_, *b = b_;
+
+    if( a->uri && b->uri )
+    {
+        int ret = strncmp( a->uri, b->uri, __MIN( a->dirlen, b->dirlen ) );
+        if( ret == 0 && a->dirlen != b->dirlen )
+            ret = a->dirlen < b->dirlen ? -1 : 1;
+        if( ret != 0 )
+            return ret;
+    }
+    else if( a->uri != b->uri )
+        return a->uri ? -1 : 1;
+
+    /* Keep the requested order within a directory */
+    return a->index < b->index ? -1 : a->index > b->index;
+}
+
+int input_preparser_PushBatch( input_preparser_t *preparser,
+    input_item_t *const *items, size_t count,
+    input_item_meta_request_option_t i_options,
+    const input_preparser_callbacks_t *cbs, void *cbs_userdata,
+    int timeout_ms, void *id )
+{
+    if( atomic_load( &preparser->deactivated ) )
+        return VLC_EGENERIC;
+
+    struct batch_entry *entries = vlc_alloc( count, sizeof( *entries ) );
+    if( unlikely( entries == NULL ) )
+        return VLC_ENOMEM;
 
     vlc_tick_t timeout = timeout_ms == -1 ? preparser->default_timeout
                                           : VLC_TICK_FROM_MS(timeout_ms);
-    struct task *task =
-        TaskNew(preparser, item, i_options, cbs, cbs_userdata, id, timeout);
-    if( !task )
-        return VLC_ENOMEM;
 
-    PreparserAddTask(preparser, task);
+    for( size_t i = 0; i < count; ++i )
+    {
+        struct batch_entry *entry = &entries[i];
+        entry->item = items[i];
+        entry->task = NULL;
+        entry->uri = NULL;
+        entry->dirlen = 0;
+        entry->index = i;
+
+        if( !PreparserAccepts( items[i], i_options ) )
+            continue;
+
+        entry->task = TaskNew( preparser, items[i], i_options, cbs,
+                               cbs_userdata, id, timeout );
+        if( unlikely( entry->task == NULL ) )
+        {
+            for( size_t j = 0; j < i; ++j )
+            {
+                if( entries[j].task )
+                    TaskDelete( entries[j].task );
+                free( entries[j].uri );
+            }
+            free( entries );
+            return VLC_ENOMEM;
+        }
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+        /* Group the medias by directory, so that consecutive tasks share
+         * the demuxer probe cache and the storage caches */
+        entry->uri = input_item_GetURI( items[i] );
+        const char *slash = entry->uri ? strrchr( entry->uri, '/' ) : NULL;
+        if( slash )
+            entry->dirlen = slash - entry->uri;
+    }
+
+    if( count > 1 )
+        qsort( entries, count, sizeof( *entries ), BatchEntryCompare );
+
+    vlc_mutex_lock( &preparser->lock );
+    for( size_t i = 0; i < count; ++i )
+        if( entries[i].task )
+            PreparserAddTask( preparser, entries[i].task );
+    PreparserDispatch( preparser );
+    vlc_mutex_unlock( &preparser->lock );
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        if( !entries[i].task && cbs && cbs->on_preparse_ended )
+            cbs->on_preparse_ended( entries[i].item, ITEM_PREPARSE_SKIPPED,
+                                    cbs_userdata );
+        free( entries[i].uri );
+    }
+    free( entries );
     return VLC_SUCCESS;
 }
 
+int input_preparser_Push( input_preparser_t *preparser,
+    input_item_t *item, input_item_meta_request_option_t i_options,
+    const input_preparser_callbacks_t *cbs, void *cbs_userdata,
+    int timeout_ms, void *id )
+{
+    return input_preparser_PushBatch( preparser, &item, 1, i_options, cbs,
+                                      cbs_userdata, timeout_ms, id );
+}
+
 void input_preparser_fetcher_Push( input_preparser_t *preparser,
     input_item_t *item, input_item_meta_request_option_t options,
     const input_fetcher_callbacks_t *cbs, void *cbs_userdata )
@@ -367,8 +687,28 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
     {
         if (!id || task->id == id)
         {
-            bool canceled =
-                vlc_executor_Cancel(preparser->executor, &task->runnable);
+            if (task->leader != NULL)
+            {   /* Duplicate request: the leader goes on */
+                vlc_list_remove(&task->duplicate_node);
+                vlc_list_remove(&task->node);
+                NotifyPreparseEnded(task);
+                TaskDelete(task);
+                continue;
+            }
+
+            PreparserPromoteDuplicate(preparser, task);
+
+            bool canceled = task->pending;
+            if (canceled)
+                vlc_list_remove(&task->pending_node);
+            else
+            {
+                canceled =
+                    vlc_executor_Cancel(preparser->executor, &task->runnable);
+                if (canceled)
+                    preparser->running--;
+            }
+
             if (canceled)
             {
                 NotifyPreparseEnded(task);
@@ -381,6 +721,7 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
         }
     }
 
+    PreparserDispatch(preparser);
     vlc_mutex_unlock(&preparser->lock);
 }
 
@@ -396,6 +737,10 @@ void input_preparser_Delete( input_preparser_t *preparser )
     input_preparser_Cancel(preparser, NULL);
 
     vlc_executor_Delete(preparser->executor);
+    assert(preparser->tasks_by_item == NULL);
+
+    if( preparser->probe_cache )
+        demux_ProbeCacheDelete( preparser->probe_cache );
 
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
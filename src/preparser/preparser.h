@@ -60,6 +60,23 @@ int input_preparser_Push( input_preparser_t *, input_item_t *,
                            void *cbs_userdata,
                            int timeout, void *id );
 
+/**
+ * This function enqueues several items to be preparsed.
+ *
+ * It behaves like input_preparser_Push() for each item, but the items are
+ * preparsed grouped by directory, which is faster for large folders.
+ *
+ * @returns VLC_SUCCESS if the items were scheduled for preparsing, an error
+ * code otherwise
+ * If this returns an error, the on_preparse_ended will *not* be invoked
+ */
+int input_preparser_PushBatch( input_preparser_t *,
+                               input_item_t *const *items, size_t count,
+                               input_item_meta_request_option_t,
+                               const input_preparser_callbacks_t *cbs,
+                               void *cbs_userdata,
+                               int timeout, void *id );
+
 void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
                                    input_item_meta_request_option_t,
                                    const input_fetcher_callbacks_t *cbs,
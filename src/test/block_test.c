@@ -86,11 +86,110 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+#define POOL_FRAMES 16
+
+static void *release_frames(void *data)
+{
+    block_t **frames = data;
+
+    for (size_t i = 0; i < POOL_FRAMES; i++)
+        block_Release(frames[i]);
+    return NULL;
+}
+
+static void *release_chain(void *data)
+{
+    block_ChainRelease(data);
+    return NULL;
+}
+
+static void alloc_frames(block_t **frames, size_t size)
+{
+    for (size_t i = 0; i < POOL_FRAMES; i++)
+    {
+        frames[i] = block_Alloc(size);
+        assert(frames[i] != NULL);
+        assert(frames[i]->i_buffer == size);
+        assert(((uintptr_t)frames[i]->p_buffer % 16) == 0);
+        memset(frames[i]->p_buffer, i, size);
+    }
+}
+
+static void test_frame_pool(void)
+{
+    struct vlc_frame_pool_stats before, after;
+    block_t *frames[POOL_FRAMES];
+    vlc_thread_t th;
+
+    vlc_frame_SetPooling(true);
+    alloc_frames(frames, 1000);
+    release_frames(frames);
+
+    /* Recycled in the same thread */
+    vlc_frame_GetPoolStats(&before);
+    alloc_frames(frames, 900);
+    vlc_frame_GetPoolStats(&after);
+    assert(after.hits == before.hits + POOL_FRAMES);
+    assert(after.misses == before.misses);
+    assert(after.peak_bytes >= after.bytes);
+
+    /* Released by another thread, recycled by the allocating one */
+    int ret = vlc_clone(&th, release_frames, frames, VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+
+    vlc_frame_GetPoolStats(&before);
+    frames[0] = block_Alloc(1000);
+    assert(frames[0] != NULL);
+    frames[0] = block_Realloc(frames[0], 100, 2000);
+    assert(frames[0] != NULL);
+    assert(frames[0]->i_buffer == 2100);
+    block_Release(frames[0]);
+    alloc_frames(frames, 1000);
+    vlc_frame_GetPoolStats(&after);
+    assert(after.hits == before.hits + POOL_FRAMES + 1);
+
+    /* Released by another thread, not taken back: the excess is freed */
+    vlc_frame_GetPoolStats(&before);
+    block_t *chain = NULL, **pp_last = &chain;
+    for (size_t i = 0; i < 1024; i++)
+    {
+        *pp_last = block_Alloc(1000);
+        assert(*pp_last != NULL);
+        pp_last = &(*pp_last)->p_next;
+    }
+    ret = vlc_clone(&th, release_chain, chain, VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+    vlc_frame_GetPoolStats(&after);
+    assert(after.bytes <= before.bytes + 256 * 1024 /* per class */);
+
+    /* Large frames are not pooled */
+    vlc_frame_GetPoolStats(&before);
+    block_t *large = block_Alloc(1 << 20);
+    assert(large != NULL);
+    block_Release(large);
+    vlc_frame_GetPoolStats(&after);
+    assert(after.hits == before.hits && after.misses == before.misses);
+
+    /* Disabled: pooled frames are freed */
+    vlc_frame_SetPooling(false);
+    release_frames(frames);
+    vlc_frame_GetPoolStats(&before);
+    alloc_frames(frames, 1000);
+    vlc_frame_GetPoolStats(&after);
+    assert(after.hits == before.hits && after.misses == before.misses);
+    assert(after.bytes == before.bytes);
+    release_frames(frames);
+    vlc_frame_SetPooling(true);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_frame_pool ();
     return 0;
 }
 
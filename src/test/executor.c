@@ -198,6 +198,69 @@ static void test_cancel(void)
     assert(canceled + shared_data.ended == 40);
 }
 
+struct barrier_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    int waiting;
+    int count;
+};
+
+static void RunBarrier(void *userdata)
+{
+    struct barrier_data *data = userdata;
+
+    /* Only returns once count tasks run in parallel */
+    vlc_mutex_lock(&data->lock);
+    if (++data->waiting == data->count)
+        vlc_cond_broadcast(&data->cond);
+    while (data->waiting < data->count)
+        vlc_cond_wait(&data->cond, &data->lock);
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_max_threads(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    /* 4 tasks waiting for each other need 4 threads */
+    vlc_executor_SetMaxThreads(executor, 4);
+
+    struct barrier_data barrier;
+    vlc_mutex_init(&barrier.lock);
+    vlc_cond_init(&barrier.cond);
+    barrier.waiting = 0;
+    barrier.count = 4;
+
+    struct vlc_runnable runnables[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        runnables[i].run = RunBarrier;
+        runnables[i].userdata = &barrier;
+        vlc_executor_Submit(executor, &runnables[i]);
+    }
+    vlc_executor_WaitIdle(executor);
+
+    /* The extra threads exit, the remaining one still runs the tasks */
+    vlc_executor_SetMaxThreads(executor, 1);
+
+    struct data shared_data;
+    InitData(&shared_data);
+
+    struct vlc_runnable increments[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        increments[i].run = RunIncrement;
+        increments[i].userdata = &shared_data;
+        vlc_executor_Submit(executor, &increments[i]);
+    }
+    vlc_executor_WaitIdle(executor);
+    assert(shared_data.ended == 10);
+
+    vlc_executor_Delete(executor);
+}
+
 struct doubler_task
 {
     vlc_executor_t *executor;
@@ -277,6 +340,7 @@ int main(void)
     test_multiple_runnables();
     test_blocking_delete();
     test_cancel();
+    test_max_threads();
     test_task_chain();
     return 0;
 }
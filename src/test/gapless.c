@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * gapless.c: test src/input/gapless.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include "../input/gapless.h"
+
+#define RATE 44100
+#define FRAME 1152
+
+/* Trims the buffer of count samples starting at the given sample, dated as
+ * a decoder would date it */
+static size_t trim(const audio_gapless_t *gapless, uint64_t sample,
+                   size_t count, size_t *skip)
+{
+    vlc_tick_t pts = VLC_TICK_0 + vlc_tick_from_samples(sample, RATE);
+    return audio_gapless_Trim(gapless, RATE, pts, count, skip);
+}
+
+int main(void)
+{
+    size_t skip;
+
+    /* No gapless information: nothing is trimmed */
+    const audio_gapless_t none = { 0, 0, 0 };
+    assert(trim(&none, 0, FRAME, &skip) == FRAME && skip == 0);
+
+    /* 10 frames, with the delay inside the first one */
+    const audio_gapless_t mp3 = {
+        .i_delay = 1105,
+        .i_padding = 1000,
+        .i_samples = 10 * FRAME,
+    };
+    const uint64_t end = 10 * FRAME - 1000;
+
+    /* Delay */
+    assert(trim(&mp3, 0, FRAME, &skip) == FRAME - 1105 && skip == 1105);
+    assert(trim(&mp3, 0, 1105, &skip) == 0);
+    assert(trim(&mp3, 1104, 2, &skip) == 1 && skip == 1);
+    assert(trim(&mp3, FRAME, FRAME, &skip) == FRAME && skip == 0);
+
+    /* Padding */
+    assert(trim(&mp3, 9 * FRAME, FRAME, &skip) == end - 9 * FRAME
+           && skip == 0);
+    assert(trim(&mp3, end, FRAME, &skip) == 0);
+    assert(trim(&mp3, end - 1, 2, &skip) == 1 && skip == 0);
+
+    /* Mid-stream seek: the buffers are located from their dates only */
+    assert(trim(&mp3, 5 * FRAME, FRAME, &skip) == FRAME && skip == 0);
+    assert(trim(&mp3, 5 * FRAME + 17, FRAME, &skip) == FRAME && skip == 0);
+    assert(trim(&mp3, end - 520, FRAME, &skip) == 520 && skip == 0);
+    assert(trim(&mp3, 1000, FRAME, &skip) == FRAME - 105 && skip == 105);
+    assert(trim(&mp3, 0, FRAME, &skip) == FRAME - 1105 && skip == 1105);
+
+    /* Delay and padding covering a whole buffer */
+    const audio_gapless_t small = {
+        .i_delay = 2 * FRAME,
+        .i_padding = 2 * FRAME,
+        .i_samples = 5 * FRAME,
+    };
+    assert(trim(&small, 0, FRAME, &skip) == 0);
+    assert(trim(&small, FRAME, FRAME, &skip) == 0);
+    assert(trim(&small, 2 * FRAME, FRAME, &skip) == FRAME && skip == 0);
+    assert(trim(&small, 3 * FRAME, FRAME, &skip) == 0);
+    assert(trim(&small, FRAME, 3 * FRAME, &skip) == FRAME && skip == FRAME);
+
+    /* Unknown length: only the delay is trimmed */
+    const audio_gapless_t open = { .i_delay = 100 };
+    assert(trim(&open, 0, FRAME, &skip) == FRAME - 100 && skip == 100);
+    assert(trim(&open, UINT64_C(1) << 32, FRAME, &skip) == FRAME
+           && skip == 0);
+
+    /* The rounded down dates are located on the right sample */
+    for (uint64_t sample = 0; sample < 2 * RATE; sample++)
+    {
+        const audio_gapless_t exact = { .i_delay = sample + 1 };
+        assert(trim(&exact, sample, 2, &skip) == 1 && skip == 1);
+    }
+
+    return 0;
+}
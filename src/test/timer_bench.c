@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * timer_bench.c: shared timers benchmark
+ *****************************************************************************
+ * Copyright (C) 2023 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the wake-ups caused by the periodic timers of many players in one
+ * process:
+ *
+ *   make -C src bench_timer && src/bench_timer [players] [seconds]
+ *
+ * Each player arms a position timer (every 50 ms, with a random phase) and a
+ * statistics timer (every second). A last timer blocks in its callback most
+ * of the time, as a network fetch would: it must not delay the other timers.
+ * The default is up to 1000 players, for 2 seconds each.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+
+#include <vlc_common.h>
+#include <vlc_rand.h>
+
+const char vlc_module_name[] = "bench_timer";
+
+#define POSITION_PERIOD VLC_TICK_FROM_MS(50)
+#define STATS_PERIOD    VLC_TICK_FROM_SEC(1)
+#define BLOCK_PERIOD    VLC_TICK_FROM_MS(250)
+
+struct bench_player
+{
+    vlc_timer_t position;
+    vlc_timer_t stats;
+};
+
+static atomic_ulong fired;
+
+static void Callback(void *data)
+{
+    (void) data;
+    atomic_fetch_add_explicit(&fired, 1, memory_order_relaxed);
+}
+
+static void BlockingCallback(void *data)
+{
+    (void) data;
+    vlc_tick_sleep(BLOCK_PERIOD - VLC_TICK_FROM_MS(50));
+}
+
+static long Switches(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru))
+        return 0;
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static void Bench(unsigned count, unsigned seconds)
+{
+    struct bench_player *players = malloc(count * sizeof (*players));
+    assert(players != NULL);
+
+    vlc_tick_t now = vlc_tick_now();
+    vlc_timer_t blocking;
+    int val = vlc_timer_create(&blocking, BlockingCallback, NULL);
+    assert(val == 0);
+    vlc_timer_schedule(blocking, false, 1, BLOCK_PERIOD);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct bench_player *p = &players[i];
+        vlc_tick_t phase = vlc_mrand48() % POSITION_PERIOD;
+
+        if (phase < 0)
+            phase = -phase;
+
+        int ret = vlc_timer_create(&p->position, Callback, p);
+        assert(ret == 0);
+        ret = vlc_timer_create(&p->stats, Callback, p);
+        assert(ret == 0);
+        vlc_timer_schedule(p->position, true, now + phase + 1,
+                           POSITION_PERIOD);
+        vlc_timer_schedule(p->stats, true, now + STATS_PERIOD, STATS_PERIOD);
+    }
+
+    atomic_store(&fired, 0);
+    long switches = Switches();
+    vlc_tick_t start = vlc_tick_now();
+
+    vlc_tick_sleep(VLC_TICK_FROM_SEC(seconds));
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    switches = Switches() - switches;
+    unsigned long calls = atomic_load(&fired);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        vlc_timer_destroy(players[i].position);
+        vlc_timer_destroy(players[i].stats);
+    }
+    vlc_timer_destroy(blocking);
+    free(players);
+
+    double secs = secf_from_vlc_tick(elapsed);
+    double expected = count * (CLOCK_FREQ / (double)POSITION_PERIOD
+                               + CLOCK_FREQ / (double)STATS_PERIOD);
+
+    printf("%6u players: %9.0f callbacks/s (%9.0f expected) "
+           "%9.0f context switches/s\n",
+           count, calls / secs, expected, switches / secs);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned max = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+    unsigned seconds = argc > 2 ? strtoul(argv[2], NULL, 10) : 2;
+
+    if (max == 0)
+        max = 1;
+    if (seconds == 0)
+        seconds = 1;
+
+    for (unsigned count = 1; count < max; count *= 10)
+        Bench(count, seconds);
+    Bench(max, seconds);
+    return 0;
+}
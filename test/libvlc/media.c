@@ -257,6 +257,15 @@ static void subitem_added(const libvlc_event_t *event, void *user_data)
 #undef FILE_SEPARATOR
 }
 
+static void subitems_progress(const libvlc_event_t *event, void *user_data)
+{
+    unsigned *count = user_data;
+
+    /* The count of subitems read only grows */
+    assert (event->u.media_subitems_progress.count > *count);
+    *count = event->u.media_subitems_progress.count;
+}
+
 static void test_media_subitems_media(libvlc_media_t *media, bool play,
                                       bool b_items_expected)
 {
@@ -264,6 +273,7 @@ static void test_media_subitems_media(libvlc_media_t *media, bool play,
     libvlc_media_add_option(media, ":no-sub-autodetect-file");
 
     bool subitems_found[ARRAY_SIZE(test_media_subitems_list)] = { 0 };
+    unsigned subitems_read = 0;
     vlc_sem_t sem;
     vlc_sem_init (&sem, 0);
 
@@ -286,6 +296,8 @@ static void test_media_subitems_media(libvlc_media_t *media, bool play,
     else
     {
         libvlc_event_attach (em, libvlc_MediaParsedChanged, subitem_parse_ended, &sem);
+        libvlc_event_attach (em, libvlc_MediaSubItemsProgress, subitems_progress,
+                             &subitems_read);
 
         int i_ret = libvlc_media_parse_with_options(media, libvlc_media_parse_local, -1);
         assert(i_ret == 0);
@@ -293,7 +305,14 @@ static void test_media_subitems_media(libvlc_media_t *media, bool play,
     }
 
     if (!b_items_expected)
+    {
+        assert (subitems_read == 0);
         return;
+    }
+
+    /* Every item was reported while parsing, nothing is matched as slave */
+    if (!play)
+        assert (subitems_read == ARRAY_SIZE(test_media_subitems_list));
 
     for (unsigned i = 0; i < ARRAY_SIZE(test_media_subitems_list); ++i)
     {
@@ -302,6 +321,36 @@ static void test_media_subitems_media(libvlc_media_t *media, bool play,
     }
 }
 
+/* Possible slaves (file.mp3) are held until the end, but counted */
+static void test_media_subitems_held(libvlc_instance_t *vlc)
+{
+    const char *subitems_path = SRCDIR"/samples/subitems";
+
+    test_log ("Testing media_subitems progress with slaves: path: '%s'\n",
+              subitems_path);
+
+    libvlc_media_t *media = libvlc_media_new_path (vlc, subitems_path);
+    assert (media != NULL);
+    libvlc_media_add_option(media, ":ignore-filetypes= ");
+    libvlc_media_add_option(media, ":sub-autodetect-file");
+
+    unsigned subitems_read = 0;
+    vlc_sem_t sem;
+    vlc_sem_init (&sem, 0);
+
+    libvlc_event_manager_t *em = libvlc_media_event_manager (media);
+    libvlc_event_attach (em, libvlc_MediaParsedChanged, subitem_parse_ended, &sem);
+    libvlc_event_attach (em, libvlc_MediaSubItemsProgress, subitems_progress,
+                         &subitems_read);
+
+    int i_ret = libvlc_media_parse_with_options(media, libvlc_media_parse_local, -1);
+    assert(i_ret == 0);
+    vlc_sem_wait (&sem);
+
+    assert (subitems_read == ARRAY_SIZE(test_media_subitems_list));
+    libvlc_media_release (media);
+}
+
 static void test_media_subitems(libvlc_instance_t *vlc)
 {
     const char *subitems_path = SRCDIR"/samples/subitems";
@@ -349,6 +398,8 @@ static void test_media_subitems(libvlc_instance_t *vlc)
     assert (media != NULL);
     test_media_subitems_media (media, false, false);
     libvlc_media_release (media);
+
+    test_media_subitems_held (vlc);
 }
 
 int main(int i_argc, char *ppsz_argv[])
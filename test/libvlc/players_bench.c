@@ -0,0 +1,268 @@
+/*****************************************************************************
+ * players_bench.c: concurrent media players benchmark
+ *****************************************************************************
+ * Copyright (C) 2023 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the CPU usage, the threads and the start latency of 1, 16 and 64
+ * media players playing concurrently in one process:
+ *
+ *   make -C test bench_libvlc_players
+ *   test/bench_libvlc_players [file or MRL] [VLC options]
+ *
+ * e.g. test/bench_libvlc_players movie.mkv --dec-threads-shared
+ *
+ * The default media is a generated H.264 and MPEG audio file, so that the
+ * players go through a threaded video decoder (avcodec), like real medias.
+ * Generating it requires an H.264 encoder: otherwise, pass a local file.
+ */
+
+#include "test.h"
+
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#undef vlc_tick_sleep
+
+#define BENCH_WINDOW VLC_TICK_FROM_SEC(3)
+
+/* Raw source of the default media, transcoded once */
+static const char bench_default_source[] =
+    "mock://video_track_count=1;audio_track_count=1;"
+    "video_width=640;video_height=360;length=10000000";
+
+static void on_sample_ended(const struct libvlc_event_t *event, void *data)
+{
+    (void) event;
+    vlc_sem_post(data);
+}
+
+/* Transcodes the default media to a local file, returns its path or NULL */
+static char *bench_generate_sample(libvlc_instance_t *vlc)
+{
+    char *path = strdup("/tmp/vlc-bench-players-XXXXXX");
+    assert(path != NULL);
+
+    int fd = mkstemp(path);
+    if (fd == -1)
+    {
+        free(path);
+        return NULL;
+    }
+    close(fd);
+
+    libvlc_media_t *md = libvlc_media_new_location(vlc, bench_default_source);
+    assert(md != NULL);
+
+    char *sout;
+    if (asprintf(&sout, ":sout=#transcode{vcodec=h264,acodec=mpga}:"
+                 "std{access=file,mux=mkv,dst=%s}", path) < 0)
+        abort();
+    libvlc_media_add_option(md, sout);
+    free(sout);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    vlc_sem_t ended;
+    vlc_sem_init(&ended, 0);
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    int ret = libvlc_event_attach(em, libvlc_MediaPlayerStopped,
+                                  on_sample_ended, &ended);
+    assert(ret == 0);
+    ret = libvlc_event_attach(em, libvlc_MediaPlayerEncounteredError,
+                              on_sample_ended, &ended);
+    assert(ret == 0);
+
+    libvlc_media_player_play(mp);
+    ret = vlc_sem_timedwait(&ended, vlc_tick_now() + VLC_TICK_FROM_SEC(60));
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+
+    struct stat st;
+    if (ret != 0 || stat(path, &st) != 0 || st.st_size == 0)
+    {
+        unlink(path);
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+struct bench_player
+{
+    libvlc_media_player_t *mp;
+    vlc_tick_t start;
+    atomic_llong latency; /* first time update after play, or 0 */
+};
+
+static void on_time_changed(const struct libvlc_event_t *event, void *data)
+{
+    struct bench_player *p = data;
+    long long expected = 0;
+
+    (void) event;
+    atomic_compare_exchange_strong(&p->latency, &expected,
+                                   vlc_tick_now() - p->start);
+}
+
+static vlc_tick_t cpu_time(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru))
+        return 0;
+    return vlc_tick_from_timeval(&ru.ru_utime)
+         + vlc_tick_from_timeval(&ru.ru_stime);
+}
+
+static unsigned thread_count(void)
+{
+    unsigned count = 0;
+#ifdef __linux__
+    FILE *stream = fopen("/proc/self/status", "r");
+    char line[256];
+
+    if (stream == NULL)
+        return 0;
+    while (fgets(line, sizeof (line), stream) != NULL)
+        if (sscanf(line, "Threads: %u", &count) == 1)
+            break;
+    fclose(stream);
+#endif
+    return count;
+}
+
+static void bench(libvlc_instance_t *vlc, const char *mrl, unsigned count)
+{
+    struct bench_player *players = calloc(count, sizeof (*players));
+    assert(players != NULL);
+
+    libvlc_media_t *md = strstr(mrl, "://") != NULL
+                       ? libvlc_media_new_location(vlc, mrl)
+                       : libvlc_media_new_path(vlc, mrl);
+    assert(md != NULL);
+    /* Keep playing short files during the measurement */
+    libvlc_media_add_option(md, ":input-repeat=65535");
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct bench_player *p = &players[i];
+
+        p->mp = libvlc_media_player_new_from_media(md);
+        assert(p->mp != NULL);
+        atomic_init(&p->latency, 0);
+
+        libvlc_event_manager_t *em = libvlc_media_player_event_manager(p->mp);
+        int ret = libvlc_event_attach(em, libvlc_MediaPlayerTimeChanged,
+                                      on_time_changed, p);
+        assert(ret == 0);
+    }
+    libvlc_media_release(md);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        players[i].start = vlc_tick_now();
+        libvlc_media_player_play(players[i].mp);
+    }
+
+    /* Wait for all the players to start, then let them settle */
+    vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_SEC(10);
+    for (unsigned i = 0; i < count; i++)
+        while (atomic_load(&players[i].latency) == 0
+            && vlc_tick_now() < deadline)
+            vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+    vlc_tick_sleep(VLC_TICK_FROM_SEC(1));
+
+    vlc_tick_t cpu = cpu_time();
+    vlc_tick_t start = vlc_tick_now();
+    vlc_tick_sleep(BENCH_WINDOW);
+    cpu = cpu_time() - cpu;
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    unsigned threads = thread_count();
+
+    vlc_tick_t latency_max = 0, latency_sum = 0;
+    unsigned started = 0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        vlc_tick_t latency = atomic_load(&players[i].latency);
+
+        if (latency == 0)
+            continue;
+        started++;
+        latency_sum += latency;
+        if (latency > latency_max)
+            latency_max = latency;
+    }
+
+    printf("%3u players: %3u started, %6.1f%% CPU, %4u threads, "
+           "start latency %4"PRId64" ms avg %4"PRId64" ms max\n",
+           count, started, 100. * cpu / elapsed, threads,
+           started ? MS_FROM_VLC_TICK(latency_sum / started) : 0,
+           MS_FROM_VLC_TICK(latency_max));
+
+    for (unsigned i = 0; i < count; i++)
+        libvlc_media_player_stop_async(players[i].mp);
+    for (unsigned i = 0; i < count; i++)
+        libvlc_media_player_release(players[i].mp);
+    free(players);
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned counts[] = { 1, 16, 64 };
+    const char *args[64] = {
+        "--quiet", "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+    };
+    int nargs = 4;
+
+    for (int i = 2; i < argc && nargs < (int)ARRAY_SIZE(args); i++)
+        args[nargs++] = argv[i];
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 0);
+
+    libvlc_instance_t *vlc = libvlc_new(nargs, args);
+    assert(vlc != NULL);
+
+    char *sample = NULL;
+    if (argc <= 1)
+    {
+        sample = bench_generate_sample(vlc);
+        if (sample == NULL)
+        {
+            fprintf(stderr, "cannot generate the H.264 sample, "
+                    "pass a local file instead\n");
+            libvlc_release(vlc);
+            return 77;
+        }
+    }
+    const char *mrl = sample != NULL ? sample : argv[1];
+
+    for (size_t i = 0; i < ARRAY_SIZE(counts); i++)
+        bench(vlc, mrl, counts[i]);
+
+    if (sample != NULL)
+    {
+        unlink(sample);
+        free(sample);
+    }
+    libvlc_release(vlc);
+    return 0;
+}
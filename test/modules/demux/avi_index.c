@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * avi_index.c: AVI demuxer chunk index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_codecs.h>
+
+#include "../../../modules/demux/avi/libavi.h"
+#include "../../../modules/demux/avi/index.h"
+
+#include "../../libvlc/test.h"
+
+#define GiB (UINT64_C(1) << 30)
+
+static void append(avi_index_t *idx, uint64_t *last_pos, uint64_t pos,
+                   uint32_t length, bool key)
+{
+    avi_entry_t entry = {
+        .i_flags = key ? AVIIF_KEYFRAME : 0,
+        .i_pos = pos,
+        .i_length = length,
+    };
+    avi_index_Append(idx, last_pos, &entry);
+}
+
+/* Checks every entry against the expected positions and lengths */
+static void check(const avi_index_t *idx, const uint64_t *pos,
+                  const uint32_t *length, const bool *key, uint32_t count)
+{
+    uint64_t total = 0;
+
+    assert(idx->i_size == count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        assert(avi_index_Pos(idx, i) == pos[i]);
+        assert(avi_index_Length(idx, i) == length[i]);
+        assert(avi_index_IsKeyframe(idx, i) == key[i]);
+        assert(avi_index_LengthTotal(idx, i) == total);
+        total += length[i];
+    }
+    assert(idx->i_lengthtotal == total);
+}
+
+/* Interleaved chunks, across several reallocations */
+static void test_dense(void)
+{
+    enum { COUNT = 40000 };
+    static uint64_t pos[COUNT];
+    static uint32_t length[COUNT];
+    static bool key[COUNT];
+    uint64_t last_pos = 0, p = 4096;
+
+    avi_index_t idx;
+    avi_index_Init(&idx);
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        pos[i] = p;
+        length[i] = 1000 + (i * 7919) % 5000;
+        key[i] = i % 25 == 0;
+        append(&idx, &last_pos, pos[i], length[i], key[i]);
+        p += 8 + length[i] + 3000; /* chunks of the other tracks */
+    }
+
+    check(&idx, pos, length, key, COUNT);
+    assert(idx.i_far == 0);
+    assert(last_pos == pos[COUNT - 1]);
+
+    /* Find returns the first entry at or after the position */
+    assert(avi_index_Find(&idx, 0) == 0);
+    for (uint32_t i = 0; i < COUNT; i += 97)
+    {
+        assert(avi_index_Find(&idx, pos[i]) == i);
+        assert(avi_index_Find(&idx, pos[i] - 1) == i);
+        assert(avi_index_Find(&idx, pos[i] + 1) == i + 1);
+    }
+    assert(avi_index_Find(&idx, pos[COUNT - 1] + 1) == COUNT);
+
+    avi_index_Clean(&idx);
+}
+
+/* Chunks too far from the first one of their block go to the side table */
+static void test_far(void)
+{
+    enum { COUNT = 3 * AVI_INDEX_BLOCK };
+    uint64_t pos[COUNT];
+    uint32_t length[COUNT];
+    bool key[COUNT];
+    uint64_t last_pos = 0;
+    uint32_t far = 0;
+
+    avi_index_t idx;
+    avi_index_Init(&idx);
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        /* A sparse track of a large file: one chunk every 200 MiB, in the
+         * first blocks, then close to each other */
+        if (i < 2 * AVI_INDEX_BLOCK)
+            pos[i] = 1024 + i * (UINT64_C(200) << 20);
+        else
+            pos[i] = pos[i - 1] + 4096;
+        length[i] = 100 + i;
+        key[i] = true;
+
+        uint64_t block_pos = pos[i - i % AVI_INDEX_BLOCK];
+        if (pos[i] - block_pos >= UINT32_MAX)
+            far++;
+        append(&idx, &last_pos, pos[i], length[i], key[i]);
+    }
+
+    check(&idx, pos, length, key, COUNT);
+    assert(far > 0 && far < 2 * AVI_INDEX_BLOCK);
+    assert(idx.i_far == far);
+    assert(pos[COUNT - 1] > 16 * GiB);
+    assert(last_pos == pos[COUNT - 1]);
+
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        assert(avi_index_Find(&idx, pos[i]) == i);
+        assert(avi_index_Find(&idx, pos[i] + 1) == i + 1);
+    }
+
+    avi_index_Clean(&idx);
+}
+
+/* Broken indexes: chunks before the first one of their block, and chunks
+ * too large for the keyframe flag */
+static void test_broken(void)
+{
+    uint64_t last_pos = 10 * GiB;
+
+    avi_index_t idx;
+    avi_index_Init(&idx);
+    append(&idx, &last_pos, 8 * GiB, 10, true);
+    append(&idx, &last_pos, 8 * GiB - 100, 20, false);
+    append(&idx, &last_pos, 8 * GiB + 100, 0x80000000, false);
+    append(&idx, &last_pos, 8 * GiB + 200, 30, false);
+    append(&idx, &last_pos, 100, 40, true);
+
+    const uint64_t pos[] = { 8 * GiB, 8 * GiB - 100, 8 * GiB + 200, 100 };
+    const uint32_t length[] = { 10, 20, 30, 40 };
+    const bool key[] = { true, false, false, true };
+    check(&idx, pos, length, key, ARRAY_SIZE(pos));
+    assert(idx.i_far == 2);
+    assert(idx.p_far[0].i_entry == 1 && idx.p_far[1].i_entry == 3);
+
+    /* The last chunk position only grows, even for skipped entries */
+    assert(last_pos == 10 * GiB);
+    append(&idx, &last_pos, 12 * GiB, 0x80000000, false);
+    assert(last_pos == 12 * GiB);
+    assert(idx.i_size == ARRAY_SIZE(pos));
+
+    avi_index_Clean(&idx);
+}
+
+int main(void)
+{
+    test_init();
+
+    test_dense();
+    test_far();
+    test_broken();
+    return 0;
+}
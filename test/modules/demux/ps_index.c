@@ -0,0 +1,303 @@
+/*****************************************************************************
+ * ps_index.c: test the MPEG-PS timestamps index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <string.h>
+#include <dirent.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+/* Two segments of packs, 40 ms each, with an SCR discontinuity between:
+ * the index timeline goes on across it */
+#define PACK_SIZE 2048
+#define PACK_DURATION VLC_TICK_FROM_MS(40)
+#define SEGMENT_PACKS 100
+#define SEGMENT_A_SCR 10 /* s */
+#define SEGMENT_B_SCR 100 /* s */
+#define LENGTH ((2 * SEGMENT_PACKS - 2) * PACK_DURATION)
+#define DISCONTINUITY_TIME ((SEGMENT_PACKS - 1) * PACK_DURATION)
+
+static int trash_Control(es_out_t *out, input_source_t *in, int query,
+                         va_list args)
+{
+    (void) out; (void) in; (void) query; (void) args;
+    return VLC_EGENERIC;
+}
+
+static int trash_Send(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    (void) out; (void) id;
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static es_out_id_t *trash_Add(es_out_t *out, input_source_t *in,
+                              const es_format_t *fmt)
+{
+    (void) out; (void) in; (void) fmt;
+    return NULL;
+}
+
+static void trash_Del(es_out_t *out, es_out_id_t *id)
+{
+    (void) out; (void) id;
+}
+
+static void trash_Delete(es_out_t *out)
+{
+    (void) out;
+}
+
+static const struct es_out_callbacks trash_cbs =
+{
+    trash_Add,
+    trash_Send,
+    trash_Del,
+    trash_Control,
+    trash_Delete,
+    NULL,
+};
+
+static void write_pack(FILE *file, uint64_t scr)
+{
+    uint8_t p[PACK_SIZE];
+    const unsigned mux_rate = PACK_SIZE * CLOCK_FREQ / PACK_DURATION / 50;
+
+    /* MPEG-2 pack header, without stuffing */
+    p[0] = 0x00; p[1] = 0x00; p[2] = 0x01; p[3] = 0xBA;
+    p[4] = 0x44 | ((scr >> 27) & 0x38) | ((scr >> 28) & 0x03);
+    p[5] = scr >> 20;
+    p[6] = 0x04 | ((scr >> 12) & 0xF8) | ((scr >> 13) & 0x03);
+    p[7] = scr >> 5;
+    p[8] = 0x04 | ((scr << 3) & 0xF8);
+    p[9] = 0x01;
+    p[10] = mux_rate >> 14;
+    p[11] = mux_rate >> 6;
+    p[12] = ((mux_rate << 2) & 0xFC) | 0x03;
+    p[13] = 0xF8;
+
+    /* Padding packet up to the pack size */
+    const size_t padding = PACK_SIZE - 14 - 6;
+    p[14] = 0x00; p[15] = 0x00; p[16] = 0x01; p[17] = 0xBE;
+    p[18] = padding >> 8;
+    p[19] = padding & 0xFF;
+    memset(&p[20], 0xFF, padding);
+
+    assert(fwrite(p, 1, PACK_SIZE, file) == PACK_SIZE);
+}
+
+static void write_stream(const char *path)
+{
+    FILE *file = vlc_fopen(path, "wb");
+    assert(file != NULL);
+
+    for (unsigned i = 0; i < SEGMENT_PACKS; i++)
+        write_pack(file, SEGMENT_A_SCR * 90000 + i * 3600);
+    for (unsigned i = 0; i < SEGMENT_PACKS; i++)
+        write_pack(file, SEGMENT_B_SCR * 90000 + i * 3600);
+    assert(fclose(file) == 0);
+}
+
+static size_t read_file(const char *path, uint8_t *buf, size_t size)
+{
+    FILE *file = vlc_fopen(path, "rb");
+    assert(file != NULL);
+    size_t read = fread(buf, 1, size, file);
+    assert(read < size);
+    fclose(file);
+    return read;
+}
+
+static demux_t *open_demux(libvlc_instance_t *vlc, const char *url,
+                           es_out_t *out)
+{
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    stream_t *s = vlc_stream_NewURL(obj, url);
+    assert(s != NULL);
+    demux_t *demux = demux_New(obj, "ps", url, s, out); /* owns the stream */
+    assert(demux != NULL);
+    return demux;
+}
+
+/* Waits for the background scan to complete the index */
+static void wait_index(demux_t *demux)
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_tick_t length = VLC_TICK_INVALID;
+    const vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_SEC(5);
+
+    vlc_mutex_init(&lock);
+    vlc_cond_init(&wait);
+    vlc_mutex_lock(&lock);
+    while (demux_Control(demux, DEMUX_GET_LENGTH, &length) != VLC_SUCCESS
+        || length != LENGTH)
+        if (vlc_cond_timedwait(&wait, &lock,
+                               vlc_tick_now() + VLC_TICK_FROM_MS(10))
+         && vlc_tick_now() > deadline)
+            break;
+    vlc_mutex_unlock(&lock);
+    assert(length == LENGTH);
+}
+
+static vlc_tick_t get_time(demux_t *demux)
+{
+    vlc_tick_t time;
+    int ret = demux_Control(demux, DEMUX_GET_TIME, &time);
+    assert(ret == VLC_SUCCESS);
+    return time;
+}
+
+/* Seeks, then reads the next pack header */
+static vlc_tick_t set_time(demux_t *demux, vlc_tick_t time)
+{
+    int ret = demux_Control(demux, DEMUX_SET_TIME, time, false);
+    assert(ret == VLC_SUCCESS);
+    ret = demux_Demux(demux);
+    assert(ret == VLC_DEMUXER_SUCCESS);
+    return get_time(demux);
+}
+
+static void test_timeline(demux_t *demux)
+{
+    /* GET_TIME goes on across the SCR discontinuity: at each pack header,
+     * it is the time of the pack on the index timeline */
+    unsigned packs = 0;
+    int ret;
+
+    while ((ret = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
+    {
+        uint64_t pos = vlc_stream_Tell(demux->s);
+        if (pos % PACK_SIZE != 14)
+            continue;
+
+        unsigned pack = pos / PACK_SIZE;
+        vlc_tick_t expected = pack < SEGMENT_PACKS ? pack * PACK_DURATION
+                            : (pack - 1) * PACK_DURATION;
+        assert(pack == packs);
+        assert(get_time(demux) == expected);
+        packs++;
+    }
+    assert(ret == VLC_DEMUXER_EOF);
+    assert(packs == 2 * SEGMENT_PACKS);
+
+    /* SET_TIME lands on the indexed pack at or before the time */
+    vlc_tick_t time = set_time(demux, VLC_TICK_FROM_SEC(2));
+    assert(time <= VLC_TICK_FROM_SEC(2));
+    assert(time > VLC_TICK_FROM_MS(1500));
+
+    time = set_time(demux, VLC_TICK_FROM_SEC(6));
+    assert(time <= VLC_TICK_FROM_SEC(6));
+    assert(time > VLC_TICK_FROM_MS(5500));
+
+    /* The first pack after the discontinuity is indexed */
+    time = set_time(demux, DISCONTINUITY_TIME + PACK_DURATION / 2);
+    assert(time == DISCONTINUITY_TIME);
+
+    time = set_time(demux, 0);
+    assert(time == 0);
+}
+
+int main(void)
+{
+    test_init();
+
+    static const char *argv[] = {
+        "-v",
+        "--ignore-config",
+        "-Idummy",
+        "--no-media-library",
+        "--ps-index",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    char dir[] = "/tmp/vlc-ps-index.XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+
+    char *path, *index_path;
+    assert(asprintf(&path, "%s/stream.mpg", dir) != -1);
+    assert(asprintf(&index_path, "%s.psidx", path) != -1);
+    char *url = vlc_path2uri(path, NULL);
+    assert(url != NULL);
+    write_stream(path);
+
+    es_out_t out = { .cbs = &trash_cbs };
+
+    /* Scanned, then saved */
+    demux_t *demux = open_demux(vlc, url, &out);
+    wait_index(demux);
+    test_timeline(demux);
+    demux_Delete(demux);
+
+    static uint8_t saved[1 << 16], index[1 << 16];
+    const size_t saved_size = read_file(index_path, saved, sizeof (saved));
+    assert(saved_size > 28 + 2 * 24);
+    assert((saved_size - 28) % 24 == 0);
+
+    /* Loaded */
+    demux = open_demux(vlc, url, &out);
+    wait_index(demux);
+    test_timeline(demux);
+    demux_Delete(demux);
+
+    /* Rejected, as its times do not increase, then scanned and saved
+     * again */
+    memcpy(index, saved, saved_size);
+    memcpy(&index[28 + 24], &saved[28 + 2 * 24], 8);
+    memcpy(&index[28 + 2 * 24], &saved[28 + 24], 8);
+    FILE *file = vlc_fopen(index_path, "wb");
+    assert(file != NULL);
+    assert(fwrite(index, 1, saved_size, file) == saved_size);
+    assert(fclose(file) == 0);
+
+    demux = open_demux(vlc, url, &out);
+    wait_index(demux);
+    test_timeline(demux);
+    demux_Delete(demux);
+
+    assert(read_file(index_path, index, sizeof (index)) == saved_size);
+    assert(memcmp(index, saved, saved_size) == 0);
+
+    /* No temporary file is left behind */
+    DIR *d = opendir(dir);
+    assert(d != NULL);
+    unsigned count = 0;
+    for (struct dirent *ent = readdir(d); ent != NULL; ent = readdir(d))
+        if (ent->d_name[0] != '.')
+            count++;
+    closedir(d);
+    assert(count == 2);
+
+    vlc_unlink(index_path);
+    vlc_unlink(path);
+    rmdir(dir);
+    free(url);
+    free(index_path);
+    free(path);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*****************************************************************************
+ * bench.c: packetizer scanners benchmark
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the startcode and emulation prevention scanners throughput:
+ *
+ *   make -C test bench_modules_packetizer && test/bench_modules_packetizer [MiB]
+ *
+ * The default is to scan 256 MiB per scanner and bitstream.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+#define BUFFER_SIZE (1 << 20)
+
+typedef const uint8_t *(*finder_t)(const uint8_t *, const uint8_t *);
+
+static const struct
+{
+    const char *psz_name;
+    finder_t pf_find;
+} finders[] = {
+    { "bits", startcode_FindAnnexB_Bits },
+#ifdef CAN_COMPILE_SSE2
+    { "sse2", startcode_FindAnnexB_SSE2 },
+#endif
+#if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+    { "avx2", startcode_FindAnnexB_AVX2 },
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    { "neon", startcode_FindAnnexB_NEON },
+#endif
+};
+
+static bool FinderAvailable(finder_t pf_find)
+{
+#if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+    if (pf_find == startcode_FindAnnexB_AVX2)
+        return vlc_CPU_AVX2();
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (pf_find == startcode_FindAnnexB_SSE2)
+        return vlc_CPU_SSE2();
+#endif
+    (void) pf_find;
+    return true;
+}
+
+/* Slice payload: random bytes, escaped as an encoder would, with a
+ * startcode every nal_size bytes */
+static void FillTypical(uint8_t *p, size_t size, size_t nal_size,
+                        unsigned short seed[3])
+{
+    unsigned zeros = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (i % nal_size == 0 && i + 4 <= size)
+        {
+            memcpy(&p[i], "\x00\x00\x01\x65", 4);
+            i += 3;
+            zeros = 0;
+            continue;
+        }
+        uint8_t byte = nrand48(seed);
+        if (zeros >= 2 && byte <= 3)
+            byte = 3;
+        zeros = byte ? 0 : zeros + 1;
+        p[i] = byte;
+    }
+}
+
+static void FillPattern(uint8_t *p, size_t size, const uint8_t *pattern,
+                        size_t pattern_size)
+{
+    for (size_t i = 0; i < size; i++)
+        p[i] = pattern[i % pattern_size];
+}
+
+static void BenchFinders(const char *name, const uint8_t *p, size_t size,
+                         size_t total)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(finders); i++)
+    {
+        if (!FinderAvailable(finders[i].pf_find))
+            continue;
+
+        size_t found = 0;
+        vlc_tick_t start = vlc_tick_now();
+        for (size_t done = 0; done < total; done += size)
+        {
+            const uint8_t *end = p + size;
+            for (const uint8_t *s = p;
+                 (s = finders[i].pf_find(s, end)) != NULL; s += 3)
+                found++;
+        }
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        printf("startcode %-12s %-4s %8.1f MiB/s (%zu found)\n",
+               name, finders[i].psz_name,
+               (double) total / 1048576 * CLOCK_FREQ / (elapsed ? elapsed : 1),
+               found);
+    }
+}
+
+static void BenchEP3B(const char *name, uint8_t *p, size_t size, size_t total,
+                      size_t count)
+{
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t done = 0; done < total; done += size)
+    {
+        unsigned prev = 0;
+        for (uint8_t *s = p; s < p + size; )
+            s = hxxx_ep3b_to_rbsp(s, p + size, &prev, count);
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("ep3b      %-12s by %-4zu %8.1f MiB/s\n", name, count,
+           (double) total / 1048576 * CLOCK_FREQ / (elapsed ? elapsed : 1));
+}
+
+int main(int argc, char *argv[])
+{
+    size_t total = (argc > 1 ? strtoul(argv[1], NULL, 10) : 256) << 20;
+    uint8_t *p = malloc(BUFFER_SIZE);
+    assert(p);
+
+    unsigned short seed[3] = { 0x1234, 0x5678, 0x9abc };
+    static const uint8_t zeros[1] = { 0x00 };
+    static const uint8_t escapes[3] = { 0x00, 0x00, 0x03 };
+    static const uint8_t startcodes[3] = { 0x00, 0x00, 0x01 };
+    static const uint8_t nearmiss[4] = { 0x00, 0x00, 0x02, 0x80 };
+
+    const struct
+    {
+        const char *name;
+        size_t nal_size;
+        const uint8_t *pattern;
+        size_t pattern_size;
+    } streams[] = {
+        { "intra",      1 << 18, NULL, 0 },
+        { "inter",      1 << 11, NULL, 0 },
+        { "zeros",      0, zeros, sizeof(zeros) },
+        { "escapes",    0, escapes, sizeof(escapes) },
+        { "startcodes", 0, startcodes, sizeof(startcodes) },
+        { "nearmiss",   0, nearmiss, sizeof(nearmiss) },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(streams); i++)
+    {
+        if (streams[i].pattern)
+            FillPattern(p, BUFFER_SIZE, streams[i].pattern,
+                        streams[i].pattern_size);
+        else
+            FillTypical(p, BUFFER_SIZE, streams[i].nal_size, seed);
+
+        BenchFinders(streams[i].name, p, BUFFER_SIZE, total);
+        BenchEP3B(streams[i].name, p, BUFFER_SIZE, total / 4, 1);
+        BenchEP3B(streams[i].name, p, BUFFER_SIZE, total, 4096);
+    }
+
+    free(p);
+    return 0;
+}
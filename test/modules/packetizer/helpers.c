@@ -30,6 +30,7 @@
 #include <vlc_block_helper.h>
 
 #include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
 
 struct results_s
 {
@@ -64,28 +65,145 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
+struct finder_s
+{
+    const char *psz_name;
+    const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *);
+};
+
+static const struct finder_s finders[] = {
+    { "bits", startcode_FindAnnexB_Bits },
+#ifdef CAN_COMPILE_SSE2
+    { "sse2", startcode_FindAnnexB_SSE2 },
+#endif
+#if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+    { "avx2", startcode_FindAnnexB_AVX2 },
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    { "neon", startcode_FindAnnexB_NEON },
+#endif
+};
+
+static bool finder_available( const struct finder_s *p_finder )
+{
+#if defined(HAVE_AVX2_INTRINSICS) && defined(CAN_COMPILE_AVX2)
+    if( p_finder->pf_find == startcode_FindAnnexB_AVX2 )
+        return vlc_CPU_AVX2();
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if( p_finder->pf_find == startcode_FindAnnexB_SSE2 )
+        return vlc_CPU_SSE2();
+#endif
+    (void) p_finder;
+    return true;
+}
+
 static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
                             const struct results_s *p_results, size_t i_results,
                             ssize_t i_results_offset )
 {
-    int i_ret;
-
-    printf("checking bits code:\n");
-    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                       startcode_FindAnnexB_Bits );
-    if( i_ret != 0 )
-        return i_ret;
-
-    /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
     {
-        printf("checking asm:\n");
-        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+        if( !finder_available( &finders[i] ) )
+        {
+            printf("%s not supported, skipping test\n", finders[i].psz_name);
+            continue;
+        }
+        printf("checking %s code:\n", finders[i].psz_name);
+        int i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                               finders[i].pf_find );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
+
+    return 0;
+}
+
+/* Compares all the implementations over every start and end offsets of
+ * a buffer full of zeroes and startcodes */
+static int run_annexb_random( void )
+{
+    uint8_t data[256];
+    unsigned short seed[3] = { 0x1234, 0x5678, 0x9abc };
+
+    for( unsigned i_run = 0; i_run < 16; i_run++ )
+    {
+        for( size_t i = 0; i < sizeof(data); i++ )
+        {
+            long r = nrand48( seed ) % 8;
+            data[i] = r < 5 ? 0 : r - 5; /* 0, 1 or 2 */
+        }
+
+        for( size_t i_start = 0; i_start < 48; i_start++ )
+        for( size_t i_end = sizeof(data) - 48; i_end <= sizeof(data); i_end++ )
+        {
+            const uint8_t *p_end = &data[i_end];
+            const uint8_t *p_ref = startcode_FindAnnexB_Bits( &data[i_start], p_end );
+            for( size_t i = 1; i < ARRAY_SIZE(finders); i++ )
+            {
+                if( finder_available( &finders[i] ) &&
+                    finders[i].pf_find( &data[i_start], p_end ) != p_ref )
+                {
+                    printf("%s mismatch run %u from %zu to %zu\n",
+                           finders[i].psz_name, i_run, i_start, i_end);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Reference implementation, forwarding byte per byte */
+static uint8_t *ep3b_to_rbsp_ref( uint8_t *p, uint8_t *end, unsigned *pi_prev,
+                                  size_t i_count )
+{
+    for( size_t i=0; i<i_count; i++ )
+    {
+        if( ++p >= end )
+            return p;
+
+        *pi_prev = (*pi_prev << 1) | (!*p);
+
+        if( *p == 0x03 && ( p + 1 ) != end && (*pi_prev & 0x06) == 0x06 )
+        {
+            ++p;
+            *pi_prev = !*p;
+        }
+    }
+    return p;
+}
+
+static int run_ep3b( void )
+{
+    uint8_t data[1024];
+    unsigned short seed[3] = { 0x4321, 0x8765, 0xcba9 };
+
+    for( unsigned i_run = 0; i_run < 64; i_run++ )
+    {
+        /* from dense escapes to mostly payload */
+        const long i_sparse = 4 + i_run * 8;
+        for( size_t i = 0; i < sizeof(data); i++ )
+        {
+            long r = nrand48( seed ) % i_sparse;
+            data[i] = r < 2 ? 0 : r == 2 ? 3 : 0x42;
+        }
+
+        uint8_t *p_ref = data, *p = data;
+        unsigned i_prev_ref = 0, i_prev = 0;
+        while( p < data + sizeof(data) )
+        {
+            size_t i_count = 1 + nrand48( seed ) % 100;
+            p_ref = ep3b_to_rbsp_ref( p_ref, data + sizeof(data), &i_prev_ref, i_count );
+            p = hxxx_ep3b_to_rbsp( p, data + sizeof(data), &i_prev, i_count );
+            if( p != p_ref || (i_prev & 0x03) != (i_prev_ref & 0x03) )
+            {
+                printf("ep3b mismatch run %u at %td\n", i_run, p_ref - data);
+                return 1;
+            }
+        }
+    }
 
     return 0;
 }
@@ -134,5 +252,11 @@ int main( void )
             return i_ret;
     }
 
-    return 0;
+    printf("* Running tests on random sets:\n");
+    i_ret = run_annexb_random();
+    if( i_ret != 0 )
+        return i_ret;
+
+    printf("* Running emulation prevention tests:\n");
+    return run_ep3b();
 }
@@ -130,6 +130,9 @@ int main(void)
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
     params.b_extra = true;
+    params.b_readonly = false;
+    uint32_t checksum = 0;
+    params.p_checksum = &checksum;
 
     params.i_read_size = 500;
     RUN("block 500", test_packetize,
@@ -141,6 +144,16 @@ int main(void)
     RUN("block 8", test_packetize,
         test_samples_raw_h265, test_samples_raw_h265_len, 0);
 
+    params.i_read_size = 0;
+    RUN("block per NAL", test_packetize,
+        test_samples_raw_h265, test_samples_raw_h265_len, 0);
+
+    params.b_readonly = true;
+    RUN("read-only block per NAL", test_packetize,
+        test_samples_raw_h265, test_samples_raw_h265_len, 0);
+    params.b_readonly = false;
+
+    params.p_checksum = NULL;
     params.i_frame_count = 1*25 + 4 /* RASL from previous GOP */;
     params.i_read_size = 500;
     RUN("skip 1st Iframe", test_packetize,
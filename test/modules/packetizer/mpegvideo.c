@@ -159,6 +159,8 @@ int main(void)
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
     params.b_extra = false;
+    params.b_readonly = false;
+    params.p_checksum = NULL;
 
     params.i_read_size = 500;
     RUN("block 500", test_packetize,
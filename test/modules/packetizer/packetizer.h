@@ -24,6 +24,10 @@
 #include <vlc_codec.h>
 #include <vlc_meta.h>
 
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
 enum
 {
     OK = VLC_SUCCESS,
@@ -37,9 +41,11 @@ struct params_s
     vlc_fourcc_t codec;
     unsigned i_rate_num;
     unsigned i_rate_den;
-    unsigned i_read_size;
+    unsigned i_read_size; /* 0 to read one NAL per block */
+    bool b_readonly; /* with one NAL per block, map the blocks read-only */
     unsigned i_frame_count;
     bool b_extra;
+    uint32_t *p_checksum; /* output data checksum to compare runs, or NULL */
 };
 
 #define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
@@ -83,6 +89,80 @@ static decoder_t *create_packetizer(libvlc_instance_t *vlc,
     return p_pack;
 }
 
+/* Size of the data up to the next AnnexB startcode, including its
+ * leading zero byte if any */
+static size_t next_nal_size(const uint8_t *p_data, size_t i_data)
+{
+    for(size_t i = 1; i + 3 <= i_data; i++)
+    {
+        if(p_data[i] == 0 && p_data[i + 1] == 0 && p_data[i + 2] == 1)
+            return (p_data[i - 1] == 0 && i > 1) ? i - 1 : i;
+    }
+    return i_data;
+}
+
+#ifdef HAVE_MMAP
+static void readonly_block_Release(block_t *p_block)
+{
+    munmap(p_block->p_start, p_block->i_size);
+    free(p_block);
+}
+
+static const struct vlc_block_callbacks readonly_block_cbs =
+{
+    readonly_block_Release,
+    false,
+};
+
+/* Block with read-only data and spare room, writing there must fault */
+static block_t *readonly_block_New(const uint8_t *p_data, size_t i_data)
+{
+    const size_t i_room = 64;
+    const size_t i_size = i_room + i_data + i_room;
+    uint8_t *p_map = mmap(NULL, i_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p_map == MAP_FAILED)
+        return NULL;
+    memcpy(p_map + i_room, p_data, i_data);
+    block_t *p_block = malloc(sizeof(*p_block));
+    if(p_block == NULL || mprotect(p_map, i_size, PROT_READ))
+    {
+        free(p_block);
+        munmap(p_map, i_size);
+        return NULL;
+    }
+    block_Init(p_block, &readonly_block_cbs, p_map, i_size);
+    p_block->p_buffer += i_room;
+    p_block->i_buffer = i_data;
+    return p_block;
+}
+#endif
+
+static block_t *read_block(stream_t *s, const uint8_t **pp_data, size_t *pi_data,
+                           const struct params_s *params)
+{
+    if(params->i_read_size)
+        return vlc_stream_Block(s, params->i_read_size);
+
+    size_t i_size = next_nal_size(*pp_data, *pi_data);
+    if(i_size == 0)
+        return NULL;
+    block_t *p_block;
+#ifdef HAVE_MMAP
+    if(params->b_readonly)
+        p_block = readonly_block_New(*pp_data, i_size);
+    else
+#endif
+    {
+        p_block = block_Alloc(i_size);
+        if(p_block)
+            memcpy(p_block->p_buffer, *pp_data, i_size);
+    }
+    *pp_data += i_size;
+    *pi_data -= i_size;
+    return p_block;
+}
+
 static int test_packetize(const char *run,
                           const uint8_t *p_data, size_t i_data,
                           const struct params_s *params)
@@ -100,9 +180,12 @@ static int test_packetize(const char *run,
     block_t **outappend = &outchain;
     block_t *p_block;
     unsigned i_count = 0;
+    uint32_t i_checksum = 2166136261;
+    const uint8_t *p_read = p_data;
+    size_t i_read = i_data;
     do
     {
-        p_block = vlc_stream_Block(s, params->i_read_size);
+        p_block = read_block(s, &p_read, &i_read, params);
         block_t *in = p_block;
         if(in && outchain == NULL)
             in->i_dts = VLC_TICK_0;
@@ -116,6 +199,8 @@ static int test_packetize(const char *run,
                                 " flags %x sz %"PRId64"\n",
                         i_count, out->i_dts, out->i_buffer,
                         out->i_flags, out->i_buffer );
+                for(size_t i = 0; i < out->i_buffer; i++)
+                    i_checksum = (i_checksum ^ out->p_buffer[i]) * 16777619;
                 block_ChainLastAppend(&outappend, out);
                 ++i_count;
             }
@@ -124,6 +209,13 @@ static int test_packetize(const char *run,
 
     EXPECT(i_count == params->i_frame_count);
 
+    if(params->p_checksum)
+    {
+        if(*params->p_checksum == 0)
+            *params->p_checksum = i_checksum;
+        EXPECT(*params->p_checksum == i_checksum);
+    }
+
     if(params->i_rate_num && params->i_rate_den)
     {
         EXPECT(p->fmt_out.video.i_frame_rate == params->i_rate_num);
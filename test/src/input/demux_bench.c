@@ -0,0 +1,1328 @@
+/*****************************************************************************
+ * demux_bench.c: demux, packetizer and decoder throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2023 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs inputs through the demuxer, the packetizers and optionally the
+ * decoders from memory, synchronously, and reports the throughput, the
+ * number of allocations and the CPU time spent in each module:
+ *
+ *   make -C test bench_src_input_demux
+ *   test/bench_src_input_demux [-j] [-d] [-s seed] [-t seconds] [files...]
+ *
+ * Without files, the same MPEG audio stream, generated from the seed, is
+ * muxed in TS, MP4, MKV, AVI and as an elementary stream. The demuxers
+ * that are not built are skipped.
+ *
+ *   -j  print the results as JSON
+ *   -d  also decode, with the first decoder found for each ES
+ *   -s  seed of the synthetic payload (default 1)
+ *   -t  length of the synthetic streams in seconds (default 600)
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_memstream.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+/*****************************************************************************
+ * Allocations counter
+ *****************************************************************************/
+#ifdef __GLIBC__
+# define HAVE_ALLOCATION_COUNT 1
+
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void *__libc_memalign(size_t, size_t);
+
+/* Overrides the C library allocator for the whole process, plugins included */
+static atomic_ullong allocations;
+
+static void CountAllocation(void)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+}
+
+VLC_EXPORT
+void *malloc(size_t size)
+{
+    CountAllocation();
+    return __libc_malloc(size);
+}
+
+VLC_EXPORT
+void *calloc(size_t n, size_t size)
+{
+    CountAllocation();
+    return __libc_calloc(n, size);
+}
+
+VLC_EXPORT
+void *realloc(void *ptr, size_t size)
+{
+    CountAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+VLC_EXPORT
+void *aligned_alloc(size_t align, size_t size)
+{
+    CountAllocation();
+    return __libc_memalign(align, size);
+}
+
+VLC_EXPORT
+int posix_memalign(void **pp, size_t align, size_t size)
+{
+    if (align < sizeof (void *) || (align & (align - 1)))
+        return EINVAL;
+
+    CountAllocation();
+    void *ptr = __libc_memalign(align, size);
+    if (ptr == NULL)
+        return ENOMEM;
+    *pp = ptr;
+    return 0;
+}
+
+static unsigned long long GetAllocations(void)
+{
+    return atomic_load_explicit(&allocations, memory_order_relaxed);
+}
+#else
+static unsigned long long GetAllocations(void)
+{
+    return 0;
+}
+#endif
+
+static vlc_tick_t ThreadTime(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return 0;
+    return vlc_tick_from_timespec(&ts);
+}
+
+/*****************************************************************************
+ * Results
+ *****************************************************************************/
+#define MAX_MODULES 16
+
+struct bench_module
+{
+    const char *type;
+    const char *name;
+    vlc_tick_t time;
+};
+
+struct bench_result
+{
+    const char *input;
+    const char *demux;
+    size_t bytes;
+    vlc_tick_t elapsed;
+    uint64_t packets; /* blocks sent by the demuxer */
+    uint64_t frames; /* blocks output by the packetizers */
+    unsigned long long allocations;
+    struct bench_module modules[MAX_MODULES];
+    size_t module_count;
+};
+
+static void AccountTime(struct bench_result *res, const char *type,
+                        const char *name, vlc_tick_t time)
+{
+    for (size_t i = 0; i < res->module_count; i++)
+        if (!strcmp(res->modules[i].type, type)
+         && !strcmp(res->modules[i].name, name))
+        {
+            res->modules[i].time += time;
+            return;
+        }
+
+    if (res->module_count < MAX_MODULES)
+        res->modules[res->module_count++] = (struct bench_module) {
+            .type = type, .name = name, .time = time,
+        };
+}
+
+/*****************************************************************************
+ * ES output: packetizes and optionally decodes synchronously
+ *****************************************************************************/
+struct bench_es_out
+{
+    es_out_t out;
+    vlc_object_t *parent;
+    bool decode;
+    struct bench_result *res;
+};
+
+struct es_out_id_t
+{
+    decoder_t *packetizer;
+    decoder_t *decoder;
+};
+
+static vlc_decoder_device *GetNoDevice(decoder_t *dec)
+{
+    (void) dec;
+    return NULL;
+}
+
+static int UpdateVideoFormat(decoder_t *dec, vlc_video_context *vctx)
+{
+    (void) dec; (void) vctx;
+    return 0;
+}
+
+static picture_t *NewPicture(decoder_t *dec)
+{
+    return picture_NewFromFormat(&dec->fmt_out.video);
+}
+
+static void QueueVideo(decoder_t *dec, picture_t *pic)
+{
+    (void) dec;
+    picture_Release(pic);
+}
+
+static void QueueCc(decoder_t *dec, block_t *block,
+                    const decoder_cc_desc_t *desc)
+{
+    (void) dec; (void) desc;
+    block_Release(block);
+}
+
+static int UpdateAudioFormat(decoder_t *dec)
+{
+    (void) dec;
+    return 0;
+}
+
+static void QueueAudio(decoder_t *dec, block_t *block)
+{
+    (void) dec;
+    block_Release(block);
+}
+
+static subpicture_t *NewSubpicture(decoder_t *dec,
+                                   const subpicture_updater_t *updater)
+{
+    (void) dec;
+    return subpicture_New(updater);
+}
+
+static void QueueSub(decoder_t *dec, subpicture_t *subpic)
+{
+    (void) dec;
+    subpicture_Delete(subpic);
+}
+
+static const struct decoder_owner_callbacks dec_cbs[ES_CATEGORY_COUNT] =
+{
+    [VIDEO_ES] = {
+        .video = {
+            .get_device = GetNoDevice,
+            .format_update = UpdateVideoFormat,
+            .buffer_new = NewPicture,
+            .queue = QueueVideo,
+            .queue_cc = QueueCc,
+        },
+    },
+    [AUDIO_ES] = {
+        .audio = {
+            .format_update = UpdateAudioFormat,
+            .queue = QueueAudio,
+        },
+    },
+    [SPU_ES] = {
+        .spu = {
+            .buffer_new = NewSubpicture,
+            .queue = QueueSub,
+        },
+    },
+};
+
+static decoder_t *DecoderNew(vlc_object_t *parent, const es_format_t *fmt,
+                             const char *capability)
+{
+    decoder_t *dec = vlc_object_create(parent, sizeof (*dec));
+    if (dec == NULL)
+        return NULL;
+
+    decoder_Init(dec, fmt);
+    dec->b_frame_drop_allowed = true;
+    dec->cbs = &dec_cbs[fmt->i_cat];
+    dec->p_module = module_need(dec, capability, NULL, false);
+    if (dec->p_module == NULL)
+    {
+        decoder_Clean(dec);
+        vlc_object_delete(dec);
+        return NULL;
+    }
+    return dec;
+}
+
+static void Decode(struct bench_es_out *ctx, es_out_id_t *id, block_t *block)
+{
+    if (id->decoder == NULL)
+    {
+        if (block != NULL)
+            block_Release(block);
+        return;
+    }
+
+    vlc_tick_t start = ThreadTime();
+    id->decoder->pf_decode(id->decoder, block);
+    AccountTime(ctx->res, "decoder",
+                module_get_object(id->decoder->p_module),
+                ThreadTime() - start);
+}
+
+static void Packetize(struct bench_es_out *ctx, es_out_id_t *id,
+                      block_t *block)
+{
+    block_t **pp_block = block != NULL ? &block : NULL;
+
+    for (;;)
+    {
+        vlc_tick_t start = ThreadTime();
+        block_t *out = id->packetizer->pf_packetize(id->packetizer, pp_block);
+        AccountTime(ctx->res, "packetizer",
+                    module_get_object(id->packetizer->p_module),
+                    ThreadTime() - start);
+        if (out == NULL)
+            break;
+
+        while (out != NULL)
+        {
+            block_t *next = out->p_next;
+
+            out->p_next = NULL;
+            ctx->res->frames++;
+            Decode(ctx, id, out);
+            out = next;
+        }
+    }
+
+    if (pp_block == NULL) /* Drain */
+        Decode(ctx, id, NULL);
+}
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    struct bench_es_out *ctx = container_of(out, struct bench_es_out, out);
+    (void) in;
+
+    if (fmt->i_cat != VIDEO_ES && fmt->i_cat != AUDIO_ES
+     && fmt->i_cat != SPU_ES)
+        return NULL;
+
+    es_out_id_t *id = malloc(sizeof (*id));
+    if (unlikely(id == NULL))
+        return NULL;
+
+    id->decoder = NULL;
+    id->packetizer = DecoderNew(ctx->parent, fmt, "packetizer");
+    if (id->packetizer == NULL)
+    {
+        free(id);
+        return NULL;
+    }
+
+    if (ctx->decode)
+    {
+        static const char caps[ES_CATEGORY_COUNT][16] = {
+            [VIDEO_ES] = "video decoder",
+            [AUDIO_ES] = "audio decoder",
+            [SPU_ES] = "spu decoder",
+        };
+        id->decoder = DecoderNew(ctx->parent, &id->packetizer->fmt_out,
+                                 caps[fmt->i_cat]);
+    }
+    return id;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct bench_es_out *ctx = container_of(out, struct bench_es_out, out);
+
+    ctx->res->packets++;
+    Packetize(ctx, id, block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    struct bench_es_out *ctx = container_of(out, struct bench_es_out, out);
+
+    Packetize(ctx, id, NULL);
+    if (id->decoder != NULL)
+        decoder_Destroy(id->decoder);
+    decoder_Destroy(id->packetizer);
+    free(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    (void) out; (void) in;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+            return VLC_EGENERIC;
+        default:
+            return VLC_SUCCESS;
+    }
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    (void) out;
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/*****************************************************************************
+ * Synthetic inputs
+ *****************************************************************************/
+/* MPEG-1 audio layer II, 48 kHz, 192 kbit/s, stereo */
+#define MPGA_FRAME_SIZE 576
+#define MPGA_FRAME_SAMPLES 1152
+#define MPGA_RATE 48000
+#define MPGA_CHANNELS 2
+#define MPGA_BITRATE 192000
+#define MPGA_FRAME_LENGTH vlc_tick_from_samples(MPGA_FRAME_SAMPLES, MPGA_RATE)
+
+struct synthetic
+{
+    const uint8_t *frames;
+    size_t count;
+};
+
+static uint8_t *GenerateFrames(size_t count, unsigned short seed[3])
+{
+    uint8_t *frames = malloc(count * MPGA_FRAME_SIZE);
+    if (frames == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t *p = &frames[i * MPGA_FRAME_SIZE];
+
+        memcpy(p, "\xFF\xFD\xA4\x04", 4);
+        /* The payload is not valid: it is never looked at before decoding */
+        for (size_t j = 4; j < MPGA_FRAME_SIZE; j++)
+            p[j] = nrand48(seed);
+    }
+    return frames;
+}
+
+static const uint8_t *GetFrame(const struct synthetic *syn, size_t i)
+{
+    return &syn->frames[i * MPGA_FRAME_SIZE];
+}
+
+static void Write(struct vlc_memstream *ms, const void *data, size_t size)
+{
+    vlc_memstream_write(ms, data, size);
+}
+
+static void Write8(struct vlc_memstream *ms, uint8_t v)
+{
+    vlc_memstream_putc(ms, v);
+}
+
+static void WriteBE16(struct vlc_memstream *ms, uint16_t v)
+{
+    uint8_t buf[2];
+    SetWBE(buf, v);
+    Write(ms, buf, sizeof (buf));
+}
+
+static void WriteBE32(struct vlc_memstream *ms, uint32_t v)
+{
+    uint8_t buf[4];
+    SetDWBE(buf, v);
+    Write(ms, buf, sizeof (buf));
+}
+
+static void WriteBE64(struct vlc_memstream *ms, uint64_t v)
+{
+    uint8_t buf[8];
+    SetQWBE(buf, v);
+    Write(ms, buf, sizeof (buf));
+}
+
+static void WriteLE16(struct vlc_memstream *ms, uint16_t v)
+{
+    uint8_t buf[2];
+    SetWLE(buf, v);
+    Write(ms, buf, sizeof (buf));
+}
+
+static void WriteLE32(struct vlc_memstream *ms, uint32_t v)
+{
+    uint8_t buf[4];
+    SetDWLE(buf, v);
+    Write(ms, buf, sizeof (buf));
+}
+
+static void WriteZeros(struct vlc_memstream *ms, size_t count)
+{
+    while (count-- > 0)
+        Write8(ms, 0);
+}
+
+static size_t Tell(struct vlc_memstream *ms)
+{
+    int ret = vlc_memstream_flush(ms);
+    assert(ret == 0);
+    return ms->length;
+}
+
+/* Patches a size field once its box, chunk or element is complete */
+static void PatchBE32(struct vlc_memstream *ms, size_t offset, uint32_t v)
+{
+    Tell(ms);
+    SetDWBE(&ms->ptr[offset], v);
+}
+
+static void PatchLE32(struct vlc_memstream *ms, size_t offset, uint32_t v)
+{
+    Tell(ms);
+    SetDWLE(&ms->ptr[offset], v);
+}
+
+static void PatchBE64(struct vlc_memstream *ms, size_t offset, uint64_t v)
+{
+    Tell(ms);
+    SetQWBE(&ms->ptr[offset], v);
+}
+
+/* Elementary stream */
+static void MuxES(struct vlc_memstream *ms, const struct synthetic *syn)
+{
+    Write(ms, syn->frames, syn->count * MPGA_FRAME_SIZE);
+}
+
+/* MPEG-TS: one PES per frame, PSI every 40 frames, PCR on the audio PID */
+#define TS_PMT_PID 0x1000
+#define TS_ES_PID 0x100
+#define TS_PSI_INTERVAL 40
+
+static uint32_t TsCrc32(const uint8_t *p, size_t size)
+{
+    uint32_t crc = 0xffffffff;
+
+    while (size-- > 0)
+    {
+        crc ^= (uint32_t) *(p++) << 24;
+        for (int i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04c11db7 : 0);
+    }
+    return crc;
+}
+
+static void TsWritePsi(struct vlc_memstream *ms, uint16_t pid, uint8_t *cc,
+                       uint8_t *section, size_t size)
+{
+    SetDWBE(&section[size - 4], TsCrc32(section, size - 4));
+
+    Write8(ms, 0x47);
+    WriteBE16(ms, 0x4000 | pid);
+    Write8(ms, 0x10 | (*cc)++ % 16);
+    Write8(ms, 0x00); /* pointer field */
+    Write(ms, section, size);
+    for (size_t i = 5 + size; i < 188; i++)
+        Write8(ms, 0xff);
+}
+
+static void TsWritePat(struct vlc_memstream *ms, uint8_t *cc)
+{
+    uint8_t pat[] = {
+        0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0x00, 0x01, 0xe0 | (TS_PMT_PID >> 8), TS_PMT_PID & 0xff,
+        0, 0, 0, 0,
+    };
+    TsWritePsi(ms, 0, cc, pat, sizeof (pat));
+}
+
+static void TsWritePmt(struct vlc_memstream *ms, uint8_t *cc)
+{
+    uint8_t pmt[] = {
+        0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0xe0 | (TS_ES_PID >> 8), TS_ES_PID & 0xff, 0xf0, 0x00,
+        0x03 /* MPEG-1 audio */, 0xe0 | (TS_ES_PID >> 8), TS_ES_PID & 0xff,
+        0xf0, 0x00,
+        0, 0, 0, 0,
+    };
+    TsWritePsi(ms, TS_PMT_PID, cc, pmt, sizeof (pmt));
+}
+
+static void TsWritePes(struct vlc_memstream *ms, uint8_t *cc, int64_t pcr,
+                       const uint8_t *pes, size_t size)
+{
+    bool start = true;
+
+    while (size > 0)
+    {
+        /* Adaptation field, including its length byte */
+        size_t af = start && pcr >= 0 ? 8 : 0;
+        size_t payload = __MIN(size, 184 - af);
+        if (payload < 184 - af)
+            af = 184 - payload;
+
+        Write8(ms, 0x47);
+        WriteBE16(ms, (start ? 0x4000 : 0) | TS_ES_PID);
+        Write8(ms, (af ? 0x30 : 0x10) | (*cc)++ % 16);
+        if (af > 0)
+        {
+            Write8(ms, af - 1);
+            if (af > 1)
+            {
+                size_t stuffing = af - 2;
+
+                if (start && pcr >= 0)
+                {
+                    Write8(ms, 0x10);
+                    WriteBE32(ms, pcr >> 1);
+                    Write8(ms, ((pcr & 1) << 7) | 0x7e);
+                    Write8(ms, 0x00);
+                    stuffing -= 6;
+                }
+                else
+                    Write8(ms, 0x00);
+                for (size_t i = 0; i < stuffing; i++)
+                    Write8(ms, 0xff);
+            }
+        }
+        Write(ms, pes, payload);
+
+        pes += payload;
+        size -= payload;
+        start = false;
+    }
+}
+
+static void MuxTS(struct vlc_memstream *ms, const struct synthetic *syn)
+{
+    uint8_t cc_pat = 0, cc_pmt = 0, cc_es = 0;
+    uint8_t pes[14 + MPGA_FRAME_SIZE];
+
+    for (size_t i = 0; i < syn->count; i++)
+    {
+        int64_t pts = 90000 + i * MPGA_FRAME_SAMPLES * 90000 / MPGA_RATE;
+        int64_t pcr = -1;
+
+        if (i % TS_PSI_INTERVAL == 0)
+        {
+            TsWritePat(ms, &cc_pat);
+            TsWritePmt(ms, &cc_pmt);
+        }
+        if (i % 2 == 0)
+            pcr = pts - 9000;
+
+        memcpy(pes, "\x00\x00\x01\xc0", 4);
+        SetWBE(&pes[4], 8 + MPGA_FRAME_SIZE);
+        pes[6] = 0x80;
+        pes[7] = 0x80; /* PTS only */
+        pes[8] = 5;
+        pes[9] = 0x21 | ((pts >> 29) & 0x0e);
+        SetWBE(&pes[10], ((pts >> 14) & 0xfffe) | 1);
+        SetWBE(&pes[12], ((pts << 1) & 0xfffe) | 1);
+        memcpy(&pes[14], GetFrame(syn, i), MPGA_FRAME_SIZE);
+
+        TsWritePes(ms, &cc_es, pcr, pes, sizeof (pes));
+    }
+}
+
+/* MP4: ftyp, mdat with chunks of 40 frames, then moov */
+#define MP4_CHUNK_FRAMES 40
+
+static size_t Mp4Open(struct vlc_memstream *ms, const char *type)
+{
+    size_t offset = Tell(ms);
+    WriteBE32(ms, 0);
+    Write(ms, type, 4);
+    return offset;
+}
+
+static size_t Mp4OpenFull(struct vlc_memstream *ms, const char *type,
+                          uint32_t flags)
+{
+    size_t offset = Mp4Open(ms, type);
+    WriteBE32(ms, flags); /* version 0 */
+    return offset;
+}
+
+static void Mp4Close(struct vlc_memstream *ms, size_t offset)
+{
+    PatchBE32(ms, offset, Tell(ms) - offset);
+}
+
+static void Mp4WriteMatrix(struct vlc_memstream *ms)
+{
+    static const uint32_t matrix[9] = {
+        0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(matrix); i++)
+        WriteBE32(ms, matrix[i]);
+}
+
+static void MuxMP4(struct vlc_memstream *ms, const struct synthetic *syn)
+{
+    const size_t chunks = (syn->count + MP4_CHUNK_FRAMES - 1)
+                        / MP4_CHUNK_FRAMES;
+    const uint32_t duration = syn->count * MPGA_FRAME_SAMPLES;
+
+    size_t box = Mp4Open(ms, "ftyp");
+    Write(ms, "isom", 4);
+    WriteBE32(ms, 0x200);
+    Write(ms, "isommp41", 8);
+    Mp4Close(ms, box);
+
+    size_t mdat = Mp4Open(ms, "mdat");
+    MuxES(ms, syn);
+    Mp4Close(ms, mdat);
+
+    size_t moov = Mp4Open(ms, "moov");
+
+    box = Mp4OpenFull(ms, "mvhd", 0);
+    WriteZeros(ms, 8); /* creation and modification times */
+    WriteBE32(ms, MPGA_RATE);
+    WriteBE32(ms, duration);
+    WriteBE32(ms, 0x10000); /* rate */
+    WriteBE16(ms, 0x100); /* volume */
+    WriteZeros(ms, 10);
+    Mp4WriteMatrix(ms);
+    WriteZeros(ms, 24);
+    WriteBE32(ms, 2); /* next track ID */
+    Mp4Close(ms, box);
+
+    size_t trak = Mp4Open(ms, "trak");
+
+    box = Mp4OpenFull(ms, "tkhd", 0x7);
+    WriteZeros(ms, 8);
+    WriteBE32(ms, 1); /* track ID */
+    WriteZeros(ms, 4);
+    WriteBE32(ms, duration);
+    WriteZeros(ms, 12); /* reserved, layer and alternate group */
+    WriteBE16(ms, 0x100); /* volume */
+    WriteZeros(ms, 2);
+    Mp4WriteMatrix(ms);
+    WriteZeros(ms, 8); /* width and height */
+    Mp4Close(ms, box);
+
+    size_t mdia = Mp4Open(ms, "mdia");
+
+    box = Mp4OpenFull(ms, "mdhd", 0);
+    WriteZeros(ms, 8);
+    WriteBE32(ms, MPGA_RATE);
+    WriteBE32(ms, duration);
+    WriteBE16(ms, 0x55c4); /* und */
+    WriteZeros(ms, 2);
+    Mp4Close(ms, box);
+
+    box = Mp4OpenFull(ms, "hdlr", 0);
+    WriteZeros(ms, 4);
+    Write(ms, "soun", 4);
+    WriteZeros(ms, 12 + 1);
+    Mp4Close(ms, box);
+
+    size_t minf = Mp4Open(ms, "minf");
+
+    box = Mp4OpenFull(ms, "smhd", 0);
+    WriteZeros(ms, 4);
+    Mp4Close(ms, box);
+
+    size_t dinf = Mp4Open(ms, "dinf");
+    box = Mp4OpenFull(ms, "dref", 0);
+    WriteBE32(ms, 1);
+    size_t url = Mp4OpenFull(ms, "url ", 0x1); /* self-contained */
+    Mp4Close(ms, url);
+    Mp4Close(ms, box);
+    Mp4Close(ms, dinf);
+
+    size_t stbl = Mp4Open(ms, "stbl");
+
+    box = Mp4OpenFull(ms, "stsd", 0);
+    WriteBE32(ms, 1);
+    size_t entry = Mp4Open(ms, "mp4a");
+    WriteZeros(ms, 6);
+    WriteBE16(ms, 1); /* data reference index */
+    WriteZeros(ms, 8);
+    WriteBE16(ms, MPGA_CHANNELS);
+    WriteBE16(ms, 16);
+    WriteZeros(ms, 4);
+    WriteBE32(ms, MPGA_RATE << 16);
+    size_t esds = Mp4OpenFull(ms, "esds", 0);
+    static const uint8_t es_descriptor[] = {
+        0x03, 21, 0x00, 0x01, 0x00,
+        0x04, 13, 0x6b /* MPEG-1 audio */, 0x15, 0x00, 0x02, 0x40,
+        MPGA_BITRATE >> 24, (MPGA_BITRATE >> 16) & 0xff,
+        (MPGA_BITRATE >> 8) & 0xff, MPGA_BITRATE & 0xff,
+        MPGA_BITRATE >> 24, (MPGA_BITRATE >> 16) & 0xff,
+        (MPGA_BITRATE >> 8) & 0xff, MPGA_BITRATE & 0xff,
+        0x06, 1, 0x02,
+    };
+    Write(ms, es_descriptor, sizeof (es_descriptor));
+    Mp4Close(ms, esds);
+    Mp4Close(ms, entry);
+    Mp4Close(ms, box);
+
+    box = Mp4OpenFull(ms, "stts", 0);
+    WriteBE32(ms, 1);
+    WriteBE32(ms, syn->count);
+    WriteBE32(ms, MPGA_FRAME_SAMPLES);
+    Mp4Close(ms, box);
+
+    box = Mp4OpenFull(ms, "stsc", 0);
+    size_t last = syn->count % MP4_CHUNK_FRAMES;
+    WriteBE32(ms, (last && chunks > 1) ? 2 : 1);
+    WriteBE32(ms, 1);
+    WriteBE32(ms, (last && chunks == 1) ? last : MP4_CHUNK_FRAMES);
+    WriteBE32(ms, 1);
+    if (last && chunks > 1)
+    {
+        WriteBE32(ms, chunks);
+        WriteBE32(ms, last);
+        WriteBE32(ms, 1);
+    }
+    Mp4Close(ms, box);
+
+    box = Mp4OpenFull(ms, "stsz", 0);
+    WriteBE32(ms, MPGA_FRAME_SIZE);
+    WriteBE32(ms, syn->count);
+    Mp4Close(ms, box);
+
+    box = Mp4OpenFull(ms, "stco", 0);
+    WriteBE32(ms, chunks);
+    for (size_t i = 0; i < chunks; i++)
+        WriteBE32(ms, mdat + 8 + i * MP4_CHUNK_FRAMES * MPGA_FRAME_SIZE);
+    Mp4Close(ms, box);
+
+    Mp4Close(ms, stbl);
+    Mp4Close(ms, minf);
+    Mp4Close(ms, mdia);
+    Mp4Close(ms, trak);
+    Mp4Close(ms, moov);
+}
+
+/* Matroska: one cluster per second of SimpleBlocks, without cues */
+#define MKV_CLUSTER_FRAMES 40
+
+static void EbmlWriteId(struct vlc_memstream *ms, uint32_t id)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        if ((id >> shift) != 0 || shift == 0)
+            Write8(ms, id >> shift);
+}
+
+static size_t EbmlOpen(struct vlc_memstream *ms, uint32_t id)
+{
+    EbmlWriteId(ms, id);
+    size_t offset = Tell(ms);
+    WriteBE64(ms, 0);
+    return offset;
+}
+
+static void EbmlClose(struct vlc_memstream *ms, size_t offset)
+{
+    PatchBE64(ms, offset, (UINT64_C(0x01) << 56) | (Tell(ms) - offset - 8));
+}
+
+static void EbmlWriteUint(struct vlc_memstream *ms, uint32_t id, uint64_t v)
+{
+    EbmlWriteId(ms, id);
+    Write8(ms, 0x88);
+    WriteBE64(ms, v);
+}
+
+static void EbmlWriteFloat(struct vlc_memstream *ms, uint32_t id, double v)
+{
+    union { double d; uint64_t u; } f = { .d = v };
+
+    EbmlWriteId(ms, id);
+    Write8(ms, 0x88);
+    WriteBE64(ms, f.u);
+}
+
+static void EbmlWriteString(struct vlc_memstream *ms, uint32_t id,
+                            const char *str)
+{
+    size_t len = strlen(str);
+
+    assert(len < 0x7f);
+    EbmlWriteId(ms, id);
+    Write8(ms, 0x80 | len);
+    Write(ms, str, len);
+}
+
+static void MuxMKV(struct vlc_memstream *ms, const struct synthetic *syn)
+{
+    size_t ebml = EbmlOpen(ms, 0x1a45dfa3);
+    EbmlWriteUint(ms, 0x4286, 1); /* EBMLVersion */
+    EbmlWriteUint(ms, 0x42f7, 1); /* EBMLReadVersion */
+    EbmlWriteUint(ms, 0x42f2, 4); /* EBMLMaxIDLength */
+    EbmlWriteUint(ms, 0x42f3, 8); /* EBMLMaxSizeLength */
+    EbmlWriteString(ms, 0x4282, "matroska"); /* DocType */
+    EbmlWriteUint(ms, 0x4287, 2); /* DocTypeVersion */
+    EbmlWriteUint(ms, 0x4285, 2); /* DocTypeReadVersion */
+    EbmlClose(ms, ebml);
+
+    size_t segment = EbmlOpen(ms, 0x18538067);
+
+    size_t info = EbmlOpen(ms, 0x1549a966);
+    EbmlWriteUint(ms, 0x2ad7b1, 1000000); /* TimestampScale */
+    EbmlWriteFloat(ms, 0x4489, /* Duration */
+                   MS_FROM_VLC_TICK(syn->count * MPGA_FRAME_LENGTH));
+    EbmlWriteString(ms, 0x4d80, "vlc bench"); /* MuxingApp */
+    EbmlWriteString(ms, 0x5741, "vlc bench"); /* WritingApp */
+    EbmlClose(ms, info);
+
+    size_t tracks = EbmlOpen(ms, 0x1654ae6b);
+    size_t track = EbmlOpen(ms, 0xae);
+    EbmlWriteUint(ms, 0xd7, 1); /* TrackNumber */
+    EbmlWriteUint(ms, 0x73c5, 1); /* TrackUID */
+    EbmlWriteUint(ms, 0x83, 2); /* TrackType: audio */
+    EbmlWriteString(ms, 0x86, "A_MPEG/L2"); /* CodecID */
+    size_t audio = EbmlOpen(ms, 0xe1);
+    EbmlWriteFloat(ms, 0xb5, MPGA_RATE); /* SamplingFrequency */
+    EbmlWriteUint(ms, 0x9f, MPGA_CHANNELS); /* Channels */
+    EbmlClose(ms, audio);
+    EbmlClose(ms, track);
+    EbmlClose(ms, tracks);
+
+    for (size_t i = 0; i < syn->count; i += MKV_CLUSTER_FRAMES)
+    {
+        vlc_tick_t base = i * MPGA_FRAME_LENGTH;
+        size_t cluster = EbmlOpen(ms, 0x1f43b675);
+        EbmlWriteUint(ms, 0xe7, MS_FROM_VLC_TICK(base)); /* Timestamp */
+
+        for (size_t j = i; j < syn->count && j < i + MKV_CLUSTER_FRAMES; j++)
+        {
+            EbmlWriteId(ms, 0xa3); /* SimpleBlock */
+            Write8(ms, 0x01);
+            WriteZeros(ms, 3);
+            WriteBE32(ms, 4 + MPGA_FRAME_SIZE);
+            Write8(ms, 0x81); /* track number */
+            WriteBE16(ms, MS_FROM_VLC_TICK(j * MPGA_FRAME_LENGTH - base));
+            Write8(ms, 0x80); /* key frame */
+            Write(ms, GetFrame(syn, j), MPGA_FRAME_SIZE);
+        }
+        EbmlClose(ms, cluster);
+    }
+    EbmlClose(ms, segment);
+}
+
+/* AVI: one chunk per frame, with the legacy index */
+static size_t RiffOpen(struct vlc_memstream *ms, const char *id,
+                       const char *type)
+{
+    Write(ms, id, 4);
+    size_t offset = Tell(ms);
+    WriteLE32(ms, 0);
+    if (type != NULL)
+        Write(ms, type, 4);
+    return offset;
+}
+
+static void RiffClose(struct vlc_memstream *ms, size_t offset)
+{
+    PatchLE32(ms, offset, Tell(ms) - offset - 4);
+}
+
+static void MuxAVI(struct vlc_memstream *ms, const struct synthetic *syn)
+{
+    size_t riff = RiffOpen(ms, "RIFF", "AVI ");
+    size_t hdrl = RiffOpen(ms, "LIST", "hdrl");
+
+    size_t chunk = RiffOpen(ms, "avih", NULL);
+    WriteLE32(ms, US_FROM_VLC_TICK(MPGA_FRAME_LENGTH));
+    WriteLE32(ms, MPGA_BITRATE / 8);
+    WriteLE32(ms, 0);
+    WriteLE32(ms, 0x10); /* AVIF_HASINDEX */
+    WriteLE32(ms, syn->count);
+    WriteLE32(ms, 0);
+    WriteLE32(ms, 1); /* streams */
+    WriteLE32(ms, MPGA_FRAME_SIZE);
+    WriteZeros(ms, 24); /* dimensions and reserved */
+    RiffClose(ms, chunk);
+
+    size_t strl = RiffOpen(ms, "LIST", "strl");
+    chunk = RiffOpen(ms, "strh", NULL);
+    Write(ms, "auds", 4);
+    WriteZeros(ms, 4 + 4 + 4 + 4); /* handler, flags, priority, initial */
+    WriteLE32(ms, MPGA_FRAME_SAMPLES); /* scale */
+    WriteLE32(ms, MPGA_RATE); /* rate */
+    WriteLE32(ms, 0);
+    WriteLE32(ms, syn->count);
+    WriteLE32(ms, MPGA_FRAME_SIZE);
+    WriteLE32(ms, UINT32_MAX); /* quality */
+    WriteLE32(ms, 0); /* sample size: one frame per chunk */
+    WriteZeros(ms, 8);
+    RiffClose(ms, chunk);
+
+    chunk = RiffOpen(ms, "strf", NULL);
+    WriteLE16(ms, 0x0050); /* WAVE_FORMAT_MPEG */
+    WriteLE16(ms, MPGA_CHANNELS);
+    WriteLE32(ms, MPGA_RATE);
+    WriteLE32(ms, MPGA_BITRATE / 8);
+    WriteLE16(ms, MPGA_FRAME_SAMPLES);
+    WriteLE16(ms, 0);
+    WriteLE16(ms, 0);
+    RiffClose(ms, chunk);
+    RiffClose(ms, strl);
+    RiffClose(ms, hdrl);
+
+    size_t movi = RiffOpen(ms, "LIST", "movi");
+    for (size_t i = 0; i < syn->count; i++)
+    {
+        Write(ms, "00wb", 4);
+        WriteLE32(ms, MPGA_FRAME_SIZE);
+        Write(ms, GetFrame(syn, i), MPGA_FRAME_SIZE);
+    }
+    RiffClose(ms, movi);
+
+    chunk = RiffOpen(ms, "idx1", NULL);
+    for (size_t i = 0; i < syn->count; i++)
+    {
+        Write(ms, "00wb", 4);
+        WriteLE32(ms, 0x10); /* AVIIF_KEYFRAME */
+        /* Relative to the movi list type */
+        WriteLE32(ms, 4 + i * (8 + MPGA_FRAME_SIZE));
+        WriteLE32(ms, MPGA_FRAME_SIZE);
+    }
+    RiffClose(ms, chunk);
+    RiffClose(ms, riff);
+}
+
+static const struct
+{
+    const char *name;
+    const char *demux;
+    void (*mux)(struct vlc_memstream *, const struct synthetic *);
+} synthetic_inputs[] = {
+    { "synthetic.ts", "ts", MuxTS },
+    { "synthetic.mp4", "mp4", MuxMP4 },
+    { "synthetic.mkv", "mkv", MuxMKV },
+    { "synthetic.avi", "avi", MuxAVI },
+    { "synthetic.mpga", "es", MuxES },
+};
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+static int Bench(vlc_object_t *parent, struct bench_result *res,
+                 const char *url, const char *demux_name, bool decode,
+                 const uint8_t *buf, size_t size)
+{
+    struct bench_es_out ctx = {
+        .out = { .cbs = &es_out_cbs },
+        .parent = parent,
+        .decode = decode,
+        .res = res,
+    };
+
+    res->demux = demux_name;
+    res->bytes = size;
+
+    stream_t *s = vlc_stream_MemoryNew(parent, (uint8_t *) buf, size, true);
+    if (s == NULL)
+        return -1;
+
+    unsigned long long allocs = GetAllocations();
+    vlc_tick_t cpu = ThreadTime();
+    vlc_tick_t start = vlc_tick_now();
+
+    demux_t *demux = demux_New(parent, demux_name, url, s, &ctx.out);
+    if (demux == NULL)
+    {
+        vlc_stream_Delete(s);
+        return -1;
+    }
+
+    while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+
+    demux_Delete(demux);
+
+    res->elapsed = vlc_tick_now() - start;
+    cpu = ThreadTime() - cpu;
+    res->allocations = GetAllocations() - allocs;
+
+    /* The demuxer time is what is left */
+    for (size_t i = 0; i < res->module_count; i++)
+        cpu -= res->modules[i].time;
+    AccountTime(res, "demux", res->demux, cpu);
+    return 0;
+}
+
+static double PerSecond(double value, vlc_tick_t elapsed)
+{
+    return value * CLOCK_FREQ / (elapsed ? elapsed : 1);
+}
+
+static void PrintText(const struct bench_result *res)
+{
+    printf("%-24s %-6s %8.1f MB/s %10.0f packets/s %10.0f frames/s"
+#ifdef HAVE_ALLOCATION_COUNT
+           " %10llu allocations"
+#endif
+           "\n", res->input, res->demux,
+           PerSecond(res->bytes / 1e6, res->elapsed),
+           PerSecond(res->packets, res->elapsed),
+           PerSecond(res->frames, res->elapsed)
+#ifdef HAVE_ALLOCATION_COUNT
+           , res->allocations
+#endif
+           );
+
+    for (size_t i = 0; i < res->module_count; i++)
+        printf("    %-10s %-16s %9.1f ms CPU\n", res->modules[i].type,
+               res->modules[i].name,
+               (double) res->modules[i].time / VLC_TICK_FROM_MS(1));
+}
+
+static void PrintJSONString(const char *str)
+{
+    putchar('"');
+    for (; *str; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+static void PrintJSON(const struct bench_result *res, bool first)
+{
+    printf("%s\n    {\n      \"input\": ", first ? "" : ",");
+    PrintJSONString(res->input);
+    printf(",\n      \"demux\": ");
+    PrintJSONString(res->demux);
+    printf(",\n      \"bytes\": %zu,\n"
+           "      \"time_us\": %"PRId64",\n"
+           "      \"mb_per_s\": %.3f,\n"
+           "      \"packets\": %"PRIu64",\n"
+           "      \"packets_per_s\": %.1f,\n"
+           "      \"frames\": %"PRIu64",\n"
+           "      \"frames_per_s\": %.1f,\n",
+           res->bytes, US_FROM_VLC_TICK(res->elapsed),
+           PerSecond(res->bytes / 1e6, res->elapsed),
+           res->packets, PerSecond(res->packets, res->elapsed),
+           res->frames, PerSecond(res->frames, res->elapsed));
+#ifdef HAVE_ALLOCATION_COUNT
+    printf("      \"allocations\": %llu,\n", res->allocations);
+#else
+    printf("      \"allocations\": null,\n");
+#endif
+    printf("      \"modules\": [");
+    for (size_t i = 0; i < res->module_count; i++)
+    {
+        printf("%s\n        { \"type\": \"%s\", \"name\": ",
+               i ? "," : "", res->modules[i].type);
+        PrintJSONString(res->modules[i].name);
+        printf(", \"cpu_us\": %"PRId64" }",
+               US_FROM_VLC_TICK(res->modules[i].time));
+    }
+    printf("\n      ]\n    }");
+}
+
+static void Report(const struct bench_result *res, bool json, bool *first)
+{
+    if (json)
+        PrintJSON(res, *first);
+    else
+        PrintText(res);
+    *first = false;
+}
+
+static uint8_t *ReadFile(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+
+    uint8_t *buf = NULL;
+    long len;
+
+    if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) > 0
+     && fseek(file, 0, SEEK_SET) == 0)
+    {
+        buf = malloc(len);
+        if (buf != NULL && fread(buf, 1, len, file) != (size_t) len)
+        {
+            free(buf);
+            buf = NULL;
+        }
+        *size = len;
+    }
+    fclose(file);
+    return buf;
+}
+
+static void usage(const char *path)
+{
+    fprintf(stderr, "Usage: %s [-j] [-d] [-s seed] [-t seconds] "
+            "[files...]\n", path);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = false, decode = false;
+    unsigned long seed = 1, seconds = 600;
+    int c;
+
+    while ((c = getopt(argc, argv, "jds:t:")) != -1)
+        switch (c)
+        {
+            case 'j':
+                json = true;
+                break;
+            case 'd':
+                decode = true;
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                seconds = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 0);
+
+    const char *args[] = { "--quiet" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    bool first = true;
+
+    if (json)
+        printf("{\n  \"seed\": %lu,\n  \"seconds\": %lu,\n"
+               "  \"decode\": %s,\n  \"results\": [",
+               seed, seconds, decode ? "true" : "false");
+
+    if (optind == argc)
+    {
+        unsigned short xsubi[3] = { 0x330e, seed, seed >> 16 };
+        struct synthetic syn = {
+            .count = VLC_TICK_FROM_SEC(seconds) / MPGA_FRAME_LENGTH,
+        };
+        uint8_t *frames = GenerateFrames(syn.count, xsubi);
+        assert(frames != NULL);
+        syn.frames = frames;
+
+        for (size_t i = 0; i < ARRAY_SIZE(synthetic_inputs); i++)
+        {
+            struct vlc_memstream ms;
+            struct bench_result res = { .input = synthetic_inputs[i].name };
+
+            if (vlc_memstream_open(&ms))
+                abort();
+            synthetic_inputs[i].mux(&ms, &syn);
+            if (vlc_memstream_close(&ms))
+                abort();
+
+            if (Bench(parent, &res, "vlc://nop", synthetic_inputs[i].demux,
+                      decode, (uint8_t *) ms.ptr, ms.length) == 0)
+                Report(&res, json, &first);
+            else if (!json)
+                printf("%-24s %-6s not available\n", res.input,
+                       synthetic_inputs[i].demux);
+            free(ms.ptr);
+        }
+        free(frames);
+    }
+
+    for (int i = optind; i < argc; i++)
+    {
+        struct bench_result res = { .input = argv[i] };
+        size_t size;
+        uint8_t *buf = ReadFile(argv[i], &size);
+        char *url = vlc_path2uri(argv[i], NULL);
+
+        if (buf == NULL || url == NULL)
+            fprintf(stderr, "Error: cannot read %s\n", argv[i]);
+        else if (Bench(parent, &res, url, "any", decode, buf, size) == 0)
+            Report(&res, json, &first);
+        else
+            fprintf(stderr, "Error: cannot demux %s\n", argv[i]);
+        free(url);
+        free(buf);
+    }
+
+    if (json)
+        printf("\n  ]\n}\n");
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * es_out_bench.c: ES output benchmark with many elementary streams
+ *****************************************************************************
+ * Copyright (C) 2023 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the time spent to demux generated streams with up to 20 programs
+ * and 240 ES, only one of which is selected, as with satellite multiplexes:
+ *
+ *   make -C test bench_src_input_es_out
+ *   test/bench_src_input_es_out [seconds of stream] [VLC options]
+ *
+ * The stream is sent to a dummy stream output, so that the input runs as
+ * fast as it can. Pass --sout-all to send all the ES to it.
+ */
+
+#include "../../libvlc/test.h"
+
+#include <sys/resource.h>
+
+static const struct
+{
+    unsigned programs;
+    unsigned tracks; /* audio tracks per program */
+} bench_streams[] = {
+    { 1, 2 },
+    { 1, 24 },
+    { 20, 2 },
+    { 20, 12 },
+};
+
+static vlc_tick_t cpu_time(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru))
+        return 0;
+    return vlc_tick_from_timeval(&ru.ru_utime)
+         + vlc_tick_from_timeval(&ru.ru_stime);
+}
+
+static void on_stopped(const struct libvlc_event_t *event, void *data)
+{
+    (void) event;
+    vlc_sem_post(data);
+}
+
+static void bench(libvlc_instance_t *vlc, unsigned programs, unsigned tracks,
+                  unsigned seconds)
+{
+    char mrl[256];
+    snprintf(mrl, sizeof (mrl), "mock://program_count=%u;audio_track_count=%u;"
+             "audio_channels=1;audio_rate=8000;audio_sinewave=false;"
+             "can_control_pace=false;"
+             "length=%"PRId64, programs, tracks, VLC_TICK_FROM_SEC(seconds));
+
+    libvlc_media_t *md = libvlc_media_new_location(vlc, mrl);
+    assert(md != NULL);
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    vlc_sem_t stopped;
+    vlc_sem_init(&stopped, 0);
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    int ret = libvlc_event_attach(em, libvlc_MediaPlayerStopped, on_stopped,
+                                  &stopped);
+    assert(ret == 0);
+
+    vlc_tick_t cpu = cpu_time();
+    vlc_tick_t start = vlc_tick_now();
+    ret = libvlc_media_player_play(mp);
+    assert(ret == 0);
+    vlc_sem_wait(&stopped);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    cpu = cpu_time() - cpu;
+
+    /* One block per track every 40 ms */
+    double blocks = (double) programs * tracks * seconds * 25;
+
+    printf("%2u programs %4u ES: %7"PRId64" ms, %7"PRId64" ms CPU, "
+           "%6.0fx realtime, %6.2f us/block\n",
+           programs, programs * tracks, MS_FROM_VLC_TICK(elapsed),
+           MS_FROM_VLC_TICK(cpu),
+           (double) VLC_TICK_FROM_SEC(seconds) / (elapsed ? elapsed : 1),
+           (double) cpu / blocks);
+
+    libvlc_media_player_release(mp);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 600;
+    const char *args[64] = {
+        "--quiet", "--sout=#dummy", "--no-sout-all",
+    };
+    int nargs = 3;
+
+    for (int i = 2; i < argc && nargs < (int)ARRAY_SIZE(args); i++)
+        args[nargs++] = argv[i];
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 0);
+
+    libvlc_instance_t *vlc = libvlc_new(nargs, args);
+    assert(vlc != NULL);
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_streams); i++)
+        bench(vlc, bench_streams[i].programs, bench_streams[i].tracks,
+              seconds);
+
+    libvlc_release(vlc);
+    return 0;
+}
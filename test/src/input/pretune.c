@@ -0,0 +1,235 @@
+/*****************************************************************************
+ * pretune.c: test switching to pre-tuned playlist items
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_player.h>
+#include <vlc_playlist.h>
+#include <vlc_input_item.h>
+
+/* A live source, starting from 0 when it is first demuxed: a pre-tuned item
+ * is already ahead when it is played. */
+#define MOCK_MRL "mock://video_track_count=1;audio_track_count=1" \
+    ";length=60000000;video_width=64;video_height=48;realtime=true" \
+    ";can_pause=false;can_seek=false;can_control_pace=false"
+
+#define ITEM_COUNT 4
+
+struct test_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    input_item_t *media;
+    vlc_tick_t first_time; /**< first time of the current media */
+    vlc_tick_t time;
+};
+
+static void
+on_current_media_changed( vlc_player_t *player, input_item_t *new_media,
+                          void *data )
+{
+    (void) player;
+    struct test_ctx *ctx = data;
+
+    vlc_mutex_lock( &ctx->lock );
+    ctx->media = new_media;
+    ctx->first_time = ctx->time = VLC_TICK_INVALID;
+    vlc_cond_broadcast( &ctx->wait );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static void
+on_position_changed( vlc_player_t *player, vlc_tick_t time, float pos,
+                     void *data )
+{
+    (void) player; (void) pos;
+    struct test_ctx *ctx = data;
+
+    vlc_mutex_lock( &ctx->lock );
+    if( ctx->first_time == VLC_TICK_INVALID )
+        ctx->first_time = time;
+    ctx->time = time;
+    vlc_cond_broadcast( &ctx->wait );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+/* Waits for the given media to be played past min, returns its first time */
+static vlc_tick_t
+wait_media( struct test_ctx *ctx, input_item_t *media, vlc_tick_t min )
+{
+    const vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_SEC( 2 );
+
+    vlc_mutex_lock( &ctx->lock );
+    while( ctx->media != media || ctx->time == VLC_TICK_INVALID
+        || ctx->time < min )
+        if( vlc_cond_timedwait( &ctx->wait, &ctx->lock, deadline ) )
+            break;
+    assert( ctx->media == media && ctx->time != VLC_TICK_INVALID );
+    vlc_tick_t time = ctx->first_time;
+    vlc_mutex_unlock( &ctx->lock );
+    return time;
+}
+
+static void
+wait_media_changed( struct test_ctx *ctx, input_item_t *media )
+{
+    const vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_SEC( 2 );
+
+    vlc_mutex_lock( &ctx->lock );
+    while( ctx->media != media )
+        if( vlc_cond_timedwait( &ctx->wait, &ctx->lock, deadline ) )
+            break;
+    assert( ctx->media == media );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static void
+wait_for( struct test_ctx *ctx, vlc_tick_t delay )
+{
+    const vlc_tick_t deadline = vlc_tick_now() + delay;
+
+    vlc_mutex_lock( &ctx->lock );
+    while( vlc_cond_timedwait( &ctx->wait, &ctx->lock, deadline ) == 0 );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static void test_pretune( libvlc_instance_t *vlc, bool live )
+{
+    test_log( "pre-tuned %s neighbours\n", live ? "live" : "idle" );
+
+    vlc_playlist_t *playlist =
+        vlc_playlist_New( VLC_OBJECT( vlc->p_libvlc_int ) );
+    assert( playlist != NULL );
+    vlc_player_t *player = vlc_playlist_GetPlayer( playlist );
+
+    struct test_ctx ctx = {
+        .first_time = VLC_TICK_INVALID,
+        .time = VLC_TICK_INVALID,
+    };
+    vlc_mutex_init( &ctx.lock );
+    vlc_cond_init( &ctx.wait );
+
+    static const struct vlc_player_cbs cbs = {
+        .on_current_media_changed = on_current_media_changed,
+        .on_position_changed = on_position_changed,
+    };
+
+    input_item_t *items[ITEM_COUNT];
+    for( size_t i = 0; i < ITEM_COUNT; i++ )
+    {
+        items[i] = input_item_New( MOCK_MRL, "mock item" );
+        assert( items[i] != NULL );
+    }
+
+    vlc_playlist_Lock( playlist );
+    vlc_player_listener_id *listener =
+        vlc_player_AddListener( player, &cbs, &ctx );
+    assert( listener != NULL );
+    int ret = vlc_playlist_Insert( playlist, 0, items, ITEM_COUNT );
+    assert( ret == VLC_SUCCESS );
+    ret = vlc_playlist_GoTo( playlist, 0 );
+    assert( ret == VLC_SUCCESS );
+    ret = vlc_playlist_Start( playlist );
+    assert( ret == VLC_SUCCESS );
+    vlc_playlist_Unlock( playlist );
+
+    /* Adopt: the next item is pre-tuned while the first one plays */
+    wait_media( &ctx, items[0], VLC_TICK_0 );
+    wait_for( &ctx, VLC_TICK_FROM_MS( 800 ) );
+    vlc_playlist_Lock( playlist );
+    ret = vlc_playlist_Next( playlist );
+    assert( ret == VLC_SUCCESS );
+    vlc_playlist_Unlock( playlist );
+
+    vlc_tick_t first = wait_media( &ctx, items[1], VLC_TICK_0 );
+    if( live )
+        assert( first >= VLC_TICK_FROM_MS( 400 ) );
+    else
+        assert( first < VLC_TICK_FROM_MS( 400 ) );
+
+    /* Delete: the removed neighbour is no longer pre-tuned */
+    vlc_playlist_Lock( playlist );
+    vlc_playlist_Remove( playlist, 2, 1 );
+    vlc_playlist_Unlock( playlist );
+    wait_for( &ctx, VLC_TICK_FROM_MS( 100 ) );
+
+    /* Delete racing an adopt: the neighbours change while the input of the
+     * pre-tuned item is being opened */
+    vlc_playlist_Lock( playlist );
+    ret = vlc_playlist_Next( playlist );
+    assert( ret == VLC_SUCCESS );
+    vlc_playlist_Unlock( playlist );
+    wait_media_changed( &ctx, items[3] );
+    vlc_playlist_Lock( playlist );
+    vlc_playlist_Remove( playlist, 0, 1 );
+    ret = vlc_playlist_Insert( playlist, 0, &items[2], 1 );
+    assert( ret == VLC_SUCCESS );
+    vlc_playlist_Unlock( playlist );
+    wait_media( &ctx, items[3], VLC_TICK_0 );
+
+    /* Delete while the switch to a pre-tuned item is pending */
+    vlc_playlist_Lock( playlist );
+    ret = vlc_playlist_Prev( playlist );
+    assert( ret == VLC_SUCCESS );
+    vlc_playlist_Clear( playlist );
+    vlc_playlist_Unlock( playlist );
+
+    vlc_playlist_Lock( playlist );
+    vlc_player_RemoveListener( player, listener );
+    vlc_playlist_Unlock( playlist );
+    vlc_playlist_Delete( playlist );
+
+    for( size_t i = 0; i < ITEM_COUNT; i++ )
+        input_item_Release( items[i] );
+}
+
+int main( void )
+{
+    test_init();
+
+    const char *argv[] = {
+        "-v",
+        "--ignore-config",
+        "-Idummy",
+        "--no-media-library",
+        "--codec=araw,rawvideo,none",
+        "--dec-dev=none",
+        "--vout=dummy",
+        "--aout=dummy",
+        "--text-renderer=tdummy",
+        "--zap-ahead=1",
+        NULL,
+    };
+    const int argc = ARRAY_SIZE( argv ) - 1;
+
+    libvlc_instance_t *vlc = libvlc_new( argc, argv );
+    assert( vlc != NULL );
+    test_pretune( vlc, true );
+    libvlc_release( vlc );
+
+    argv[argc] = "--zap-ahead-live=0";
+    vlc = libvlc_new( argc + 1, argv );
+    assert( vlc != NULL );
+    test_pretune( vlc, false );
+    libvlc_release( vlc );
+    return 0;
+}
@@ -208,6 +208,83 @@ static void test_cancel_thumbnail( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+struct strip_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t count;
+    size_t received;
+    bool b_expected_success;
+};
+
+static void thumbnailer_callback_strip( void* data, size_t index,
+                                        picture_t* p_thumbnail )
+{
+    struct strip_ctx* p_ctx = data;
+    vlc_mutex_lock( &p_ctx->lock );
+
+    assert( index == p_ctx->received && "Unexpected thumbnail order" );
+    if ( p_ctx->b_expected_success )
+    {
+        assert( p_thumbnail != NULL );
+        assert( p_thumbnail->format.i_chroma == VLC_CODEC_ARGB );
+    }
+    else
+        assert( p_thumbnail == NULL );
+
+    p_ctx->received++;
+    if ( p_ctx->received == p_ctx->count )
+        vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void test_strip_thumbnails( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    static const vlc_tick_t times[] = {
+        VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 120 ),
+        VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 4 * 60 ),
+    };
+    static const char* mrls[] = {
+        "mock://video_track_count=1;audio_track_count=1;length=300000000"
+        ";video_chroma=ARGB",
+        "mock://video_track_count=0;audio_track_count=1;length=300000000",
+    };
+
+    struct strip_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+
+    for ( size_t i = 0; i < ARRAY_SIZE( mrls ); ++i )
+    {
+        input_item_t* p_item = input_item_New( mrls[i], "mock item" );
+        assert( p_item != NULL );
+
+        ctx.count = ARRAY_SIZE( times );
+        ctx.received = 0;
+        ctx.b_expected_success = i == 0;
+
+        vlc_mutex_lock( &ctx.lock );
+        vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestStrip(
+            p_thumbnailer, times, ARRAY_SIZE( times ), 0, 0, p_item,
+            VLC_TICK_FROM_SEC( 2 ), thumbnailer_callback_strip, &ctx );
+        assert( p_req != NULL );
+        while ( ctx.received < ctx.count )
+        {
+            vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 5 );
+            int res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+            assert( res != ETIMEDOUT );
+        }
+        vlc_mutex_unlock( &ctx.lock );
+
+        input_item_Release( p_item );
+    }
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 int main()
 {
     test_init();
@@ -221,6 +298,7 @@ int main()
 
     test_thumbnails( vlc );
     test_cancel_thumbnail( vlc );
+    test_strip_thumbnails( vlc );
 
     libvlc_release( vlc );
 }
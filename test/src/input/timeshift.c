@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * timeshift.c: test jumping inside the timeshift buffer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_player.h>
+#include <vlc_input_item.h>
+
+/* A live source: it can't pause, seek nor be paced, so that pausing starts
+ * the timeshift and relative jumps can only be done inside it. */
+#define MOCK_MRL "mock://video_track_count=1;audio_track_count=1" \
+    ";length=60000000;video_width=64;video_height=48;realtime=true" \
+    ";can_pause=false;can_seek=false;can_control_pace=false"
+
+struct test_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_tick_t time;
+};
+
+static void
+on_position_changed( vlc_player_t *player, vlc_tick_t time, float pos,
+                     void *data )
+{
+    (void) player; (void) pos;
+    struct test_ctx *ctx = data;
+
+    vlc_mutex_lock( &ctx->lock );
+    ctx->time = time;
+    vlc_cond_broadcast( &ctx->wait );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static vlc_tick_t
+get_time( struct test_ctx *ctx )
+{
+    vlc_mutex_lock( &ctx->lock );
+    vlc_tick_t time = ctx->time;
+    vlc_mutex_unlock( &ctx->lock );
+    return time;
+}
+
+static vlc_tick_t
+wait_time( struct test_ctx *ctx, vlc_tick_t min, vlc_tick_t max,
+           vlc_tick_t timeout )
+{
+    const vlc_tick_t deadline = vlc_tick_now() + timeout;
+
+    vlc_mutex_lock( &ctx->lock );
+    while( ctx->time == VLC_TICK_INVALID
+        || ctx->time < min || ctx->time > max )
+        if( vlc_cond_timedwait( &ctx->wait, &ctx->lock, deadline ) )
+            break;
+    vlc_tick_t time = ctx->time;
+    vlc_mutex_unlock( &ctx->lock );
+    return time;
+}
+
+static void
+wait_for( struct test_ctx *ctx, vlc_tick_t delay )
+{
+    const vlc_tick_t deadline = vlc_tick_now() + delay;
+
+    vlc_mutex_lock( &ctx->lock );
+    while( vlc_cond_timedwait( &ctx->wait, &ctx->lock, deadline ) == 0 );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static void test_timeshift_jumps( libvlc_instance_t *vlc )
+{
+    vlc_player_t *player = vlc_player_New( VLC_OBJECT( vlc->p_libvlc_int ),
+                                           VLC_PLAYER_LOCK_NORMAL,
+                                           NULL, NULL );
+    assert( player != NULL );
+
+    struct test_ctx ctx = { .time = VLC_TICK_INVALID };
+    vlc_mutex_init( &ctx.lock );
+    vlc_cond_init( &ctx.wait );
+
+    static const struct vlc_player_cbs cbs = {
+        .on_position_changed = on_position_changed,
+    };
+
+    input_item_t *item = input_item_New( MOCK_MRL, "mock item" );
+    assert( item != NULL );
+
+    vlc_player_Lock( player );
+    vlc_player_listener_id *listener =
+        vlc_player_AddListener( player, &cbs, &ctx );
+    assert( listener != NULL );
+    int ret = vlc_player_SetCurrentMedia( player, item );
+    assert( ret == VLC_SUCCESS );
+    ret = vlc_player_Start( player );
+    assert( ret == VLC_SUCCESS );
+    vlc_player_Unlock( player );
+    input_item_Release( item );
+
+    vlc_tick_t time = wait_time( &ctx, VLC_TICK_FROM_MS( 300 ), INT64_MAX,
+                                 VLC_TICK_FROM_SEC( 3 ) );
+    assert( time >= VLC_TICK_FROM_MS( 300 ) );
+
+    /* The source goes on while paused: the timeshift stores it */
+    vlc_player_Lock( player );
+    vlc_player_Pause( player );
+    vlc_player_Unlock( player );
+    wait_for( &ctx, VLC_TICK_FROM_MS( 1500 ) );
+
+    const vlc_tick_t paused = get_time( &ctx );
+    vlc_player_Lock( player );
+    vlc_player_Resume( player );
+    vlc_player_Unlock( player );
+    time = wait_time( &ctx, paused + VLC_TICK_FROM_MS( 1200 ), INT64_MAX,
+                      VLC_TICK_FROM_SEC( 2 ) );
+    assert( time >= paused + VLC_TICK_FROM_MS( 1200 ) );
+
+    /* Backward, into the data already played from the buffer */
+    const vlc_tick_t before = get_time( &ctx );
+    vlc_player_Lock( player );
+    vlc_player_JumpTime( player, VLC_TICK_FROM_MS( -1000 ) );
+    vlc_player_Unlock( player );
+    time = wait_time( &ctx, VLC_TICK_0, before - VLC_TICK_FROM_MS( 200 ),
+                      VLC_TICK_FROM_SEC( 1 ) );
+    assert( time <= before - VLC_TICK_FROM_MS( 200 ) );
+    assert( time >= before - VLC_TICK_FROM_MS( 1200 ) );
+
+    /* Forward, still behind the live source */
+    const vlc_tick_t back = get_time( &ctx );
+    vlc_player_Lock( player );
+    vlc_player_JumpTime( player, VLC_TICK_FROM_MS( 1000 ) );
+    vlc_player_Unlock( player );
+    time = wait_time( &ctx, back + VLC_TICK_FROM_MS( 600 ), INT64_MAX,
+                      VLC_TICK_FROM_MS( 500 ) );
+    assert( time >= back + VLC_TICK_FROM_MS( 600 ) );
+
+    vlc_player_Lock( player );
+    vlc_player_Stop( player );
+    vlc_player_RemoveListener( player, listener );
+    vlc_player_Unlock( player );
+    vlc_player_Delete( player );
+}
+
+int main( void )
+{
+    test_init();
+
+    static const char *argv[] = {
+        "-v",
+        "--ignore-config",
+        "-Idummy",
+        "--no-media-library",
+        "--codec=araw,rawvideo,none",
+        "--dec-dev=none",
+        "--vout=dummy",
+        "--aout=dummy",
+        "--text-renderer=tdummy",
+        "--input-timeshift-memory=16",
+    };
+    libvlc_instance_t *vlc = libvlc_new( ARRAY_SIZE( argv ), argv );
+    assert( vlc != NULL );
+
+    test_timeshift_jumps( vlc );
+
+    libvlc_release( vlc );
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*****************************************************************************
+ * bank.c: test the plugins bank loading
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Loads the plugins bank without the plugins cache, so that every plugin is
+ * loaded (cold start), then with the cache (warm start), and checks that
+ * both give the same modules. The startup times are printed.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+
+#include <string.h>
+
+struct bank_module
+{
+    char *name;
+    char *capability;
+    int score;
+};
+
+static vlc_tick_t
+LoadBank(const char *cache, struct bank_module **modsp, size_t *countp)
+{
+    const char *args[] = { "-v", cache };
+
+    vlc_tick_t start = vlc_tick_now();
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    vlc_tick_t duration = vlc_tick_now() - start;
+    assert(vlc != NULL);
+
+    size_t count;
+    module_t **list = module_list_get(&count);
+    assert(list != NULL);
+
+    struct bank_module *mods = malloc(count * sizeof (*mods));
+    assert(mods != NULL);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *capability = module_get_capability(list[i]);
+
+        mods[i].name = strdup(module_get_object(list[i]));
+        mods[i].capability = strdup(capability ? capability : "");
+        mods[i].score = module_get_score(list[i]);
+        assert(mods[i].name != NULL && mods[i].capability != NULL);
+    }
+    module_list_free(list);
+    libvlc_release(vlc);
+
+    *modsp = mods;
+    *countp = count;
+    return duration;
+}
+
+static void
+FreeBank(struct bank_module *mods, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        free(mods[i].name);
+        free(mods[i].capability);
+    }
+    free(mods);
+}
+
+static int
+CompareModules(const void *a, const void *b)
+{
+    const struct bank_module *ma = a, *mb = b;
+    int ret = strcmp(ma->name, mb->name);
+
+    if (ret == 0)
+        ret = strcmp(ma->capability, mb->capability);
+    if (ret == 0)
+        ret = ma->score - mb->score;
+    return ret;
+}
+
+static void
+CheckSameBank(const struct bank_module *a, size_t acount,
+              const struct bank_module *b, size_t bcount)
+{
+    assert(acount == bcount);
+    for (size_t i = 0; i < acount; i++)
+    {
+        assert(!strcmp(a[i].name, b[i].name));
+        assert(!strcmp(a[i].capability, b[i].capability));
+        assert(a[i].score == b[i].score);
+    }
+}
+
+int main(void)
+{
+    test_init();
+
+    struct bank_module *cold, *cold2, *warm;
+    size_t cold_count, cold2_count, warm_count;
+    vlc_tick_t duration;
+
+    duration = LoadBank("--no-plugins-cache", &cold, &cold_count);
+    test_log("cold start: %zu modules in %"PRId64" ms\n", cold_count,
+             MS_FROM_VLC_TICK(duration));
+    assert(cold_count > 0);
+
+    duration = LoadBank("--plugins-cache", &warm, &warm_count);
+    test_log("warm start: %zu modules in %"PRId64" ms\n", warm_count,
+             MS_FROM_VLC_TICK(duration));
+
+    /* Plugins are loaded by several threads: the result must not depend on
+     * the scheduling */
+    duration = LoadBank("--no-plugins-cache", &cold2, &cold2_count);
+    test_log("cold start: %zu modules in %"PRId64" ms\n", cold2_count,
+             MS_FROM_VLC_TICK(duration));
+
+    CheckSameBank(cold, cold_count, cold2, cold2_count);
+
+    /* The cache does not keep the order of the submodules within a plugin */
+    qsort(cold, cold_count, sizeof (*cold), CompareModules);
+    qsort(warm, warm_count, sizeof (*warm), CompareModules);
+    CheckSameBank(cold, cold_count, warm, warm_count);
+
+    FreeBank(cold, cold_count);
+    FreeBank(cold2, cold2_count);
+    FreeBank(warm, warm_count);
+    return 0;
+}
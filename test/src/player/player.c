@@ -2531,6 +2531,74 @@ test_timers(struct ctx *ctx)
     }
 }
 
+static void
+test_timers_interpolation(struct ctx *ctx)
+{
+    test_log("timers interpolation\n");
+
+    vlc_player_t *player = ctx->player;
+
+    static const struct vlc_player_timer_cbs cbs =
+    {
+        .on_update = timers_on_update,
+        .on_discontinuity = timers_on_discontinuity,
+    };
+
+#define SPARSE_LENGTH VLC_TICK_FROM_MS(600)
+#define SPARSE_SAMPLE_LENGTH VLC_TICK_FROM_MS(200)
+#define INTERPOLATION_DELAY VLC_TICK_FROM_MS(20)
+
+    struct timer_state timer = { .delay = INTERPOLATION_DELAY };
+    vlc_vector_init(&timer.vec);
+    timer.id = vlc_player_AddTimer(player, timer.delay, &cbs, &timer);
+    assert(timer.id);
+
+    /* One clock update per audio sample */
+    struct media_params params = DEFAULT_MEDIA_PARAMS(SPARSE_LENGTH);
+    params.track_count[VIDEO_ES] = 0;
+    params.track_count[SPU_ES] = 0;
+    params.audio_sample_length = SPARSE_SAMPLE_LENGTH;
+
+    player_set_current_mock_media(ctx, "media1", &params, false);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_STARTED);
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+    test_end(ctx);
+
+    /* No more points once the timer is removed */
+    vlc_player_RemoveTimer(player, timer.id);
+
+    vec_report_timer *vec = &timer.vec;
+    size_t point_count = 0, interpolated_count = 0;
+
+    for (size_t i = 1; i < vec->size; ++i)
+    {
+        struct report_timer *prev_report = &vec->data[i - 1];
+        struct report_timer *report = &vec->data[i];
+
+        if (report->type != REPORT_TIMER_POINT
+         || prev_report->type != REPORT_TIMER_POINT
+         || prev_report->point.system_date == INT64_MAX)
+            continue;
+
+        /* Interpolated points follow the clock */
+        assert(report->point.ts >= prev_report->point.ts);
+        assert(report->point.position >= prev_report->point.position);
+        assert(report->point.system_date >= prev_report->point.system_date);
+        point_count++;
+
+        if ((report->point.ts - VLC_TICK_0) % SPARSE_SAMPLE_LENGTH != 0)
+            interpolated_count++;
+    }
+
+    /* The listener is updated about once per period, not once per sample */
+    assert(interpolated_count > 0);
+    assert(point_count > 2 * (SPARSE_LENGTH / SPARSE_SAMPLE_LENGTH));
+
+    vlc_vector_clear(&timer.vec);
+}
+
 static void
 test_teletext(struct ctx *ctx)
 {
@@ -2922,6 +2990,7 @@ main(void)
     test_tracks_ids(&ctx);
     test_programs(&ctx);
     test_timers(&ctx);
+    test_timers_interpolation(&ctx);
     test_teletext(&ctx);
 
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), true);